@@ -21,6 +21,7 @@
 #include "lx200aok.h"
 
 #include <cmath>
+#include <cstdlib>
 #include <memory>
 #include <cstring>
 #include <unistd.h>
@@ -319,6 +320,10 @@ bool LX200Skywalker::initProperties()
     IUFillText(&FirmwareVersionT[0], "Firmware", "Version", "123456");
     IUFillTextVector(&FirmwareVersionTP, FirmwareVersionT, 1, getDeviceName(), "Firmware", "Firmware", INFO_TAB, IP_RO, 60,
                      IPS_IDLE);
+    IUFillNumber(&TickStatisticsN[0], "TICK_DURATION", "Duration (ms)", "%.0f", 0.0, 60000, 0.0, 0.0);
+    IUFillNumber(&TickStatisticsN[1], "TICK_QUERIES", "Queries", "%.0f", 0.0, 100, 0.0, 0.0);
+    IUFillNumberVector(&TickStatisticsNP, TickStatisticsN, 2, getDeviceName(), "TICK_STATISTICS", "Status tick", INFO_TAB,
+                       IP_RO, 60, IPS_IDLE);
 
     // Setting the park position in the controller (with webinterface) evokes a restart of the very same!
     // 4th option "purge" of INDI::Telescope doesn't make any sense here, so it is not displayed
@@ -347,12 +352,14 @@ bool LX200Skywalker::updateProperties()
         defineProperty(&MountStateSP);
         defineProperty(&SystemSlewSpeedNP);
         defineProperty(&FirmwareVersionTP);
+        defineProperty(&TickStatisticsNP);
     }
     else
     {
         deleteProperty(MountStateSP.name);
         deleteProperty(SystemSlewSpeedNP.name);
         deleteProperty(FirmwareVersionTP.name);
+        deleteProperty(TickStatisticsNP.name);
     }
 
     return true;
@@ -363,6 +370,8 @@ bool LX200Skywalker::updateProperties()
 ***************************************************************************************/
 bool LX200Skywalker::Connect()
 {
+    // the TCS may have changed while we were not connected
+    invalidateStatus();
     if (! DefaultDevice::Connect())
         return false;
     return true;
@@ -375,11 +384,62 @@ bool LX200Skywalker::Disconnect()
 
 /**************************************************************************************
 **
-***************************************************************************************
+***************************************************************************************/
 bool LX200Skywalker::ReadScopeStatus()
 {
-    return (LX200Telescope::ReadScopeStatus());  // TCS does not :D#! -> ovverride isSlewComplete
-}*/
+    // Same sequence as LX200Telescope, but all queries go through sendQuery so they are counted
+    if (!isConnected())
+        return false;
+
+    if (isSimulation())
+    {
+        mountSim();
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+    tickQueryCount = 0;
+
+    // TCS does not :D#! -> isSlewComplete() queries "?#" while slewing or parking only
+    if (TrackState == SCOPE_SLEWING)
+    {
+        if (isSlewComplete())
+        {
+            IUResetSwitch(&SlewRateSP);
+            SlewRateS[SLEW_CENTERING].s = ISS_ON;
+            IDSetSwitch(&SlewRateSP, nullptr);
+            LOG_INFO("Slew is complete. Tracking...");
+        }
+    }
+    else if (TrackState == SCOPE_PARKING)
+    {
+        if (isSlewComplete())
+            SetParked(true);
+    }
+
+    char response[TCS_RESPONSE_BUFFER_LENGTH];
+    if (!sendQuery(":GR#", response) || f_scansexa(response, &currentRA) != 0 ||
+            !sendQuery(":GD#", response) || f_scansexa(response, &currentDEC) != 0)
+    {
+        EqNP.s = IPS_ALERT;
+        IDSetNumber(&EqNP, "Error reading RA/DEC.");
+        return false;
+    }
+
+    NewRaDec(currentRA, currentDEC);
+
+    updateTickStatistics(tickStart);
+    return true;
+}
+
+void LX200Skywalker::updateTickStatistics(std::chrono::steady_clock::time_point tickStart)
+{
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - tickStart;
+    TickStatisticsN[0].value = duration.count();
+    TickStatisticsN[1].value = tickQueryCount;
+    TickStatisticsNP.s = IPS_OK;
+    IDSetNumber(&TickStatisticsNP, nullptr);
+}
 
 bool LX200Skywalker::isSlewComplete()
 {
@@ -390,6 +450,10 @@ bool LX200Skywalker::isSlewComplete()
         // Slew complete?
         if (*response == '0') // Query response == '0', mount is not slewing (anymore)
         {
+            // The TCS changes lock state at the end of the motion, read lock and pier side once
+            if (!refreshStatus())
+                LOG_WARN("Failed to read TCS status at end of motion.");
+
             if (TrackState == SCOPE_SLEWING)
             {
                 notifyTrackState(SCOPE_TRACKING);
@@ -599,16 +663,13 @@ bool LX200Skywalker::SavePark()
 // the model itself!
 bool LX200Skywalker::notifyPierSide()
 {
-    char lstat[20] = {0};
-    if (getJSONData_Y(5, lstat, 20)) // this is the model!
+    if (tcsStatus.modelValid || fetchStatus_Y()) // this is the model!
     {
-        int li = std::stoi(lstat);
-        li = li & (1 << 7);
-        if (li > 0)
+        if (tcsStatus.pierWest)
             Telescope::setPierSide(INDI::Telescope::PIER_WEST);
         else
             Telescope::setPierSide(INDI::Telescope::PIER_EAST);
-        LOGF_INFO("Telescope pointing %s", (li > 0) ? "east" : "west");
+        LOGF_INFO("Telescope pointing %s", tcsStatus.pierWest ? "east" : "west");
         return true;
     }
     else
@@ -747,80 +808,92 @@ bool LX200Skywalker::setSiteLatitude(double Lat)
 
 }
 
-bool LX200Skywalker::getJSONData_gp(int jindex, char *jstr, int jstrlen) // preliminary hardcoded  :gp-query
+/*
+ * Send a :gp or :Y# query and read the JSON reply.
+ */
+bool LX200Skywalker::getJSONData(const char *cmd, char *json)
 {
-    char lresponse[128];
-    lresponse [0] = '\0';
-    char lcmd[4] = ":gp";
-    char end = '}';
-    if(!transmit(lcmd))
-    {
-        LOGF_ERROR("Command <%s> not transmitted.", lcmd);
-    }
-    if (receive(lresponse, end, 1))
+    json[0] = '\0';
+    if(!transmit(cmd))
     {
-        flush();
+        LOGF_ERROR("Command <%s> not transmitted.", cmd);
+        return false;
     }
-    else
+    if (!receive(json, '}', 1))
     {
         LOG_ERROR("Failed to get JSONData");
         return false;
     }
+    flush();
+    return true;
+}
+
+/*
+ * Decode firmware version and lock state from the :gp reply in one pass.
+ */
+bool LX200Skywalker::fetchStatus_gp()
+{
+    char lresponse[128];
+    if (!getJSONData(":gp", lresponse))
+        return false;
+
     char data[3][40] = {"", "", ""};
-    int returnCode = sscanf(lresponse, "%*[^[][%40[^\"]%40[^,]%*[,]%40[^]]", data[0], data[1], data[2]);
+    int returnCode = sscanf(lresponse, "%*[^[][%39[^\"]%39[^,]%*[,]%39[^]]", data[0], data[1], data[2]);
     if (returnCode < 1)
     {
         LOGF_ERROR("Failed to parse JSONData '%s'.", lresponse);
         return false;
     }
-    strncpy(jstr, data[jindex], jstrlen);
+    strncpy(tcsStatus.firmware, data[1], sizeof(tcsStatus.firmware) - 1);
+    tcsStatus.locked  = (atoi(data[2]) > 0);
+    tcsStatus.gpValid = true;
     return true;
 }
 
-bool LX200Skywalker::getJSONData_Y(int jindex, char *jstr, int jstrlen) // preliminary hardcoded query :Y#-query
+/*
+ * Decode the model flags from the :Y# reply in one pass, bit 7 is the pier side.
+ */
+bool LX200Skywalker::fetchStatus_Y()
 {
     char lresponse[128];
-    lresponse [0] = '\0';
-    char lcmd[4] = ":Y#";
-    char end = '}';
-    if(!transmit(lcmd))
-    {
-        LOGF_ERROR("Command <%s> not transmitted.", lcmd);
-    }
-    if (receive(lresponse, end, 1))
-    {
-        flush();
-    }
-    else
-    {
-        LOG_ERROR("Failed to get JSONData");
+    if (!getJSONData(":Y#", lresponse))
         return false;
-    }
+
     char data[6][20] = {"", "", "", "", "", ""};
-    int returnCode = sscanf(lresponse, "%20[^,]%*[,]%20[^,]%*[,]%20[^#]%*[#\",]%20[^,]%*[,]%20[^,]%*[,]%20[^,]", data[0],
+    int returnCode = sscanf(lresponse, "%19[^,]%*[,]%19[^,]%*[,]%19[^#]%*[#\",]%19[^,]%*[,]%19[^,]%*[,]%19[^,]", data[0],
                             data[1], data[2], data[3], data[4], data[5]);
-    if (returnCode < 1)
+    if (returnCode < 6)
     {
         LOGF_ERROR("Failed to parse JSONData '%s'.", lresponse);
         return false;
     }
-    strncpy(jstr, data[jindex], jstrlen);
+    tcsStatus.pierWest   = ((atoi(data[5]) & (1 << 7)) != 0);
+    tcsStatus.modelValid = true;
     return true;
 }
 
+/*
+ * Read all TCS status values, regardless of what is cached.
+ */
+bool LX200Skywalker::refreshStatus()
+{
+    invalidateStatus();
+    bool gp = fetchStatus_gp();
+    bool model = fetchStatus_Y();
+    return gp && model;
+}
+
+void LX200Skywalker::invalidateStatus()
+{
+    tcsStatus.gpValid    = false;
+    tcsStatus.modelValid = false;
+}
+
 bool LX200Skywalker::MountLocked()
 {
-    char lstat[20] = {0};
-    if(!getJSONData_gp(2, lstat, 20))
+    if (!tcsStatus.gpValid && !fetchStatus_gp())
         return false;
-    else
-    {
-        int li = std::stoi(lstat);
-        if (li > 0)
-            return true;
-        else
-            return false;
-    }
+    return tcsStatus.locked;
 }
 
 bool LX200Skywalker::SetMountLock(bool enable)
@@ -984,14 +1057,10 @@ bool LX200Skywalker::setSystemSlewSpeed (int xx)
  */
 bool LX200Skywalker::getFirmwareInfo(char* vstring)
 {
-    char lstat[40] = {0};
-    if(!getJSONData_gp(1, lstat, 40))
+    if (!tcsStatus.gpValid && !fetchStatus_gp())
         return false;
-    else
-    {
-        strcpy(vstring, lstat);
-        return true;
-    }
+    strcpy(vstring, tcsStatus.firmware);
+    return true;
 }
 
 /*********************************************************************************
@@ -1043,6 +1112,11 @@ bool LX200Skywalker::transmit(const char* buffer)
     //    LOG_DEBUG(__FUNCTION__);
     int bytesWritten = 0;
     flush();
+    tickQueryCount++;
+    // Anything but a get (:G.., ?#, :gp, :Y#) may change lock state or pier side
+    if (strncmp(buffer, ":G", 2) != 0 && strncmp(buffer, "?", 1) != 0 && strncmp(buffer, ":gp", 3) != 0 &&
+            strncmp(buffer, ":Y", 2) != 0)
+        invalidateStatus();
     int returnCode = tty_write_string(PortFD, buffer, &bytesWritten);
     if (returnCode != TTY_OK)
     {
@@ -29,6 +29,7 @@
 #include <indilogger.h>
 #include <termios.h>
 
+#include <chrono>
 #include <cstring>
 #include <string>
 #include <unistd.h>
@@ -113,10 +114,29 @@ class LX200Skywalker : public LX200Telescope
         ITextVectorProperty FirmwareVersionTP;
         IText FirmwareVersionT[1] {};
 
+        // Duration and number of queries of the last status tick
+        INumberVectorProperty TickStatisticsNP;
+        INumber TickStatisticsN[2];
+        int tickQueryCount {0};
+        void updateTickStatistics(std::chrono::steady_clock::time_point tickStart);
+
+        // TCS status decoded from the JSON replies of :gp and :Y#. Kept until a command
+        // that may change it is sent to the TCS.
+        struct TCSStatus
+        {
+            bool gpValid {false};     // firmware and lock
+            bool modelValid {false};  // pier side
+            char firmware[40] {};
+            bool locked {false};
+            bool pierWest {false};
+        };
+        TCSStatus tcsStatus;
+
         int controller_format { LX200_LONG_FORMAT };
 
         // override
         virtual void getBasicData() override;
+        virtual bool ReadScopeStatus() override;
         virtual bool saveConfigItems(FILE *fp) override;
         virtual bool Goto(double ra, double dec) override;
         virtual bool Connect() override;
@@ -133,8 +153,11 @@ class LX200Skywalker : public LX200Telescope
         bool SavePark();
         bool getSystemSlewSpeed (int *xx);
         bool setSystemSlewSpeed (int xx);
-        bool getJSONData_Y(int jindex, char *jstr, int jstrlen);
-        bool getJSONData_gp(int jindex, char *jstr, int jstrlen);
+        bool getJSONData(const char *cmd, char *json);
+        bool fetchStatus_gp();
+        bool fetchStatus_Y();
+        bool refreshStatus();
+        void invalidateStatus();
         bool notifyPierSide();
         void notifyMountLock(bool locked);
         void notifyTrackState(INDI::Telescope::TelescopeStatus state);
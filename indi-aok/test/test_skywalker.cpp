@@ -0,0 +1,256 @@
+/*
+    AOK Skywalker driver
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * Status tick tests against a scripted Skywalker TCS. The stand-in answers the queries on
+ * the master side of a pseudo terminal, the driver talks to the slave side.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "lx200aok.h"
+
+class SkywalkerEmulator
+{
+    public:
+        SkywalkerEmulator()
+        {
+            master = posix_openpt(O_RDWR | O_NOCTTY);
+            if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+                return;
+
+            slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+            if (slave < 0)
+                return;
+
+            struct termios tty;
+            tcgetattr(slave, &tty);
+            cfmakeraw(&tty);
+            tcsetattr(slave, TCSANOW, &tty);
+
+            // a tracking, locked mount on the east side of the pier
+            responses[":GR#"] = "05:00:00#";
+            responses[":GD#"] = "+45*00:00#";
+            responses["?#"]   = "0#";
+            responses[":gp"]  = "{\"gp\":[0,\"V1.2.3\",1]}";
+            responses[":Y#"]  = "{\"Y\":\"1,2,3#\",4,5,0}";
+
+            running = true;
+            thread = std::thread(&SkywalkerEmulator::run, this);
+        }
+
+        ~SkywalkerEmulator()
+        {
+            running = false;
+            if (thread.joinable())
+                thread.join();
+            if (slave >= 0)
+                close(slave);
+            if (master >= 0)
+                close(master);
+        }
+
+        int fd() const
+        {
+            return slave;
+        }
+
+        void setResponse(const std::string &command, const std::string &response)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            responses[command] = response;
+        }
+
+        /** Commands received since the last call */
+        std::vector<std::string> takeCommands()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            std::vector<std::string> result;
+            result.swap(commands);
+            return result;
+        }
+
+    private:
+        void run()
+        {
+            std::string command;
+            while (running)
+            {
+                struct pollfd pfd = { master, POLLIN, 0 };
+                if (poll(&pfd, 1, 20) <= 0)
+                    continue;
+
+                char c;
+                if (read(master, &c, 1) != 1)
+                    continue;
+
+                command += c;
+
+                std::string response;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    // :gp is the only command without a terminating #
+                    if (c != '#' && command != ":gp")
+                        continue;
+                    auto it = responses.find(command);
+                    commands.push_back(command);
+                    if (it != responses.end())
+                        response = it->second;
+                }
+                if (!response.empty() && write(master, response.data(), response.size()) < 0)
+                    break;
+                command.clear();
+            }
+        }
+
+        int master { -1 };
+        int slave { -1 };
+        std::atomic_bool running { false };
+        std::thread thread;
+        std::mutex lock;
+        std::map<std::string, std::string> responses;
+        std::vector<std::string> commands;
+};
+
+class TestSkywalker : public LX200Skywalker
+{
+    public:
+        explicit TestSkywalker(int fd)
+        {
+            initProperties();
+            PortFD = fd;
+            setConnected(true, IPS_OK);
+        }
+
+        bool tick()
+        {
+            return ReadScopeStatus();
+        }
+
+        void setTrackState(TelescopeStatus state)
+        {
+            TrackState = state;
+        }
+
+        TelescopeStatus trackState() const
+        {
+            return TrackState;
+        }
+
+        TelescopePierSide pierSide() const
+        {
+            return currentPierSide;
+        }
+
+        bool locked()
+        {
+            return MountLocked();
+        }
+
+        bool lock(bool enable)
+        {
+            return SetMountLock(enable);
+        }
+
+        int tickQueries() const
+        {
+            return static_cast<int>(TickStatisticsN[1].value);
+        }
+};
+
+static int count(const std::vector<std::string> &commands, const std::string &command)
+{
+    int n = 0;
+    for (const auto &c : commands)
+        if (c == command)
+            n++;
+    return n;
+}
+
+TEST(SkywalkerTickTest, tracking_tick_reads_position_only)
+{
+    SkywalkerEmulator tcs;
+    ASSERT_GE(tcs.fd(), 0);
+    TestSkywalker skywalker(tcs.fd());
+    skywalker.setTrackState(INDI::Telescope::SCOPE_TRACKING);
+
+    ASSERT_TRUE(skywalker.tick());
+    EXPECT_EQ(tcs.takeCommands(), std::vector<std::string>({":GR#", ":GD#"}));
+    EXPECT_EQ(skywalker.tickQueries(), 2);
+}
+
+TEST(SkywalkerTickTest, end_of_slew_reads_status_snapshot_once)
+{
+    SkywalkerEmulator tcs;
+    ASSERT_GE(tcs.fd(), 0);
+    TestSkywalker skywalker(tcs.fd());
+
+    tcs.setResponse("?#", "1#");
+    skywalker.setTrackState(INDI::Telescope::SCOPE_SLEWING);
+    ASSERT_TRUE(skywalker.tick());
+    std::vector<std::string> commands = tcs.takeCommands();
+    EXPECT_EQ(count(commands, "?#"), 1);
+    EXPECT_EQ(count(commands, ":gp"), 0);
+    EXPECT_EQ(count(commands, ":Y#"), 0);
+
+    tcs.setResponse("?#", "0#");
+    tcs.setResponse(":Y#", "{\"Y\":\"1,2,3#\",4,5,128}");
+    ASSERT_TRUE(skywalker.tick());
+    commands = tcs.takeCommands();
+    EXPECT_EQ(count(commands, ":gp"), 1);
+    EXPECT_EQ(count(commands, ":Y#"), 1);
+    EXPECT_EQ(skywalker.trackState(), INDI::Telescope::SCOPE_TRACKING);
+    EXPECT_EQ(skywalker.pierSide(), INDI::Telescope::PIER_WEST);
+    EXPECT_EQ(skywalker.tickQueries(), 5);
+
+    // cached until a command may have changed it
+    EXPECT_TRUE(skywalker.locked());
+    EXPECT_TRUE(skywalker.lock(true));
+    EXPECT_TRUE(tcs.takeCommands().empty());
+}
+
+TEST(SkywalkerTickTest, commands_invalidate_the_snapshot)
+{
+    SkywalkerEmulator tcs;
+    ASSERT_GE(tcs.fd(), 0);
+    TestSkywalker skywalker(tcs.fd());
+
+    EXPECT_TRUE(skywalker.locked());
+    EXPECT_EQ(tcs.takeCommands(), std::vector<std::string>({":gp"}));
+
+    // unlocking toggles the lock with :hE#, the next lock query has to ask the TCS again
+    EXPECT_TRUE(skywalker.lock(false));
+    EXPECT_EQ(tcs.takeCommands(), std::vector<std::string>({":hE#"}));
+
+    tcs.setResponse(":gp", "{\"gp\":[0,\"V1.2.3\",0]}");
+    EXPECT_FALSE(skywalker.locked());
+    EXPECT_EQ(tcs.takeCommands(), std::vector<std::string>({":gp"}));
+}
@@ -77,6 +77,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
 #define NFLUSHES                1    /* Number of times a CCD array is flushed before an exposure */
 #define TEMP_UPDATE_THRESHOLD   0.05
 #define COOLER_UPDATE_THRESHOLD 0.05
+#define SEQ_MAX_LAG             2.0  /* Max time between a sequence frame delivery and the next request (s) */
+#define SEQ_DURATION_TOLERANCE  0.001 /* Requests this close to the sequence duration continue it (s) */
 
 static std::unique_ptr<ApogeeCCD> apogeeCCD(new ApogeeCCD());
 
@@ -131,6 +133,10 @@ bool ApogeeCCD::initProperties()
     IUFillSwitchVector(&FanStatusSP, FanStatusS, 4, getDeviceName(), "CCD_FAN", "Fan", OPTIONS_TAB, IP_RW, ISR_1OFMANY,
                        0, IPS_IDLE);
 
+    IUFillNumber(&SequenceN[0], "SEQUENCE_COUNT", "Frames", "%.f", 1, 65535, 1, 1);
+    IUFillNumberVector(&SequenceNP, SequenceN, 1, getDeviceName(), "CCD_SEQUENCE", "Sequence", OPTIONS_TAB, IP_RW, 60,
+                       IPS_IDLE);
+
     // Filter Type
     IUFillSwitch(&FilterTypeS[TYPE_UNKNOWN], "TYPE_UNKNOWN", "No CFW", ISS_ON);
     IUFillSwitch(&FilterTypeS[TYPE_FW50_9R], "TYPE_FW50_9R", "FW50 9R", ISS_OFF);
@@ -176,6 +182,13 @@ bool ApogeeCCD::updateProperties()
         defineProperty(&FanStatusSP);
         getCameraParams();
 
+        // Sequences need per-frame downloads, which gen one ethernet cameras cannot do
+        if (ioInterface == "usb")
+        {
+            defineProperty(&SequenceNP);
+            loadConfig(true, SequenceNP.name);
+        }
+
         if (cfwFound)
         {
             INDI::FilterInterface::updateProperties();
@@ -191,6 +204,7 @@ bool ApogeeCCD::updateProperties()
         deleteProperty(ReadOutSP.name);
         deleteProperty(CamInfoTP.name);
         deleteProperty(FanStatusSP.name);
+        deleteProperty(SequenceNP.name);
 
         if (cfwFound)
         {
@@ -497,6 +511,19 @@ bool ApogeeCCD::ISNewNumber(const char *dev, const char *name, double values[],
             INDI::FilterInterface::processNumber(dev, name, values, names, n);
             return true;
         }
+
+        if (!strcmp(name, SequenceNP.name))
+        {
+            IUUpdateNumber(&SequenceNP, values, names, n);
+            if (isSimulation() == false && InExposure == false)
+                stopSequence();
+            SequenceNP.s = IPS_OK;
+            IDSetNumber(&SequenceNP, nullptr);
+            if (SequenceN[0].value > 1)
+                LOGF_INFO("Consecutive exposures with the same settings will run as a %.f frame camera sequence.",
+                          SequenceN[0].value);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -515,7 +542,25 @@ bool ApogeeCCD::StartExposure(float duration)
     }
 
     if (isSimulation() == false)
-        ApgCam->SetImageCount(1);
+    {
+        // The client must ask for the next frame right after the previous one was delivered, otherwise
+        // the camera exposed it while the client was moving the mount or the focuser in between
+        if (seqRemaining > 0 && fabs(ExposureRequest - seqDuration) < SEQ_DURATION_TOLERANCE &&
+                imageFrameType == seqFrameType && -CalcTimeLeft(seqDelivered, 0) <= SEQ_MAX_LAG)
+        {
+            // The camera started this frame on its own right after the previous one was read out
+            seqRemaining--;
+            PrimaryCCD.setExposureDuration(ExposureRequest);
+            ExpStart = seqNextStart;
+            LOGF_DEBUG("Continuing camera sequence, %d frames left after this one.", seqRemaining);
+            InExposure = true;
+            return true;
+        }
+
+        stopSequence();
+        if (startSequence(ioInterface == "usb" ? SequenceN[0].value : 1) == false)
+            return false;
+    }
 
     /* BIAS frame is the same as DARK but with minimum period. i.e. readout from camera electronics.*/
     if (imageFrameType == INDI::CCDChip::BIAS_FRAME || imageFrameType == INDI::CCDChip::DARK_FRAME)
@@ -560,6 +605,9 @@ bool ApogeeCCD::StartExposure(float duration)
 
 bool ApogeeCCD::AbortExposure()
 {
+    // Stopping the exposure ends the whole camera sequence
+    seqRemaining = 0;
+
     try
     {
         if (isSimulation() == false)
@@ -575,6 +623,59 @@ bool ApogeeCCD::AbortExposure()
     return true;
 }
 
+bool ApogeeCCD::startSequence(int count)
+{
+    try
+    {
+        if (count > 1)
+        {
+            // Download each frame as soon as it is ready instead of all of them at the end
+            ApgCam->SetBulkDownload(false);
+            ApgCam->SetImageCount(count);
+            seqActive = true;
+        }
+        else
+        {
+            if (seqActive)
+                ApgCam->SetBulkDownload(true);
+            ApgCam->SetImageCount(1);
+            seqActive = false;
+        }
+    }
+    catch (std::runtime_error &err)
+    {
+        LOGF_ERROR("SetImageCount() failed. %s.", err.what());
+        return false;
+    }
+
+    seqRemaining = count - 1;
+    seqDuration  = ExposureRequest;
+    seqFrameType = imageFrameType;
+
+    if (count > 1)
+        LOGF_INFO("Starting a %d frame camera sequence.", count);
+
+    return true;
+}
+
+void ApogeeCCD::stopSequence()
+{
+    if (seqRemaining <= 0)
+        return;
+
+    LOGF_DEBUG("Stopping camera sequence with %d frames left.", seqRemaining);
+    seqRemaining = 0;
+
+    try
+    {
+        ApgCam->StopExposure(false);
+    }
+    catch (std::runtime_error &err)
+    {
+        LOGF_DEBUG("StopExposure() failed. %s.", err.what());
+    }
+}
+
 float ApogeeCCD::CalcTimeLeft(timeval start, float req)
 {
     double timesince;
@@ -597,6 +698,9 @@ bool ApogeeCCD::UpdateCCDFrame(int x, int y, int w, int h)
         return false;
     }
 
+    if (isSimulation() == false)
+        stopSequence();
+
     /* Add the X and Y offsets */
     long x_1 = x;
     long y_1 = y;
@@ -652,6 +756,9 @@ bool ApogeeCCD::UpdateCCDBin(int binx, int biny)
         return false;
     }
 
+    if (isSimulation() == false)
+        stopSequence();
+
     try
     {
         if (isSimulation() == false)
@@ -681,7 +788,6 @@ bool ApogeeCCD::UpdateCCDBin(int binx, int biny)
 
 int ApogeeCCD::grabImage()
 {
-    std::vector<uint16_t> pImageData;
     uint16_t *image = reinterpret_cast<uint16_t*>(PrimaryCCD.getFrameBuffer());
 
     try
@@ -695,10 +801,10 @@ int ApogeeCCD::grabImage()
         }
         else
         {
-            ApgCam->GetImage(pImageData);
+            // Fixed up straight into the frame buffer, no intermediate image
+            ApgCam->GetImage(image, PrimaryCCD.getFrameBufferSize() / sizeof(uint16_t));
             imageWidth  = ApgCam->GetRoiNumCols();
             imageHeight = ApgCam->GetRoiNumRows();
-            copy(pImageData.begin(), pImageData.end(), image);
         }
         guard.unlock();
     }
@@ -1205,6 +1311,8 @@ bool ApogeeCCD::Disconnect()
     {
         if (isSimulation() == false)
         {
+            stopSequence();
+            seqActive = false;
             ApgCam->CloseConnection();
             if (cfwFound)
                 ApgCFW->Close();
@@ -1280,6 +1388,9 @@ void ApogeeCCD::TimerHit()
                     usleep(250000);
                     status = ApgCam->GetImagingStatus();
                 }
+
+                // The next frame of a camera sequence starts exposing now
+                gettimeofday(&seqNextStart, nullptr);
             }
 
             /* We're done exposing */
@@ -1288,6 +1399,7 @@ void ApogeeCCD::TimerHit()
             InExposure = false;
             /* grab and save image */
             grabImage();
+            gettimeofday(&seqDelivered, nullptr);
         }
         else
         {
@@ -1295,6 +1407,11 @@ void ApogeeCCD::TimerHit()
             PrimaryCCD.setExposureLeft(timeleft);
         }
     }
+    else if (seqRemaining > 0 && -CalcTimeLeft(seqDelivered, 0) > SEQ_MAX_LAG)
+    {
+        // The client did not ask for the next frame in time, its own sequence is over or paused
+        stopSequence();
+    }
 
     switch (TemperatureNP.s)
     {
@@ -1451,6 +1568,9 @@ bool ApogeeCCD::saveConfigItems(FILE *fp)
     if (FanStatusSP.s != IPS_ALERT)
         IUSaveConfigSwitch(fp, &FanStatusSP);
 
+    if (ioInterface == "usb")
+        IUSaveConfigNumber(fp, &SequenceNP);
+
     if (cfwFound)
     {
         INDI::FilterInterface::saveConfigItems(fp);
@@ -1480,6 +1600,10 @@ int ApogeeCCD::QueryFilter()
 
 bool ApogeeCCD::SelectFilter(int position)
 {
+    // Frames the camera keeps taking would be exposed through the old filter
+    if (InExposure == false)
+        stopSequence();
+
     try
     {
         ApgCFW->SetPosition(position);
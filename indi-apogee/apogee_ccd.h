@@ -107,6 +107,10 @@ class ApogeeCCD : public INDI::CCD, public INDI::FilterInterface
             FAN_FAST
         };
 
+        // Camera sequence, frames exposed back to back from one StartExposure
+        INumber SequenceN[1];
+        INumberVectorProperty SequenceNP;
+
         // Filter Type
         ISwitchVectorProperty FilterTypeSP;
         ISwitch FilterTypeS[5];
@@ -136,6 +140,14 @@ class ApogeeCCD : public INDI::CCD, public INDI::FilterInterface
         INDI::CCDChip::CCD_FRAME imageFrameType;
         struct timeval ExpStart;
 
+        // Frames of the running camera sequence not yet requested by the client
+        int seqRemaining {0};
+        bool seqActive {false};
+        double seqDuration {0};
+        INDI::CCDChip::CCD_FRAME seqFrameType;
+        struct timeval seqNextStart;
+        struct timeval seqDelivered;
+
         std::string ioInterface;
         std::string subnet;
         std::string firmwareRev;
@@ -161,6 +173,8 @@ class ApogeeCCD : public INDI::CCD, public INDI::FilterInterface
         void printInfo(const std::string &model, uint16_t maxImgRows, uint16_t maxImgCols);
 
         float CalcTimeLeft(timeval, float);
+        bool startSequence(int count);
+        void stopSequence();
         int grabImage();
         bool getCameraParams();
         void activateCooler(bool enable);
@@ -167,7 +167,12 @@ void ASICCD::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
         LOGF_ERROR("Failed to set exposure duration (%s).", Helpers::toString(ret));
     }
 
-    ret = ASIStartVideoCapture(mCameraInfo.CameraID);
+    // The stream reads into its own buffer with the format cached here, ROI and format
+    // changes made while streaming reach it through requestFormat() between two frames.
+    ASIVideoStream::Format current = streamFormat();
+    int waitMS = static_cast<int>((ExposureRequest * 2000.0) + 500);
+
+    ret = mVideoStream.start(current, waitMS);
     if (ret != ASI_SUCCESS)
     {
         LOGF_ERROR("Failed to start video capture (%s).", Helpers::toString(ret));
@@ -175,11 +180,11 @@ void ASICCD::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
 
     while (!isAboutToQuit)
     {
-        uint8_t *targetFrame = PrimaryCCD.getFrameBuffer();
-        uint32_t totalBytes  = PrimaryCCD.getFrameBufferSize();
-        int waitMS           = static_cast<int>((ExposureRequest * 2000.0) + 500);
+        uint8_t *targetFrame = nullptr;
+        size_t totalBytes    = 0;
+        ASIVideoStream::Format format;
 
-        ret = ASIGetVideoData(mCameraInfo.CameraID, targetFrame, totalBytes, waitMS);
+        ret = mVideoStream.nextFrame(&targetFrame, &totalBytes, &format);
         if (ret != ASI_SUCCESS)
         {
             if (ret != ASI_ERROR_TIMEOUT)
@@ -193,14 +198,25 @@ void ASICCD::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
             continue;
         }
 
-        if (mCurrentVideoFormat == ASI_IMG_RGB24)
-            for (uint32_t i = 0; i < totalBytes; i += 3)
+        if (!format.sameGeometry(current))
+        {
+            if (format.type != current.type)
+                Streamer->setPixelFormat(
+                    Helpers::pixelFormat(format.type, mCameraInfo.BayerPattern, mCameraInfo.IsColorCam),
+                    format.type == ASI_IMG_RAW16 ? 16 : 8
+                );
+            Streamer->setSize(format.width, format.height);
+            current = format;
+        }
+
+        if (format.type == ASI_IMG_RGB24)
+            for (size_t i = 0; i < totalBytes; i += 3)
                 std::swap(targetFrame[i], targetFrame[i + 2]);
 
         Streamer->newFrame(targetFrame, totalBytes);
     }
 
-    ASIStopVideoCapture(mCameraInfo.CameraID);
+    mVideoStream.stop();
 }
 
 void ASICCD::workerBlinkExposure(const std::atomic_bool &isAboutToQuit, int blinks, float duration)
@@ -383,6 +399,7 @@ void ASICCD::workerExposure(const std::atomic_bool &isAboutToQuit, float duratio
 ASICCD::ASICCD(const ASI_CAMERA_INFO &camInfo, const std::string &cameraName)
     : mCameraName(cameraName)
     , mCameraInfo(camInfo)
+    , mVideoStream(camInfo.CameraID)
 {
     setVersion(ASI_VERSION_MAJOR, ASI_VERSION_MINOR);
     setDeviceName(cameraName.c_str());
@@ -619,7 +636,7 @@ bool ASICCD::Disconnect()
 
     if (isSimulation() == false)
     {
-        ASIStopVideoCapture(mCameraInfo.CameraID);
+        mVideoStream.stop();
         ASIStopExposure(mCameraInfo.CameraID);
         ASICloseCamera(mCameraInfo.CameraID);
     }
@@ -819,6 +836,8 @@ bool ASICCD::ISNewNumber(const char *dev, const char *name, double values[], cha
                 }
             }
 
+            mMonoBinActive = isMonoBinActive();
+
             ControlNP.setState(IPS_OK);
             ControlNP.apply();
             return true;
@@ -899,9 +918,9 @@ bool ASICCD::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
 
         if (VideoFormatSP.isNameMatch(name))
         {
-            if (Streamer->isBusy())
+            if (Streamer->isRecording())
             {
-                LOG_ERROR("Cannot change format while streaming/recording.");
+                LOG_ERROR("Cannot change format while recording.");
                 VideoFormatSP.setState(IPS_ALERT);
                 VideoFormatSP.apply();
                 return true;
@@ -1094,26 +1113,45 @@ bool ASICCD::UpdateCCDFrame(int x, int y, int w, int h)
 
     LOGF_DEBUG("Frame ROI x:%d y:%d w:%d h:%d", subX, subY, subW, subH);
 
-    ASI_ERROR_CODE ret;
-
-    ret = ASISetROIFormat(mCameraInfo.CameraID, subW, subH, binX, getImageType());
-    if (ret != ASI_SUCCESS)
+    if (mVideoStream.isCapturing())
     {
-        LOGF_ERROR("Failed to set ROI (%s).", Helpers::toString(ret));
-        return false;
+        // A SER file cannot change its frame size half way
+        if (Streamer->isRecording() && (subW != static_cast<uint32_t>(PrimaryCCD.getSubW() / binX) ||
+                                        subH != static_cast<uint32_t>(PrimaryCCD.getSubH() / binY)))
+        {
+            LOG_ERROR("Cannot resize the frame while recording.");
+            return false;
+        }
     }
-
-    ret = ASISetStartPos(mCameraInfo.CameraID, subX, subY);
-    if (ret != ASI_SUCCESS)
+    else
     {
-        LOGF_ERROR("Failed to set start position (%s).", Helpers::toString(ret));
-        return false;
+        ASI_ERROR_CODE ret;
+
+        ret = ASISetROIFormat(mCameraInfo.CameraID, subW, subH, binX, getImageType());
+        if (ret != ASI_SUCCESS)
+        {
+            LOGF_ERROR("Failed to set ROI (%s).", Helpers::toString(ret));
+            return false;
+        }
+
+        ret = ASISetStartPos(mCameraInfo.CameraID, subX, subY);
+        if (ret != ASI_SUCCESS)
+        {
+            LOGF_ERROR("Failed to set start position (%s).", Helpers::toString(ret));
+            return false;
+        }
     }
 
     // Set UNBINNED coords
     //PrimaryCCD.setFrame(x, y, w, h);
     PrimaryCCD.setFrame(subX * binX, subY * binY, subW * binX, subH * binY);
 
+    // The stream applies the new ROI between two frames and resizes the streamer itself
+    if (mVideoStream.isCapturing())
+        mVideoStream.requestFormat(streamFormat());
+
+    mMonoBinActive = isMonoBinActive();
+
     // Total bytes required for image buffer
     uint32_t nbuf = (subW * subH * static_cast<uint32_t>(PrimaryCCD.getBPP()) / 8) * ((getImageType() == ASI_IMG_RGB24) ? 3 :
                     1);
@@ -1122,7 +1160,8 @@ bool ASICCD::UpdateCCDFrame(int x, int y, int w, int h)
     PrimaryCCD.setFrameBufferSize(nbuf);
 
     // Always set BINNED size
-    Streamer->setSize(subW, subH);
+    if (!mVideoStream.isCapturing())
+        Streamer->setSize(subW, subH);
 
     return true;
 }
@@ -1198,7 +1237,7 @@ int ASICCD::grabImage(float duration)
     PrimaryCCD.setNAxis(type == ASI_IMG_RGB24 ? 3 : 2);
 
     // If mono camera or we're sending Luma or RGB, turn off bayering
-    if (mCameraInfo.IsColorCam == false || type == ASI_IMG_Y8 || type == ASI_IMG_RGB24 || isMonoBinActive())
+    if (mCameraInfo.IsColorCam == false || type == ASI_IMG_Y8 || type == ASI_IMG_RGB24 || mMonoBinActive)
         SetCCDCapability(GetCCDCapability() & ~CCD_HAS_BAYER);
     else
         SetCCDCapability(GetCCDCapability() | CCD_HAS_BAYER);
@@ -1229,16 +1268,21 @@ bool ASICCD::isMonoBinActive()
         return false;
     }
 
-    int width = 0, height = 0, bin = 1;
-    ASI_IMG_TYPE imgType = ASI_IMG_RAW8;
-    ret = ASIGetROIFormat(mCameraInfo.CameraID, &width, &height, &bin, &imgType);
-    if (ret != ASI_SUCCESS)
-    {
-        LOGF_ERROR("Failed to get ROI format (%s).", Helpers::toString(ret));
-        return false;
-    }
+    // Use the requested format rather than asking the camera, a running stream applies it later
+    ASI_IMG_TYPE imgType = getImageType();
+    return (imgType == ASI_IMG_RAW8 || imgType == ASI_IMG_RAW16) && PrimaryCCD.getBinX() > 1;
+}
 
-    return (imgType == ASI_IMG_RAW8 || imgType == ASI_IMG_RAW16) && bin > 1;
+ASIVideoStream::Format ASICCD::streamFormat() const
+{
+    ASIVideoStream::Format format;
+    format.bin    = PrimaryCCD.getBinX();
+    format.x      = PrimaryCCD.getSubX() / format.bin;
+    format.y      = PrimaryCCD.getSubY() / format.bin;
+    format.width  = PrimaryCCD.getSubW() / format.bin;
+    format.height = PrimaryCCD.getSubH() / format.bin;
+    format.type   = getImageType();
+    return format;
 }
 
 /* The timer call back is used for temperature monitoring */
@@ -1413,6 +1457,13 @@ void ASICCD::createControls(int piNumberOfControls)
             ASISetControlValue(mCameraInfo.CameraID, cap.ControlType, value, ASI_FALSE);
         }
 
+        // Prefer hardware binning, the user setting restored from the config still overrides it
+        if (cap.ControlType == ASI_HARDWARE_BIN)
+        {
+            LOG_DEBUG("createControls->enable hardware binning");
+            ASISetControlValue(mCameraInfo.CameraID, cap.ControlType, 1, ASI_FALSE);
+        }
+
         long value     = 0;
         ASI_BOOL isAuto = ASI_FALSE;
         ASIGetControlValue(mCameraInfo.CameraID, cap.ControlType, &value, &isAuto);
@@ -1485,7 +1536,8 @@ void ASICCD::updateControls()
 void ASICCD::updateRecorderFormat()
 {
     mCurrentVideoFormat = getImageType();
-    if (mCurrentVideoFormat == ASI_IMG_END)
+    // A running stream switches the recorder when the new format reaches it
+    if (mCurrentVideoFormat == ASI_IMG_END || mVideoStream.isCapturing())
         return;
 
     Streamer->setPixelFormat(
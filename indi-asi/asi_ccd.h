@@ -24,6 +24,7 @@
 
 #include <ASICamera2.h>
 
+#include "asi_video_stream.h"
 #include "indipropertyswitch.h"
 #include "indipropertynumber.h"
 #include "indipropertytext.h"
@@ -126,6 +127,9 @@ private:
     /** Get if MonoBin is active, thus Bayer is irrelevant */
     bool isMonoBinActive();
 
+    /** Current ROI and format in the units the SDK expects */
+    ASIVideoStream::Format streamFormat() const;
+
 private:
     /** Additional Properties to INDI::CCD */
     INDI::PropertyNumber  CoolerNP {1};
@@ -151,4 +155,6 @@ private:
     ASI_IMG_TYPE                  mCurrentVideoFormat;
     std::vector<ASI_CONTROL_CAPS> mControlCaps;
     ASI_CAMERA_INFO               mCameraInfo;
+    ASIVideoStream                mVideoStream;
+    bool                          mMonoBinActive {false};
 };
@@ -0,0 +1,250 @@
+/*
+    ASI video stream benchmark
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * Measures the frame rate reached by ASIVideoStream against a capture loop that queries
+ * the camera state on every frame and restarts the stream for every ROI change. The SDK
+ * is mocked: a frame takes a fixed overhead plus a time per binned row, restarting the
+ * capture costs a start latency and every query costs a USB round trip.
+ */
+
+#include "asi_video_stream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <thread>
+
+static int sensorWidth  = 1936;
+static int sensorHeight = 1096;
+static int frameUs      = 1000;     // fixed cost of a frame
+static int rowUs        = 10;       // readout time of a binned row
+static int startMs      = 200;      // first frame delay after starting the capture
+static int queryUs      = 500;      // one control or format query
+static int moveEvery    = 50;       // frames between two ROI moves
+static int frames       = 500;
+
+static ASIVideoStream::Format mockFormat;
+static bool mockStarted = false;
+
+static void mockDelay(long us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+extern "C" {
+
+ASI_ERROR_CODE ASIStartVideoCapture(int)
+{
+    mockDelay(startMs * 1000L);
+    mockStarted = true;
+    return ASI_SUCCESS;
+}
+
+ASI_ERROR_CODE ASIStopVideoCapture(int)
+{
+    mockStarted = false;
+    return ASI_SUCCESS;
+}
+
+ASI_ERROR_CODE ASISetROIFormat(int, int width, int height, int bin, ASI_IMG_TYPE type)
+{
+    if (mockStarted || width % 8 || height % 2 || width * bin > sensorWidth || height * bin > sensorHeight)
+        return ASI_ERROR_INVALID_SIZE;
+    mockDelay(queryUs);
+    mockFormat.width  = width;
+    mockFormat.height = height;
+    mockFormat.bin    = bin;
+    mockFormat.type   = type;
+    return ASI_SUCCESS;
+}
+
+ASI_ERROR_CODE ASIGetROIFormat(int, int *width, int *height, int *bin, ASI_IMG_TYPE *type)
+{
+    mockDelay(queryUs);
+    *width  = mockFormat.width;
+    *height = mockFormat.height;
+    *bin    = mockFormat.bin;
+    *type   = mockFormat.type;
+    return ASI_SUCCESS;
+}
+
+ASI_ERROR_CODE ASISetStartPos(int, int x, int y)
+{
+    mockDelay(queryUs);
+    mockFormat.x = x;
+    mockFormat.y = y;
+    return ASI_SUCCESS;
+}
+
+ASI_ERROR_CODE ASIGetControlValue(int, ASI_CONTROL_TYPE, long *value, ASI_BOOL *isAuto)
+{
+    mockDelay(queryUs);
+    *value  = 0;
+    *isAuto = ASI_FALSE;
+    return ASI_SUCCESS;
+}
+
+ASI_ERROR_CODE ASIGetVideoData(int, unsigned char *buffer, long size, int)
+{
+    if (!mockStarted)
+        return ASI_ERROR_VIDEO_MODE_ACTIVE;
+    if (static_cast<size_t>(size) < mockFormat.frameBytes())
+        return ASI_ERROR_BUFFER_TOO_SMALL;
+    mockDelay(frameUs + static_cast<long>(rowUs) * mockFormat.height);
+    memset(buffer, 0x40, mockFormat.frameBytes());
+    return ASI_SUCCESS;
+}
+
+}
+
+static ASIVideoStream::Format roi(int width, int height, int bin, int frame)
+{
+    ASIVideoStream::Format format;
+    format.width  = width;
+    format.height = height;
+    format.bin    = bin;
+    format.type   = ASI_IMG_RAW8;
+    // Follow a drifting target across the sensor
+    int spanX = sensorWidth / bin - width;
+    int spanY = sensorHeight / bin - height;
+    format.x = spanX > 0 ? (frame * 8) % spanX : 0;
+    format.y = spanY > 0 ? (frame * 2) % spanY : 0;
+    return format;
+}
+
+/* Per-frame state queries, restart for every ROI change */
+static double runNaive(int width, int height, int bin)
+{
+    std::vector<uint8_t> buffer;
+    ASIVideoStream::Format format = roi(width, height, bin, 0);
+    ASISetROIFormat(0, format.width, format.height, format.bin, format.type);
+    ASISetStartPos(0, format.x, format.y);
+    ASIStartVideoCapture(0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+    {
+        if (moveEvery > 0 && i > 0 && i % moveEvery == 0)
+        {
+            format = roi(width, height, bin, i);
+            ASIStopVideoCapture(0);
+            ASISetROIFormat(0, format.width, format.height, format.bin, format.type);
+            ASISetStartPos(0, format.x, format.y);
+            ASIStartVideoCapture(0);
+        }
+
+        long monoBin;
+        ASI_BOOL isAuto;
+        int w, h, b;
+        ASI_IMG_TYPE type;
+        ASIGetControlValue(0, ASI_MONO_BIN, &monoBin, &isAuto);
+        ASIGetROIFormat(0, &w, &h, &b, &type);
+
+        buffer.resize(format.frameBytes());
+        ASIGetVideoData(0, buffer.data(), buffer.size(), 1000);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    ASIStopVideoCapture(0);
+    return frames / elapsed.count();
+}
+
+static double runStream(int width, int height, int bin)
+{
+    ASIVideoStream stream(0);
+    ASIVideoStream::Format format = roi(width, height, bin, 0);
+    stream.start(format, 1000);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+    {
+        if (moveEvery > 0 && i > 0 && i % moveEvery == 0)
+            stream.requestFormat(roi(width, height, bin, i));
+
+        uint8_t *frame;
+        size_t size;
+        ASI_ERROR_CODE ret = stream.nextFrame(&frame, &size, &format);
+        if (ret != ASI_SUCCESS)
+        {
+            fprintf(stderr, "Frame %d failed (%d)\n", i, ret);
+            return 0;
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    stream.stop();
+    return frames / elapsed.count();
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "n:f:r:s:q:m:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                frames = atoi(optarg);
+                break;
+            case 'f':
+                frameUs = atoi(optarg);
+                break;
+            case 'r':
+                rowUs = atoi(optarg);
+                break;
+            case 's':
+                startMs = atoi(optarg);
+                break;
+            case 'q':
+                queryUs = atoi(optarg);
+                break;
+            case 'm':
+                moveEvery = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n frames] [-f frame overhead us] [-r row readout us] [-s capture start ms] "
+                        "[-q query us] [-m frames between ROI moves, 0 for none]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    printf("Mock SDK: %dx%d sensor, frame %d us + %d us/row, capture start %d ms, query %d us, ROI move every %d frames\n",
+           sensorWidth, sensorHeight, frameUs, rowUs, startMs, queryUs, moveEvery);
+
+    struct
+    {
+        const char *name;
+        int width, height, bin;
+    } modes[] =
+    {
+        { "full frame", 1936, 1096, 1 },
+        { "full bin2",  968,  548,  2 },
+        { "ROI 640",    640,  480,  1 },
+        { "ROI 256",    256,  256,  1 },
+    };
+
+    for (const auto &mode : modes)
+    {
+        double naive  = runNaive(mode.width, mode.height, mode.bin);
+        double stream = runStream(mode.width, mode.height, mode.bin);
+        printf("%-10s  naive %6.1f fps   stream %6.1f fps\n", mode.name, naive, stream);
+    }
+
+    return 0;
+}
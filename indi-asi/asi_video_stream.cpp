@@ -0,0 +1,181 @@
+/*
+    ASI CCD Driver
+
+    Copyright (C) 2015 Jasem Mutlaq (mutlaqja@ikarustech.com)
+    Copyright (C) 2018 Leonard Bottleman (leonard@whiteweasel.net)
+    Copyright (C) 2021 Pawel Soja (kernel32.pl@gmail.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "asi_video_stream.h"
+
+size_t ASIVideoStream::Format::frameBytes() const
+{
+    size_t pixels = static_cast<size_t>(width) * height;
+    switch (type)
+    {
+        case ASI_IMG_RAW16:
+            return pixels * 2;
+        case ASI_IMG_RGB24:
+            return pixels * 3;
+        default:
+            return pixels;
+    }
+}
+
+bool ASIVideoStream::Format::sameGeometry(const Format &other) const
+{
+    return width == other.width && height == other.height && bin == other.bin && type == other.type;
+}
+
+ASIVideoStream::ASIVideoStream(int cameraID)
+    : mCameraID(cameraID)
+{
+}
+
+ASIVideoStream::~ASIVideoStream()
+{
+    stop();
+}
+
+ASI_ERROR_CODE ASIVideoStream::start(const Format &format, int waitMs)
+{
+    {
+        std::lock_guard<std::mutex> guard(mPendingLock);
+        mHasPending = false;
+    }
+
+    ASI_ERROR_CODE ret = setCameraFormat(format);
+    if (ret != ASI_SUCCESS)
+        return ret;
+
+    mFormat = format;
+    mWaitMs = waitMs;
+    mBuffer.resize(mFormat.frameBytes());
+
+    mFrames   = 0;
+    mFPS      = 0;
+    mFPSStart = std::chrono::steady_clock::now();
+
+    ret = ASIStartVideoCapture(mCameraID);
+    mCapturing = (ret == ASI_SUCCESS);
+    return ret;
+}
+
+void ASIVideoStream::stop()
+{
+    if (!mCapturing.exchange(false))
+        return;
+
+    ASIStopVideoCapture(mCameraID);
+
+    // A format queued after the last frame must still reach the camera for the next exposure
+    Format format;
+    if (takePending(&format) && setCameraFormat(format) == ASI_SUCCESS)
+        mFormat = format;
+}
+
+void ASIVideoStream::requestFormat(const Format &format)
+{
+    std::lock_guard<std::mutex> guard(mPendingLock);
+    mPending    = format;
+    mHasPending = true;
+}
+
+bool ASIVideoStream::takePending(Format *format)
+{
+    std::lock_guard<std::mutex> guard(mPendingLock);
+    if (!mHasPending)
+        return false;
+    *format     = mPending;
+    mHasPending = false;
+    return true;
+}
+
+ASI_ERROR_CODE ASIVideoStream::setCameraFormat(const Format &format)
+{
+    ASI_ERROR_CODE ret = ASISetROIFormat(mCameraID, format.width, format.height, format.bin, format.type);
+    if (ret == ASI_SUCCESS)
+        ret = ASISetStartPos(mCameraID, format.x, format.y);
+    return ret;
+}
+
+ASI_ERROR_CODE ASIVideoStream::applyPending()
+{
+    Format format;
+    if (!takePending(&format))
+        return ASI_SUCCESS;
+
+    ASI_ERROR_CODE ret;
+
+    // Moving the ROI around the sensor is accepted by the SDK while capturing
+    if (format.sameGeometry(mFormat))
+    {
+        ret = ASISetStartPos(mCameraID, format.x, format.y);
+        if (ret == ASI_SUCCESS)
+            mFormat = format;
+        return ret;
+    }
+
+    ASIStopVideoCapture(mCameraID);
+
+    ret = setCameraFormat(format);
+    if (ret == ASI_SUCCESS)
+    {
+        mFormat = format;
+        mBuffer.resize(mFormat.frameBytes());
+    }
+    else
+    {
+        // Keep streaming with the previous format
+        setCameraFormat(mFormat);
+    }
+
+    ASI_ERROR_CODE startRet = ASIStartVideoCapture(mCameraID);
+    if (startRet != ASI_SUCCESS)
+    {
+        mCapturing = false;
+        return startRet;
+    }
+
+    return ret;
+}
+
+ASI_ERROR_CODE ASIVideoStream::nextFrame(uint8_t **frame, size_t *size, Format *format)
+{
+    ASI_ERROR_CODE ret = applyPending();
+    if (ret != ASI_SUCCESS)
+        return ret;
+
+    ret = ASIGetVideoData(mCameraID, mBuffer.data(), static_cast<long>(mBuffer.size()), mWaitMs);
+    if (ret != ASI_SUCCESS)
+        return ret;
+
+    auto now = std::chrono::steady_clock::now();
+    mFrames++;
+    std::chrono::duration<double> elapsed = now - mFPSStart;
+    if (elapsed.count() >= 1.0)
+    {
+        mFPS      = mFrames / elapsed.count();
+        mFrames   = 0;
+        mFPSStart = now;
+    }
+
+    *frame  = mBuffer.data();
+    *size   = mBuffer.size();
+    *format = mFormat;
+    return ASI_SUCCESS;
+}
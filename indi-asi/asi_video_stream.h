@@ -0,0 +1,106 @@
+/*
+    ASI CCD Driver
+
+    Copyright (C) 2015 Jasem Mutlaq (mutlaqja@ikarustech.com)
+    Copyright (C) 2018 Leonard Bottleman (leonard@whiteweasel.net)
+    Copyright (C) 2021 Pawel Soja (kernel32.pl@gmail.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <ASICamera2.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief The ASIVideoStream class owns a running ASI video capture.
+ *
+ * Everything the capture loop needs is cached when the stream starts, so reading a frame
+ * is a single ASIGetVideoData into a buffer owned by the stream. ROI and format changes
+ * are queued with requestFormat() from any thread and applied by the capture thread
+ * between two frames: a pure move of the ROI only updates the start position, any other
+ * change restarts the capture on the camera without stopping the stream.
+ */
+class ASIVideoStream
+{
+public:
+    struct Format
+    {
+        int x {0};
+        int y {0};
+        int width {0};      // binned pixels
+        int height {0};     // binned pixels
+        int bin {1};
+        ASI_IMG_TYPE type {ASI_IMG_RAW8};
+
+        size_t frameBytes() const;
+        /** True when both formats only differ by their start position */
+        bool sameGeometry(const Format &other) const;
+    };
+
+    explicit ASIVideoStream(int cameraID);
+    ~ASIVideoStream();
+
+    /** Set the ROI and format on the camera, then start capturing. */
+    ASI_ERROR_CODE start(const Format &format, int waitMs);
+    /** Stop capturing, a format still queued is set on the camera. */
+    void stop();
+
+    bool isCapturing() const
+    {
+        return mCapturing;
+    }
+
+    /** Queue a new ROI or format, it replaces any request not applied yet. */
+    void requestFormat(const Format &format);
+
+    /**
+     * Apply a queued format then wait for the next frame. On success frame points into a
+     * buffer owned by the stream, valid until the next call, and format describes it.
+     */
+    ASI_ERROR_CODE nextFrame(uint8_t **frame, size_t *size, Format *format);
+
+    /** Frames per second delivered over the last second */
+    double fps() const
+    {
+        return mFPS;
+    }
+
+private:
+    bool takePending(Format *format);
+    ASI_ERROR_CODE setCameraFormat(const Format &format);
+    ASI_ERROR_CODE applyPending();
+
+    int mCameraID;
+    int mWaitMs {0};
+    Format mFormat;
+    std::vector<uint8_t> mBuffer;
+    std::atomic_bool mCapturing {false};
+
+    std::mutex mPendingLock;
+    Format mPending;
+    bool mHasPending {false};
+
+    uint32_t mFrames {0};
+    std::chrono::steady_clock::time_point mFPSStart;
+    std::atomic<double> mFPS {0};
+};
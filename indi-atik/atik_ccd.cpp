@@ -21,12 +21,14 @@
 */
 
 #include "atik_ccd.h"
+#include "atik_exposure_wait.h"
 
 #include "config.h"
 
 #include <stream/streammanager.h>
 
 #include <algorithm>
+#include <chrono>
 #include <math.h>
 #include <unistd.h>
 #include <deque>
@@ -96,6 +98,9 @@ static class Loader
         }
 } loader;
 
+std::map<ArtemisHandle, ATIKCCD *> ATIKCCD::m_FastCameras;
+pthread_mutex_t ATIKCCD::m_FastCamerasMutex = PTHREAD_MUTEX_INITIALIZER;
+
 ATIKCCD::ATIKCCD(std::string filterName, int id) : FilterInterface(this), m_iDevice(id)
 {
     setVersion(ATIK_VERSION_MAJOR, ATIK_VERSION_MINOR);
@@ -165,11 +170,26 @@ bool ATIKCCD::initProperties()
     IUFillSwitch(&FastModeS[FASTMODE_POWERSAVE], "CONTROL_POWERSAVE", "Powersave / Low noise", ISS_OFF);
     IUFillSwitch(&FastModeS[FASTMODE_NORMAL], "CONTROL_NORMAL", "Normal", ISS_OFF);
     IUFillSwitch(&FastModeS[FASTMODE_FAST], "CONTROL_FAST", "Fast / Stream", ISS_OFF);
-    // TODO: Implement fast mode 'fast' then increase SwitchVector size to 3
-    IDLog("Warning: Exposure speed 'fast' is not implemented in this version.");
-    IUFillSwitchVector(&FastModeSP, FastModeS, 2, getDeviceName(), "CCD_FAST_MODE", "Fast Mode", CONTROLS_TAB, IP_RW,
+    IUFillSwitchVector(&FastModeSP, FastModeS, 3, getDeviceName(), "CCD_FAST_MODE", "Fast Mode", CONTROLS_TAB, IP_RW,
                        ISR_1OFMANY, 60, IPS_IDLE);
 
+    // Continuous exposing
+    IUFillSwitch(&ContinuousS[CONTINUOUS_OFF], "CONTINUOUS_OFF", "OFF", ISS_ON);
+    IUFillSwitch(&ContinuousS[CONTINUOUS_ON], "CONTINUOUS_ON", "ON", ISS_OFF);
+    IUFillSwitchVector(&ContinuousSP, ContinuousS, 2, getDeviceName(), "CCD_CONTINUOUS_EXPOSING", "Continuous", OPTIONS_TAB,
+                       IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    // Frame interval
+    IUFillNumber(&FrameIntervalN[0], "FRAME_INTERVAL", "Interval (s)", "%.3f", 0, 3600 * 24, 0, 0);
+    IUFillNumberVector(&FrameIntervalNP, FrameIntervalN, 1, getDeviceName(), "CCD_FRAME_INTERVAL", "Frame Interval",
+                       IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
+    // Completion latency
+    IUFillNumber(&LatencyN[LATENCY_READY], "LATENCY_READY", "Ready after end (s)", "%.4f", -3600, 3600, 0, 0);
+    IUFillNumber(&LatencyN[LATENCY_DELIVERY], "LATENCY_DELIVERY", "Ready to delivered (s)", "%.4f", 0, 3600, 0, 0);
+    IUFillNumberVector(&LatencyNP, LatencyN, 2, getDeviceName(), "CCD_FRAME_LATENCY", "Frame Latency",
+                       IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
 #if 0
     // Bit send format
     IUFillSwitch(&BitSendS[BITSEND_16BITS], "BITSEND_16BITS", "16BITS", ISS_OFF);
@@ -225,6 +245,15 @@ bool ATIKCCD::updateProperties()
             //loadConfig(true, "CCD_BIT_SEND");
         }
 
+        if (m_CanContinuous)
+        {
+            defineProperty(&ContinuousSP);
+            loadConfig(true, "CCD_CONTINUOUS_EXPOSING");
+        }
+
+        defineProperty(&FrameIntervalNP);
+        defineProperty(&LatencyNP);
+
         if (m_CameraFlags & ARTEMIS_PROPERTIES_CAMERAFLAGS_HAS_FILTERWHEEL)
         {
             INDI::FilterInterface::updateProperties();
@@ -252,6 +281,12 @@ bool ATIKCCD::updateProperties()
             // deleteProperty(BitSendSP.name); // unused
         }
 
+        if (m_CanContinuous)
+            deleteProperty(ContinuousSP.name);
+
+        deleteProperty(FrameIntervalNP.name);
+        deleteProperty(LatencyNP.name);
+
         if (m_CameraFlags & ARTEMIS_PROPERTIES_CAMERAFLAGS_HAS_FILTERWHEEL)
         {
             INDI::FilterInterface::updateProperties();
@@ -376,6 +411,18 @@ bool ATIKCCD::setupParams()
         cap |= CCD_HAS_ST4_PORT;
     }
 
+    // Can we stream with fast exposures?
+    m_HasFastMode = ArtemisHasFastMode(hCam);
+    if (m_HasFastMode)
+    {
+        LOG_DEBUG("Camera supports fast mode streaming.");
+        cap |= CCD_HAS_STREAMING;
+    }
+
+    // Can we overlap readout with the next exposure?
+    m_CanContinuous = ArtemisContinuousExposingModeSupported(hCam);
+    LOGF_DEBUG("Camera %s continuous exposing.", m_CanContinuous ? "supports" : "does not support");
+
     // Done with the capabilities!
     SetCCDCapability(cap);
 
@@ -453,8 +500,6 @@ bool ATIKCCD::setupParams()
             IUResetSwitch(&FastModeSP);
             if (0 <= index && index < (int)(sizeof(FastModeS) / sizeof(FastModeS[0])))
             {
-                if (index == FASTMODE_FAST)
-                    LOG_WARN("Warning: fast mode exposure speed is not implemented, please choose another mode.");
                 FastModeS[index].s = ISS_ON;
             }
             else LOG_WARN("Warning: camera is currently configured with an unknown Fast Mode state.");
@@ -625,6 +670,9 @@ bool ATIKCCD::Disconnect()
     RemoveTimer(genTimerID);
     genTimerID = -1;
 
+    if (m_Streaming)
+        StopStreaming();
+
     pthread_mutex_lock(&condMutex);
     tState = threadState;
     threadRequest = StateTerminate;
@@ -875,6 +923,22 @@ bool ATIKCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, ch
             IDSetSwitch(&v, nullptr);
             return true;
         }
+        else if (!strcmp(name, ContinuousSP.name))
+        {
+            int prevIndex = IUFindOnSwitchIndex(&ContinuousSP);
+            IUUpdateSwitch(&ContinuousSP, states, names, n);
+            if (setContinuousExposing(ContinuousS[CONTINUOUS_ON].s == ISS_ON))
+                ContinuousSP.s = IPS_OK;
+            else
+            {
+                IUResetSwitch(&ContinuousSP);
+                ContinuousS[prevIndex].s = ISS_ON;
+                ContinuousSP.s = IPS_ALERT;
+            }
+
+            IDSetSwitch(&ContinuousSP, nullptr);
+            return true;
+        }
 #if 0
         else if (!strcmp(name, BitSendSP.name))
         {
@@ -981,6 +1045,40 @@ bool ATIKCCD::StartExposure(float duration)
     PrimaryCCD.setExposureDuration(duration);
     ExposureRequest = duration;
 
+    bool const darkFrame = PrimaryCCD.getFrameType() == INDI::CCDChip::DARK_FRAME ||
+                           PrimaryCCD.getFrameType() == INDI::CCDChip::BIAS_FRAME;
+
+    // In continuous mode the camera starts integrating again as soon as the previous frame is read out.
+    // If the settings did not change, that exposure is simply picked up by the imaging thread.
+    if (m_Continuous)
+    {
+        if (m_ContinuousDuration >= 0 && m_ContinuousDuration == duration && m_ContinuousDark == darkFrame)
+        {
+            pthread_mutex_lock(&accessMutex);
+            int state = ArtemisCameraState(hCam);
+            pthread_mutex_unlock(&accessMutex);
+
+            if (state > CAMERA_IDLE && state < CAMERA_FLUSHING)
+            {
+                LOGF_DEBUG("Continue Exposure : %.3fs", duration);
+                ExpStart = m_LastFrame;
+                if (ExposureRequest > VERBOSE_EXPOSURE)
+                    LOGF_INFO("Taking a %g seconds frame...", ExposureRequest);
+
+                InExposure = true;
+                pthread_mutex_lock(&condMutex);
+                threadRequest = StateExposure;
+                pthread_cond_signal(&cv);
+                pthread_mutex_unlock(&condMutex);
+                return true;
+            }
+        }
+
+        // Settings changed, stop the exposure the camera may have rolled into and start over
+        ArtemisStopExposure(hCam);
+        m_ContinuousDuration = -1;
+    }
+
     // Camera needs to be in idle state to start exposure after previous abort
     int maxWaitCount = 1000; // 1000 * 0.1s = 100s
     while (ArtemisCameraState(hCam) != CAMERA_IDLE && --maxWaitCount > 0)
@@ -1009,8 +1107,7 @@ bool ATIKCCD::StartExposure(float duration)
     //        }
     //    }
 
-    ArtemisSetDarkMode(hCam, PrimaryCCD.getFrameType() == INDI::CCDChip::DARK_FRAME ||
-                       PrimaryCCD.getFrameType() == INDI::CCDChip::BIAS_FRAME);
+    ArtemisSetDarkMode(hCam, darkFrame);
 
     int rc = ArtemisStartExposure(hCam, duration);
 
@@ -1020,6 +1117,12 @@ bool ATIKCCD::StartExposure(float duration)
         return false;
     }
 
+    if (m_Continuous)
+    {
+        m_ContinuousDuration = duration;
+        m_ContinuousDark = darkFrame;
+    }
+
     gettimeofday(&ExpStart, nullptr);
     if (ExposureRequest > VERBOSE_EXPOSURE)
         LOGF_INFO("Taking a %g seconds frame...", ExposureRequest);
@@ -1050,14 +1153,233 @@ bool ATIKCCD::AbortExposure()
     pthread_mutex_unlock(&condMutex);
     ArtemisStopExposure(hCam);
     InExposure = false;
+    m_ContinuousDuration = -1;
+    return true;
+}
+
+/////////////////////////////////////////////////////////
+/// Enable or disable continuous exposing
+/////////////////////////////////////////////////////////
+bool ATIKCCD::setContinuousExposing(bool enable)
+{
+    pthread_mutex_lock(&accessMutex);
+    int rc = ArtemisSetContinuousExposingMode(hCam, enable);
+    // Stop the exposure the camera may have rolled into on its own
+    if (rc == ARTEMIS_OK && !enable && !InExposure && m_ContinuousDuration >= 0)
+        ArtemisStopExposure(hCam);
+    pthread_mutex_unlock(&accessMutex);
+
+    if (rc != ARTEMIS_OK)
+    {
+        LOGF_ERROR("Failed to %s continuous exposing (%d).", enable ? "enable" : "disable", rc);
+        return false;
+    }
+
+    m_Continuous = enable;
+    m_ContinuousDuration = -1;
+    LOGF_INFO("Continuous exposing is %s.", enable ? "on" : "off");
+    return true;
+}
+
+/////////////////////////////////////////////////////////
+/// Drop the running continuous sequence, the frames it
+/// produces no longer match the frame, binning or type
+/////////////////////////////////////////////////////////
+void ATIKCCD::stopContinuousSequence()
+{
+    if (m_ContinuousDuration < 0)
+        return;
+
+    m_ContinuousDuration = -1;
+    // An exposure in progress is completed as requested, the next one starts over
+    if (!InExposure)
+    {
+        pthread_mutex_lock(&accessMutex);
+        ArtemisStopExposure(hCam);
+        pthread_mutex_unlock(&accessMutex);
+    }
+}
+
+/////////////////////////////////////////////////////////
+/// Start fast mode streaming
+/////////////////////////////////////////////////////////
+bool ATIKCCD::StartStreaming()
+{
+    if (!m_HasFastMode)
+    {
+        LOG_ERROR("Camera does not support fast mode streaming.");
+        return false;
+    }
+
+    ExposureRequest = 1.0 / Streamer->getTargetFPS();
+    int ms = std::max(1, static_cast<int>(ExposureRequest * 1000));
+
+    Streamer->setPixelFormat((GetCCDCapability() & CCD_HAS_BAYER) ? INDI_BAYER_RGGB : INDI_MONO, 16);
+    Streamer->setSize(PrimaryCCD.getSubW() / PrimaryCCD.getBinX(), PrimaryCCD.getSubH() / PrimaryCCD.getBinY());
+
+    // reset video ring
+    pthread_mutex_lock(&videoMutex);
+    videoFree.clear();
+    videoReady.clear();
+    for (int i = 0; i < VIDEO_RING_SIZE; i++)
+        videoFree.push_back(i);
+    m_DroppedFrames = 0;
+    m_Streaming = true;
+    pthread_mutex_unlock(&videoMutex);
+
+    int stat = pthread_create(&publishThread, nullptr, &publishHelper, this);
+    if (stat != 0)
+    {
+        LOGF_ERROR("Error creating publishing thread (%d)", stat);
+        m_Streaming = false;
+        return false;
+    }
+
+    pthread_mutex_lock(&m_FastCamerasMutex);
+    m_FastCameras[hCam] = this;
+    pthread_mutex_unlock(&m_FastCamerasMutex);
+
+    pthread_mutex_lock(&accessMutex);
+    ArtemisSetFastCallback(hCam, &fastCallbackHelper);
+    bool started = ArtemisStartFastExposure(hCam, ms);
+    pthread_mutex_unlock(&accessMutex);
+
+    if (!started)
+    {
+        LOG_ERROR("Failed to start fast exposures.");
+        StopStreaming();
+        return false;
+    }
+
+    LOGF_DEBUG("Fast exposures started : %d ms", ms);
+    return true;
+}
+
+/////////////////////////////////////////////////////////
+/// Stop fast mode streaming
+/////////////////////////////////////////////////////////
+bool ATIKCCD::StopStreaming()
+{
+    pthread_mutex_lock(&accessMutex);
+    ArtemisStopExposure(hCam);
+    ArtemisSetFastCallback(hCam, nullptr);
+    pthread_mutex_unlock(&accessMutex);
+
+    // Once removed, no callback can reach this camera any more
+    pthread_mutex_lock(&m_FastCamerasMutex);
+    m_FastCameras.erase(hCam);
+    pthread_mutex_unlock(&m_FastCamerasMutex);
+
+    pthread_mutex_lock(&videoMutex);
+    bool const wasStreaming = m_Streaming;
+    m_Streaming = false;
+    pthread_cond_broadcast(&videoCV);
+    pthread_mutex_unlock(&videoMutex);
+
+    if (wasStreaming)
+        pthread_join(publishThread, nullptr);
+
+    if (m_DroppedFrames > 0)
+        LOGF_INFO("Streaming dropped %u frames.", m_DroppedFrames);
+
     return true;
 }
 
+/////////////////////////////////////////////////////////
+/// SDK fast mode frame callback
+/////////////////////////////////////////////////////////
+void ATIKCCD::fastCallbackHelper(ArtemisHandle handle, int x, int y, int w, int h, int binx, int biny,
+                                 void *imageBuffer)
+{
+    INDI_UNUSED(x);
+    INDI_UNUSED(y);
+    INDI_UNUSED(binx);
+    INDI_UNUSED(biny);
+
+    pthread_mutex_lock(&m_FastCamerasMutex);
+    auto camera = m_FastCameras.find(handle);
+    if (camera != m_FastCameras.end())
+        camera->second->fastCallback(w, h, imageBuffer);
+    pthread_mutex_unlock(&m_FastCamerasMutex);
+}
+
+void ATIKCCD::fastCallback(int w, int h, void *imageBuffer)
+{
+    size_t const size = static_cast<size_t>(w) * h * sizeof(uint16_t);
+    int slot;
+
+    // Take a free slot, or recycle the oldest frame the publisher has not picked up yet
+    pthread_mutex_lock(&videoMutex);
+    if (!m_Streaming)
+    {
+        pthread_mutex_unlock(&videoMutex);
+        return;
+    }
+    if (!videoFree.empty())
+    {
+        slot = videoFree.front();
+        videoFree.pop_front();
+    }
+    else
+    {
+        slot = videoReady.front();
+        videoReady.pop_front();
+        m_DroppedFrames++;
+    }
+    pthread_mutex_unlock(&videoMutex);
+
+    uint8_t const *src = static_cast<uint8_t const *>(imageBuffer);
+    videoRing[slot].assign(src, src + size);
+
+    pthread_mutex_lock(&videoMutex);
+    videoReady.push_back(slot);
+    pthread_cond_signal(&videoCV);
+    pthread_mutex_unlock(&videoMutex);
+}
+
+/////////////////////////////////////////////////////////
+/// Publishing thread, sends frames without blocking the SDK
+/////////////////////////////////////////////////////////
+void *ATIKCCD::publishHelper(void *context)
+{
+    return static_cast<ATIKCCD *>(context)->publishVideo();
+}
+
+void *ATIKCCD::publishVideo()
+{
+    while (true)
+    {
+        pthread_mutex_lock(&videoMutex);
+        while (videoReady.empty() && m_Streaming)
+            pthread_cond_wait(&videoCV, &videoMutex);
+
+        if (!m_Streaming)
+        {
+            pthread_mutex_unlock(&videoMutex);
+            break;
+        }
+
+        int slot = videoReady.front();
+        videoReady.pop_front();
+        pthread_mutex_unlock(&videoMutex);
+
+        Streamer->newFrame(videoRing[slot].data(), videoRing[slot].size());
+
+        pthread_mutex_lock(&videoMutex);
+        videoFree.push_back(slot);
+        pthread_mutex_unlock(&videoMutex);
+    }
+
+    return nullptr;
+}
+
 /////////////////////////////////////////////////////////
 /// Updates CCD sub frame
 /////////////////////////////////////////////////////////
 bool ATIKCCD::UpdateCCDFrame(int x, int y, int w, int h)
 {
+    stopContinuousSequence();
+
     int rc = ArtemisSubframe(hCam, x, y, w, h);
     if (rc != ARTEMIS_OK)
     {
@@ -1079,6 +1401,8 @@ bool ATIKCCD::UpdateCCDFrame(int x, int y, int w, int h)
 /////////////////////////////////////////////////////////
 bool ATIKCCD::UpdateCCDBin(int binx, int biny)
 {
+    stopContinuousSequence();
+
     int rc = ArtemisBin(hCam, binx, biny);
 
     if (rc != ARTEMIS_OK)
@@ -1089,6 +1413,17 @@ bool ATIKCCD::UpdateCCDBin(int binx, int biny)
     return UpdateCCDFrame(PrimaryCCD.getSubX(), PrimaryCCD.getSubY(), PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
 }
 
+/////////////////////////////////////////////////////////
+/// Update CCD frame type
+/////////////////////////////////////////////////////////
+bool ATIKCCD::UpdateCCDFrameType(INDI::CCDChip::CCD_FRAME fType)
+{
+    if (fType != PrimaryCCD.getFrameType())
+        stopContinuousSequence();
+
+    return INDI::CCD::UpdateCCDFrameType(fType);
+}
+
 /////////////////////////////////////////////////////////
 /// Download from CCD
 /////////////////////////////////////////////////////////
@@ -1116,6 +1451,16 @@ bool ATIKCCD::grabImage()
     if (ExposureRequest > VERBOSE_EXPOSURE)
         LOG_INFO("Download complete.");
 
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    if (m_LastFrame.tv_sec != 0)
+    {
+        FrameIntervalN[0].value = (now.tv_sec - m_LastFrame.tv_sec) + (now.tv_usec - m_LastFrame.tv_usec) / 1e6;
+        FrameIntervalNP.s = IPS_OK;
+        IDSetNumber(&FrameIntervalNP, nullptr);
+    }
+    m_LastFrame = now;
+
     ExposureComplete(&PrimaryCCD);
     return true;
 }
@@ -1401,15 +1746,35 @@ void *ATIKCCD::imagingThreadEntry()
 /////////////////////////////////////////////////////////
 void ATIKCCD::checkExposureProgress()
 {
+    using namespace std::chrono;
+
     int expRetry = 0;
-    int uSecs = 1000000;
+
+    // The exposure is expected to end at the deadline: sleep until shortly before it,
+    // then poll the SDK finely until the image is ready.
+    pthread_mutex_unlock(&condMutex);
+    pthread_mutex_lock(&accessMutex);
+    float timeLeft = ArtemisExposureTimeRemaining(hCam);
+    pthread_mutex_unlock(&accessMutex);
+    AtikExposureWait wait(steady_clock::now() + microseconds(static_cast<int64_t>(timeLeft * 1e6)));
+    pthread_mutex_lock(&condMutex);
 
     while (threadRequest == StateExposure)
     {
         pthread_mutex_unlock(&condMutex);
+        steady_clock::time_point now = steady_clock::now();
+        int64_t const remainingUs = wait.remainingUs(now);
+
         pthread_mutex_lock(&accessMutex);
-        if (ArtemisImageReady(hCam))
+        bool const ready = ArtemisImageReady(hCam);
+        int state = CAMERA_IDLE;
+        // Camera state is only needed to detect failures, so it is not queried on every fine poll
+        if (!ready && wait.checkState(now))
+            state = ArtemisCameraState(hCam);
+
+        if (ready)
         {
+            steady_clock::time_point const readyAt = steady_clock::now();
             InExposure = false;
             PrimaryCCD.setExposureLeft(0.0);
             if (ExposureRequest > VERBOSE_EXPOSURE)
@@ -1418,13 +1783,18 @@ void ATIKCCD::checkExposureProgress()
             exposureSetRequest(StateIdle);
             pthread_mutex_unlock(&condMutex);
             grabImage();
-            pthread_mutex_lock(&condMutex);
             pthread_mutex_unlock(&accessMutex);
+
+            LatencyN[LATENCY_READY].value = duration<double>(readyAt - wait.deadline()).count();
+            LatencyN[LATENCY_DELIVERY].value = duration<double>(steady_clock::now() - readyAt).count();
+            LatencyNP.s = IPS_OK;
+            IDSetNumber(&LatencyNP, nullptr);
+
+            pthread_mutex_lock(&condMutex);
             break;
         }
-
-        int state = ArtemisCameraState(hCam);
         pthread_mutex_unlock(&accessMutex);
+
         if (state == -1)
         {
             if (++expRetry < MAX_EXP_RETRIES)
@@ -1459,31 +1829,14 @@ void ATIKCCD::checkExposureProgress()
             }
         }
 
-        pthread_mutex_lock(&accessMutex);
-        float timeLeft = ArtemisExposureTimeRemaining(hCam);
-        pthread_mutex_unlock(&accessMutex);
-        if (timeLeft > 1.1)
-        {
-            float fraction = timeLeft - static_cast<float>(static_cast<int>(timeLeft));
-            if (fraction >= 0.005)
-            {
-                uSecs = (fraction * 1000000.0f);
-            }
-            else
-            {
-                uSecs = 1000000;
-            }
-        }
-        else
-        {
-            uSecs = 10000;
-        }
-        if (timeLeft >= 0.0049)
+        if (remainingUs >= 4900)
         {
-            PrimaryCCD.setExposureLeft(timeLeft);
+            PrimaryCCD.setExposureLeft(remainingUs / 1e6);
         }
 
-        usleep(uSecs);
+        // Sleep without holding accessMutex, see AtikExposureWait for the pacing
+        usleep(wait.nextSleepUs(now));
+
         pthread_mutex_lock(&condMutex);
     }
 }
@@ -1538,6 +1891,9 @@ bool ATIKCCD::saveConfigItems(FILE *fp)
         // IUSaveConfigSwitch(fp, &BitSendSP); // unused
     }
 
+    if (m_CanContinuous)
+        IUSaveConfigSwitch(fp, &ContinuousSP);
+
     if (m_CameraFlags & ARTEMIS_PROPERTIES_CAMERAFLAGS_HAS_FILTERWHEEL)
         IUSaveConfigText(fp, FilterNameTP);
     // JM 2020-01-15: Seems like setting filter slot results in spinning
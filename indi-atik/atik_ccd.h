@@ -26,6 +26,10 @@
 #include <indifilterinterface.h>
 #include <indiccd.h>
 
+#include <deque>
+#include <map>
+#include <vector>
+
 class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
 {
     public:
@@ -44,6 +48,9 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         virtual bool StartExposure(float duration) override;
         virtual bool AbortExposure() override;
 
+        virtual bool StartStreaming() override;
+        virtual bool StopStreaming() override;
+
         static void debugCallbackHelper(void *context, const char *message);
 
     protected:
@@ -54,6 +61,7 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         virtual void TimerHit() override;
         virtual bool UpdateCCDFrame(int x, int y, int w, int h) override;
         virtual bool UpdateCCDBin(int binx, int biny) override;
+        virtual bool UpdateCCDFrameType(INDI::CCDChip::CCD_FRAME fType) override;
 
         // Guide Port
         virtual IPState GuideNorth(uint32_t ms) override;
@@ -119,6 +127,18 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         // Debug
         void debugCallback(const char *message);
 
+        // Fast mode streaming: the SDK callback copies frames into a small ring,
+        // publishVideo() hands them over to the streamer.
+        static void fastCallbackHelper(ArtemisHandle handle, int x, int y, int w, int h, int binx, int biny,
+                                       void *imageBuffer);
+        void fastCallback(int w, int h, void *imageBuffer);
+        static void *publishHelper(void *context);
+        void *publishVideo();
+
+        // Continuous exposing
+        bool setContinuousExposing(bool enable);
+        void stopContinuousSequence();
+
         // Exposure Progress
         void checkExposureProgress();
         void exposureSetRequest(ImageState request);
@@ -212,6 +232,28 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
             FASTMODE_FAST,
         };
 
+        // Continuous exposing, readout overlaps the next integration
+        ISwitch ContinuousS[2];
+        ISwitchVectorProperty ContinuousSP;
+        enum
+        {
+            CONTINUOUS_OFF = 0,
+            CONTINUOUS_ON
+        };
+
+        // Interval between the last two delivered frames
+        INumber FrameIntervalN[1];
+        INumberVectorProperty FrameIntervalNP;
+
+        // Time from expected end of exposure to image ready, and from ready to delivered
+        INumber LatencyN[2];
+        INumberVectorProperty LatencyNP;
+        enum
+        {
+            LATENCY_READY = 0,
+            LATENCY_DELIVERY
+        };
+
 #if 0 // unused
         // Bit send
         ISwitch BitSendS[2];
@@ -246,6 +288,29 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         pthread_mutex_t condMutex = PTHREAD_MUTEX_INITIALIZER;
         pthread_mutex_t accessMutex = PTHREAD_MUTEX_INITIALIZER;
 
+        // Video ring
+        static constexpr int VIDEO_RING_SIZE = 3;
+        std::vector<uint8_t> videoRing[VIDEO_RING_SIZE];
+        std::deque<int> videoFree;
+        std::deque<int> videoReady;
+        pthread_t publishThread;
+        pthread_cond_t videoCV         = PTHREAD_COND_INITIALIZER;
+        pthread_mutex_t videoMutex     = PTHREAD_MUTEX_INITIALIZER;
+        bool m_Streaming { false };
+        uint32_t m_DroppedFrames { 0 };
+
+        // Fast callback carries no context, so cameras are looked up by handle
+        static std::map<ArtemisHandle, ATIKCCD *> m_FastCameras;
+        static pthread_mutex_t m_FastCamerasMutex;
+
+        // Continuous exposing state
+        bool m_HasFastMode { false };
+        bool m_CanContinuous { false };
+        bool m_Continuous { false };
+        float m_ContinuousDuration { -1 };
+        bool m_ContinuousDark { false };
+        struct timeval m_LastFrame {};
+
         // Pulse Guiding
         int WEtimerID;
         int NStimerID;
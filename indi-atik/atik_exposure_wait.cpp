@@ -0,0 +1,56 @@
+/*
+ ATIK CCD & Filter Wheel Driver
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "atik_exposure_wait.h"
+
+#include <algorithm>
+
+AtikExposureWait::AtikExposureWait(TimePoint deadline) : m_Deadline(deadline)
+{
+}
+
+int64_t AtikExposureWait::remainingUs(TimePoint now) const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(m_Deadline - now).count();
+}
+
+bool AtikExposureWait::checkState(TimePoint now)
+{
+    if (m_StateChecked && now - m_LastStateCheck < std::chrono::milliseconds(STATE_CHECK_MS))
+        return false;
+
+    m_StateChecked = true;
+    m_LastStateCheck = now;
+    return true;
+}
+
+uint32_t AtikExposureWait::nextSleepUs(TimePoint now)
+{
+    int64_t const remaining = remainingUs(now);
+
+    // Coarse sleep until the guard before the deadline, at most a second to stay responsive to abort
+    if (remaining > EXP_GUARD_US)
+        return static_cast<uint32_t>(std::min<int64_t>(remaining - EXP_GUARD_US, 1000000));
+
+    // Back off when the camera runs late, so that the cooler and guiding timers are not starved of the lock
+    uint32_t const sleepUs = m_PollUs;
+    if (remaining < 0)
+        m_PollUs = std::min<uint32_t>(m_PollUs * 2, EXP_POLL_MAX_US);
+    return sleepUs;
+}
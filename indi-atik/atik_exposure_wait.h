@@ -0,0 +1,62 @@
+/*
+ ATIK CCD & Filter Wheel Driver
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+
+#define EXP_GUARD_US            20000 /* Coarse sleep ends this long before expected completion (us) */
+#define EXP_POLL_US             500   /* First image ready polling period near completion (us) */
+#define EXP_POLL_MAX_US         16000 /* Image ready polling period backs off up to this (us) */
+#define STATE_CHECK_MS          100   /* Camera state polling period while waiting (ms) */
+
+/**
+ * @brief Paces the imaging thread while an exposure runs. It sleeps coarsely, at most a
+ * second at a time, until EXP_GUARD_US before the expected end, then polls for the image
+ * every EXP_POLL_US. Once the camera is late the polling period doubles up to
+ * EXP_POLL_MAX_US. The camera state is only wanted every STATE_CHECK_MS.
+ */
+class AtikExposureWait
+{
+    public:
+        typedef std::chrono::steady_clock::time_point TimePoint;
+
+        explicit AtikExposureWait(TimePoint deadline);
+
+        TimePoint deadline() const
+        {
+            return m_Deadline;
+        }
+
+        /** Time left until the expected end of the exposure, negative once the camera is late (us) */
+        int64_t remainingUs(TimePoint now) const;
+
+        /** True when the camera state should be queried on this poll to detect failures */
+        bool checkState(TimePoint now);
+
+        /** Sleep before the next image ready poll (us) */
+        uint32_t nextSleepUs(TimePoint now);
+
+    private:
+        TimePoint m_Deadline;
+        TimePoint m_LastStateCheck;
+        bool m_StateChecked { false };
+        uint32_t m_PollUs { EXP_POLL_US };
+};
@@ -0,0 +1,121 @@
+/*
+ ATIK CCD & Filter Wheel Driver
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+/*
+ * The imaging thread's wait for an exposure, run against a mocked Artemis SDK on a
+ * simulated clock: the image is noticed within one poll of being ready, long exposures
+ * are slept through with few SDK calls, and a late camera is polled less and less often.
+ */
+
+#include <gtest/gtest.h>
+
+#include "atik_exposure_wait.h"
+
+using namespace std::chrono;
+
+typedef AtikExposureWait::TimePoint TimePoint;
+
+// The SDK calls made by checkExposureProgress, with the image ready at a given time
+struct MockArtemis
+{
+    TimePoint readyAt;
+    int readyCalls { 0 };
+    int stateCalls { 0 };
+
+    bool ArtemisImageReady(TimePoint now)
+    {
+        readyCalls++;
+        return now >= readyAt;
+    }
+    int ArtemisCameraState()
+    {
+        stateCalls++;
+        return 2; // CAMERA_EXPOSING
+    }
+};
+
+// Same sequence of calls as ATIKCCD::checkExposureProgress, the clock only moves on sleeps
+static TimePoint waitForImage(MockArtemis &sdk, AtikExposureWait &wait, TimePoint now)
+{
+    while (!sdk.ArtemisImageReady(now))
+    {
+        if (wait.checkState(now))
+            sdk.ArtemisCameraState();
+        now += microseconds(wait.nextSleepUs(now));
+    }
+    return now;
+}
+
+TEST(AtikExposureWaitTest, short_exposure_seen_within_a_poll)
+{
+    TimePoint start;
+    AtikExposureWait wait(start + milliseconds(10));
+    MockArtemis sdk;
+    sdk.readyAt = wait.deadline() + microseconds(300);
+
+    TimePoint seen = waitForImage(sdk, wait, start);
+
+    EXPECT_LE(duration_cast<microseconds>(seen - sdk.readyAt).count(), EXP_POLL_US);
+    // fine polling all along, 10.3 ms at 500 us
+    EXPECT_LE(sdk.readyCalls, 10300 / EXP_POLL_US + 2);
+    EXPECT_EQ(sdk.stateCalls, 1);
+}
+
+TEST(AtikExposureWaitTest, long_exposure_sleeps_coarsely)
+{
+    TimePoint start;
+    AtikExposureWait wait(start + seconds(10));
+    MockArtemis sdk;
+    sdk.readyAt = wait.deadline() + milliseconds(1);
+
+    TimePoint seen = waitForImage(sdk, wait, start);
+
+    EXPECT_LE(duration_cast<microseconds>(seen - sdk.readyAt).count(), EXP_POLL_US);
+    // one poll a second up to the guard, then 21 ms of fine polling
+    EXPECT_LE(sdk.readyCalls, 11 + (EXP_GUARD_US + 1000) / EXP_POLL_US + 2);
+    EXPECT_LE(sdk.stateCalls, 12);
+}
+
+TEST(AtikExposureWaitTest, late_camera_is_polled_less_often)
+{
+    TimePoint start;
+    AtikExposureWait wait(start + seconds(1));
+    MockArtemis sdk;
+    sdk.readyAt = wait.deadline() + seconds(2);
+
+    TimePoint seen = waitForImage(sdk, wait, start);
+
+    EXPECT_LE(duration_cast<microseconds>(seen - sdk.readyAt).count(), EXP_POLL_MAX_US);
+    // 2 s late at the longest period instead of 4000 polls at the shortest
+    EXPECT_LE(sdk.readyCalls, 2 + EXP_GUARD_US / EXP_POLL_US + 2000000 / EXP_POLL_MAX_US + 8);
+    // state checks stay STATE_CHECK_MS apart
+    EXPECT_LE(sdk.stateCalls, 3000 / STATE_CHECK_MS + 2);
+}
+
+TEST(AtikExposureWaitTest, remaining_time_goes_negative_when_late)
+{
+    TimePoint start;
+    AtikExposureWait wait(start + seconds(5));
+
+    EXPECT_EQ(wait.remainingUs(start), 5000000);
+    EXPECT_EQ(wait.remainingUs(start + seconds(6)), -1000000);
+    // coarse sleeps are capped to a second to stay responsive to abort
+    EXPECT_EQ(wait.nextSleepUs(start), 1000000U);
+    EXPECT_EQ(wait.nextSleepUs(start + milliseconds(4500)), 500000U - EXP_GUARD_US);
+}
@@ -26,6 +26,7 @@
 #include <cmath>
 #include <memory>
 #include <cstring>
+#include <thread>
 #include <unistd.h>
 #ifndef _WIN32
 #include <termios.h>
@@ -440,6 +441,13 @@ bool LX200StarGo::initProperties()
     IUFillNumberVector(&MountRequestDelayNP, MountRequestDelayN, 1, getDeviceName(), "REQUEST_DELAY", "StarGO", RA_DEC_TAB,
                        IP_RW, 60, IPS_OK);
 
+    // status poll statistics
+    IUFillNumber(&PollStatisticsN[0], "POLL_DURATION", "Last Poll (ms)", "%.0f", 0.0, 60000, 0.0, 0.0);
+    IUFillNumber(&PollStatisticsN[1], "POLL_DURATION_AVG", "Average Poll (ms)", "%.0f", 0.0, 60000, 0.0, 0.0);
+    IUFillNumber(&PollStatisticsN[2], "POLL_QUERIES", "Queries", "%.0f", 0.0, 100, 0.0, 0.0);
+    IUFillNumberVector(&PollStatisticsNP, PollStatisticsN, 3, getDeviceName(), "POLL_STATISTICS", "Status Poll", RA_DEC_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
     return true;
 }
 
@@ -462,6 +470,7 @@ bool LX200StarGo::updateProperties()
         defineProperty(&TrackingAdjustmentNP);
         defineProperty(&MeridianFlipModeSP);
         defineProperty(&MountRequestDelayNP);
+        defineProperty(&PollStatisticsNP);
         defineProperty(&MountFirmwareInfoTP);
         getStarGoBasicData();
     }
@@ -478,6 +487,7 @@ bool LX200StarGo::updateProperties()
         deleteProperty(SystemSpeedSlewSP.name);
         deleteProperty(MeridianFlipModeSP.name);
         deleteProperty(MountRequestDelayNP.name);
+        deleteProperty(PollStatisticsNP.name);
         deleteProperty(MountFirmwareInfoTP.name);
     }
 
@@ -492,6 +502,11 @@ bool LX200StarGo::Connect()
     if (! DefaultDevice::Connect())
         return false;
 
+    // read all status values with the first poll
+    pierSideStale      = true;
+    parkStateStale     = true;
+    lastFullStatusPoll = std::chrono::steady_clock::time_point();
+
     // activate focuser AUX1 if the switch is set to "activated"
     return activateFocuserAux1((IUFindOnSwitchIndex(&Aux1FocuserSP) == DefaultDevice::INDI_ENABLED));
 }
@@ -518,6 +533,16 @@ bool LX200StarGo::ReadScopeStatus()
     }
 
     LOG_DEBUG("################################ ReadScopeStatus (start) ################################");
+    std::chrono::steady_clock::time_point pollStart = std::chrono::steady_clock::now();
+    pollQueryCount = 0;
+
+    // Pier side and park state only change while the mount moves. Read them while and right after
+    // moving, and every now and then in case the hand controller moved the mount.
+    bool wasMoving = (TrackState == SCOPE_SLEWING || TrackState == SCOPE_PARKING);
+    bool fullPoll  = (pollStart - lastFullStatusPoll >= std::chrono::seconds(AVALON_STATUS_REFRESH_INTERVAL));
+    if (fullPoll)
+        lastFullStatusPoll = pollStart;
+
     int x, y;
 
     if (! getMotorStatus(&x, &y))
@@ -530,19 +555,28 @@ bool LX200StarGo::ReadScopeStatus()
             return false;
         }
     }
+    // motors moving fast, possibly started from the hand controller
+    if (x > 1 || y > 1)
+        pierSideStale = true;
 
-    char parkHomeStatus[1] = {0};
-    if (! getParkHomeStatus(parkHomeStatus))
+    bool isParked = (TrackState == SCOPE_PARKED);
+    if (parkStateStale || TrackState == SCOPE_PARKING || fullPoll)
     {
-        LOG_ERROR("Cannot determine scope status, failed to determine park/sync state.");
-        return false;
+        char parkHomeStatus[AVALON_RESPONSE_BUFFER_LENGTH] = {0};
+        if (! getParkHomeStatus(parkHomeStatus))
+        {
+            LOG_ERROR("Cannot determine scope status, failed to determine park/sync state.");
+            return false;
+        }
+        LOGF_DEBUG("Mount state = %s", parkHomeStatus);
+        isParked       = (strcmp(parkHomeStatus, "2") == 0);
+        parkStateStale = false;
     }
-    LOGF_DEBUG("Mount state = %s", parkHomeStatus);
 
     INDI::Telescope::TelescopeStatus newTrackState = TrackState;
 
     // handle parking / unparking
-    if(strcmp(parkHomeStatus, "2") == 0)
+    if(isParked)
     {
         newTrackState = SCOPE_PARKED;
         if (TrackState != newTrackState)
@@ -586,18 +620,42 @@ bool LX200StarGo::ReadScopeStatus()
     TrackState = newTrackState;
     NewRaDec(currentRA, currentDEC);
 
-    if (! syncSideOfPier())
+    if (pierSideStale || wasMoving || fullPoll)
     {
-        LOG_ERROR("Cannot determine scope status, failed to determine pier side.");
-        return false;
+        if (! syncSideOfPier())
+        {
+            LOG_ERROR("Cannot determine scope status, failed to determine pier side.");
+            return false;
+        }
+        pierSideStale = false;
     }
 
     LOG_DEBUG("################################ ReadScopeStatus (finish) ###############################");
 
+    bool result = true;
     if (loader.isFocuserAux1Activated() && TrackState != SCOPE_SLEWING)
-        return loader.getFocuserAux1()->ReadFocuserStatus();
+        result = loader.getFocuserAux1()->ReadFocuserStatus();
+
+    updatePollStatistics(pollStart);
+    return result;
+}
+
+/**
+ * @brief Publish the duration and the number of queries of the status poll that started at pollStart.
+ */
+void LX200StarGo::updatePollStatistics(std::chrono::steady_clock::time_point pollStart)
+{
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - pollStart;
+
+    PollStatisticsN[0].value = duration.count();
+    // smooth the average over roughly the last ten polls
+    if (PollStatisticsN[1].value <= 0)
+        PollStatisticsN[1].value = duration.count();
     else
-        return true;
+        PollStatisticsN[1].value = 0.9 * PollStatisticsN[1].value + 0.1 * duration.count();
+    PollStatisticsN[2].value = pollQueryCount;
+    PollStatisticsNP.s = IPS_OK;
+    IDSetNumber(&PollStatisticsNP, nullptr);
 }
 
 /**************************************************************************************
@@ -669,6 +727,7 @@ bool LX200StarGo::slewToHome(ISState* states, char* names[], int n)
     {
         MountGotoHomeSP.s = IPS_BUSY;
         TrackState = SCOPE_SLEWING;
+        pierSideStale = parkStateStale = true;
     }
     else
     {
@@ -1030,6 +1089,7 @@ bool LX200StarGo::Park()
     {
         LOG_INFO("Parking mount...");
         TrackState = SCOPE_PARKING;
+        pierSideStale = parkStateStale = true;
         return true;
     }
     else
@@ -1077,6 +1137,7 @@ bool LX200StarGo::UnPark()
     if (sendQuery(":X370#", response) && strcmp(response, "p0") == 0)
     {
         LOG_INFO("Unparking mount...");
+        pierSideStale = parkStateStale = true;
         return true;
     }
     else
@@ -1146,6 +1207,9 @@ bool LX200StarGo::sendQuery(const char* cmd, char* response, char end, int wait)
 {
     LOGF_DEBUG("%s %s End:%c Wait:%ds", __FUNCTION__, cmd, end, wait);
     response[0] = '\0';
+    // give the mount the configured time since the previous command
+    waitForMountRequestDelay();
+    pollQueryCount++;
     char lresponse[AVALON_RESPONSE_BUFFER_LENGTH];
     int lbytes = 0;
     lresponse [0] = '\0';
@@ -1159,8 +1223,7 @@ bool LX200StarGo::sendQuery(const char* cmd, char* response, char end, int wait)
     if(!transmit(cmd))
     {
         LOGF_ERROR("Command <%s> failed.", cmd);
-        // sleep for 50 mseconds to avoid flooding the mount with commands
-        nanosleep(&mount_request_delay, nullptr);
+        lastRequestTime = std::chrono::steady_clock::now();
         return false;
     }
     lresponse[0] = '\0';
@@ -1181,12 +1244,26 @@ bool LX200StarGo::sendQuery(const char* cmd, char* response, char end, int wait)
     }
     flush();
 
-    // sleep for 50 mseconds to avoid flooding the mount with commands
-    nanosleep(&mount_request_delay, nullptr);
+    lastRequestTime = std::chrono::steady_clock::now();
 
     return true;
 }
 
+/**
+ * @brief Sleep for what is left of the request delay since the last exchange, so that the
+ *        mount is not flooded with commands while consecutive queries are not slowed down
+ *        by time already spent elsewhere.
+ */
+void LX200StarGo::waitForMountRequestDelay()
+{
+    std::chrono::nanoseconds delay = std::chrono::seconds(mount_request_delay.tv_sec) +
+                                     std::chrono::nanoseconds(mount_request_delay.tv_nsec);
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - lastRequestTime;
+
+    if (elapsed < delay)
+        std::this_thread::sleep_for(delay - elapsed);
+}
+
 bool LX200StarGo::ParseMotionState(char* state)
 {
     LOGF_DEBUG("%s %s", __FUNCTION__, state);
@@ -2501,6 +2578,7 @@ bool LX200StarGo::Goto(double ra, double dec)
     }
 
     TrackState = SCOPE_SLEWING;
+    pierSideStale = true;
     //EqNP.s     = IPS_BUSY;
 
     //    LOGF_INFO("Slewing to RA: %s - DEC: %s", RAStr, DecStr);
@@ -2520,6 +2598,7 @@ bool LX200StarGo::MoveNS(INDI_DIR_NS dir, TelescopeMotionCommand command)
         LOG_ERROR("Error N/S motion direction.");
         return false;
     }
+    pierSideStale = true;
 
     return true;
 }
@@ -2537,6 +2616,7 @@ bool LX200StarGo::MoveWE(INDI_DIR_WE dir, TelescopeMotionCommand command)
         LOG_ERROR("Error W/E motion direction.");
         return false;
     }
+    pierSideStale = true;
 
     return true;
 }
@@ -2551,6 +2631,7 @@ bool LX200StarGo::Abort()
         LOG_ERROR("Failed to abort slew.");
         return false;
     }
+    pierSideStale = parkStateStale = true;
 
     if (GuideNSNP.s == IPS_BUSY || GuideWENP.s == IPS_BUSY)
     {
@@ -2603,6 +2684,7 @@ bool LX200StarGo::Sync(double ra, double dec)
     currentDEC = dec;
 
     LOG_INFO("Synchronization successful.");
+    pierSideStale = true;
 
     EqNP.s     = IPS_OK;
 
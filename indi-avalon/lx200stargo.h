@@ -29,6 +29,7 @@
 #include <indilogger.h>
 #include <termios.h>
 
+#include <chrono>
 #include <cstring>
 #include <string>
 #include <unistd.h>
@@ -38,6 +39,7 @@
 #define AVALON_TIMEOUT                                  2
 #define AVALON_COMMAND_BUFFER_LENGTH                    32
 #define AVALON_RESPONSE_BUFFER_LENGTH                   32
+#define AVALON_STATUS_REFRESH_INTERVAL                  30 /* seconds between two polls reading all status values */
 
 enum TDirection
 {
@@ -150,6 +152,10 @@ class LX200StarGo : public LX200Telescope
         INumberVectorProperty MountRequestDelayNP;
         INumber MountRequestDelayN[1];
 
+        // duration and number of queries of the status poll
+        INumberVectorProperty PollStatisticsNP;
+        INumber PollStatisticsN[3];
+
         int controller_format { LX200_LONG_FORMAT };
 
         // override LX200Generic
@@ -179,6 +185,16 @@ class LX200StarGo : public LX200Telescope
             mount_request_delay.tv_sec = secs;
             mount_request_delay.tv_nsec = nanosecs;
         };
+        // wait until the request delay has passed since the last exchange with the mount
+        void waitForMountRequestDelay();
+        std::chrono::steady_clock::time_point lastRequestTime;
+
+        // pier side and park state only change through motion, they are re-read when stale
+        bool pierSideStale {true};
+        bool parkStateStale {true};
+        std::chrono::steady_clock::time_point lastFullStatusPoll;
+        int pollQueryCount {0};
+        void updatePollStatistics(std::chrono::steady_clock::time_point pollStart);
 
         // autoguiding
         virtual bool setGuidingSpeeds(int raSpeed, int decSpeed);
@@ -0,0 +1,280 @@
+/*
+    Avalon StarGo driver
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * Status poll tests against a StarGo emulator. The emulator answers the LX200 / StarGo
+ * queries on the master side of a pseudo terminal, the driver talks to the slave side.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "lx200stargo.h"
+
+class StarGoEmulator
+{
+    public:
+        StarGoEmulator()
+        {
+            master = posix_openpt(O_RDWR | O_NOCTTY);
+            if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+                return;
+
+            slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+            if (slave < 0)
+                return;
+
+            struct termios tty;
+            tcgetattr(slave, &tty);
+            cfmakeraw(&tty);
+            tcsetattr(slave, TCSANOW, &tty);
+
+            // a tracking, unparked mount
+            responses[":X34#"]  = "m10#";
+            responses[":X38#"]  = "p0#";
+            responses[":X590#"] = "RD0500000004500000#";
+            responses[":X39#"]  = "PE#";
+
+            running = true;
+            thread = std::thread(&StarGoEmulator::run, this);
+        }
+
+        ~StarGoEmulator()
+        {
+            running = false;
+            if (thread.joinable())
+                thread.join();
+            if (slave >= 0)
+                close(slave);
+            if (master >= 0)
+                close(master);
+        }
+
+        int fd() const
+        {
+            return slave;
+        }
+
+        void setResponse(const std::string &command, const std::string &response)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            responses[command] = response;
+        }
+
+        /** Commands received since the last call */
+        std::vector<std::string> takeCommands()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            std::vector<std::string> result;
+            result.swap(commands);
+            return result;
+        }
+
+    private:
+        void run()
+        {
+            std::string command;
+            while (running)
+            {
+                struct pollfd pfd = { master, POLLIN, 0 };
+                if (poll(&pfd, 1, 20) <= 0)
+                    continue;
+
+                char c;
+                if (read(master, &c, 1) != 1)
+                    continue;
+
+                command += c;
+                if (c != '#')
+                    continue;
+
+                std::string response;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    commands.push_back(command);
+                    auto it = responses.find(command);
+                    if (it != responses.end())
+                        response = it->second;
+                }
+                if (!response.empty() && write(master, response.data(), response.size()) < 0)
+                    break;
+                command.clear();
+            }
+        }
+
+        int master { -1 };
+        int slave { -1 };
+        std::atomic_bool running { false };
+        std::thread thread;
+        std::mutex lock;
+        std::map<std::string, std::string> responses;
+        std::vector<std::string> commands;
+};
+
+class TestStarGo : public LX200StarGo
+{
+    public:
+        explicit TestStarGo(int fd)
+        {
+            initProperties();
+            PortFD = fd;
+            setConnected(true, IPS_OK);
+        }
+
+        bool poll()
+        {
+            return ReadScopeStatus();
+        }
+
+        void setTrackState(TelescopeStatus state)
+        {
+            TrackState = state;
+        }
+
+        TelescopeStatus trackState() const
+        {
+            return TrackState;
+        }
+
+        bool stopMotionNorth()
+        {
+            return MoveNS(DIRECTION_NORTH, MOTION_STOP);
+        }
+
+        double pollDuration() const
+        {
+            return PollStatisticsN[0].value;
+        }
+
+        int pollQueries() const
+        {
+            return static_cast<int>(PollStatisticsN[2].value);
+        }
+};
+
+static bool contains(const std::vector<std::string> &commands, const std::string &command)
+{
+    for (const auto &c : commands)
+        if (c == command)
+            return true;
+    return false;
+}
+
+TEST(StarGoPollTest, first_poll_reads_everything_then_only_motion_and_position)
+{
+    StarGoEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestStarGo stargo(emulator.fd());
+
+    ASSERT_TRUE(stargo.poll());
+    std::vector<std::string> commands = emulator.takeCommands();
+    EXPECT_TRUE(contains(commands, ":X34#"));
+    EXPECT_TRUE(contains(commands, ":X38#"));
+    EXPECT_TRUE(contains(commands, ":X590#"));
+    EXPECT_TRUE(contains(commands, ":X39#"));
+    EXPECT_EQ(stargo.trackState(), INDI::Telescope::SCOPE_TRACKING);
+
+    ASSERT_TRUE(stargo.poll());
+    commands = emulator.takeCommands();
+    EXPECT_EQ(commands, std::vector<std::string>({":X34#", ":X590#"}));
+    EXPECT_EQ(stargo.pollQueries(), 2);
+}
+
+TEST(StarGoPollTest, pier_side_is_read_during_and_after_a_slew)
+{
+    StarGoEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestStarGo stargo(emulator.fd());
+    ASSERT_TRUE(stargo.poll());
+    emulator.takeCommands();
+
+    emulator.setResponse(":X34#", "m55#");
+    stargo.setTrackState(INDI::Telescope::SCOPE_SLEWING);
+    ASSERT_TRUE(stargo.poll());
+    EXPECT_TRUE(contains(emulator.takeCommands(), ":X39#"));
+
+    // the poll that sees the slew end still reads the final pier side
+    emulator.setResponse(":X34#", "m10#");
+    emulator.setResponse(":X39#", "PW#");
+    ASSERT_TRUE(stargo.poll());
+    EXPECT_TRUE(contains(emulator.takeCommands(), ":X39#"));
+    EXPECT_EQ(stargo.trackState(), INDI::Telescope::SCOPE_TRACKING);
+
+    ASSERT_TRUE(stargo.poll());
+    EXPECT_FALSE(contains(emulator.takeCommands(), ":X39#"));
+
+    // manual motion marks the pier side stale as well
+    ASSERT_TRUE(stargo.stopMotionNorth());
+    emulator.takeCommands();
+    ASSERT_TRUE(stargo.poll());
+    EXPECT_TRUE(contains(emulator.takeCommands(), ":X39#"));
+}
+
+TEST(StarGoPollTest, park_state_is_read_only_while_parking)
+{
+    StarGoEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestStarGo stargo(emulator.fd());
+    ASSERT_TRUE(stargo.poll());
+    emulator.takeCommands();
+
+    emulator.setResponse(":X34#", "m55#");
+    emulator.setResponse(":X38#", "pB#");
+    stargo.setTrackState(INDI::Telescope::SCOPE_PARKING);
+    ASSERT_TRUE(stargo.poll());
+    EXPECT_TRUE(contains(emulator.takeCommands(), ":X38#"));
+    EXPECT_EQ(stargo.trackState(), INDI::Telescope::SCOPE_PARKING);
+
+    emulator.setResponse(":X34#", "m00#");
+    emulator.setResponse(":X38#", "p2#");
+    ASSERT_TRUE(stargo.poll());
+    EXPECT_TRUE(contains(emulator.takeCommands(), ":X38#"));
+    EXPECT_EQ(stargo.trackState(), INDI::Telescope::SCOPE_PARKED);
+
+    ASSERT_TRUE(stargo.poll());
+    EXPECT_FALSE(contains(emulator.takeCommands(), ":X38#"));
+    EXPECT_EQ(stargo.trackState(), INDI::Telescope::SCOPE_PARKED);
+}
+
+TEST(StarGoPollTest, poll_only_waits_between_queries)
+{
+    StarGoEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestStarGo stargo(emulator.fd());
+    ASSERT_TRUE(stargo.poll());
+
+    // polls are spaced further apart than the 50 ms request delay, so only the gap between
+    // the two queries of a poll is paced
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_TRUE(stargo.poll());
+    EXPECT_EQ(stargo.pollQueries(), 2);
+    EXPECT_GE(stargo.pollDuration(), 45);
+    EXPECT_LT(stargo.pollDuration(), 150);
+}
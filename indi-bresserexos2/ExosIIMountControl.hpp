@@ -509,13 +509,15 @@ class ExosIIMountControl :
 
 
         //Called each time a pair of coordinates was received from the serial interface.
-        virtual void OnPointingCoordinatesReceived(float right_ascension, float declination)
+        virtual void OnPointingCoordinatesReceived(float right_ascension, float declination,
+                const std::chrono::time_point<std::chrono::system_clock> &timeStamp)
         {
             //std::cerr << "Received data : RA: " << right_ascension << " DEC:" << declination << std::endl;
 
             SerialDeviceControl::EquatorialCoordinates lastCoordinates = GetPointingCoordinates();
 
             SerialDeviceControl::EquatorialCoordinates coordinatesReceived;
+            coordinatesReceived.TimeStamp = timeStamp;
             coordinatesReceived.RightAscension = right_ascension;
             coordinatesReceived.Declination = declination;
 
@@ -631,11 +633,13 @@ class ExosIIMountControl :
         }
 
         //Called each time a pair of geo coordinates was received from the serial inferface. This happends only by active request (GET_SITE_LOCATION_COMMAND_ID)
-        virtual void OnSiteLocationCoordinatesReceived(float latitude, float longitude)
+        virtual void OnSiteLocationCoordinatesReceived(float latitude, float longitude,
+                const std::chrono::time_point<std::chrono::system_clock> &timeStamp)
         {
             std::cerr << "Received data : LAT: " << latitude << " LON:" << longitude << std::endl;
 
             SerialDeviceControl::EquatorialCoordinates coordinatesReceived;
+            coordinatesReceived.TimeStamp = timeStamp;
             coordinatesReceived.RightAscension = latitude;
             coordinatesReceived.Declination = longitude;
 
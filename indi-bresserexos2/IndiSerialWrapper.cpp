@@ -1,5 +1,7 @@
 #include "IndiSerialWrapper.hpp"
 
+#include <algorithm>
+
 using namespace GoToDriver;
 
 #define UNUSED(x) (void)(x)
@@ -91,6 +93,66 @@ int16_t IndiSerialWrapper::ReadByte()
     return -1;
 }
 
+//Blocks until data is available to read or the timeout in milliseconds elapsed. Returns true if data is available.
+bool IndiSerialWrapper::WaitForData(int timeoutMilliseconds)
+{
+    if(IsOpen())
+    {
+        struct pollfd pfd;
+        pfd.fd = mTtyFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int result = poll(&pfd, 1, timeoutMilliseconds);
+
+        if(result > 0 && (pfd.revents & POLLIN))
+        {
+            return true;
+        }
+
+        //a hang up or error on the port would make poll return immediately, so honour the timeout to avoid spinning.
+        if(result > 0)
+        {
+            usleep(timeoutMilliseconds * 1000);
+        }
+    }
+    else
+    {
+        usleep(timeoutMilliseconds * 1000);
+    }
+
+    return false;
+}
+
+//Reads whatever is available up to length bytes without blocking. Returns the number of bytes read, or -1 on error.
+int IndiSerialWrapper::ReadBytes(uint8_t* buffer, size_t length)
+{
+    if(IsOpen() && buffer != nullptr && length > 0)
+    {
+        size_t available = BytesToRead();
+
+        if(available == 0)
+        {
+            return 0;
+        }
+
+        //only ask for what the driver already has, so the read never blocks.
+        ssize_t result = read(mTtyFd, buffer, std::min(available, length));
+
+        if(result > -1)
+        {
+            return (int)result;
+        }
+
+        if(errno == EAGAIN || errno == EINTR)
+        {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
 //writes the buffer to the serial interface.
 //this function should handle all the quirks of various serial interfaces.
 bool IndiSerialWrapper::Write(uint8_t* buffer, size_t offset, size_t length)
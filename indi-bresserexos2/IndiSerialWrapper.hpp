@@ -31,6 +31,8 @@
 #include <unistd.h>
 #include <termios.h>
 #include <sys/ioctl.h>
+#include <poll.h>
+#include <cerrno>
 #include <mutex>
 
 #include <indicom.h>
@@ -81,6 +83,12 @@ class IndiSerialWrapper : public SerialDeviceControl::ISerialInterface
         //Reads a byte from the serial device. Can safely cast to uint8_t unless -1 is returned, corresponding to "stream end reached".
         virtual int16_t ReadByte();
 
+        //Blocks until data is available to read or the timeout in milliseconds elapsed. Returns true if data is available.
+        virtual bool WaitForData(int timeoutMilliseconds);
+
+        //Reads whatever is available up to length bytes without blocking. Returns the number of bytes read, or -1 on error.
+        virtual int ReadBytes(uint8_t* buffer, size_t length);
+
         //writes the buffer to the serial interface.
         //this function should handle all the quirks of various serial interfaces.
         virtual bool Write(uint8_t* buffer, size_t offset, size_t length);
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <vector>
 #include "config.h"
@@ -34,10 +35,13 @@ class INotifyPointingCoordinatesReceived
 {
     public:
         //Called each time a pair of coordinates was received from the serial interface.
-        virtual void OnPointingCoordinatesReceived(float right_ascension, float declination) = 0;
+        //The time stamp is taken when the data completing the message was read from the serial interface.
+        virtual void OnPointingCoordinatesReceived(float right_ascension, float declination,
+                const std::chrono::time_point<std::chrono::system_clock> &timeStamp) = 0;
 
         //Called each time a pair of geo coordinates was received from the serial inferface.
         //This occurs only by active request (GET_SITE_LOCATION_COMMAND_ID)
-        virtual void OnSiteLocationCoordinatesReceived(float latitude, float longitude) = 0;
+        virtual void OnSiteLocationCoordinatesReceived(float latitude, float longitude,
+                const std::chrono::time_point<std::chrono::system_clock> &timeStamp) = 0;
 };
 }
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include "config.h"
 
@@ -47,6 +48,12 @@ class ISerialInterface
         //Reads a byte from the serial device. Can safely cast to uint8_t unless -1 is returned, corresponding to "stream end reached".
         virtual int16_t ReadByte() = 0;
 
+        //Blocks until data is available to read or the timeout in milliseconds elapsed. Returns true if data is available.
+        virtual bool WaitForData(int timeoutMilliseconds) = 0;
+
+        //Reads whatever is available up to length bytes without blocking. Returns the number of bytes read, or -1 on error.
+        virtual int ReadBytes(uint8_t* buffer, size_t length) = 0;
+
         //writes the buffer to the serial interface.
         //this function should handle all the quirks of various serial interfaces.
         virtual bool Write(uint8_t* buffer, size_t offset, size_t length) = 0;
@@ -23,20 +23,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <vector>
-#include <deque>
-#include <queue>
 #include <thread>
 
-#include <algorithm>
 #include "config.h"
 #include "INotifyPointingCoordinatesReceived.hpp"
 #include "ISerialInterface.hpp"
-#include "CriticalData.hpp"
 #include "SerialCommand.hpp"
-#include "CircularBuffer.hpp"
+#include "SpscRingBuffer.hpp"
 
 namespace SerialDeviceControl
 {
@@ -52,7 +50,7 @@ class SerialCommandTransceiver
             mInterfaceImplementation(interfaceImplementation),
             mDataReceivedCallback(dataReceivedCallback),
             mThreadRunning(false),
-            mSerialReceiverBuffer(0x00),
+            mSerialReceiverBuffer(),
             mSerialReaderThread()
         {
             SerialCommand::PushHeader(mMessageHeader);
@@ -61,16 +59,16 @@ class SerialCommandTransceiver
         //Destroys this transceiver, and stops the thread pulling the serial data from the mount.
         virtual ~SerialCommandTransceiver()
         {
-            bool threadRunning = mThreadRunning.Get();
-
-            if(threadRunning)
-            {
-                Stop();
-            }
+            Stop();
         }
         //Start the serial command dispatching.
         virtual bool Start()
         {
+            if(mThreadRunning.exchange(true))
+            {
+                return true;
+            }
+
             mSerialReaderThread = std::thread(&SerialCommandTransceiver::SerialReaderThreadFunction, this);
 
             return true;
@@ -79,12 +77,8 @@ class SerialCommandTransceiver
         //Stop the serial command dispatching.
         bool Stop()
         {
-            bool running = mThreadRunning.Get();
-
-            if(running)
+            if(mThreadRunning.exchange(false))
             {
-                mThreadRunning.Set(false);
-
                 mSerialReaderThread.join();
             }
 
@@ -99,17 +93,23 @@ class SerialCommandTransceiver
         }
 
     private:
+        //maximum time the reader waits for data before checking whether it should stop.
+        static constexpr const int READER_WAIT_TIMEOUT_MS {100};
+
+        //size of the receiver ring, must be a power of two.
+        static constexpr const size_t RECEIVER_BUFFER_SIZE {256};
+
         //Reference to the serial implementation.
         InterfaceType &mInterfaceImplementation;
 
         //Reference to the data received interface.
         CallbackType &mDataReceivedCallback;
 
-        //mutex locked running state variable, if set to false the serial receiver thread is terminated.
-        CriticalData<bool> mThreadRunning;
+        //running state variable, if set to false the serial receiver thread is terminated.
+        std::atomic<bool> mThreadRunning;
 
-        //A cicular buffer implementation to receive serial message from the mount.
-        CircularBuffer<uint8_t, 256> mSerialReceiverBuffer;
+        //lock free ring the reader thread reads serial data into and parses messages from.
+        SpscRingBuffer<uint8_t, RECEIVER_BUFFER_SIZE> mSerialReceiverBuffer;
 
         //Contains a message header for convinience.
         std::vector<uint8_t> mMessageHeader;
@@ -117,107 +117,122 @@ class SerialCommandTransceiver
         //movable thread object to control.
         std::thread mSerialReaderThread;
 
-        //buffer used when serial messages are parsed.
-        std::vector<uint8_t> mParseBuffer;
+        //Returns true if the message header starts at the logical index of the receiver buffer.
+        bool IsHeaderAt(size_t index)
+        {
+            for(size_t i = 0; i < mMessageHeader.size(); i++)
+            {
+                if(mSerialReceiverBuffer.Peek(index + i) != mMessageHeader[i])
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
 
         //When messages are received, try parsing them.
         //It may happen that messages are received in fragments, this function tries to piece together these fragments to valid messages.
-        //skip any previous junk if message was found, drop anything until the end of the parsed message, to clean up the buffer.
-        void TryParseMessagesFromBuffer()
+        //Every complete message in the buffer is dispatched, junk in front of a header is dropped, an incomplete message is left for the next read.
+        void TryParseMessagesFromBuffer(const std::chrono::time_point<std::chrono::system_clock> &timeStamp)
         {
-            mParseBuffer.clear();
+            const size_t headerSize = mMessageHeader.size();
 
-            if(mSerialReceiverBuffer.Size() > 0)
+            while(mSerialReceiverBuffer.Size() >= headerSize)
             {
-                mSerialReceiverBuffer.CopyToVector(mParseBuffer);
+                size_t available = mSerialReceiverBuffer.Size();
+                size_t startPosition = 0;
 
-                std::vector<uint8_t>::iterator startPosition = std::search(mParseBuffer.begin(), mParseBuffer.end(), mMessageHeader.begin(),
-                        mMessageHeader.end());
-
-                std::vector<uint8_t>::iterator endPosition = startPosition + MESSAGE_FRAME_SIZE;
+                while(startPosition + headerSize <= available && !IsHeaderAt(startPosition))
+                {
+                    startPosition++;
+                }
 
-                if(startPosition != mParseBuffer.end() && endPosition != mParseBuffer.end())
+                if(startPosition + headerSize > available)
                 {
-                    //std::cout << "found sequence!" << std::endl;
+                    //no header, keep the tail since it may be the beginning of the next one.
+                    mSerialReceiverBuffer.Discard(available - (headerSize - 1));
+                    return;
+                }
 
-                    FloatByteConverter ra_bytes;
-                    FloatByteConverter dec_bytes;
+                mSerialReceiverBuffer.Discard(startPosition);
 
-                    ra_bytes.bytes[0] = *(startPosition + 5);
-                    ra_bytes.bytes[1] = *(startPosition + 6);
-                    ra_bytes.bytes[2] = *(startPosition + 7);
-                    ra_bytes.bytes[3] = *(startPosition + 8);
+                uint8_t message[MESSAGE_FRAME_SIZE];
 
-                    dec_bytes.bytes[0] = *(startPosition + 9);
-                    dec_bytes.bytes[1] = *(startPosition + 10);
-                    dec_bytes.bytes[2] = *(startPosition + 11);
-                    dec_bytes.bytes[3] = *(startPosition + 12);
+                if(mSerialReceiverBuffer.Peek(0, message, MESSAGE_FRAME_SIZE) < MESSAGE_FRAME_SIZE)
+                {
+                    return;
+                }
 
-                    uint8_t cid = *(startPosition + 4);
-                    float ra = ra_bytes.decimal_number;
-                    float dec = dec_bytes.decimal_number;
+                mSerialReceiverBuffer.Discard(MESSAGE_FRAME_SIZE);
 
-                    //handle specific response.
-                    switch(cid)
-                    {
-                        case SerialCommandID::TELESCOPE_SITE_LOCATION_REPORT_COMMAND_ID:
-                            //std::cout << "new location received!" << std::endl;
-                            mDataReceivedCallback.OnSiteLocationCoordinatesReceived(ra, dec);
-                            break;
+                FloatByteConverter ra_bytes;
+                FloatByteConverter dec_bytes;
 
-                        case SerialCommandID::TELESCOPE_POSITION_REPORT_COMMAND_ID:
-                            mDataReceivedCallback.OnPointingCoordinatesReceived(ra, dec);
-                            break;
+                ra_bytes.bytes[0] = message[5];
+                ra_bytes.bytes[1] = message[6];
+                ra_bytes.bytes[2] = message[7];
+                ra_bytes.bytes[3] = message[8];
 
-                        default:
-                            break;
-                    }
+                dec_bytes.bytes[0] = message[9];
+                dec_bytes.bytes[1] = message[10];
+                dec_bytes.bytes[2] = message[11];
+                dec_bytes.bytes[3] = message[12];
+
+                uint8_t cid = message[4];
+                float ra = ra_bytes.decimal_number;
+                float dec = dec_bytes.decimal_number;
 
-                    size_t dropCount = endPosition - mParseBuffer.begin();
+                //handle specific response.
+                switch(cid)
+                {
+                    case SerialCommandID::TELESCOPE_SITE_LOCATION_REPORT_COMMAND_ID:
+                        mDataReceivedCallback.OnSiteLocationCoordinatesReceived(ra, dec, timeStamp);
+                        break;
 
-                    mSerialReceiverBuffer.DiscardFront(dropCount);
+                    case SerialCommandID::TELESCOPE_POSITION_REPORT_COMMAND_ID:
+                        mDataReceivedCallback.OnPointingCoordinatesReceived(ra, dec, timeStamp);
+                        break;
 
-                    //std::cout << "Receive size after :" << mSerialReceiverBuffer.Size() << " dropped " << dropCount << std::endl;
+                    default:
+                        break;
                 }
             }
         }
-        //Endless loop function of the thread used to receive the serial messages of the mount.
+        //Loop function of the thread used to receive the serial messages of the mount.
+        //Sleeps in the serial interface until data arrives, reads everything available at once and parses it right away.
         void SerialReaderThreadFunction()
         {
             std::cerr << "Serial Reader Thread started!" << std::endl;
-            bool running = mThreadRunning.Get();
 
             mInterfaceImplementation.Open();
 
-            if(running == false)
-            {
-                mThreadRunning.Set(true);
+            uint8_t readBuffer[RECEIVER_BUFFER_SIZE];
 
-                do
+            while(mThreadRunning.load())
+            {
+                if(!mInterfaceImplementation.WaitForData(READER_WAIT_TIMEOUT_MS))
                 {
-                    //controller sends status messages about every second so wait a bit
-                    std::this_thread::sleep_until(std::chrono::system_clock::now() + std::chrono::milliseconds(500));
+                    continue;
+                }
 
-                    size_t bufferContent = mInterfaceImplementation.BytesToRead();
-                    int16_t data = -1;
+                //every message completed by this read is stamped with the time the data arrived.
+                std::chrono::time_point<std::chrono::system_clock> timeStamp = std::chrono::system_clock::now();
 
-                    bool addSucceed = false;
+                int bytesRead = 0;
 
-                    if(bufferContent > 0)
+                do
+                {
+                    bytesRead = mInterfaceImplementation.ReadBytes(readBuffer, mSerialReceiverBuffer.Free());
+
+                    if(bytesRead > 0)
                     {
-                        while((data = mInterfaceImplementation.ReadByte()) > -1)
-                        {
-                            addSucceed = mSerialReceiverBuffer.PushBack((uint8_t)data);
-                        }
-
-                        if(addSucceed)
-                        {
-                            TryParseMessagesFromBuffer();
-                        }
+                        mSerialReceiverBuffer.Write(readBuffer, bytesRead);
+
+                        TryParseMessagesFromBuffer(timeStamp);
                     }
-                    running = mThreadRunning.Get();
                 }
-                while(running == true);
+                while(bytesRead > 0 && mThreadRunning.load());
             }
             std::cerr << "Serial Reader Thread stopped!" << std::endl;
             mInterfaceImplementation.Flush();
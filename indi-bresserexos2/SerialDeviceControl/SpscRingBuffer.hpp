@@ -0,0 +1,125 @@
+/*
+ * SpscRingBuffer.hpp
+ *
+ * Copyright 2020 Kevin Krüger <kkevin@gmx.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "config.h"
+
+namespace SerialDeviceControl
+{
+//Lock free ring buffer for exactly one producer thread and one consumer thread.
+//The producer only moves the tail, the consumer only moves the head, so neither side needs a mutex.
+//The capacity has to be a power of two, indices are free running and wrapped with a mask.
+template<typename T, size_t capacity>
+class SpscRingBuffer
+{
+        static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity has to be a power of two");
+
+    public:
+        SpscRingBuffer() :
+            mHead(0),
+            mTail(0)
+        {
+
+        }
+
+        //Producer side: append up to count elements, returns the number of elements actually stored.
+        size_t Write(const T* data, size_t count)
+        {
+            size_t tail = mTail.load(std::memory_order_relaxed);
+            size_t head = mHead.load(std::memory_order_acquire);
+
+            count = std::min(count, capacity - (tail - head));
+
+            for(size_t i = 0; i < count; i++)
+            {
+                mBuffer[(tail + i) & (capacity - 1)] = data[i];
+            }
+
+            mTail.store(tail + count, std::memory_order_release);
+
+            return count;
+        }
+
+        //Consumer side: number of elements ready to be read.
+        size_t Size() const
+        {
+            return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_relaxed);
+        }
+
+        //Producer side: number of elements that can still be written.
+        size_t Free() const
+        {
+            return capacity - (mTail.load(std::memory_order_relaxed) - mHead.load(std::memory_order_acquire));
+        }
+
+        //Consumer side: return the element at the logical index, counted from the oldest element. Index has to be below Size().
+        T Peek(size_t index) const
+        {
+            return mBuffer[(mHead.load(std::memory_order_relaxed) + index) & (capacity - 1)];
+        }
+
+        //Consumer side: copy up to count elements starting at the logical index without removing them, returns the number copied.
+        size_t Peek(size_t index, T* data, size_t count) const
+        {
+            size_t head = mHead.load(std::memory_order_relaxed);
+            size_t available = mTail.load(std::memory_order_acquire) - head;
+
+            if(index >= available)
+            {
+                return 0;
+            }
+
+            count = std::min(count, available - index);
+
+            for(size_t i = 0; i < count; i++)
+            {
+                data[i] = mBuffer[(head + index + i) & (capacity - 1)];
+            }
+
+            return count;
+        }
+
+        //Consumer side: drop up to count of the oldest elements.
+        void Discard(size_t count)
+        {
+            size_t head = mHead.load(std::memory_order_relaxed);
+            size_t available = mTail.load(std::memory_order_acquire) - head;
+
+            mHead.store(head + std::min(count, available), std::memory_order_release);
+        }
+
+    private:
+        //index of the oldest element, only written by the consumer.
+        alignas(64) std::atomic<size_t> mHead;
+
+        //index after the newest element, only written by the producer.
+        alignas(64) std::atomic<size_t> mTail;
+
+        T mBuffer[capacity];
+};
+}
@@ -0,0 +1,254 @@
+/*
+ * test_serial_transceiver.cpp
+ *
+ * Copyright 2020 Kevin Krüger <kkevin@gmx.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+//Streams synthetic mount telegrams through a pseudo terminal into the serial transceiver.
+//The test writes on the master side, the transceiver reads the slave side through the indi serial wrapper.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "IndiSerialWrapper.hpp"
+#include "SerialDeviceControl/SerialCommand.hpp"
+#include "SerialDeviceControl/SerialCommandTransceiver.hpp"
+#include "SerialDeviceControl/INotifyPointingCoordinatesReceived.hpp"
+
+using namespace SerialDeviceControl;
+
+//Records every message the transceiver dispatches.
+class MessageRecorder : public INotifyPointingCoordinatesReceived
+{
+    public:
+        struct Message
+        {
+            bool pointing;
+            float first;
+            float second;
+            std::chrono::time_point<std::chrono::system_clock> timeStamp;
+            std::chrono::time_point<std::chrono::system_clock> dispatched;
+        };
+
+        virtual void OnPointingCoordinatesReceived(float right_ascension, float declination,
+                const std::chrono::time_point<std::chrono::system_clock> &timeStamp)
+        {
+            Add(true, right_ascension, declination, timeStamp);
+        }
+
+        virtual void OnSiteLocationCoordinatesReceived(float latitude, float longitude,
+                const std::chrono::time_point<std::chrono::system_clock> &timeStamp)
+        {
+            Add(false, latitude, longitude, timeStamp);
+        }
+
+        //wait until count messages were received, returns false on timeout.
+        bool WaitFor(size_t count, std::chrono::milliseconds timeout)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            return mCondition.wait_for(lock, timeout, [this, count]()
+            {
+                return mMessages.size() >= count;
+            });
+        }
+
+        std::vector<Message> Messages()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mMessages;
+        }
+
+    private:
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::vector<Message> mMessages;
+
+        void Add(bool pointing, float first, float second, const std::chrono::time_point<std::chrono::system_clock> &timeStamp)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mMessages.push_back({pointing, first, second, timeStamp, std::chrono::system_clock::now()});
+            }
+            mCondition.notify_all();
+        }
+};
+
+class SerialTransceiverTest : public ::testing::Test
+{
+    protected:
+        int mMaster {-1};
+        int mSlave {-1};
+        GoToDriver::IndiSerialWrapper mSerial;
+        MessageRecorder mRecorder;
+        SerialCommandTransceiver<GoToDriver::IndiSerialWrapper, MessageRecorder> mTransceiver {mSerial, mRecorder};
+
+        void SetUp() override
+        {
+            mMaster = posix_openpt(O_RDWR | O_NOCTTY);
+            ASSERT_GE(mMaster, 0);
+            ASSERT_EQ(grantpt(mMaster), 0);
+            ASSERT_EQ(unlockpt(mMaster), 0);
+
+            mSlave = open(ptsname(mMaster), O_RDWR | O_NOCTTY);
+            ASSERT_GE(mSlave, 0);
+
+            struct termios tty;
+            ASSERT_EQ(tcgetattr(mSlave, &tty), 0);
+            cfmakeraw(&tty);
+            ASSERT_EQ(tcsetattr(mSlave, TCSANOW, &tty), 0);
+
+            mSerial.SetFD(mSlave);
+            mTransceiver.Start();
+        }
+
+        void TearDown() override
+        {
+            mTransceiver.Stop();
+
+            if(mSlave > -1)
+            {
+                close(mSlave);
+            }
+
+            if(mMaster > -1)
+            {
+                close(mMaster);
+            }
+        }
+
+        static std::vector<uint8_t> Telegram(uint8_t cid, float first, float second)
+        {
+            std::vector<uint8_t> telegram;
+            SerialCommand::PushHeader(telegram);
+            telegram.push_back(cid);
+
+            FloatByteConverter value;
+            value.decimal_number = first;
+            telegram.insert(telegram.end(), value.bytes, value.bytes + 4);
+            value.decimal_number = second;
+            telegram.insert(telegram.end(), value.bytes, value.bytes + 4);
+
+            return telegram;
+        }
+
+        void Send(const std::vector<uint8_t> &data)
+        {
+            ASSERT_EQ(write(mMaster, data.data(), data.size()), (ssize_t)data.size());
+        }
+};
+
+TEST_F(SerialTransceiverTest, status_messages_are_dispatched_as_they_arrive)
+{
+    const size_t count = 20;
+    std::vector<std::chrono::time_point<std::chrono::system_clock>> sent;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        sent.push_back(std::chrono::system_clock::now());
+        Send(Telegram(SerialCommandID::TELESCOPE_POSITION_REPORT_COMMAND_ID, 1.0f + i, -10.0f - i));
+        ASSERT_TRUE(mRecorder.WaitFor(i + 1, std::chrono::milliseconds(1000)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::vector<MessageRecorder::Message> messages = mRecorder.Messages();
+    ASSERT_EQ(messages.size(), count);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        EXPECT_TRUE(messages[i].pointing);
+        EXPECT_FLOAT_EQ(messages[i].first, 1.0f + i);
+        EXPECT_FLOAT_EQ(messages[i].second, -10.0f - i);
+
+        //stamped after it was sent and dispatched right away, far below the one second report interval of the mount.
+        EXPECT_GE(messages[i].timeStamp, sent[i]);
+        EXPECT_LE(messages[i].timeStamp, messages[i].dispatched);
+        EXPECT_LT(messages[i].dispatched - sent[i], std::chrono::milliseconds(100));
+    }
+}
+
+TEST_F(SerialTransceiverTest, fragmented_telegram_with_leading_junk)
+{
+    std::vector<uint8_t> data = {0x00, 0x55, 0x13, 0xaa};
+    std::vector<uint8_t> telegram = Telegram(SerialCommandID::TELESCOPE_SITE_LOCATION_REPORT_COMMAND_ID, 52.5f, 13.4f);
+    data.insert(data.end(), telegram.begin(), telegram.end());
+
+    //split inside the header and inside the payload.
+    Send(std::vector<uint8_t>(data.begin(), data.begin() + 6));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    Send(std::vector<uint8_t>(data.begin() + 6, data.begin() + 12));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_TRUE(mRecorder.Messages().empty());
+
+    std::chrono::time_point<std::chrono::system_clock> completed = std::chrono::system_clock::now();
+    Send(std::vector<uint8_t>(data.begin() + 12, data.end()));
+
+    ASSERT_TRUE(mRecorder.WaitFor(1, std::chrono::milliseconds(1000)));
+    std::vector<MessageRecorder::Message> messages = mRecorder.Messages();
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_FALSE(messages[0].pointing);
+    EXPECT_FLOAT_EQ(messages[0].first, 52.5f);
+    EXPECT_FLOAT_EQ(messages[0].second, 13.4f);
+
+    //the time stamp belongs to the read completing the telegram.
+    EXPECT_GE(messages[0].timeStamp, completed);
+}
+
+TEST_F(SerialTransceiverTest, burst_larger_than_receiver_buffer)
+{
+    const size_t count = 64;
+    std::vector<uint8_t> data;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        std::vector<uint8_t> telegram = Telegram(SerialCommandID::TELESCOPE_POSITION_REPORT_COMMAND_ID, (float)i, (float)(2 * i));
+        data.insert(data.end(), telegram.begin(), telegram.end());
+    }
+
+    Send(data);
+
+    ASSERT_TRUE(mRecorder.WaitFor(count, std::chrono::milliseconds(2000)));
+    std::vector<MessageRecorder::Message> messages = mRecorder.Messages();
+    ASSERT_EQ(messages.size(), count);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        EXPECT_FLOAT_EQ(messages[i].first, (float)i);
+        EXPECT_FLOAT_EQ(messages[i].second, (float)(2 * i));
+    }
+}
+
+TEST_F(SerialTransceiverTest, stop_while_idle_returns_promptly)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    mTransceiver.Stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
@@ -22,6 +22,7 @@
 */
 
 #include <algorithm>
+#include <chrono>
 #include <math.h>
 #include <queue>
 #include <string.h>
@@ -58,6 +59,7 @@ double anglediff(double a, double b)
 
 bool CelestronAUX::ISSnoopDevice(XMLEle *root)
 {
+    std::lock_guard<std::recursive_timed_mutex> lock(m_PortLock);
     const char *propName = findXMLAttValu(root, "name");
 
     // update cordwrap position at each init of the alignment subsystem
@@ -105,6 +107,7 @@ CelestronAUX::CelestronAUX()
 /////////////////////////////////////////////////////////////////////////////////////
 CelestronAUX::~CelestronAUX()
 {
+    m_Sampler.stop();
 }
 
 
@@ -314,6 +317,7 @@ bool CelestronAUX::Handshake()
 /////////////////////////////////////////////////////////////////////////////////////
 bool CelestronAUX::Disconnect()
 {
+    m_Sampler.stop();
     Abort();
     return INDI::Telescope::Disconnect();
 }
@@ -574,6 +578,15 @@ bool CelestronAUX::initProperties()
     IUFillNumberVector(&GuideRateNP, GuideRateN, 2, getDeviceName(), "GUIDE_RATE", "Guiding Rate", GUIDE_TAB, IP_RW, 0,
                        IPS_IDLE);
 
+    // Encoder sampling
+    IUFillNumber(&EncoderSamplingN[0], "SAMPLING_RATE", "Rate (Hz)", "%.f", 0, 10, 1, 0);
+    IUFillNumberVector(&EncoderSamplingNP, EncoderSamplingN, 1, getDeviceName(), "ENCODER_SAMPLING", "Encoder Sampling",
+                       OPTIONS_TAB, IP_RW, 60, IPS_IDLE);
+    IUFillNumber(&EncoderRatesN[ENCODER_RATE_ALT], "ENCODER_RATE_ALT", "Dec/ALT (\"/s)", "%.2f", -1e6, 1e6, 0, 0);
+    IUFillNumber(&EncoderRatesN[ENCODER_RATE_AZ], "ENCODER_RATE_AZ", "Ra/AZM (\"/s)", "%.2f", -1e6, 1e6, 0, 0);
+    IUFillNumberVector(&EncoderRatesNP, EncoderRatesN, 2, getDeviceName(), "ENCODER_RATES", "Encoder Rates",
+                       MOUNTINFO_TAB, IP_RO, 60, IPS_IDLE);
+
     // to update cordwrap pos at each init of alignment subsystem
     IDSnoopDevice(getDeviceName(), "ALIGNMENT_SUBSYSTEM_MATH_PLUGIN_INITIALISE");
 
@@ -612,6 +625,10 @@ bool CelestronAUX::updateProperties()
         defineProperty(&GuideRateNP);
         loadConfig(true, GuideRateNP.name);
 
+        defineProperty(&EncoderSamplingNP);
+        defineProperty(&EncoderRatesNP);
+        loadConfig(true, EncoderSamplingNP.name);
+
         defineProperty(&MountTypeSP);
 
         getCordwrap();
@@ -656,11 +673,15 @@ bool CelestronAUX::updateProperties()
     }
     else
     {
+        m_Sampler.stop();
+
         deleteProperty(MountTypeSP.name);
         deleteProperty(CordWrapSP.name);
         deleteProperty(GuideNSNP.name);
         deleteProperty(GuideWENP.name);
         deleteProperty(GuideRateNP.name);
+        deleteProperty(EncoderSamplingNP.name);
+        deleteProperty(EncoderRatesNP.name);
         deleteProperty(CWPosSP.name);
         deleteProperty(CWBaseSP.name);
         deleteProperty(GPSEmuSP.name);
@@ -682,6 +703,7 @@ bool CelestronAUX::saveConfigItems(FILE *fp)
     IUSaveConfigSwitch(fp, &CWPosSP);
     IUSaveConfigSwitch(fp, &GPSEmuSP);
     IUSaveConfigSwitch(fp, &CWBaseSP);
+    IUSaveConfigNumber(fp, &EncoderSamplingNP);
     return true;
 }
 
@@ -703,6 +725,8 @@ void CelestronAUX::ISGetProperties(const char *dev)
 bool CelestronAUX::ISNewBLOB(const char *dev, const char *name, int sizes[], int blobsizes[], char *blobs[],
                              char *formats[], char *names[], int n)
 {
+    std::lock_guard<std::recursive_timed_mutex> lock(m_PortLock);
+
     if (strcmp(dev, getDeviceName()) == 0)
     {
         // Process alignment properties
@@ -717,6 +741,8 @@ bool CelestronAUX::ISNewBLOB(const char *dev, const char *name, int sizes[], int
 /////////////////////////////////////////////////////////////////////////////////////
 bool CelestronAUX::ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n)
 {
+    std::lock_guard<std::recursive_timed_mutex> lock(m_PortLock);
+
     //  first check if it's for our device
 
     if (strcmp(dev, getDeviceName()) == 0)
@@ -730,6 +756,20 @@ bool CelestronAUX::ISNewNumber(const char *dev, const char *name, double values[
             return true;
         }
 
+        // Encoder sampling
+        if (strcmp(name, EncoderSamplingNP.name) == 0)
+        {
+            IUUpdateNumber(&EncoderSamplingNP, values, names, n);
+            EncoderSamplingNP.s = IPS_OK;
+            IDSetNumber(&EncoderSamplingNP, nullptr);
+
+            m_Sampler.stop();
+            if (EncoderSamplingN[0].value > 0 && isConnected() && !isSimulation())
+                startSampler();
+
+            return true;
+        }
+
         processGuiderProperties(name, values, names, n);
 
         // Process alignment properties
@@ -746,6 +786,8 @@ bool CelestronAUX::ISNewNumber(const char *dev, const char *name, double values[
 /////////////////////////////////////////////////////////////////////////////////////
 bool CelestronAUX::ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int n)
 {
+    std::lock_guard<std::recursive_timed_mutex> lock(m_PortLock);
+
     if (strcmp(dev, getDeviceName()) == 0)
     {
         // mount type
@@ -915,6 +957,8 @@ bool CelestronAUX::ISNewSwitch(const char *dev, const char *name, ISState *state
 /////////////////////////////////////////////////////////////////////////////////////
 bool CelestronAUX::ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n)
 {
+    std::lock_guard<std::recursive_timed_mutex> lock(m_PortLock);
+
     if (strcmp(dev, getDeviceName()) == 0)
     {
         // Process alignment properties
@@ -1235,6 +1279,8 @@ bool CelestronAUX::Sync(double ra, double dec)
 /////////////////////////////////////////////////////////////////////////////////////
 void CelestronAUX::TimerHit()
 {
+    std::lock_guard<std::recursive_timed_mutex> lock(m_PortLock);
+
     TraceThisTickCount++;
     if (60 == TraceThisTickCount)
     {
@@ -1266,6 +1312,14 @@ void CelestronAUX::TimerHit()
     // This will call ReadScopeStatus
     INDI::Telescope::TimerHit();
 
+    if (m_Sampler.running())
+    {
+        EncoderRatesN[ENCODER_RATE_ALT].value = m_Sampler.rate(ALT) * 3600 / STEPS_PER_DEGREE;
+        EncoderRatesN[ENCODER_RATE_AZ].value  = m_Sampler.rate(AZM) * 3600 / STEPS_PER_DEGREE;
+        EncoderRatesNP.s = m_Sampler.valid() ? IPS_OK : IPS_BUSY;
+        IDSetNumber(&EncoderRatesNP, nullptr);
+    }
+
     // OK I have updated the celestial reference frame RA/DEC in ReadScopeStatus
     // Now handle the tracking state
     switch (TrackState)
@@ -1450,7 +1504,10 @@ int32_t CelestronAUX::GetALT()
     // return alt encoder adjusted to -90...90
     while (m_AltSteps > STEPS_PER_REVOLUTION)
         m_AltSteps -= STEPS_PER_REVOLUTION;
-    return m_AltSteps;
+
+    int32_t steps = m_AltSteps;
+    m_Sampler.position(ALT, EncoderSampler::clock(), steps);
+    return steps;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -1463,7 +1520,9 @@ int32_t CelestronAUX::GetAZ()
     while (m_AzSteps > STEPS_PER_REVOLUTION)
         m_AzSteps -= STEPS_PER_REVOLUTION;
 
-    return m_AzSteps;
+    int32_t steps = m_AzSteps;
+    m_Sampler.position(AZM, EncoderSampler::clock(), steps);
+    return steps;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -1759,12 +1818,16 @@ void CelestronAUX::querryStatus()
 {
     if ( isConnected() )
     {
-        AUXTargets trg[2] = { ALT, AZM };
-        for (int i = 0; i < 2; i++)
+        // The sampler keeps the positions up to date
+        if (!m_Sampler.running())
         {
-            AUXCommand cmd(MC_GET_POSITION, APP, trg[i]);
-            sendAUXCommand(cmd);
-            readAUXResponse(cmd);
+            AUXTargets trg[2] = { ALT, AZM };
+            for (int i = 0; i < 2; i++)
+            {
+                AUXCommand cmd(MC_GET_POSITION, APP, trg[i]);
+                sendAUXCommand(cmd);
+                readAUXResponse(cmd);
+            }
         }
         if (m_SlewingAlt && ScopeStatus != SLEWING_MANUAL)
         {
@@ -1781,6 +1844,46 @@ void CelestronAUX::querryStatus()
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////
+/// Encoder sampler.
+/// Reads both axis encoders at ENCODER_SAMPLING rate, independent of the polling
+/// period, through readEncoder on the sampler thread.
+/// GetALT/GetAZ then serve the position estimated at the time they are called.
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::startSampler()
+{
+    m_Sampler.start(EncoderSamplingN[0].value, [this](AUXTargets trg, double &t, int32_t &steps)
+    {
+        return readEncoder(trg, t, steps);
+    });
+    LOGF_INFO("Sampling encoders at %.f Hz.", EncoderSamplingN[0].value);
+}
+
+bool CelestronAUX::readEncoder(AUXTargets trg, double &t, int32_t &steps)
+{
+    std::unique_lock<std::recursive_timed_mutex> lock(m_PortLock, std::defer_lock);
+    while (!lock.try_lock_for(std::chrono::milliseconds(10)))
+    {
+        if (!m_Sampler.running())
+            return false;
+    }
+
+    if (!m_Sampler.running() || PortFD <= 0)
+        return false;
+
+    uint32_t &readings = (trg == ALT) ? m_AltReadings : m_AzReadings;
+    uint32_t previous  = readings;
+
+    // The controller latches the position when the command arrives, stamp the sample then
+    AUXCommand cmd(MC_GET_POSITION, APP, trg);
+    t = EncoderSampler::clock();
+    if (!sendAUXCommand(cmd) || !readAUXResponse(cmd) || readings == previous)
+        return false;
+
+    steps = (trg == ALT) ? m_AltSteps : m_AzSteps;
+    return true;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////
 /// This is simple GPS emulation for HC.
 /// If HC asks for the GPS we reply with data from our GPS/Site info.
@@ -1909,11 +2012,13 @@ bool CelestronAUX::processResponse(AUXCommand &m)
                     case ALT:
                         // The Alt encoder value is signed!
                         m_AltSteps = m.getPosition();
+                        m_AltReadings++;
                         DEBUGF(DBG_CAUX, "Got Alt: %ld", m_AltSteps);
                         break;
                     case AZM:
                         // Celestron uses N as zero Azimuth!
                         m_AzSteps = range360int(m.getPosition());
+                        m_AzReadings++;
                         DEBUGF(DBG_CAUX, "Got Az: %ld", m_AzSteps);
                         break;
                     default:
@@ -30,7 +30,10 @@
 #include <connectionplugins/connectiontcp.h>
 #include <alignment/AlignmentSubsystemForDrivers.h>
 
+#include <mutex>
+
 #include "auxproto.h"
+#include "encodersampler.h"
 
 class CelestronAUX :
     public INDI::Telescope,
@@ -111,6 +114,10 @@ class CelestronAUX :
         bool TimerTick(double dt);
         bool GuidePulse(INDI_EQ_AXIS axis, uint32_t ms, int8_t rate);
 
+        // Encoder sampler
+        void startSampler();
+        bool readEncoder(AUXTargets trg, double &t, int32_t &steps);
+
 
     private:
 
@@ -206,6 +213,9 @@ class CelestronAUX :
         // AUX protocol uses signed 24bit integers for positions
         int32_t m_AltSteps {0};
         int32_t m_AzSteps {0};
+        // Number of position responses processed, tells the sampler a reading is fresh
+        uint32_t m_AltReadings {0};
+        uint32_t m_AzReadings {0};
         // FIXME: Current rate in steps per sec?
         int32_t m_AltRate {0};
         int32_t m_AzRate {0};
@@ -234,6 +244,13 @@ class CelestronAUX :
         bool m_CordWrapActive {false};
         int32_t m_CordWrapPosition {0};
 
+        // Serializes command/response exchanges between the INDI thread and the sampler.
+        // Every INDI entry point that talks to the mount holds it, so does each sample.
+        std::recursive_timed_mutex m_PortLock;
+
+        // Encoder sampler
+        EncoderSampler m_Sampler {STEPS_PER_REVOLUTION, SAMPLER_WINDOW, SAMPLER_TOLERANCE, SAMPLER_MAX_AGE};
+
         // FP
         int modem_ctrl;
         void setRTS(bool rts);
@@ -285,6 +302,13 @@ class CelestronAUX :
         // guide
         INumber GuideRateN[2]{};
         INumberVectorProperty GuideRateNP;
+        // Encoder sampling rate, 0 polls the encoders once per timer tick
+        INumber EncoderSamplingN[1] {};
+        INumberVectorProperty EncoderSamplingNP;
+        // Axis rates fitted from the encoder samples
+        INumber EncoderRatesN[2] {};
+        INumberVectorProperty EncoderRatesNP;
+        enum { ENCODER_RATE_ALT, ENCODER_RATE_AZ };
 
         ///////////////////////////////////////////////////////////////////////////////
         /// Static Const Private Variables
@@ -319,5 +343,11 @@ class CelestronAUX :
         static constexpr uint8_t CTS_TIMEOUT {100};
         // ms
         static constexpr uint8_t RTS_DELAY {50};
+        // Encoder samples kept for the rate fit
+        static constexpr size_t SAMPLER_WINDOW {8};
+        // A sample further than one arcmin off the fit restarts it
+        static constexpr double SAMPLER_TOLERANCE {STEPS_PER_DEGREE / 60};
+        // seconds, older estimates fall back to the last encoder reading
+        static constexpr double SAMPLER_MAX_AGE {1.0};
 
 };
@@ -0,0 +1,114 @@
+/*
+    Celestron Aux Encoder Estimator
+
+    Copyright (C) 2020 Paweł T. Jochym
+    Copyright (C) 2020 Fabrizio Pollastri
+    Copyright (C) 2021 Jasem Mutlaq
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <math.h>
+
+#include "encoderestimator.h"
+
+EncoderEstimator::EncoderEstimator(int32_t revolution, size_t window, double tolerance)
+    : m_Revolution(revolution), m_Window(window < 2 ? 2 : window), m_Tolerance(tolerance)
+{
+}
+
+void EncoderEstimator::reset()
+{
+    m_Samples.clear();
+    m_Time = m_Position = m_Rate = 0;
+}
+
+void EncoderEstimator::addSample(double t, int32_t steps)
+{
+    if (m_Samples.empty())
+    {
+        m_LastRaw = steps;
+        m_Samples.push_back({t, static_cast<double>(steps)});
+        m_Time     = t;
+        m_Position = steps;
+        m_Rate     = 0;
+        return;
+    }
+
+    // Samples out of order can only come from a confused caller
+    if (t <= m_Samples.back().t)
+        return;
+
+    // Unwrap: the axis never moves more than half a revolution between samples
+    int32_t delta = steps - m_LastRaw;
+    while (delta > m_Revolution / 2)
+        delta -= m_Revolution;
+    while (delta < -(m_Revolution / 2))
+        delta += m_Revolution;
+    m_LastRaw = steps;
+
+    Sample s {t, m_Samples.back().steps + delta};
+
+    // The axis changed its motion, the older samples describe a different line
+    if (m_Samples.size() >= 2 && fabs(position(t) - s.steps) > m_Tolerance)
+        m_Samples.erase(m_Samples.begin(), m_Samples.end() - 1);
+
+    m_Samples.push_back(s);
+    while (m_Samples.size() > m_Window)
+        m_Samples.pop_front();
+
+    fit();
+}
+
+bool EncoderEstimator::valid() const
+{
+    return m_Samples.size() >= 2;
+}
+
+double EncoderEstimator::position(double t) const
+{
+    return m_Position + m_Rate * (t - m_Time);
+}
+
+double EncoderEstimator::lastTime() const
+{
+    return m_Samples.empty() ? 0 : m_Samples.back().t;
+}
+
+void EncoderEstimator::fit()
+{
+    // Least squares line through the samples, centered on their mean time
+    double n = m_Samples.size();
+    double meanT = 0, meanS = 0;
+    for (const Sample &s : m_Samples)
+    {
+        meanT += s.t;
+        meanS += s.steps;
+    }
+    meanT /= n;
+    meanS /= n;
+
+    double stt = 0, sts = 0;
+    for (const Sample &s : m_Samples)
+    {
+        stt += (s.t - meanT) * (s.t - meanT);
+        sts += (s.t - meanT) * (s.steps - meanS);
+    }
+
+    m_Time     = meanT;
+    m_Position = meanS;
+    m_Rate     = stt > 0 ? sts / stt : 0;
+}
@@ -0,0 +1,87 @@
+/*
+    Celestron Aux Encoder Estimator
+
+    Copyright (C) 2020 Paweł T. Jochym
+    Copyright (C) 2020 Fabrizio Pollastri
+    Copyright (C) 2021 Jasem Mutlaq
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <deque>
+#include <stdint.h>
+
+/**
+ * Position and rate estimate of one axis from timestamped encoder samples.
+ *
+ * The samples are unwrapped across the 24bit encoder revolution and a straight
+ * line is fitted through the most recent ones. When a new sample does not fit
+ * the line (the axis started, stopped or changed rate) the older samples are
+ * dropped and the fit restarts from the last two readings.
+ */
+class EncoderEstimator
+{
+    public:
+        EncoderEstimator(int32_t revolution, size_t window, double tolerance);
+
+        void reset();
+
+        /** Add an encoder reading taken at host time t (seconds) */
+        void addSample(double t, int32_t steps);
+
+        /** At least two samples are available */
+        bool valid() const;
+
+        /** Estimated unwrapped position at time t, in steps */
+        double position(double t) const;
+
+        /** Estimated rate in steps per second */
+        double rate() const
+        {
+            return m_Rate;
+        }
+
+        /** Time of the newest sample */
+        double lastTime() const;
+
+        size_t size() const
+        {
+            return m_Samples.size();
+        }
+
+    private:
+        void fit();
+
+        struct Sample
+        {
+            double t;
+            double steps;
+        };
+
+        int32_t m_Revolution;
+        size_t m_Window;
+        double m_Tolerance;
+
+        std::deque<Sample> m_Samples;
+        int32_t m_LastRaw {0};
+
+        // Fitted line: steps = m_Position + m_Rate * (t - m_Time)
+        double m_Time {0};
+        double m_Position {0};
+        double m_Rate {0};
+};
@@ -0,0 +1,148 @@
+/*
+    Celestron Aux Encoder Sampler
+
+    Copyright (C) 2020 Paweł T. Jochym
+    Copyright (C) 2020 Fabrizio Pollastri
+    Copyright (C) 2021 Jasem Mutlaq
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <math.h>
+
+#include <chrono>
+
+#include "encodersampler.h"
+
+EncoderSampler::EncoderSampler(int32_t revolution, size_t window, double tolerance, double maxAge)
+    : m_Revolution(revolution), m_MaxAge(maxAge), m_Alt(revolution, window, tolerance), m_Az(revolution, window, tolerance)
+{
+}
+
+EncoderSampler::~EncoderSampler()
+{
+    stop();
+}
+
+double EncoderSampler::clock()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void EncoderSampler::start(double rate, ReadFunction read)
+{
+    if (m_Running || rate <= 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_EstimatorLock);
+        m_Alt.reset();
+        m_Az.reset();
+    }
+    {
+        std::lock_guard<std::mutex> guard(m_Lock);
+        m_Period = 1.0 / rate;
+    }
+    m_Read = read;
+
+    m_Running = true;
+    m_Thread = std::thread(&EncoderSampler::loop, this);
+}
+
+void EncoderSampler::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_Lock);
+        m_Running = false;
+    }
+    m_Condition.notify_all();
+
+    // The read function gives up waiting for the port, so this is safe with the port held
+    if (m_Thread.joinable())
+        m_Thread.join();
+}
+
+void EncoderSampler::loop()
+{
+    std::unique_lock<std::mutex> guard(m_Lock);
+    while (m_Running)
+    {
+        auto next = std::chrono::steady_clock::now() + std::chrono::duration<double>(m_Period);
+        guard.unlock();
+
+        sample(ALT);
+        sample(AZM);
+
+        guard.lock();
+        m_Condition.wait_until(guard, next, [this]
+        {
+            return !m_Running;
+        });
+    }
+}
+
+void EncoderSampler::sample(AUXTargets axis)
+{
+    double t;
+    int32_t steps;
+    if (!m_Running || !m_Read(axis, t, steps))
+        return;
+
+    std::lock_guard<std::mutex> guard(m_EstimatorLock);
+    (axis == ALT ? m_Alt : m_Az).addSample(t, steps);
+}
+
+bool EncoderSampler::position(AUXTargets axis, double t, int32_t &steps)
+{
+    if (!m_Running)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_EstimatorLock);
+    const EncoderEstimator &estimator = (axis == ALT) ? m_Alt : m_Az;
+    if (!estimator.valid() || t - estimator.lastTime() > m_MaxAge)
+        return false;
+
+    // The fit is unwrapped, fold it back to the range the controller reports
+    int32_t p = static_cast<int32_t>(lround(fmod(estimator.position(t), m_Revolution)));
+    if (axis == ALT)
+    {
+        if (p >= m_Revolution / 2)
+            p -= m_Revolution;
+        else if (p < -(m_Revolution / 2))
+            p += m_Revolution;
+    }
+    else
+    {
+        if (p < 0)
+            p += m_Revolution;
+        else if (p >= m_Revolution)
+            p -= m_Revolution;
+    }
+    steps = p;
+    return true;
+}
+
+double EncoderSampler::rate(AUXTargets axis)
+{
+    std::lock_guard<std::mutex> guard(m_EstimatorLock);
+    return (axis == ALT) ? m_Alt.rate() : m_Az.rate();
+}
+
+bool EncoderSampler::valid()
+{
+    std::lock_guard<std::mutex> guard(m_EstimatorLock);
+    return m_Alt.valid() && m_Az.valid();
+}
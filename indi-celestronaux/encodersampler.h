@@ -0,0 +1,95 @@
+/*
+    Celestron Aux Encoder Sampler
+
+    Copyright (C) 2020 Paweł T. Jochym
+    Copyright (C) 2020 Fabrizio Pollastri
+    Copyright (C) 2021 Jasem Mutlaq
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "auxproto.h"
+#include "encoderestimator.h"
+
+/**
+ * Background reader of the ALT and AZM encoders.
+ *
+ * A thread reads both axes through the port read function at the sampling rate
+ * and feeds the host timestamped readings to one EncoderEstimator per axis.
+ * position() serves the estimate in the range of the raw readings: signed
+ * 24bit for ALT, 0 to one revolution for AZM.
+ */
+class EncoderSampler
+{
+    public:
+        /**
+         * Query the position of axis. t is the host time the query was sent.
+         * Returns false when there is no fresh reading. The function should give
+         * up waiting for the port once running() is false.
+         */
+        typedef std::function<bool(AUXTargets axis, double &t, int32_t &steps)> ReadFunction;
+
+        EncoderSampler(int32_t revolution, size_t window, double tolerance, double maxAge);
+        ~EncoderSampler();
+
+        /** Start sampling at rate Hz, restarting the fits */
+        void start(double rate, ReadFunction read);
+        void stop();
+
+        bool running() const
+        {
+            return m_Running;
+        }
+
+        /** Estimated position of axis at host time t, false without a recent fit */
+        bool position(AUXTargets axis, double t, int32_t &steps);
+
+        /** Fitted rate of axis in steps per second */
+        double rate(AUXTargets axis);
+
+        /** Both axes have a fit */
+        bool valid();
+
+        /** Host time in seconds, for the read function and position() */
+        static double clock();
+
+    private:
+        void loop();
+        void sample(AUXTargets axis);
+
+        int32_t m_Revolution;
+        double m_MaxAge;
+        ReadFunction m_Read;
+
+        std::thread m_Thread;
+        std::atomic_bool m_Running {false};
+        std::mutex m_Lock;
+        std::condition_variable m_Condition;
+        double m_Period {0};
+
+        // Guards the estimators, the read function runs outside of it
+        std::mutex m_EstimatorLock;
+        EncoderEstimator m_Alt;
+        EncoderEstimator m_Az;
+};
@@ -0,0 +1,127 @@
+/*
+    Celestron Aux Encoder Estimator
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+/*
+ * Rate fit and interpolation of the encoder estimator. The readings mimic the
+ * bundled nse_simulator.py, which moves the axes in 100 ms ticks.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "encoderestimator.h"
+
+static const int32_t revolution = 16777216;
+static const double stepsPerDegree = revolution / 360.0;
+// sidereal tracking on one axis, in steps per second
+static const double trackingRate = 15.04 / 3600 * stepsPerDegree;
+
+TEST(EncoderEstimatorTest, needs_two_samples)
+{
+    EncoderEstimator estimator(revolution, 8, stepsPerDegree / 60);
+    EXPECT_FALSE(estimator.valid());
+
+    estimator.addSample(10.0, 1000);
+    EXPECT_FALSE(estimator.valid());
+    EXPECT_EQ(estimator.position(11.0), 1000);
+
+    estimator.addSample(10.2, 1100);
+    EXPECT_TRUE(estimator.valid());
+    EXPECT_NEAR(estimator.rate(), 500, 1e-6);
+    EXPECT_NEAR(estimator.position(10.3), 1150, 1e-6);
+}
+
+TEST(EncoderEstimatorTest, interpolates_between_simulator_ticks)
+{
+    EncoderEstimator estimator(revolution, 8, stepsPerDegree / 60);
+
+    // sampled at 4 Hz, the position only changes every 100 ms
+    for (int i = 0; i < 12; i++)
+    {
+        double t = 0.25 * i + 0.03;
+        estimator.addSample(t, static_cast<int32_t>(1e6 + trackingRate * floor(t * 10) / 10));
+    }
+
+    EXPECT_NEAR(estimator.rate(), trackingRate, trackingRate * 0.05);
+
+    // the estimate between samples is closer than the tick quantization of the readings
+    double t = 3.1;
+    EXPECT_NEAR(estimator.position(t), 1e6 + trackingRate * t, trackingRate * 0.1);
+}
+
+TEST(EncoderEstimatorTest, unwraps_azimuth)
+{
+    EncoderEstimator estimator(revolution, 8, stepsPerDegree / 60);
+
+    estimator.addSample(0.0, revolution - 200);
+    estimator.addSample(0.5, revolution - 100);
+    estimator.addSample(1.0, 0);
+    estimator.addSample(1.5, 100);
+
+    EXPECT_NEAR(estimator.rate(), 200, 1e-6);
+    EXPECT_NEAR(estimator.position(2.0), revolution + 200, 1e-6);
+
+    // moving backwards across zero
+    estimator.reset();
+    estimator.addSample(0.0, 100);
+    estimator.addSample(0.5, 0);
+    estimator.addSample(1.0, revolution - 100);
+
+    EXPECT_NEAR(estimator.rate(), -200, 1e-6);
+    EXPECT_NEAR(fmod(estimator.position(1.5) + revolution, revolution), revolution - 200, 1e-6);
+}
+
+TEST(EncoderEstimatorTest, restarts_when_the_axis_changes_motion)
+{
+    EncoderEstimator estimator(revolution, 8, stepsPerDegree / 60);
+
+    // tracking
+    for (int i = 0; i < 8; i++)
+        estimator.addSample(0.25 * i, static_cast<int32_t>(trackingRate * 0.25 * i));
+    EXPECT_EQ(estimator.size(), 8u);
+
+    // a 2 deg/s slew starts, one sample later the fit follows it
+    double start = 1.75;
+    double slew  = 2 * stepsPerDegree;
+    double base  = trackingRate * start;
+    estimator.addSample(2.0, static_cast<int32_t>(base + slew * (2.0 - start)));
+    EXPECT_EQ(estimator.size(), 2u);
+
+    estimator.addSample(2.25, static_cast<int32_t>(base + slew * (2.25 - start)));
+    estimator.addSample(2.5, static_cast<int32_t>(base + slew * (2.5 - start)));
+    EXPECT_NEAR(estimator.rate(), slew, slew * 0.001);
+    EXPECT_NEAR(estimator.position(2.6), base + slew * (2.6 - start), 2);
+}
+
+TEST(EncoderEstimatorTest, keeps_a_bounded_window)
+{
+    EncoderEstimator estimator(revolution, 8, stepsPerDegree / 60);
+
+    for (int i = 0; i < 100; i++)
+        estimator.addSample(0.1 * i, 50 * i);
+
+    EXPECT_EQ(estimator.size(), 8u);
+    EXPECT_DOUBLE_EQ(estimator.lastTime(), 0.1 * 99);
+    EXPECT_NEAR(estimator.rate(), 500, 1e-6);
+
+    // out of order samples are ignored
+    estimator.addSample(5.0, 0);
+    EXPECT_DOUBLE_EQ(estimator.lastTime(), 0.1 * 99);
+}
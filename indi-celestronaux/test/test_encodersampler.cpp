@@ -0,0 +1,210 @@
+/*
+    Celestron Aux Encoder Sampler
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+/*
+ * The sampler thread against a stub port: readings in the controller's ranges,
+ * estimates folded back to them, stale fits and stopping while the port is held.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "encodersampler.h"
+
+static const int32_t revolution = 16777216;
+static const double stepsPerDegree = revolution / 360.0;
+
+// Stand-in for the mount port: both axes move at a constant rate and a read returns
+// the reading at the time it was sent, ALT signed and AZM 0 to one revolution, as
+// CelestronAUX::processResponse stores them.
+class StubPort
+{
+    public:
+        StubPort(double altStart, double altRate, double azStart, double azRate)
+            : altStart(altStart), altRate(altRate), azStart(azStart), azRate(azRate), start(EncoderSampler::clock())
+        {
+        }
+
+        EncoderSampler::ReadFunction reader(EncoderSampler &sampler)
+        {
+            return [this, &sampler](AUXTargets axis, double &t, int32_t &steps)
+            {
+                return read(sampler, axis, t, steps);
+            };
+        }
+
+        /** Unwrapped position of axis at host time t */
+        double position(AUXTargets axis, double t) const
+        {
+            return (axis == ALT) ? altStart + altRate * (t - start) : azStart + azRate * (t - start);
+        }
+
+        /** What the controller reports for the unwrapped position */
+        static int32_t reading(AUXTargets axis, double steps)
+        {
+            int32_t p = static_cast<int32_t>(llround(steps) % revolution);
+            if (p < 0)
+                p += revolution;
+            if (axis == ALT && p >= revolution / 2)
+                p -= revolution;
+            return p;
+        }
+
+        // the port is held by someone else
+        std::atomic_bool busy { false };
+        // queries go unanswered
+        std::atomic_bool silent { false };
+        std::atomic_int altReads { 0 };
+        std::atomic_int azReads { 0 };
+
+    private:
+        bool read(EncoderSampler &sampler, AUXTargets axis, double &t, int32_t &steps)
+        {
+            // like CelestronAUX::readEncoder, give up waiting for the port once stopped
+            while (busy)
+            {
+                if (!sampler.running())
+                    return false;
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+
+            (axis == ALT ? altReads : azReads)++;
+            if (silent)
+                return false;
+            t     = EncoderSampler::clock();
+            steps = reading(axis, position(axis, t));
+            return true;
+        }
+
+        double altStart, altRate, azStart, azRate;
+        double start;
+};
+
+static bool waitValid(EncoderSampler &sampler)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!sampler.valid() && std::chrono::steady_clock::now() < end)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return sampler.valid();
+}
+
+TEST(EncoderSamplerTest, follows_both_axes_through_zero)
+{
+    EncoderSampler sampler(revolution, 8, stepsPerDegree / 60, 1.0);
+    // ALT slewing down through the horizon, AZM backwards through north
+    StubPort port(1000, -4000, 1000, -5000);
+
+    int32_t steps = 0;
+    EXPECT_FALSE(sampler.position(ALT, EncoderSampler::clock(), steps));
+
+    double started = EncoderSampler::clock();
+    sampler.start(20, port.reader(sampler));
+    ASSERT_TRUE(waitValid(sampler));
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+
+    double t = EncoderSampler::clock();
+    ASSERT_TRUE(sampler.position(ALT, t, steps));
+    EXPECT_LT(steps, 0);
+    EXPECT_NEAR(steps, port.position(ALT, t), 3);
+
+    ASSERT_TRUE(sampler.position(AZM, t, steps));
+    EXPECT_GT(steps, revolution / 2);
+    EXPECT_LT(steps, revolution);
+    EXPECT_NEAR(steps, revolution + port.position(AZM, t), 3);
+
+    EXPECT_NEAR(sampler.rate(ALT), -4000, 10);
+    EXPECT_NEAR(sampler.rate(AZM), -5000, 10);
+    sampler.stop();
+    double elapsed = EncoderSampler::clock() - started;
+
+    // both axes are read each period, and no faster than the sampling rate
+    EXPECT_GE(port.altReads, 2);
+    EXPECT_LE(port.altReads, elapsed * 20 + 1);
+    EXPECT_LE(abs(port.altReads - port.azReads), 1);
+}
+
+TEST(EncoderSamplerTest, alt_estimate_stays_in_the_signed_range)
+{
+    EncoderSampler sampler(revolution, 8, stepsPerDegree / 60, 1.0);
+    // ALT crossing the -180 degree end of the signed range, where the readings jump to +180
+    StubPort port(-(revolution / 2) + 200, -4000, 0, 0);
+
+    sampler.start(20, port.reader(sampler));
+    ASSERT_TRUE(waitValid(sampler));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    int32_t steps = 0;
+    double t      = EncoderSampler::clock();
+    ASSERT_TRUE(sampler.position(ALT, t, steps));
+    EXPECT_LT(steps, revolution / 2);
+    EXPECT_GE(steps, -(revolution / 2));
+    EXPECT_NEAR(steps, StubPort::reading(ALT, port.position(ALT, t)), 3);
+}
+
+TEST(EncoderSamplerTest, stale_or_missing_readings_are_not_estimated)
+{
+    EncoderSampler sampler(revolution, 8, stepsPerDegree / 60, 0.2);
+    StubPort port(1000, 100, 1000, 100);
+    int32_t steps = 0;
+
+    // no answer from the mount
+    port.silent = true;
+    sampler.start(20, port.reader(sampler));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_GT(port.altReads, 0);
+    EXPECT_FALSE(sampler.position(ALT, EncoderSampler::clock(), steps));
+
+    // answers, then stops answering for longer than the maximum age
+    port.silent = false;
+    ASSERT_TRUE(waitValid(sampler));
+    EXPECT_TRUE(sampler.position(AZM, EncoderSampler::clock(), steps));
+    port.silent = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    EXPECT_FALSE(sampler.position(AZM, EncoderSampler::clock(), steps));
+
+    // a stopped sampler leaves the positions to the last reading
+    port.silent = false;
+    ASSERT_TRUE(waitValid(sampler));
+    sampler.stop();
+    EXPECT_FALSE(sampler.position(AZM, EncoderSampler::clock(), steps));
+}
+
+TEST(EncoderSamplerTest, stops_while_the_port_is_held)
+{
+    EncoderSampler sampler(revolution, 8, stepsPerDegree / 60, 1.0);
+    StubPort port(0, 0, 0, 0);
+
+    // as from an INDI callback holding the port lock
+    port.busy = true;
+    sampler.start(20, port.reader(sampler));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sampler.stop();
+    EXPECT_FALSE(sampler.running());
+    EXPECT_EQ(port.altReads, 0);
+
+    // and it starts again afterwards with fresh fits
+    port.busy = false;
+    sampler.start(20, port.reader(sampler));
+    EXPECT_TRUE(waitValid(sampler));
+}
@@ -31,6 +31,8 @@
 #include <sys/stat.h>
 #include <termios.h>
 #include <memory>
+#include <chrono>
+#include <algorithm>
 #include <indicom.h>
 
 #include "dreamfocuser.h"
@@ -112,6 +114,11 @@ DreamFocuser::DreamFocuser()
 
 }
 
+DreamFocuser::~DreamFocuser()
+{
+    stopWorker();
+}
+
 bool DreamFocuser::initProperties()
 {
     INDI::Focuser::initProperties();
@@ -290,17 +297,20 @@ bool DreamFocuser::ISNewSwitch (const char *dev, const char *name, ISState *stat
             int index = IUFindOnSwitchIndex(&ParkSP);
             IUResetSwitch(&ParkSP);
 
-            if ( (isParked && (index == PARK_UNPARK)) || ( !isParked && (index == PARK_PARK)) )
+            DreamFocuserState current = getState();
+            if ( (current.isParked && (index == PARK_UNPARK)) || ( !current.isParked && (index == PARK_PARK)) )
             {
-                LOG_INFO("Park, issuing command.");
-                if ( setPark() )
+                if (current.isAbsolute == false)
                 {
-                    //ParkSP.s = IPS_OK;
-                    FocusAbsPosNP.s = IPS_OK;
-                    IDSetNumber(&FocusAbsPosNP, nullptr);
+                    LOG_ERROR("Focuser is not in Absolute mode. Please sync before to allow parking.");
+                    ParkSP.s = IPS_ALERT;
                 }
                 else
-                    ParkSP.s = IPS_ALERT;
+                {
+                    LOG_INFO("Park, issuing command.");
+                    queueRequest('G');
+                    ParkSP.s = IPS_BUSY;
+                }
             }
             IDSetSwitch(&ParkSP, nullptr);
             return true;
@@ -312,7 +322,8 @@ bool DreamFocuser::ISNewSwitch (const char *dev, const char *name, ISState *stat
 
 bool DreamFocuser::SyncFocuser(uint32_t ticks)
 {
-    return setSync(ticks);
+    queueRequest('Z', ticks);
+    return true;
 }
 
 /****************************************************************
@@ -334,7 +345,37 @@ bool DreamFocuser::getTemperature()
 
 bool DreamFocuser::Handshake()
 {
-    return getStatus();
+    stopWorker();
+
+    // Max position and absolute mode only change on sync, read them once here
+    if ( !getStatus() || !getAbsolute() || !getMaxPosition() || !getPosition() )
+        return false;
+
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        state = DreamFocuserState();
+        pendingMotions = 0;
+        state.isMoving = isMoving;
+        state.isParked = isParked;
+        state.isVcc12V = isVcc12V;
+        state.isAbsolute = isAbsolute;
+        state.position = currentPosition;
+        state.statusValid = state.positionValid = true;
+        state.worker = isMoving ? WORKER_MOVING : WORKER_IDLE;
+    }
+
+    FocusMaxPosN[0].value = currentMaxPosition;
+    SetFocuserMaxPosition(currentMaxPosition);
+    FocusAbsPosN[0].value = currentPosition;
+
+    startWorker();
+    return true;
+}
+
+bool DreamFocuser::Disconnect()
+{
+    stopWorker();
+    return INDI::Focuser::Disconnect();
 }
 
 bool DreamFocuser::getStatus()
@@ -350,6 +391,11 @@ bool DreamFocuser::getStatus()
     else
         return false;
 
+    return true;
+}
+
+bool DreamFocuser::getAbsolute()
+{
     if ( dispatch_command('W') ) // Is absolute?
         isAbsolute = currentResponse.d == 1 ? true : false;
     else
@@ -419,23 +465,15 @@ bool DreamFocuser::setPark()
     }
 
     if ( dispatch_command('G') )
-    {
-      LOG_INFO( "Focuser park command.");
       return true;
-    }
     LOG_ERROR("Park failed.");
     return false;
 }
 
 bool DreamFocuser::AbortFocuser()
 {
-    if ( dispatch_command('H') )
-    {
-        LOG_INFO("Focusing aborted.");
-        return true;
-    };
-    LOG_ERROR("Abort failed.");
-    return false;
+    queueRequest('H');
+    return true;
 }
 
 
@@ -468,45 +506,39 @@ IPState DreamFocuser::MoveAbsFocuser(uint32_t ticks)
 {
     LOGF_DEBUG("MoveAbsPosition: %d", ticks);
 
-    if (isAbsolute == false)
+    DreamFocuserState current = getState();
+
+    if (current.isAbsolute == false)
     {
         LOG_ERROR("Focuser is not in Absolute mode. Please sync.");
         return IPS_ALERT;
     }
 
-    if (isParked != 0)
+    if (current.isParked != 0)
     {
         LOG_ERROR("Please unpark before issuing any motion commands.");
         return IPS_ALERT;
     }
-    if ( setPosition(ticks) )
-    {
-        FocusAbsPosNP.s = IPS_OK;
-        IDSetNumber(&FocusAbsPosNP, nullptr);
-        return IPS_OK;
-    }
-    return IPS_ALERT;
+
+    queueRequest('M', ticks);
+    return IPS_BUSY;
 }
 
 IPState DreamFocuser::MoveRelFocuser(FocusDirection dir, uint32_t ticks)
 {
-    int32_t finalTicks = currentPosition + ((int32_t)ticks * (dir == FOCUS_INWARD ? -1 : 1));
+    DreamFocuserState current = getState();
+    int32_t finalTicks = current.position + ((int32_t)ticks * (dir == FOCUS_INWARD ? -1 : 1));
 
     LOGF_DEBUG("MoveRelPosition: %d", finalTicks);
 
-    if (isParked != 0)
+    if (current.isParked != 0)
     {
         LOG_ERROR("Please unpark before issuing any motion commands.");
         return IPS_ALERT;
     }
 
-    if ( setPosition(finalTicks) )
-    {
-        FocusRelPosNP.s = IPS_OK;
-        IDSetNumber(&FocusRelPosNP, nullptr);
-        return IPS_OK;
-    }
-    return IPS_ALERT;
+    queueRequest('M', static_cast<uint32_t>(finalTicks));
+    return IPS_BUSY;
 }
 
 
@@ -516,26 +548,22 @@ void DreamFocuser::TimerHit()
     if ( ! isConnected() )
         return;
 
-    int oldAbsStatus = FocusAbsPosNP.s;
-    int32_t oldPosition = currentPosition;
-
-    if ( getMaxPosition() )
+    // Only publish what the worker has read, the serial port is never touched here
+    DreamFocuserState current;
     {
-        if ( FocusMaxPosN[0].value != currentMaxPosition ) {
-            FocusMaxPosN[0].value = currentMaxPosition;
-            FocusMaxPosNP.s = IPS_OK;
-            IDSetNumber(&FocusMaxPosNP, nullptr);
-            SetFocuserMaxPosition(currentMaxPosition);
-        }
+        std::lock_guard<std::mutex> guard(stateLock);
+        current = state;
+        state.failedCommand = 0;
     }
-    else
-        FocusMaxPosNP.s = IPS_ALERT;
 
-    if ( getStatus() )
+    int oldAbsStatus = FocusAbsPosNP.s;
+    double oldPosition = FocusAbsPosN[0].value;
+
+    if ( current.statusValid && current.worker != WORKER_OFFLINE )
     {
 
         StatusSP.s = IPS_OK;
-        if ( isMoving )
+        if ( current.isMoving || current.worker == WORKER_MOVING )
         {
             //LOG_INFO("Moving" );
             FocusAbsPosNP.s = IPS_BUSY;
@@ -545,16 +573,21 @@ void DreamFocuser::TimerHit()
         {
             if ( FocusAbsPosNP.s != IPS_IDLE )
                 FocusAbsPosNP.s = IPS_OK;
+            if ( FocusRelPosNP.s == IPS_BUSY )
+            {
+                FocusRelPosNP.s = IPS_OK;
+                IDSetNumber(&FocusRelPosNP, nullptr);
+            }
             StatusS[1].s = ISS_OFF;
         };
 
-        if ( isParked == 1 )
+        if ( current.isParked == 1 || current.worker == WORKER_PARKING )
         {
             ParkSP.s = IPS_BUSY;
             StatusS[2].s = ISS_ON;
             ParkS[0].s = ISS_ON;
         }
-        else if ( isParked == 2 )
+        else if ( current.isParked == 2 )
         {
             ParkSP.s = IPS_OK;
             StatusS[2].s = ISS_ON;
@@ -567,7 +600,7 @@ void DreamFocuser::TimerHit()
             ParkSP.s = IPS_IDLE;
         }
 
-        if ( isAbsolute )
+        if ( current.isAbsolute )
         {
             StatusS[0].s = ISS_ON;
             if ( FocusAbsPosN[0].min != 0 )
@@ -590,40 +623,43 @@ void DreamFocuser::TimerHit()
     else
         StatusSP.s = IPS_ALERT;
 
-    if ( getTemperature() )
+    if ( current.weatherValid )
     {
-        WeatherNP.s = ( (WeatherN[0].value != currentTemperature) || (WeatherN[1].value != currentHumidity)) ? IPS_BUSY : IPS_OK;
-        WeatherN[0].value = currentTemperature;
-        WeatherN[1].value = currentHumidity;
-        WeatherN[2].value = pow(currentHumidity / 100, 1.0 / 8) * (112 + 0.9 * currentTemperature) + 0.1 * currentTemperature - 112;
+        WeatherNP.s = ( (WeatherN[0].value != current.temperature) || (WeatherN[1].value != current.humidity)) ? IPS_BUSY : IPS_OK;
+        WeatherN[0].value = current.temperature;
+        WeatherN[1].value = current.humidity;
+        WeatherN[2].value = pow(current.humidity / 100, 1.0 / 8) * (112 + 0.9 * current.temperature) + 0.1 * current.temperature - 112;
     }
     else
         WeatherNP.s = IPS_ALERT;
 
-    if ( FocusAbsPosNP.s != IPS_IDLE )
+    if ( current.positionValid && current.worker != WORKER_OFFLINE )
+        FocusAbsPosN[0].value = current.position;
+    else if ( FocusAbsPosNP.s != IPS_IDLE )
+        FocusAbsPosNP.s = IPS_ALERT;
+
+    switch ( current.failedCommand )
     {
-        if ( getPosition() )
-        {
-            if ( oldPosition != currentPosition )
-            {
-                FocusAbsPosNP.s = IPS_BUSY;
-                StatusS[1].s = ISS_ON;
-                FocusAbsPosN[0].value = currentPosition;
-            }
-            else
+        case 'M':
+            FocusAbsPosNP.s = IPS_ALERT;
+            if ( FocusRelPosNP.s == IPS_BUSY )
             {
-                StatusS[1].s = ISS_OFF;
-                FocusAbsPosNP.s = IPS_OK;
+                FocusRelPosNP.s = IPS_ALERT;
+                IDSetNumber(&FocusRelPosNP, nullptr);
             }
-            //if ( currentPosition < 0 )
-            // FocusAbsPosNP.s = IPS_ALERT;
-        }
-        else
-            FocusAbsPosNP.s = IPS_ALERT;
+            break;
+        case 'G':
+            ParkSP.s = IPS_ALERT;
+            break;
+        case 'Z':
+            LOG_ERROR("Focuser sync failed.");
+            FocusSyncNP.s = IPS_ALERT;
+            IDSetNumber(&FocusSyncNP, nullptr);
+            StatusSP.s = IPS_ALERT;
+            break;
     }
 
-
-    if ((oldAbsStatus != FocusAbsPosNP.s) || (oldPosition != currentPosition))
+    if ((oldAbsStatus != FocusAbsPosNP.s) || (oldPosition != FocusAbsPosN[0].value))
         IDSetNumber(&FocusAbsPosNP, nullptr);
 
     IDSetNumber(&WeatherNP, nullptr);
@@ -635,6 +671,216 @@ void DreamFocuser::TimerHit()
 
 }
 
+DreamFocuser::DreamFocuserState DreamFocuser::getState()
+{
+    std::lock_guard<std::mutex> guard(stateLock);
+    return state;
+}
+
+
+/****************************************************************
+**
+** Serial worker. Commands from the INDI thread are queued and
+** executed here, between them the worker polls the focuser: fast
+** while it moves or parks, slow when idle. A focuser that stops
+** answering only stalls this thread.
+**
+*****************************************************************/
+
+void DreamFocuser::startWorker()
+{
+    std::lock_guard<std::mutex> guard(queueLock);
+    requests.clear();
+    pollFailures = 0;
+    workerRunning = true;
+    workerThread = std::thread(&DreamFocuser::workerLoop, this);
+}
+
+void DreamFocuser::stopWorker()
+{
+    {
+        std::lock_guard<std::mutex> guard(queueLock);
+        workerRunning = false;
+    }
+    queueCondition.notify_all();
+
+    if (workerThread.joinable())
+        workerThread.join();
+}
+
+void DreamFocuser::queueRequest(char k, uint32_t l)
+{
+    int pending = 0;
+    {
+        std::lock_guard<std::mutex> guard(queueLock);
+        if (k == 'H')
+        {
+            // Abort overtakes every motion still waiting in the queue
+            for (auto it = requests.begin(); it != requests.end();)
+            {
+                if (it->k == 'M' || it->k == 'G')
+                {
+                    it = requests.erase(it);
+                    pending--;
+                }
+                else
+                    ++it;
+            }
+            requests.push_front({k, l});
+        }
+        else
+            requests.push_back({k, l});
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        if (k == 'M' || k == 'G')
+        {
+            pending++;
+            state.worker = (k == 'M') ? WORKER_MOVING : WORKER_PARKING;
+        }
+        pendingMotions += pending;
+    }
+
+    queueCondition.notify_one();
+}
+
+void DreamFocuser::workerLoop()
+{
+    std::chrono::steady_clock::time_point nextPoll = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point nextWeather = nextPoll;
+    std::unique_lock<std::mutex> lock(queueLock);
+
+    while (workerRunning)
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if (!requests.empty())
+        {
+            Request request = requests.front();
+            requests.pop_front();
+            lock.unlock();
+            runRequest(request);
+            lock.lock();
+
+            // Follow every command with a status poll at the fast rate
+            nextPoll = std::min(nextPoll, now + std::chrono::milliseconds(DREAMFOCUSER_POLL_MOVING));
+            continue;
+        }
+
+        if (now < nextPoll)
+        {
+            queueCondition.wait_until(lock, nextPoll);
+            continue;
+        }
+
+        lock.unlock();
+        bool readWeather = now >= nextWeather;
+        if (readWeather)
+            nextWeather = now + std::chrono::milliseconds(DREAMFOCUSER_POLL_WEATHER);
+        pollFocuser(readWeather);
+        WorkerState worker = getState().worker;
+        lock.lock();
+
+        bool fast = (worker == WORKER_MOVING || worker == WORKER_PARKING);
+        nextPoll = now + std::chrono::milliseconds(fast ? DREAMFOCUSER_POLL_MOVING : DREAMFOCUSER_POLL_IDLE);
+    }
+}
+
+void DreamFocuser::runRequest(const Request &request)
+{
+    bool success = false;
+
+    switch (request.k)
+    {
+        case 'M':
+            success = setPosition(static_cast<int32_t>(request.l));
+            break;
+        case 'Z':
+            // Syncing switches the focuser to absolute mode
+            success = setSync(request.l) && getAbsolute();
+            break;
+        case 'G':
+            success = setPark();
+            if ( success )
+                LOG_INFO( "Focuser park command.");
+            break;
+        case 'H':
+            success = dispatch_command('H');
+            if ( success )
+                LOG_INFO("Focusing aborted.");
+            else
+                LOG_ERROR("Abort failed.");
+            break;
+    }
+
+    std::lock_guard<std::mutex> guard(stateLock);
+    if (request.k == 'M' || request.k == 'G')
+        pendingMotions--;
+
+    if (request.k == 'Z' && success)
+        state.isAbsolute = isAbsolute;
+
+    if (!success)
+    {
+        state.failedCommand = request.k;
+        if (pendingMotions == 0 && state.worker != WORKER_OFFLINE)
+            state.worker = state.isMoving ? WORKER_MOVING : WORKER_IDLE;
+    }
+}
+
+void DreamFocuser::pollFocuser(bool readWeather)
+{
+    bool statusRead = getStatus();
+    bool positionRead = statusRead && getPosition();
+    bool weatherRead = readWeather && statusRead && getTemperature();
+
+    std::lock_guard<std::mutex> guard(stateLock);
+
+    if (statusRead)
+    {
+        state.isMoving = isMoving;
+        state.isParked = isParked;
+        state.isVcc12V = isVcc12V;
+    }
+    if (positionRead)
+        state.position = currentPosition;
+    if (weatherRead)
+    {
+        state.temperature = currentTemperature;
+        state.humidity = currentHumidity;
+    }
+    state.statusValid = statusRead;
+    state.positionValid = positionRead;
+    if (readWeather)
+        state.weatherValid = weatherRead;
+
+    if (!positionRead)
+    {
+        if (++pollFailures >= DREAMFOCUSER_MAX_FAILURES && state.worker != WORKER_OFFLINE)
+        {
+            LOG_ERROR("Focuser is not responding.");
+            state.worker = WORKER_OFFLINE;
+        }
+        return;
+    }
+
+    if (state.worker == WORKER_OFFLINE)
+        LOG_INFO("Focuser is responding again.");
+    pollFailures = 0;
+
+    // A queued motion keeps the fast rate until the worker has sent it
+    if (pendingMotions > 0 && state.worker != WORKER_OFFLINE)
+        return;
+
+    if (isParked == 1)
+        state.worker = WORKER_PARKING;
+    else if (isMoving)
+        state.worker = WORKER_MOVING;
+    else
+        state.worker = WORKER_IDLE;
+}
+
 
 /****************************************************************
 **
@@ -730,7 +976,7 @@ bool DreamFocuser::read_response()
     //LOG_DEBUG("Read response");
 
     // Read a single response
-    if ( (err_code = tty_read(PortFD, (char *)&currentResponse, sizeof(currentResponse), 5, &nbytes_read)) != TTY_OK)
+    if ( (err_code = tty_read(PortFD, (char *)&currentResponse, sizeof(currentResponse), DREAMFOCUSER_TIMEOUT, &nbytes_read)) != TTY_OK)
     {
         tty_error_msg(err_code, err_msg, 32);
         LOGF_ERROR("TTY error detected: %s", err_msg);
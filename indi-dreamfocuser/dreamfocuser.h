@@ -23,6 +23,10 @@
 #define DREAMFOCUSER_H
 
 #include <string>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include <indidevapi.h>
 #include <indicom.h>
@@ -32,6 +36,11 @@ using namespace std;
 
 #define DREAMFOCUSER_STEP_SIZE      32
 #define DREAMFOCUSER_ERROR_BUFFER   1024
+#define DREAMFOCUSER_TIMEOUT        1       // seconds to wait for a response
+#define DREAMFOCUSER_POLL_MOVING    100     // ms between status polls while moving or parking
+#define DREAMFOCUSER_POLL_IDLE      2000    // ms between status polls while idle
+#define DREAMFOCUSER_POLL_WEATHER   10000   // ms between temperature and humidity reads
+#define DREAMFOCUSER_MAX_FAILURES   3       // consecutive failed polls before the focuser is reported offline
 
 
 class DreamFocuser : public INDI::Focuser
@@ -51,7 +60,34 @@ class DreamFocuser : public INDI::Focuser
             unsigned char z;
         };
 
+        /* State of the serial worker */
+        enum WorkerState
+        {
+            WORKER_IDLE,
+            WORKER_MOVING,
+            WORKER_PARKING,
+            WORKER_OFFLINE
+        };
+
+        /* Focuser state as last read by the worker */
+        struct DreamFocuserState
+        {
+            float temperature = 0;
+            float humidity = 0;
+            int32_t position = 0;
+            bool isAbsolute = false;
+            bool isMoving = false;
+            unsigned char isParked = 0;
+            bool isVcc12V = false;
+            bool statusValid = false;
+            bool positionValid = false;
+            bool weatherValid = false;
+            WorkerState worker = WORKER_IDLE;
+            char failedCommand = 0;     // last motion, sync or park command the focuser rejected
+        };
+
         DreamFocuser();
+        virtual ~DreamFocuser();
 
         const char *getDefaultName() override;
         virtual bool initProperties() override;
@@ -62,6 +98,7 @@ class DreamFocuser : public INDI::Focuser
 
     protected:
         virtual bool Handshake() override;
+        virtual bool Disconnect() override;
         virtual void TimerHit() override;
         virtual bool SyncFocuser(uint32_t ticks) override;
 
@@ -69,6 +106,9 @@ class DreamFocuser : public INDI::Focuser
         virtual IPState MoveRelFocuser(FocusDirection dir, uint32_t ticks) override;
         virtual bool AbortFocuser() override;
 
+        ISwitch StatusS[3];
+        ISwitchVectorProperty StatusSP;
+
     private:
 
         INumber WeatherN[3];
@@ -77,12 +117,23 @@ class DreamFocuser : public INDI::Focuser
         ISwitch ParkS[2];
         ISwitchVectorProperty ParkSP;
 
-        ISwitch StatusS[3];
-        ISwitchVectorProperty StatusSP;
-
         //INumber SetBacklashN[1];
         //INumberVectorProperty SetBacklashNP;
 
+        /* Command queue of the serial worker */
+        struct Request
+        {
+            char k;
+            uint32_t l;
+        };
+
+        void startWorker();
+        void stopWorker();
+        void queueRequest(char k, uint32_t l = 0);
+        void workerLoop();
+        void runRequest(const Request &request);
+        void pollFocuser(bool readWeather);
+
         unsigned char calculate_checksum(DreamFocuserCommand c);
         bool send_command(char k, uint32_t l = 0, unsigned char addr = 0);
         bool read_response();
@@ -94,8 +145,11 @@ class DreamFocuser : public INDI::Focuser
         bool getMaxPosition();
         bool setPosition(int32_t position);
         bool setSync(uint32_t position = 0);
+        bool getAbsolute();
         bool setPark();
 
+        DreamFocuserState getState();
+
        // Variables
         float currentTemperature;
         float currentHumidity;
@@ -106,6 +160,19 @@ class DreamFocuser : public INDI::Focuser
         unsigned char isParked;
         bool isVcc12V;
         DreamFocuserCommand currentResponse;
+
+        // Worker, only the worker thread talks to the focuser once it runs
+        std::thread workerThread;
+        bool workerRunning = false;
+        std::deque<Request> requests;
+        std::mutex queueLock;
+        std::condition_variable queueCondition;
+        int pollFailures = 0;
+
+        // Published state, guarded by stateLock
+        DreamFocuserState state;
+        int pendingMotions = 0;
+        std::mutex stateLock;
 };
 
 #endif
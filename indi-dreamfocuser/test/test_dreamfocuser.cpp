@@ -0,0 +1,423 @@
+/*
+  INDI Driver for DreamFocuser
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+/*
+ * Worker tests against a DreamFocuser emulator. The emulator answers the 8 byte binary
+ * protocol on the master side of a pseudo terminal, the driver talks to the slave side.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "dreamfocuser.h"
+
+static const int32_t emulatorMaxPosition = 250000;
+static const int32_t emulatorStepsPerTick = 20;    // motion per 10 ms
+
+class DreamFocuserEmulator
+{
+    public:
+        DreamFocuserEmulator()
+        {
+            master = posix_openpt(O_RDWR | O_NOCTTY);
+            if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+                return;
+
+            slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+            if (slave < 0)
+                return;
+
+            struct termios tty;
+            tcgetattr(slave, &tty);
+            cfmakeraw(&tty);
+            tcsetattr(slave, TCSANOW, &tty);
+
+            running = true;
+            thread = std::thread(&DreamFocuserEmulator::run, this);
+        }
+
+        ~DreamFocuserEmulator()
+        {
+            running = false;
+            if (thread.joinable())
+                thread.join();
+            if (slave >= 0)
+                close(slave);
+            if (master >= 0)
+                close(master);
+        }
+
+        int fd() const
+        {
+            return slave;
+        }
+
+        /** An unresponsive focuser reads commands but never answers */
+        void setSilent(bool value)
+        {
+            silent = value;
+        }
+
+        /** Answer command k with an error from now on */
+        void reject(char k)
+        {
+            rejected = k;
+        }
+
+        int32_t position()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            return current;
+        }
+
+        /** Number of commands k received since the last call */
+        int takeCount(char k)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            int count = 0;
+            std::vector<char> remaining;
+            for (char c : commands)
+            {
+                if (c == k)
+                    count++;
+                else
+                    remaining.push_back(c);
+            }
+            commands.swap(remaining);
+            return count;
+        }
+
+    private:
+        void run()
+        {
+            unsigned char frame[8];
+            size_t length = 0;
+            auto nextStep = std::chrono::steady_clock::now();
+
+            while (running)
+            {
+                struct pollfd pfd = { master, POLLIN, 0 };
+                if (poll(&pfd, 1, 5) > 0)
+                {
+                    ssize_t n = read(master, frame + length, sizeof(frame) - length);
+                    if (n > 0)
+                        length += n;
+                }
+
+                if (std::chrono::steady_clock::now() >= nextStep)
+                {
+                    step();
+                    nextStep += std::chrono::milliseconds(10);
+                }
+
+                if (length < sizeof(frame))
+                    continue;
+                length = 0;
+
+                std::lock_guard<std::mutex> guard(lock);
+                commands.push_back(frame[1]);
+                if (!silent && !answer(frame))
+                    break;
+            }
+        }
+
+        void step()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (current < target)
+                current = std::min(target, current + emulatorStepsPerTick);
+            else if (current > target)
+                current = std::max(target, current - emulatorStepsPerTick);
+        }
+
+        bool answer(const unsigned char *command)
+        {
+            unsigned char response[8] = { 'M', command[1], 0, 0, 0, 0, 0, 0 };
+            int32_t value = (command[2] << 24) | (command[3] << 16) | (command[4] << 8) | command[5];
+            int32_t reply = 0;
+
+            // a rejected command leaves the focuser alone and gets the error answer
+            switch (command[1] == rejected ? '!' : command[1])
+            {
+                case 'I':
+                    reply = (current != target ? 1 : 0) | (parked << 3);
+                    break;
+                case 'W':
+                    reply = absolute ? 1 : 0;
+                    break;
+                case 'A':
+                    reply = command[6] == 3 ? emulatorMaxPosition : 0;
+                    break;
+                case 'P':
+                    reply = current;
+                    break;
+                case 'T':
+                    // 21.5 C, 60 % humidity
+                    reply = (600 << 16) | 215;
+                    break;
+                case 'M':
+                    target = value;
+                    reply = value;
+                    break;
+                case 'Z':
+                    current = target = value;
+                    absolute = true;
+                    reply = value;
+                    break;
+                case 'H':
+                    target = current;
+                    break;
+                case 'G':
+                    parked = parked ? 0 : 2;
+                    break;
+                default:
+                    response[1] = '!';
+                    break;
+            }
+
+            response[2] = (reply >> 24) & 0xff;
+            response[3] = (reply >> 16) & 0xff;
+            response[4] = (reply >> 8) & 0xff;
+            response[5] = reply & 0xff;
+            for (int i = 0; i < 7; i++)
+                response[7] += response[i];
+
+            return write(master, response, sizeof(response)) == sizeof(response);
+        }
+
+        int master { -1 };
+        int slave { -1 };
+        std::atomic_bool running { false };
+        std::atomic_bool silent { false };
+        std::atomic<char> rejected { 0 };
+        std::thread thread;
+        std::mutex lock;
+        std::vector<char> commands;
+
+        int32_t current { 1000 };
+        int32_t target { 1000 };
+        bool absolute { true };
+        int parked { 0 };
+};
+
+class TestDreamFocuser : public DreamFocuser
+{
+    public:
+        explicit TestDreamFocuser(int fd)
+        {
+            initProperties();
+            PortFD = fd;
+            connected = Handshake();
+            setConnected(connected, IPS_OK);
+        }
+
+        bool connected { false };
+
+        IPState moveAbs(uint32_t ticks)
+        {
+            return MoveAbsFocuser(ticks);
+        }
+
+        bool abort()
+        {
+            return AbortFocuser();
+        }
+
+        /** Publish the worker state, as the INDI timer would */
+        void publish()
+        {
+            TimerHit();
+        }
+
+        IPState absStatus() const
+        {
+            return FocusAbsPosNP.s;
+        }
+
+        double absPosition() const
+        {
+            return FocusAbsPosN[0].value;
+        }
+
+        double maxPosition() const
+        {
+            return FocusMaxPosN[0].value;
+        }
+
+        bool sync(uint32_t ticks)
+        {
+            return SyncFocuser(ticks);
+        }
+
+        IPState syncStatus() const
+        {
+            return FocusSyncNP.s;
+        }
+
+        IPState statusStatus() const
+        {
+            return StatusSP.s;
+        }
+
+        /** Publish until the absolute position settles, returns false on timeout */
+        bool waitForMoveEnd(std::chrono::milliseconds timeout)
+        {
+            auto end = std::chrono::steady_clock::now() + timeout;
+            while (std::chrono::steady_clock::now() < end)
+            {
+                publish();
+                if (absStatus() == IPS_OK)
+                    return true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            return false;
+        }
+};
+
+TEST(DreamFocuserTest, max_position_is_read_once_per_connect)
+{
+    DreamFocuserEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestDreamFocuser focuser(emulator.fd());
+    ASSERT_TRUE(focuser.connected);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    focuser.publish();
+
+    EXPECT_EQ(focuser.maxPosition(), emulatorMaxPosition);
+    EXPECT_EQ(focuser.absPosition(), 1000);
+    EXPECT_EQ(emulator.takeCount('A'), 1);
+    EXPECT_EQ(emulator.takeCount('W'), 1);
+}
+
+TEST(DreamFocuserTest, move_completes_through_the_worker)
+{
+    DreamFocuserEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestDreamFocuser focuser(emulator.fd());
+    ASSERT_TRUE(focuser.connected);
+
+    EXPECT_EQ(focuser.moveAbs(3000), IPS_BUSY);
+    focuser.publish();
+    EXPECT_EQ(focuser.absStatus(), IPS_BUSY);
+
+    ASSERT_TRUE(focuser.waitForMoveEnd(std::chrono::milliseconds(3000)));
+    EXPECT_EQ(focuser.absPosition(), 3000);
+    EXPECT_EQ(emulator.position(), 3000);
+}
+
+TEST(DreamFocuserTest, polls_fast_while_moving_and_slow_when_idle)
+{
+    DreamFocuserEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestDreamFocuser focuser(emulator.fd());
+    ASSERT_TRUE(focuser.connected);
+
+    // the handshake and the first worker poll, then nothing for the idle period
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    EXPECT_LE(emulator.takeCount('I'), 2);
+
+    // 3000 steps take one and a half seconds
+    focuser.moveAbs(4000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    EXPECT_GE(emulator.takeCount('I'), 6);
+
+    ASSERT_TRUE(focuser.waitForMoveEnd(std::chrono::milliseconds(3000)));
+    emulator.takeCount('I');
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    EXPECT_LE(emulator.takeCount('I'), 1);
+}
+
+TEST(DreamFocuserTest, abort_stops_a_move_without_waiting)
+{
+    DreamFocuserEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestDreamFocuser focuser(emulator.fd());
+    ASSERT_TRUE(focuser.connected);
+
+    focuser.moveAbs(100000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(focuser.abort());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    ASSERT_TRUE(focuser.waitForMoveEnd(std::chrono::milliseconds(1000)));
+    EXPECT_EQ(emulator.takeCount('H'), 1);
+    EXPECT_LT(emulator.position(), 100000);
+    EXPECT_EQ(focuser.absPosition(), emulator.position());
+}
+
+TEST(DreamFocuserTest, unresponsive_focuser_does_not_block_the_driver)
+{
+    DreamFocuserEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestDreamFocuser focuser(emulator.fd());
+    ASSERT_TRUE(focuser.connected);
+
+    emulator.setSilent(true);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(focuser.moveAbs(5000), IPS_BUSY);
+    EXPECT_TRUE(focuser.abort());
+    focuser.publish();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    // the worker gives up on the missing answers and reports the focuser offline
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (focuser.absStatus() != IPS_ALERT && std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        focuser.publish();
+    }
+    EXPECT_EQ(focuser.absStatus(), IPS_ALERT);
+}
+
+TEST(DreamFocuserTest, failed_sync_is_reported)
+{
+    DreamFocuserEmulator emulator;
+    ASSERT_GE(emulator.fd(), 0);
+    TestDreamFocuser focuser(emulator.fd());
+    ASSERT_TRUE(focuser.connected);
+
+    emulator.reject('Z');
+    EXPECT_TRUE(focuser.sync(5000));
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (focuser.syncStatus() != IPS_ALERT && std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        focuser.publish();
+    }
+    EXPECT_EQ(emulator.takeCount('Z'), 1);
+    EXPECT_EQ(focuser.syncStatus(), IPS_ALERT);
+    EXPECT_EQ(focuser.statusStatus(), IPS_ALERT);
+    EXPECT_EQ(emulator.position(), 1000);
+}
@@ -17,8 +17,10 @@
 
 #include "align.h"
 
+#include "triangulate.h"
 #include "../eqmodbase.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include <libnova/sidereal_time.h>
@@ -83,6 +85,9 @@ Align::Align(INDI::Telescope *t)
     currentdeltaDEC  = 0.0;
     lastnearestindex = -1;
 
+    faceTransformsRevision = 0;
+    lastface               = -1;
+
     AlignDataFileTP        = nullptr;
     AlignDataBP            = nullptr;
     AlignPointNP           = nullptr;
@@ -180,45 +185,64 @@ bool Align::updateProperties()
     return true;
 }
 
-void Align::AlignNStar(double jd, IGeographicCoordinates *position, double currentRA, double currentDEC,
-                       double *alignedRA, double *alignedDEC, bool ingoto)
+static void altaz_to_cosines(double alt, double az, double v[3])
 {
-    //double pointaz = (pointset->range24(lst - currentRA - 12.0) * 360.0) / 24.0;
-    //double pointalt = currentDEC + pointset->lat;
-    double pointaz, pointalt;
-    //std::set<PointSet::Distance, bool (*)(PointSet::Distance, PointSet::Distance)> *sortedpoints;
-    pointset->AltAzFromRaDec(currentRA, currentDEC, jd, &pointalt, &pointaz, position);
-    //sortedpoints=pointset->ComputeDistances(pointalt, pointaz, PointSet::None, ingoto);
+    double horangle = range360(-180.0 - az) * M_PI / 180.0;
+    double altangle = alt * M_PI / 180.0;
+    v[0]            = cos(altangle) * cos(horangle);
+    v[1]            = cos(altangle) * sin(horangle);
+    v[2]            = sin(altangle);
+}
 
-    std::vector<HtmID> face;
-    face = pointset->findFace(currentRA, currentDEC, jd, pointalt, pointaz, position, ingoto);
+static void cross_product(const double a[3], const double b[3], double out[3])
+{
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
 
-    //if (sortedpoints->size() < 2) {
-    if (face.size() < 3)
+/* Same test as PointSet::isPointInside: p is on the same side of the three edges.
+   That also holds for the antipode of the face, which the center direction rules out. */
+static bool inside_face(double edges[3][3], const double center[3], const double p[3])
+{
+    bool left  = false;
+    bool right = false;
+    if (center[0] * p[0] + center[1] * p[1] + center[2] * p[2] <= 0)
+        return false;
+    for (int i = 0; i < 3; i++)
     {
-        //IDLog("AlignNstar: only %d points in set - using Nearest mode\n", sortedpoints->size());
-        AlignNearest(jd, position, currentRA, currentDEC, alignedRA, alignedDEC, ingoto);
+        if (edges[i][0] * p[0] + edges[i][1] * p[1] + edges[i][2] * p[2] < 0)
+            left = true;
+        else
+            right = true;
+        if (left && right)
+            return false;
     }
-    else
+    return true;
+}
+
+void Align::UpdateFaceTransforms()
+{
+    std::vector<Face *> faces;
+    if (faceTransformsRevision == pointset->getRevision())
+        return;
+    faces = pointset->getFaces();
+    faceTransforms.resize(faces.size());
+    vertexFaces.clear();
+    for (size_t f = 0; f < faces.size(); f++)
     {
+        FaceTransform *face = &faceTransforms[f];
         /* Taki's Algorithm (p33): http://www.geocities.jp/toshimi_taki/matrix/matrix_method_rev_e.pdf */
-        //std::set<PointSet::Distance>::iterator it = sortedpoints->begin();
-        //PointSet::Point *point = pointset->getPoint(it->htmID);
-        std::vector<HtmID>::iterator it = face.begin();
-        PointSet::Point *point          = pointset->getPoint(*it);
         double celestialMatrix[3][3];
         double invcelestialMatrix[3][3];
         double telescopeMatrix[3][3];
-        double T[3][3];
-        double invT[3][3];
-        double l, m, n;
-        double L, M, N;
-        //int max=(sortedpoints->size() == 2)?2:3;
-        int max = 3;
+        double c[3][3], t[3][3];
 
-        for (int i = 0; i < max; i++)
+        for (int i = 0; i < 3; i++)
         {
-            //IDLog("Align NStar: align point %d htm = %s, telescope alt=%g az=%g\n", i, point->htmname, point->telescopeALT, point->telescopeAZ);
+            PointSet::Point *point = pointset->getPoint(faces[f]->v[i]);
+            face->v[i]             = faces[f]->v[i];
+            vertexFaces[face->v[i]].push_back(f);
 
             celestialMatrix[0][i] =
                 cos(point->aligndata.targetDEC * M_PI / 180.0) *
@@ -230,177 +254,176 @@ void Align::AlignNStar(double jd, IGeographicCoordinates *position, double curre
                     180.0);
             celestialMatrix[2][i] = sin(point->aligndata.targetDEC * M_PI / 180.0);
 
-            /*
-            telescopeMatrix[0][i]=cos(point->aligndata.telescopeDEC * M_PI / 180.0) *
-            cos(((pointset->range24(point->aligndata.telescopeRA - point->aligndata.lst) * 360) / 24.0) * M_PI / 180.0);
-                 telescopeMatrix[1][i]=cos(point->aligndata.telescopeDEC * M_PI / 180.0) *
-            sin(((pointset->range24(point->aligndata.telescopeRA - point->aligndata.lst) * 360) / 24.0) * M_PI / 180.0);
-                 telescopeMatrix[2][i]=sin(point->aligndata.telescopeDEC * M_PI / 180.0);
-                 */
-            /*
-            celestialMatrix[0][i]=cos(point->celestialALT * M_PI / 180.0) *
-            cos(point->celestialAZ * M_PI / 180.0);
-                 celestialMatrix[1][i]=cos(point->celestialALT * M_PI / 180.0) *
-            sin(point->celestialAZ * M_PI / 180.0);
-                 celestialMatrix[2][i]=sin(point->celestialALT * M_PI / 180.0);
-                 */
             telescopeMatrix[0][i] = cos(point->telescopeALT * M_PI / 180.0) *
                                     cos(range360(-180.0 - point->telescopeAZ) * M_PI / 180.0);
             telescopeMatrix[1][i] = cos(point->telescopeALT * M_PI / 180.0) *
                                     sin(range360(-180.0 - point->telescopeAZ) * M_PI / 180.0);
             telescopeMatrix[2][i] = sin(point->telescopeALT * M_PI / 180.0);
-            it++;
-            //point = pointset->getPoint(it->htmID);
-            point = pointset->getPoint(*it);
-        }
 
-        //if (sortedpoints->size() == 2) {
-        if (face.size() == 2)
-        {
-            /* compute vector product of the two points */
-            /* and insert it in the set */
-            double norm = 1.0;
-            celestialMatrix[0][2] =
-                celestialMatrix[1][0] * celestialMatrix[2][1] - celestialMatrix[2][0] * celestialMatrix[1][1];
-            celestialMatrix[1][2] =
-                celestialMatrix[2][0] * celestialMatrix[0][1] - celestialMatrix[0][0] * celestialMatrix[2][1];
-            celestialMatrix[2][2] =
-                celestialMatrix[0][0] * celestialMatrix[1][1] - celestialMatrix[1][0] * celestialMatrix[0][1];
-            norm = sqrt(celestialMatrix[0][2] * celestialMatrix[0][2] + celestialMatrix[1][2] * celestialMatrix[1][2] +
-                        celestialMatrix[2][2] * celestialMatrix[2][2]);
-            celestialMatrix[0][2] = celestialMatrix[0][2] / norm;
-            celestialMatrix[1][2] = celestialMatrix[1][2] / norm;
-            celestialMatrix[2][2] = celestialMatrix[2][2] / norm;
-
-            telescopeMatrix[0][2] =
-                telescopeMatrix[1][0] * telescopeMatrix[2][1] - telescopeMatrix[2][0] * telescopeMatrix[1][1];
-            telescopeMatrix[1][2] =
-                telescopeMatrix[2][0] * telescopeMatrix[0][1] - telescopeMatrix[0][0] * telescopeMatrix[2][1];
-            telescopeMatrix[2][2] =
-                telescopeMatrix[0][0] * telescopeMatrix[1][1] - telescopeMatrix[1][0] * telescopeMatrix[0][1];
-            norm = sqrt(telescopeMatrix[0][2] * telescopeMatrix[0][2] + telescopeMatrix[1][2] * telescopeMatrix[1][2] +
-                        telescopeMatrix[2][2] * telescopeMatrix[2][2]);
-            telescopeMatrix[0][2] = telescopeMatrix[0][2] / norm;
-            telescopeMatrix[1][2] = telescopeMatrix[1][2] / norm;
-            telescopeMatrix[2][2] = telescopeMatrix[2][2] / norm;
+            c[i][0] = point->cx;
+            c[i][1] = point->cy;
+            c[i][2] = point->cz;
+            t[i][0] = point->tx;
+            t[i][1] = point->ty;
+            t[i][2] = point->tz;
         }
         //MATRIX_LOG("celestialMatrix", celestialMatrix);
         //MATRIX_LOG("telescopeMatrix", telescopeMatrix);
         inverse_matrix_3x3(celestialMatrix, invcelestialMatrix);
-        //MATRIX_LOG("invcelestialMatrix", invcelestialMatrix);
-        mult_matrix_3x3(telescopeMatrix, invcelestialMatrix, T);
-        inverse_matrix_3x3(T, invT);
-        //MATRIX_LOG("T", T);
-        //MATRIX_LOG("invT", invT);
-        if (!(ingoto))
+        mult_matrix_3x3(telescopeMatrix, invcelestialMatrix, face->T);
+        inverse_matrix_3x3(face->T, face->invT);
+
+        cross_product(c[2], c[0], face->celestialEdges[0]);
+        cross_product(c[0], c[1], face->celestialEdges[1]);
+        cross_product(c[1], c[2], face->celestialEdges[2]);
+        cross_product(t[2], t[0], face->telescopeEdges[0]);
+        cross_product(t[0], t[1], face->telescopeEdges[1]);
+        cross_product(t[1], t[2], face->telescopeEdges[2]);
+        for (int k = 0; k < 3; k++)
         {
-            double lst = 0;
-
-            lst = ln_get_apparent_sidereal_time(jd);
-            lst += (position->longitude / 15.0);
-            lst = range24(lst);
-            /*
-            l = cos(currentDEC * M_PI / 180.0) * cos(((pointset->range24(currentRA - lst) * 360) / 24.0) * M_PI / 180.0);
-            m = cos(currentDEC * M_PI / 180.0) * sin(((pointset->range24(currentRA - lst) * 360) / 24.0) * M_PI / 180.0);
-            n = sin(currentDEC * M_PI / 180.0);
-            */
-            l = cos(pointalt * M_PI / 180.0) * cos(range360(-180.0 - pointaz) * M_PI / 180.0);
-            m = cos(pointalt * M_PI / 180.0) * sin(range360(-180.0 - pointaz) * M_PI / 180.0);
-            n = sin(pointalt * M_PI / 180.0);
-
-            L = invT[0][0] * l + invT[0][1] * m + invT[0][2] * n;
-            M = invT[1][0] * l + invT[1][1] * m + invT[1][2] * n;
-            N = invT[2][0] * l + invT[2][1] * m + invT[2][2] * n;
-
-            *alignedRA = atan(M / L) * 12.0 / M_PI;
-            //IDLog("Aligning RA = %g L=%g at LST = %g (point alt = %g az = %g)\n", *alignedRA, L, lst, pointalt, pointaz);
-            if (L < 0.0)
-                *alignedRA += 12.0;
-            //IDLog("Aligning RA = %g at LST = %g\n", *alignedRA, lst);
-            *alignedRA = range24(*alignedRA + lst);
-            //if (L < 0) *alignedRA += 12.0;
-            //if (*alignedRA < 0) *alignedRA = 24.0 + *alignedRA;
-
-            *alignedDEC = asin(N) * 180.0 / M_PI;
-
-            /*
-            alignedaz = atan(M/L) * 180.0 / M_PI;
-            //if (L < 0) alignedaz += 180.0;
-            //if (alignedaz < 0) alignedaz = 360.0 + alignedaz;
-            alignedaz = pointset->range360(-180.0 - alignedaz);
-
-            alignedalt = asin(N) * 180.0 / M_PI;
-
-            pointset->RaDecFromAltAz(alignedalt, alignedaz, jd, alignedRA, alignedDEC, position);
-            */
+            face->celestialCenter[k] = c[0][k] + c[1][k] + c[2][k];
+            face->telescopeCenter[k] = t[0][k] + t[1][k] + t[2][k];
         }
+    }
+    faceTransformsRevision = pointset->getRevision();
+    lastface               = -1;
+}
+
+bool Align::InsideFace(FaceTransform *face, bool ingoto, const double p[3])
+{
+    if (ingoto)
+        return inside_face(face->celestialEdges, face->celestialCenter, p);
+    return inside_face(face->telescopeEdges, face->telescopeCenter, p);
+}
+
+int Align::LocateFace(double alt, double az, bool ingoto, int hint)
+{
+    double p[3];
+    altaz_to_cosines(alt, az, p);
+    // while tracking the position usually stays in the same face
+    if (hint >= 0 && hint < (int)faceTransforms.size() && InsideFace(&faceTransforms[hint], ingoto, p))
+        return hint;
+    // otherwise it is most likely one of the faces around the nearest align point
+    PointSet::Point *point = pointset->findNearest(alt, az, ingoto);
+    std::map<HtmID, std::vector<int>>::iterator around;
+    if (point && (around = vertexFaces.find(point->htmID)) != vertexFaces.end())
+    {
+        for (int f : around->second)
+            if (InsideFace(&faceTransforms[f], ingoto, p))
+                return f;
+    }
+    for (size_t f = 0; f < faceTransforms.size(); f++)
+    {
+        if (InsideFace(&faceTransforms[f], ingoto, p))
+            return f;
+    }
+    return -1;
+}
+
+void Align::CelestialToTelescope(FaceTransform *face, double lst, double ra, double dec, double *alt, double *az)
+{
+    double l, m, n;
+    double L, M, N;
+
+    // LMN should be RA/DEC relative to lst=0
+    L = cos(dec * M_PI / 180.0) * cos(((range24(ra - lst) * 360) / 24.0) * M_PI / 180.0);
+    M = cos(dec * M_PI / 180.0) * sin(((range24(ra - lst) * 360) / 24.0) * M_PI / 180.0);
+    N = sin(dec * M_PI / 180.0);
+
+    l = face->T[0][0] * L + face->T[0][1] * M + face->T[0][2] * N;
+    m = face->T[1][0] * L + face->T[1][1] * M + face->T[1][2] * N;
+    n = face->T[2][0] * L + face->T[2][1] * M + face->T[2][2] * N;
+
+    *az = atan(m / l) * 180.0 / M_PI;
+    if (l < 0)
+        *az += 180.0;
+    // Eq 4-13 and 4-14 from Taki page 11
+    //   when l >= 0 1st or 4th quadrant
+    //   when l < 0  2nd or 3rd quadrant
+    // atan returns values between -M_PI / 2 and M_PI / 2
+    //From Taki to kstars azimuth
+    *az = range360(-180.0 - *az);
+
+    *alt = asin(n) * 180.0 / M_PI;
+}
+
+void Align::AlignNStar(double jd, IGeographicCoordinates *position, double currentRA, double currentDEC,
+                       double *alignedRA, double *alignedDEC, bool ingoto)
+{
+    double pointaz, pointalt;
+    double lst;
+    int face;
+    pointset->AltAzFromRaDec(currentRA, currentDEC, jd, &pointalt, &pointaz, position);
+
+    UpdateFaceTransforms();
+    face = LocateFace(pointalt, pointaz, ingoto, lastface);
+    if (face != lastface)
+    {
+        if (face >= 0)
+            LOGF_DEBUG("Align: current face is {%d, %d, %d}", pointset->getPoint(faceTransforms[face].v[0])->index,
+                      pointset->getPoint(faceTransforms[face].v[1])->index,
+                      pointset->getPoint(faceTransforms[face].v[2])->index);
         else
-        {
-            double alignedalt, alignedaz;
-            double lst;
-            lst = ln_get_apparent_sidereal_time(jd);
-            lst += (position->longitude / 15.0);
-            lst = range24(lst);
-
-            L = cos(currentDEC * M_PI / 180.0) *
-                cos(((range24(currentRA - lst) * 360) / 24.0) * M_PI / 180.0);
-            M = cos(currentDEC * M_PI / 180.0) *
-                sin(((range24(currentRA - lst) * 360) / 24.0) * M_PI / 180.0);
-            N = sin(currentDEC * M_PI / 180.0);
-
-            // LMN should be RA/DEC relative to lst=0
-            //L = cos(pointalt * M_PI / 180.0) * cos(pointset->range360(-180.0 - pointaz) * M_PI / 180.0);
-            //M = cos(pointalt * M_PI / 180.0) * sin(pointset->range360(-180.0 - pointaz) * M_PI / 180.0);
-            //N = sin(pointalt * M_PI / 180.0);
-
-            //MATRIX_LOG("celestialMatrix", celestialMatrix);
-            //MATRIX_LOG("telescopeMatrix", telescopeMatrix);
-            //MATRIX_LOG("T", T);
-            //MATRIX_LOG("invT", invT);
-
-            l = T[0][0] * L + T[0][1] * M + T[0][2] * N;
-            m = T[1][0] * L + T[1][1] * M + T[1][2] * N;
-            n = T[2][0] * L + T[2][1] * M + T[2][2] * N;
-            /*
-            *alignedRA = atan(m/l) * 12.0 / M_PI;
-            if (l < 0) *alignedRA += 12.0;
-            if (*alignedRA < 0) *alignedRA = 24.0 + *alignedRA;
-
-            *alignedDEC = asin(n) * 180.0 / M_PI;
-            */
-            alignedaz = atan(m / l) * 180.0 / M_PI;
-            if (l < 0)
-                alignedaz += 180.0;
-            // Eq 4-13 and 4-14 from Taki page 11
-            //   when l >= 0 1st or 4th quadrant
-            //   when l < 0  2nd or 3rd quadrant
-            // atan returns values between -M_PI / 2 and M_PI / 2
-            //IDLog("L %f M %F N %f l %f m %f n %f, Taki alignedaz %f\n", L, M, N, l, m, n, alignedaz);
-            //From Taki to kstars azimuth
-            alignedaz = range360(-180.0 - alignedaz);
-
-            alignedalt = asin(n) * 180.0 / M_PI;
-
-            pointset->RaDecFromAltAz(alignedalt, alignedaz, jd, alignedRA, alignedDEC, position);
-            currentdeltaRA  = *alignedRA - currentRA;
-            currentdeltaDEC = *alignedDEC - currentDEC;
-            LOGF_INFO("GOTO ALign NStar: delta RA = %f, delta DEC  = %f alt=%f az=%f",
-                      currentdeltaRA, currentdeltaDEC, alignedalt, alignedaz);
-        }
-        //IDLog("ALign NStar: delta RA = %f, delta DEC = %f\n", (*alignedRA - currentRA), (*alignedDEC - currentDEC));
+            LOG_DEBUG("Align: current face is empty");
+    }
+    lastface = face;
+
+    if (face < 0)
+    {
+        //IDLog("AlignNstar: position outside of the triangulation - using Nearest mode\n");
+        AlignNearest(jd, position, currentRA, currentDEC, alignedRA, alignedDEC, ingoto);
+        return;
     }
+
+    lst = ln_get_apparent_sidereal_time(jd);
+    lst += (position->longitude / 15.0);
+    lst = range24(lst);
+
+    if (!(ingoto))
+    {
+        FaceTransform *f = &faceTransforms[face];
+        double l, m, n;
+        double L, M, N;
+
+        l = cos(pointalt * M_PI / 180.0) * cos(range360(-180.0 - pointaz) * M_PI / 180.0);
+        m = cos(pointalt * M_PI / 180.0) * sin(range360(-180.0 - pointaz) * M_PI / 180.0);
+        n = sin(pointalt * M_PI / 180.0);
+
+        L = f->invT[0][0] * l + f->invT[0][1] * m + f->invT[0][2] * n;
+        M = f->invT[1][0] * l + f->invT[1][1] * m + f->invT[1][2] * n;
+        N = f->invT[2][0] * l + f->invT[2][1] * m + f->invT[2][2] * n;
+
+        *alignedRA = atan(M / L) * 12.0 / M_PI;
+        //IDLog("Aligning RA = %g L=%g at LST = %g (point alt = %g az = %g)\n", *alignedRA, L, lst, pointalt, pointaz);
+        if (L < 0.0)
+            *alignedRA += 12.0;
+        *alignedRA = range24(*alignedRA + lst);
+
+        *alignedDEC = asin(N) * 180.0 / M_PI;
+    }
+    else
+    {
+        double alignedalt, alignedaz;
+
+        CelestialToTelescope(&faceTransforms[face], lst, currentRA, currentDEC, &alignedalt, &alignedaz);
+
+        pointset->RaDecFromAltAz(alignedalt, alignedaz, jd, alignedRA, alignedDEC, position);
+        currentdeltaRA  = *alignedRA - currentRA;
+        currentdeltaDEC = *alignedDEC - currentDEC;
+        LOGF_INFO("GOTO ALign NStar: delta RA = %f, delta DEC  = %f alt=%f az=%f",
+                  currentdeltaRA, currentdeltaDEC, alignedalt, alignedaz);
+    }
+    //IDLog("ALign NStar: delta RA = %f, delta DEC = %f\n", (*alignedRA - currentRA), (*alignedDEC - currentDEC));
 }
 
 void Align::AlignNearest(double jd, INDI::IGeographicCoordinates *position, double currentRA, double currentDEC,
                          double *alignedRA, double *alignedDEC, bool ingoto)
 {
-    //double pointaz = (pointset->range24(lst - currentRA - 12.0) * 360.0) / 24.0;
-    //double pointalt = currentDEC + pointset->lat;
     double pointaz, pointalt;
-    std::set<PointSet::Distance, bool (*)(PointSet::Distance, PointSet::Distance)> *sortedpoints;
+    PointSet::Point *point;
     pointset->AltAzFromRaDec(currentRA, currentDEC, jd, &pointalt, &pointaz, position);
-    sortedpoints = pointset->ComputeDistances(pointalt, pointaz, PointSet::None, ingoto);
-    if (sortedpoints->empty())
+    point = pointset->findNearest(pointalt, pointaz, ingoto);
+    if (!point)
     {
         *alignedRA  = currentRA;
         *alignedDEC = currentDEC;
@@ -408,7 +431,6 @@ void Align::AlignNearest(double jd, INDI::IGeographicCoordinates *position, doub
     }
     else
     {
-        PointSet::Point *point = pointset->getPoint(sortedpoints->begin()->htmID);
         if (lastnearestindex != point->index)
             LOGF_INFO("Align: current point is %d\n", point->index);
         lastnearestindex = point->index;
@@ -495,6 +517,7 @@ void Align::AlignSync(SyncData globalsync, SyncData thissync)
     syncdata.telescopeDEC = thissync.telescopeDEC;
 
     pointset->AddPoint(syncdata, nullptr);
+    JournalDataFile(false);
     DEBUGF(INDI::Logger::DBG_SESSION,
            "Align Sync: point added: lst=%.8f celestial RA %.8f DEC %.8f Telescope RA %.8f DEC %.8f", syncdata.lst,
            syncdata.targetRA, syncdata.targetDEC, syncdata.telescopeRA, syncdata.telescopeDEC);
@@ -634,6 +657,7 @@ bool Align::ISNewSwitch(const char *dev, const char *name, ISState *states, char
             if (!strcmp(sw->name, "ALIGNLISTADD"))
             {
                 pointset->AddPoint(syncdata, nullptr);
+                JournalDataFile(false);
                 IDMessage(telescope->getDeviceName(), "Align: added point to list");
                 ;
                 pointset->setBlobData(AlignDataBP);
@@ -646,6 +670,7 @@ bool Align::ISNewSwitch(const char *dev, const char *name, ISState *states, char
             else if (!strcmp(sw->name, "ALIGNLISTCLEAR"))
             {
                 pointset->Reset();
+                JournalDataFile(true);
                 IDMessage(telescope->getDeviceName(), "Align: list cleared");
                 ;
                 pointset->setBlobData(AlignDataBP);
@@ -734,6 +759,19 @@ bool Align::ISNewBLOB(const char *dev, const char *name, int sizes[], int blobsi
     return false;
 }
 
+/* Binary data files keep up with the list: new points and clears are appended to them */
+void Align::JournalDataFile(bool clear)
+{
+    char *filename = IUFindText(AlignDataFileTP, "ALIGNDATAFILENAME")->text;
+    char *res;
+
+    if (!PointSet::isBinaryDataFile(filename))
+        return;
+    res = clear ? pointset->JournalClear(filename) : pointset->JournalPoint(filename, syncdata);
+    if (res)
+        IDMessage(telescope->getDeviceName(), "Can not journal Align Data to file %s: %s", filename, res);
+}
+
 bool Align::saveConfigItems(FILE *fp)
 {
     if (AlignModeSP)
@@ -21,6 +21,8 @@
 
 #include <inditelescope.h>
 
+#include <vector>
+
 typedef struct SyncData SyncData;
 
 class Align
@@ -47,12 +49,35 @@ class Align
 
         AlignData syncdata;
 
+        /* Taki's transformation for one face of the triangulation, T maps celestial
+           to telescope direction cosines. The edge normals and center directions of the celestial
+           and telescope triangles locate a position in the face without going through the point set. */
+        typedef struct FaceTransform
+        {
+            HtmID v[3];
+            double celestialEdges[3][3], celestialCenter[3];
+            double telescopeEdges[3][3], telescopeCenter[3];
+            double T[3][3];
+            double invT[3][3];
+        } FaceTransform;
+
         enum AlignmentMode GetAlignmentMode();
+        void JournalDataFile(bool clear);
+        void UpdateFaceTransforms();
+        bool InsideFace(FaceTransform *face, bool ingoto, const double p[3]);
+        int LocateFace(double alt, double az, bool ingoto, int hint);
+        void CelestialToTelescope(FaceTransform *face, double lst, double ra, double dec, double *alt, double *az);
 
         double currentdeltaRA, currentdeltaDEC;
 
         int lastnearestindex;
 
+        // Face transforms are rebuilt when the point set revision changes
+        std::vector<FaceTransform> faceTransforms;
+        std::map<HtmID, std::vector<int>> vertexFaces;
+        unsigned long faceTransformsRevision;
+        int lastface;
+
     public:
         Align(INDI::Telescope *);
         virtual ~Align();
@@ -0,0 +1,118 @@
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "kdtree.h"
+
+#include <algorithm>
+
+KDTree::KDTree()
+{
+}
+
+void KDTree::Reset()
+{
+    nodes.clear();
+}
+
+void KDTree::AddPoint(HtmID id, double x, double y, double z)
+{
+    Node node;
+    node.p[0] = x;
+    node.p[1] = y;
+    node.p[2] = z;
+    node.id   = id;
+    node.axis = 0;
+    nodes.push_back(node);
+}
+
+void KDTree::Build()
+{
+    build(0, nodes.size());
+}
+
+bool KDTree::isEmpty() const
+{
+    return nodes.empty();
+}
+
+void KDTree::build(int begin, int end)
+{
+    if (end - begin < 2)
+        return;
+    // split along the axis of largest extent
+    double lo[3] = { 2.0, 2.0, 2.0 }, hi[3] = { -2.0, -2.0, -2.0 };
+    for (int i = begin; i < end; i++)
+        for (int k = 0; k < 3; k++)
+        {
+            lo[k] = std::min(lo[k], nodes[i].p[k]);
+            hi[k] = std::max(hi[k], nodes[i].p[k]);
+        }
+    int axis = 0;
+    for (int k = 1; k < 3; k++)
+        if (hi[k] - lo[k] > hi[axis] - lo[axis])
+            axis = k;
+    int mid = (begin + end) / 2;
+    std::nth_element(nodes.begin() + begin, nodes.begin() + mid, nodes.begin() + end,
+                     [axis](const Node &a, const Node &b)
+    {
+        return a.p[axis] < b.p[axis];
+    });
+    nodes[mid].axis = axis;
+    build(begin, mid);
+    build(mid + 1, end);
+}
+
+HtmID KDTree::Nearest(double x, double y, double z) const
+{
+    double q[3] = { x, y, z };
+    int best     = -1;
+    double bestd = 0.0;
+    search(0, nodes.size(), q, &best, &bestd);
+    return nodes[best].id;
+}
+
+void KDTree::search(int begin, int end, const double q[3], int *best, double *bestd) const
+{
+    if (begin >= end)
+        return;
+    int mid          = (begin + end) / 2;
+    const Node &node = nodes[mid];
+    double dx        = node.p[0] - q[0];
+    double dy        = node.p[1] - q[1];
+    double dz        = node.p[2] - q[2];
+    double d         = dx * dx + dy * dy + dz * dz;
+    if (*best < 0 || d < *bestd || (d == *bestd && node.id < nodes[*best].id))
+    {
+        *best  = mid;
+        *bestd = d;
+    }
+    if (end - begin == 1)
+        return;
+    double delta = q[node.axis] - node.p[node.axis];
+    // visit the side of the query first, the other one only if the split plane is close enough
+    if (delta < 0)
+    {
+        search(begin, mid, q, best, bestd);
+        if (delta * delta <= *bestd)
+            search(mid + 1, end, q, best, bestd);
+    }
+    else
+    {
+        search(mid + 1, end, q, best, bestd);
+        if (delta * delta <= *bestd)
+            search(begin, mid, q, best, bestd);
+    }
+}
@@ -0,0 +1,50 @@
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "htm.h"
+
+#include <vector>
+
+/* 3-d tree of align points given by their direction cosines.
+   On the unit sphere the nearest point in chord length is also the nearest in angle,
+   so this answers the nearest align point queries without sorting the whole set. */
+class KDTree
+{
+  public:
+    KDTree();
+    void Reset();
+    void AddPoint(HtmID id, double x, double y, double z);
+    // Balance the tree, call once all points are added
+    void Build();
+    bool isEmpty() const;
+    // Nearest point to the (unit) vector x, y, z. Ties go to the lowest HtmID.
+    // Must not be called on an empty tree.
+    HtmID Nearest(double x, double y, double z) const;
+
+  private:
+    typedef struct Node
+    {
+        double p[3];
+        HtmID id;
+        int axis;
+    } Node;
+    void build(int begin, int end);
+    void search(int begin, int end, const double q[3], int *best, double *bestd) const;
+    // Nodes are stored in implicit order: the median of a range is its root
+    std::vector<Node> nodes;
+};
@@ -24,10 +24,84 @@
 #include <libnova/sidereal_time.h>
 #include <libnova/transform.h>
 
+#include <algorithm>
 #include <math.h>
+#include <stdint.h>
 #include <string.h>
+#include <unistd.h>
 #include <wordexp.h>
 
+/* Binary align data file: a header followed by a journal of records.
+   header: "EQAL" magic, uint32 version, site longitude, latitude, elevation (doubles)
+   record: uint8 type, payload, uint32 FNV-1a checksum of type and payload
+   A POINT record carries lst, jd, target RA/DEC and telescope RA/DEC (doubles),
+   a CLEAR record has no payload and empties the list.
+   All fields are little endian. A torn or corrupt record ends the journal. */
+#define ALIGN_BINARY_MAGIC "EQAL"
+#define ALIGN_BINARY_VERSION 1
+#define ALIGN_BINARY_HEADER_SIZE (4 + 4 + 3 * 8)
+#define ALIGN_RECORD_POINT 1
+#define ALIGN_RECORD_CLEAR 2
+#define ALIGN_RECORD_MAX_SIZE (1 + 6 * 8 + 4)
+/* Compact the journal when it holds more than twice the live points (plus some slack) */
+#define ALIGN_JOURNAL_SLACK 16
+
+static void putLE32(unsigned char *b, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        b[i] = (v >> (8 * i)) & 0xff;
+}
+
+static uint32_t getLE32(const unsigned char *b)
+{
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--)
+        v = (v << 8) | b[i];
+    return v;
+}
+
+static void putLEDouble(unsigned char *b, double d)
+{
+    uint64_t v;
+    memcpy(&v, &d, sizeof(v));
+    for (int i = 0; i < 8; i++)
+        b[i] = (v >> (8 * i)) & 0xff;
+}
+
+static double getLEDouble(const unsigned char *b)
+{
+    uint64_t v = 0;
+    double d;
+    for (int i = 7; i >= 0; i--)
+        v = (v << 8) | b[i];
+    memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+static uint32_t fnv1a(const unsigned char *b, size_t n)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ b[i]) * 16777619u;
+    return h;
+}
+
+/* Encode a record in buf, returns its size */
+static size_t encodeRecord(unsigned char *buf, unsigned char type, AlignData *aligndata)
+{
+    size_t n = 0;
+    buf[n++] = type;
+    if (type == ALIGN_RECORD_POINT)
+    {
+        double values[6] = { aligndata->lst, aligndata->jd, aligndata->targetRA, aligndata->targetDEC,
+                             aligndata->telescopeRA, aligndata->telescopeDEC };
+        for (int i = 0; i < 6; i++, n += 8)
+            putLEDouble(buf + n, values[i]);
+    }
+    putLE32(buf + n, fnv1a(buf, n));
+    return n + 4;
+}
+
 void PointSet::AltAzFromRaDec(double ra, double dec, double jd, double *alt, double *az, INDI::IGeographicCoordinates *pos)
 {
     INDI::IEquatorialCoordinates lnradec;
@@ -121,6 +195,11 @@ PointSet::PointSet(INDI::Telescope *t)
     telescope  = t;
     lnalignpos = nullptr;
     PointSetInitialized = false;
+    journalEnd     = 0;
+    journalRecords = 0;
+    // the nearest point index is built for revision 0, which is never used
+    revision        = 1;
+    nearestRevision = 0;
 }
 
 const char *PointSet::getDeviceName()
@@ -198,6 +277,7 @@ void PointSet::AddPoint(AlignData aligndata, INDI::IGeographicCoordinates *pos)
     point.index = getNbPoints();
     PointSetMap->insert(std::pair<HtmID, Point>(point.htmID, point));
     Triangulation->AddPoint(point.htmID);
+    revision++;
     LOGF_INFO("Align Pointset: added point %d alt = %g az = %g\n", point.index,
               point.celestialALT, point.celestialAZ);
     LOGF_INFO("Align Triangulate: number of faces is %d\n", Triangulation->getFaces().size());
@@ -218,6 +298,47 @@ int PointSet::getNbTriangles()
     return Triangulation->getFaces().size();
 }
 
+std::vector<Face *> PointSet::getFaces()
+{
+    return Triangulation->getFaces();
+}
+
+unsigned long PointSet::getRevision()
+{
+    return revision;
+}
+
+void PointSet::UpdateNearestIndex()
+{
+    std::map<HtmID, Point>::iterator it;
+    if (nearestRevision == revision)
+        return;
+    celestialTree.Reset();
+    telescopeTree.Reset();
+    for (it = PointSetMap->begin(); it != PointSetMap->end(); it++)
+    {
+        celestialTree.AddPoint(it->first, it->second.cx, it->second.cy, it->second.cz);
+        telescopeTree.AddPoint(it->first, it->second.tx, it->second.ty, it->second.tz);
+    }
+    celestialTree.Build();
+    telescopeTree.Build();
+    nearestRevision = revision;
+}
+
+PointSet::Point *PointSet::findNearest(double alt, double az, bool ingoto)
+{
+    double horangle, altangle;
+    KDTree *tree;
+    if (nearestRevision != revision)
+        UpdateNearestIndex();
+    tree = ingoto ? &celestialTree : &telescopeTree;
+    if (tree->isEmpty())
+        return nullptr;
+    horangle = range360(-180.0 - az) * M_PI / 180.0;
+    altangle = alt * M_PI / 180.0;
+    return getPoint(tree->Nearest(cos(altangle) * cos(horangle), cos(altangle) * sin(horangle), sin(altangle)));
+}
+
 bool PointSet::isInitialized()
 {
     return  PointSetInitialized;
@@ -235,6 +356,7 @@ void PointSet::Init()
 void PointSet::Reset()
 {
     current.clear();
+    revision++;
     if (PointSetMap)
     {
         PointSetMap->clear();
@@ -273,12 +395,23 @@ char *PointSet::LoadDataFile(const char *filename)
         wordfree(&wexp);
         return strerror(errno);
     }
+    // Binary data files are recognized by their content, whatever their name
+    char magic[4];
+    if (fread(magic, 1, 4, fp) == 4 && !memcmp(magic, ALIGN_BINARY_MAGIC, 4))
+    {
+        char *res = LoadBinaryFile(fp, wexp.we_wordv[0]);
+        fclose(fp);
+        wordfree(&wexp);
+        return res;
+    }
+    rewind(fp);
     wordfree(&wexp);
     lp = newLilXML();
     if (PointSetXmlRoot)
         delXMLEle(PointSetXmlRoot);
     PointSetXmlRoot = readXMLFile(fp, lp, errmsg);
     delLilXML(lp);
+    fclose(fp);
     if (!PointSetXmlRoot)
         return errmsg;
     if (!strcmp(tagXMLEle(nextXMLEle(PointSetXmlRoot, 1)), "aligndata"))
@@ -315,6 +448,7 @@ char *PointSet::LoadDataFile(const char *filename)
     lnalignpos->longitude = lon;
     lnalignpos->latitude = lat;
     PointSetMap->clear();
+    revision++;
     alignxml     = nextXMLEle(sitexml, 1);
     aligndata.jd = -1.0;
     while (alignxml)
@@ -359,19 +493,260 @@ char *PointSet::WriteDataFile(const char *filename)
                 (fabs(lnalignpos->latitude - IUFindNumber(telescope->getNumber("GEOGRAPHIC_COORD"), "LAT")->value) > 1E-4))
             return (char *)("Can not mix alignment data from different sites (lng. and/or lat. differs)");
     }
+    if (isBinaryDataFile(wexp.we_wordv[0]))
+    {
+        char *res = WriteBinaryFile(wexp.we_wordv[0]);
+        wordfree(&wexp);
+        return res;
+    }
     //if (filename == nullptr) return;
     if (!(fp = fopen(wexp.we_wordv[0], "w")))
     {
         wordfree(&wexp);
         return strerror(errno);
     }
+    wordfree(&wexp);
     root = toXML();
 
     prXMLEle(fp, root, 0);
     fclose(fp);
+    delXMLEle(root);
+    return nullptr;
+}
+
+bool PointSet::isBinaryDataFile(const char *filename)
+{
+    size_t len = strlen(filename);
+    return (len > 4) && !strcmp(filename + len - 4, ".bin");
+}
+
+void PointSet::getSite(double site[3])
+{
+    if (lnalignpos)
+    {
+        site[0] = lnalignpos->longitude;
+        site[1] = lnalignpos->latitude;
+        site[2] = alt;
+    }
+    else
+    {
+        site[0] = IUFindNumber(telescope->getNumber("GEOGRAPHIC_COORD"), "LONG")->value;
+        site[1] = IUFindNumber(telescope->getNumber("GEOGRAPHIC_COORD"), "LAT")->value;
+        site[2] = IUFindNumber(telescope->getNumber("GEOGRAPHIC_COORD"), "ELEV")->value;
+    }
+}
+
+/* Read the header and the journal of a binary data file positioned after the magic,
+   replaying the records into the point set. */
+char *PointSet::ScanBinaryFile(FILE *fp, double site[3], long *end, int *records)
+{
+    unsigned char buf[ALIGN_RECORD_MAX_SIZE];
+
+    if (fread(buf, 1, ALIGN_BINARY_HEADER_SIZE - 4, fp) != ALIGN_BINARY_HEADER_SIZE - 4)
+        return (char *)"Truncated align data header";
+    if (getLE32(buf) != ALIGN_BINARY_VERSION)
+        return (char *)"Unsupported align data file version";
+    for (int i = 0; i < 3; i++)
+        site[i] = getLEDouble(buf + 4 + 8 * i);
+
+    if (lnalignpos)
+        free(lnalignpos);
+    lnalignpos = (INDI::IGeographicCoordinates *)malloc(sizeof(INDI::IGeographicCoordinates));
+    lnalignpos->longitude = lon = site[0];
+    lnalignpos->latitude = lat = site[1];
+    alt = site[2];
+    PointSetMap->clear();
+    Triangulation->Reset();
+    current.clear();
+    revision++;
+
+    *end     = ALIGN_BINARY_HEADER_SIZE;
+    *records = 0;
+    while (fread(buf, 1, 1, fp) == 1)
+    {
+        size_t payload = (buf[0] == ALIGN_RECORD_POINT) ? 6 * 8 : (buf[0] == ALIGN_RECORD_CLEAR) ? 0 : SIZE_MAX;
+        if (payload == SIZE_MAX || fread(buf + 1, 1, payload + 4, fp) != payload + 4 ||
+                getLE32(buf + 1 + payload) != fnv1a(buf, 1 + payload))
+        {
+            IDLog("Align: ignoring align data after offset %ld (torn or corrupt record)\n", *end);
+            break;
+        }
+        if (buf[0] == ALIGN_RECORD_POINT)
+        {
+            AlignData aligndata;
+            aligndata.lst          = getLEDouble(buf + 1);
+            aligndata.jd           = getLEDouble(buf + 9);
+            aligndata.targetRA     = getLEDouble(buf + 17);
+            aligndata.targetDEC    = getLEDouble(buf + 25);
+            aligndata.telescopeRA  = getLEDouble(buf + 33);
+            aligndata.telescopeDEC = getLEDouble(buf + 41);
+            AddPoint(aligndata, lnalignpos);
+        }
+        else if (buf[0] == ALIGN_RECORD_CLEAR)
+        {
+            PointSetMap->clear();
+            Triangulation->Reset();
+            current.clear();
+            revision++;
+        }
+        *end += 1 + payload + 4;
+        (*records)++;
+    }
+    return nullptr;
+}
+
+char *PointSet::LoadBinaryFile(FILE *fp, const char *path)
+{
+    double site[3];
+    long end;
+    int records;
+    char *res = ScanBinaryFile(fp, site, &end, &records);
+    if (res)
+        return res;
+
+    journalPath    = path;
+    journalEnd     = end;
+    journalRecords = records;
+    IDLog("Align: load binary file (lon %f lat %f alt %f), %d records, %d points\n", lon, lat, alt, records,
+          getNbPoints());
+    return nullptr;
+}
+
+/* Write the live points as a fresh journal, replacing the file atomically */
+char *PointSet::WriteBinaryFile(const char *path)
+{
+    static char errmsg[512];
+    std::string tmppath = std::string(path) + ".tmp";
+    std::vector<Point *> points;
+    std::vector<unsigned char> data;
+    unsigned char buf[ALIGN_RECORD_MAX_SIZE];
+    double site[3];
+    FILE *fp;
+
+    for (auto &p : *PointSetMap)
+        points.push_back(&p.second);
+    std::sort(points.begin(), points.end(), [](Point * a, Point * b)
+    {
+        return a->index < b->index;
+    });
+
+    getSite(site);
+    data.reserve(ALIGN_BINARY_HEADER_SIZE + points.size() * ALIGN_RECORD_MAX_SIZE);
+    data.insert(data.end(), ALIGN_BINARY_MAGIC, ALIGN_BINARY_MAGIC + 4);
+    putLE32(buf, ALIGN_BINARY_VERSION);
+    for (int i = 0; i < 3; i++)
+        putLEDouble(buf + 4 + 8 * i, site[i]);
+    data.insert(data.end(), buf, buf + ALIGN_BINARY_HEADER_SIZE - 4);
+    for (Point *p : points)
+    {
+        size_t n = encodeRecord(buf, ALIGN_RECORD_POINT, &p->aligndata);
+        data.insert(data.end(), buf, buf + n);
+    }
+
+    if (!(fp = fopen(tmppath.c_str(), "wb")))
+        return strerror(errno);
+    if (fwrite(data.data(), 1, data.size(), fp) != data.size() || fflush(fp) != 0 || fsync(fileno(fp)) != 0)
+    {
+        snprintf(errmsg, sizeof(errmsg), "%s", strerror(errno));
+        fclose(fp);
+        unlink(tmppath.c_str());
+        return errmsg;
+    }
+    fclose(fp);
+    if (rename(tmppath.c_str(), path) != 0)
+    {
+        snprintf(errmsg, sizeof(errmsg), "%s", strerror(errno));
+        unlink(tmppath.c_str());
+        return errmsg;
+    }
+
+    journalPath    = path;
+    journalEnd     = data.size();
+    journalRecords = points.size();
     return nullptr;
 }
 
+char *PointSet::AppendJournal(const char *filename, unsigned char type, AlignData *aligndata)
+{
+    wordexp_t wexp;
+    unsigned char buf[ALIGN_RECORD_MAX_SIZE];
+    double site[3];
+    FILE *fp;
+    char *res = nullptr;
+
+    if (wordexp(filename, &wexp, 0))
+    {
+        wordfree(&wexp);
+        return (char *)("Badly formed filename");
+    }
+    std::string path = wexp.we_wordv[0];
+    wordfree(&wexp);
+
+    if (!(fp = fopen(path.c_str(), "r+b")))
+    {
+        // No file yet: start the journal with the current list
+        if (errno != ENOENT)
+            return strerror(errno);
+        return WriteBinaryFile(path.c_str());
+    }
+
+    // Only the file last loaded or written holds the live list, appending to any other one
+    // and compacting it later would drop the points it holds
+    if (path != journalPath)
+    {
+        fclose(fp);
+        return (char *)("File was not loaded, load or write it before journaling to it");
+    }
+
+    char magic[4];
+    if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, ALIGN_BINARY_MAGIC, 4))
+        res = (char *)"Not a binary align data file";
+    else if (fread(buf, 1, ALIGN_BINARY_HEADER_SIZE - 4, fp) != ALIGN_BINARY_HEADER_SIZE - 4)
+        res = (char *)"Truncated align data header";
+    else
+    {
+        site[0] = getLEDouble(buf + 4);
+        site[1] = getLEDouble(buf + 12);
+    }
+    // New points are computed for the current site, as in WriteDataFile
+    if (!res && ((fabs(site[0] - IUFindNumber(telescope->getNumber("GEOGRAPHIC_COORD"), "LONG")->value) > 1E-4) ||
+                 (fabs(site[1] - IUFindNumber(telescope->getNumber("GEOGRAPHIC_COORD"), "LAT")->value) > 1E-4)))
+        res = (char *)("Can not mix alignment data from different sites (lng. and/or lat. differs)");
+    if (res)
+    {
+        fclose(fp);
+        return res;
+    }
+
+    // Drop a torn record left by an interrupted append before writing after it
+    size_t n = encodeRecord(buf, type, aligndata);
+    if (ftruncate(fileno(fp), journalEnd) != 0 || fseek(fp, journalEnd, SEEK_SET) != 0 ||
+            fwrite(buf, 1, n, fp) != n || fflush(fp) != 0)
+    {
+        // The next append truncates whatever part of the record made it to the file
+        res = strerror(errno);
+        fclose(fp);
+        return res;
+    }
+    fclose(fp);
+    journalEnd += n;
+    journalRecords++;
+
+    if (journalRecords > 2 * getNbPoints() + ALIGN_JOURNAL_SLACK)
+        return WriteBinaryFile(path.c_str());
+    return nullptr;
+}
+
+char *PointSet::JournalPoint(const char *filename, AlignData aligndata)
+{
+    return AppendJournal(filename, ALIGN_RECORD_POINT, &aligndata);
+}
+
+char *PointSet::JournalClear(const char *filename)
+{
+    return AppendJournal(filename, ALIGN_RECORD_CLEAR, nullptr);
+}
+
 XMLEle *PointSet::toXML()
 {
     AlignData aligndata;
@@ -18,9 +18,12 @@
 #pragma once
 
 #include "htm.h"
+#include "kdtree.h"
 
 #include <map>
 #include <set>
+#include <stdio.h>
+#include <string>
 #include <vector>
 
 // to get access to lat/long data
@@ -68,6 +71,10 @@ class PointSet
         void Reset();
         char *LoadDataFile(const char *filename);
         char *WriteDataFile(const char *filename);
+        // Binary data files (.bin) are journaled: syncs and clears are appended, not rewritten
+        static bool isBinaryDataFile(const char *filename);
+        char *JournalPoint(const char *filename, AlignData aligndata);
+        char *JournalClear(const char *filename);
         XMLEle *toXML();
         void setBlobData(IBLOBVectorProperty *bp);
         void setPointBlobData(IBLOB *blob);
@@ -76,6 +83,13 @@ class PointSet
                 bool ingoto);
         std::vector<HtmID> findFace(double currentRA, double currentDEC, double jd, double pointalt, double pointaz,
                                     INDI::IGeographicCoordinates *position, bool ingoto);
+        std::vector<Face *> getFaces();
+        // Changes whenever points are added or the set is reset, to invalidate derived data
+        unsigned long getRevision();
+        // Nearest point in celestial (ingoto) or telescope coordinates, nullptr if the set is empty.
+        // Safe to call from several threads once UpdateNearestIndex() has been called for this revision.
+        Point *findNearest(double alt, double az, bool ingoto);
+        void UpdateNearestIndex();
         double lat, lon, alt;
         void AltAzFromRaDec(double ra, double dec, double jd, double *alt, double *az, INDI::IGeographicCoordinates *pos);
         void AltAzFromRaDecSidereal(double ra, double dec, double lst, double *alt, double *az, INDI::IGeographicCoordinates *pos);
@@ -85,6 +99,11 @@ class PointSet
 
     protected:
     private:
+        char *LoadBinaryFile(FILE *fp, const char *path);
+        char *WriteBinaryFile(const char *path);
+        char *AppendJournal(const char *filename, unsigned char type, AlignData *aligndata);
+        char *ScanBinaryFile(FILE *fp, double site[3], long *end, int *records);
+        void getSite(double site[3]);
         XMLEle *PointSetXmlRoot;
         std::map<HtmID, Point> *PointSetMap;
         bool PointSetInitialized;
@@ -95,5 +114,12 @@ class PointSet
         INDI::Telescope *telescope;
         // from align data file
         INDI::IGeographicCoordinates *lnalignpos;
+        // binary data file the journal state below refers to
+        std::string journalPath;
+        long journalEnd;
+        int journalRecords;
+        unsigned long revision;
+        unsigned long nearestRevision;
+        KDTree celestialTree, telescopeTree;
         friend class TriangulateCHull;
 };
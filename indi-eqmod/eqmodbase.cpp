@@ -36,6 +36,8 @@
 
 #include <cmath>
 #include <memory>
+#include <vector>
+#include <algorithm>
 #include <cstring>
 #include <unistd.h>
 #include <assert.h>
@@ -64,6 +66,7 @@ using namespace INDI::AlignmentSubsystem;
 #define GOTO_ITERATIVE_LIMIT 5 /* Max GOTO Iterations */
 #define RAGOTORESOLUTION     5 /* GOTO Resolution in arcsecs */
 #define DEGOTORESOLUTION     5 /* GOTO Resolution in arcsecs */
+#define GOTO_PATH_STEP       1.0 /* Distance between goto path samples checked against horizon limits, degrees */
 
 /* Preset Slew Speeds */
 #define SLEWMODES 11
@@ -311,6 +314,7 @@ void EQMod::ISGetProperties(const char *dev)
         defineProperty(SlewSpeedsNP);
         defineProperty(GuideRateNP);
         defineProperty(PulseLimitsNP);
+        defineProperty(GuideEdgesNP);
         defineProperty(MountInformationTP);
         defineProperty(SteppersNP);
         defineProperty(CurrentSteppersNP);
@@ -397,6 +401,7 @@ bool EQMod::loadProperties()
     PulseLimitsNP  = getNumber("PULSE_LIMITS");
     MinPulseN      = IUFindNumber(PulseLimitsNP, "MIN_PULSE");
     MinPulseTimerN = IUFindNumber(PulseLimitsNP, "MIN_PULSE_TIMER");
+    GuideEdgesNP   = getNumber("GUIDE_EDGES");
 
     MountInformationTP = getText("MOUNTINFORMATION");
     SteppersNP         = getNumber("STEPPERS");
@@ -470,6 +475,7 @@ bool EQMod::updateProperties()
         defineProperty(SlewSpeedsNP);
         defineProperty(GuideRateNP);
         defineProperty(PulseLimitsNP);
+        defineProperty(GuideEdgesNP);
         defineProperty(MountInformationTP);
         defineProperty(SteppersNP);
         defineProperty(CurrentSteppersNP);
@@ -626,6 +632,7 @@ bool EQMod::updateProperties()
         deleteProperty(GuideWENP.name);
         deleteProperty(GuideRateNP->name);
         deleteProperty(PulseLimitsNP->name);
+        deleteProperty(GuideEdgesNP->name);
         deleteProperty(MountInformationTP->name);
         deleteProperty(SteppersNP->name);
         deleteProperty(CurrentSteppersNP->name);
@@ -852,6 +859,7 @@ bool EQMod::ReadScopeStatus()
     try
     {
         TelescopePierSide pierSide;
+        mount->PrefetchStatus();
         currentRAEncoder = mount->GetRAEncoder();
         currentDEEncoder = mount->GetDEEncoder();
         DEBUGF(DBG_SCOPE_STATUS, "Current encoders RA=%ld DE=%ld", static_cast<long>(currentRAEncoder),
@@ -1809,6 +1817,37 @@ bool EQMod::gotoInProgress()
     return (!gotoparams.completed);
 }
 
+#ifdef WITH_SCOPE_LIMITS
+// Both axes slew at the same rate, so the axis with the shorter move stops first.
+// Sample that path in encoder space, which follows meridian flips, and test it against the horizon.
+bool EQMod::inGotoPathLimits(GotoParams *g, double lst, double juliandate)
+{
+    double const radegrees = (static_cast<double>(g->ratargetencoder) - g->racurrentencoder) * 360.0 / totalRAEncoder;
+    double const dedegrees = (static_cast<double>(g->detargetencoder) - g->decurrentencoder) * 360.0 / totalDEEncoder;
+    double const length    = std::max(std::fabs(radegrees), std::fabs(dedegrees));
+    int const n            = static_cast<int>(std::ceil(length / GOTO_PATH_STEP)) + 1;
+    std::vector<double> az(n), alt(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        double const travel = (n > 1) ? length * i / (n - 1) : 0.0;
+        double const ra     = std::copysign(std::min(travel, std::fabs(radegrees)), radegrees);
+        double const de     = std::copysign(std::min(travel, std::fabs(dedegrees)), dedegrees);
+        uint32_t const raencoder = static_cast<uint32_t>(g->racurrentencoder + std::lround(ra * totalRAEncoder / 360.0));
+        uint32_t const deencoder = static_cast<uint32_t>(g->decurrentencoder + std::lround(de * totalDEEncoder / 360.0));
+
+        INDI::IEquatorialCoordinates pathradec;
+        INDI::IHorizontalCoordinates pathaltaz;
+        EncodersToRADec(raencoder, deencoder, lst, &pathradec.rightascension, &pathradec.declination, nullptr, nullptr);
+        INDI::EquatorialToHorizontal(&pathradec, &m_Location, juliandate, &pathaltaz);
+        az[i]  = pathaltaz.azimuth;
+        alt[i] = pathaltaz.altitude;
+    }
+
+    return horizon->inGotoPathLimits(az.data(), alt.data(), n);
+}
+#endif
+
 bool EQMod::Goto(double r, double d)
 {
     double juliandate;
@@ -1973,6 +2012,18 @@ bool EQMod::Goto(double r, double d)
         return false;
     }
 
+#ifdef WITH_SCOPE_LIMITS
+    if (horizon)
+    {
+        if (!inGotoPathLimits(&gotoparams, lst, juliandate))
+        {
+            LOG_WARN("Goto path crosses Horizon Limits.");
+            gotoparams.completed = true;
+            return false;
+        }
+    }
+#endif
+
     try
     {
         // stop motor
@@ -2227,7 +2278,7 @@ IPState EQMod::GuideNorth(uint32_t ms)
         {
             pulseInProgress |= 1;
             GuideTimerNS = IEAddTimer(ms, (IE_TCF *)timedguideNSCallback, this);
-            mount->StartDETracking(GetDETrackRate() + rateshift);
+            guidePulseEdge(false, GetDETrackRate() + rateshift);
         }
         else
         {
@@ -2236,7 +2287,7 @@ IPState EQMod::GuideNorth(uint32_t ms)
 
             struct timespec starttime, endtime;
             clock_gettime(CLOCK_MONOTONIC, &starttime);
-            mount->StartDETracking(GetDETrackRate() + rateshift);
+            guidePulseEdge(false, GetDETrackRate() + rateshift);
             clock_gettime(CLOCK_MONOTONIC, &endtime);
             double elapsed =
                 (endtime.tv_sec - starttime.tv_sec) * 1000.0 + ((endtime.tv_nsec - starttime.tv_nsec) / 1000000.0);
@@ -2256,7 +2307,7 @@ IPState EQMod::GuideNorth(uint32_t ms)
                         mount->TurnDEPPEC(true);
                     }
                 }
-                mount->StartDETracking(GetDETrackRate());
+                guidePulseEdge(false, GetDETrackRate());
             }
             catch (EQModError e)
             {
@@ -2310,7 +2361,7 @@ IPState EQMod::GuideSouth(uint32_t ms)
         {
             pulseInProgress |= 1;
             GuideTimerNS = IEAddTimer(ms, (IE_TCF *)timedguideNSCallback, this);
-            mount->StartDETracking(GetDETrackRate() - rateshift);
+            guidePulseEdge(false, GetDETrackRate() - rateshift);
         }
         else
         {
@@ -2319,7 +2370,7 @@ IPState EQMod::GuideSouth(uint32_t ms)
 
             struct timespec starttime, endtime;
             clock_gettime(CLOCK_MONOTONIC, &starttime);
-            mount->StartDETracking(GetDETrackRate() - rateshift);
+            guidePulseEdge(false, GetDETrackRate() - rateshift);
             clock_gettime(CLOCK_MONOTONIC, &endtime);
             double elapsed =
                 (endtime.tv_sec - starttime.tv_sec) * 1000.0 + ((endtime.tv_nsec - starttime.tv_nsec) / 1000000.0);
@@ -2339,7 +2390,7 @@ IPState EQMod::GuideSouth(uint32_t ms)
                         mount->TurnDEPPEC(true);
                     }
                 }
-                mount->StartDETracking(GetDETrackRate());
+                guidePulseEdge(false, GetDETrackRate());
             }
             catch (EQModError e)
             {
@@ -2392,7 +2443,7 @@ IPState EQMod::GuideEast(uint32_t ms)
         {
             pulseInProgress |= 2;
             GuideTimerWE = IEAddTimer(ms, (IE_TCF *)timedguideWECallback, this);
-            mount->StartRATracking(GetRATrackRate() - rateshift);
+            guidePulseEdge(true, GetRATrackRate() - rateshift);
         }
         else
         {
@@ -2401,7 +2452,7 @@ IPState EQMod::GuideEast(uint32_t ms)
 
             struct timespec starttime, endtime;
             clock_gettime(CLOCK_MONOTONIC, &starttime);
-            mount->StartRATracking(GetRATrackRate() - rateshift);
+            guidePulseEdge(true, GetRATrackRate() - rateshift);
             clock_gettime(CLOCK_MONOTONIC, &endtime);
             double elapsed =
                 (endtime.tv_sec - starttime.tv_sec) * 1000.0 + ((endtime.tv_nsec - starttime.tv_nsec) / 1000000.0);
@@ -2421,7 +2472,7 @@ IPState EQMod::GuideEast(uint32_t ms)
                         mount->TurnRAPPEC(true);
                     }
                 }
-                mount->StartRATracking(GetRATrackRate());
+                guidePulseEdge(true, GetRATrackRate());
             }
             catch (EQModError e)
             {
@@ -2475,7 +2526,7 @@ IPState EQMod::GuideWest(uint32_t ms)
         {
             pulseInProgress |= 2;
             GuideTimerWE = IEAddTimer(ms, (IE_TCF *)timedguideWECallback, this);
-            mount->StartRATracking(GetRATrackRate() + rateshift);
+            guidePulseEdge(true, GetRATrackRate() + rateshift);
         }
         else
         {
@@ -2484,7 +2535,7 @@ IPState EQMod::GuideWest(uint32_t ms)
 
             struct timespec starttime, endtime;
             clock_gettime(CLOCK_MONOTONIC, &starttime);
-            mount->StartRATracking(GetRATrackRate() + rateshift);
+            guidePulseEdge(true, GetRATrackRate() + rateshift);
             clock_gettime(CLOCK_MONOTONIC, &endtime);
             double elapsed =
                 (endtime.tv_sec - starttime.tv_sec) * 1000.0 + ((endtime.tv_nsec - starttime.tv_nsec) / 1000000.0);
@@ -2504,7 +2555,7 @@ IPState EQMod::GuideWest(uint32_t ms)
                         mount->TurnRAPPEC(true);
                     }
                 }
-                mount->StartRATracking(GetRATrackRate());
+                guidePulseEdge(true, GetRATrackRate());
             }
             catch (EQModError e)
             {
@@ -3467,7 +3518,7 @@ void EQMod::timedguideNSCallback(void *userpointer)
                 p->mount->TurnDEPPEC(true);
             }
         }
-        p->mount->StartDETracking(p->GetDETrackRate());
+        p->guidePulseEdge(false, p->GetDETrackRate());
     }
     catch (EQModError e)
     {
@@ -3498,7 +3549,7 @@ void EQMod::timedguideWECallback(void *userpointer)
                 p->mount->TurnRAPPEC(true);
             }
         }
-        p->mount->StartRATracking(p->GetRATrackRate());
+        p->guidePulseEdge(true, p->GetRATrackRate());
     }
     catch (EQModError e)
     {
@@ -3513,6 +3564,26 @@ void EQMod::timedguideWECallback(void *userpointer)
     IERmTimer(p->GuideTimerWE);
 }
 
+void EQMod::guidePulseEdge(bool ra, double trackspeed)
+{
+    struct timespec starttime, endtime;
+    uint32_t commands = mount->GetCommandCount();
+
+    clock_gettime(CLOCK_MONOTONIC, &starttime);
+    if (ra)
+        mount->GuideRATracking(trackspeed);
+    else
+        mount->GuideDETracking(trackspeed);
+    clock_gettime(CLOCK_MONOTONIC, &endtime);
+
+    double elapsed =
+        (endtime.tv_sec - starttime.tv_sec) * 1000.0 + ((endtime.tv_nsec - starttime.tv_nsec) / 1000000.0);
+    IUFindNumber(GuideEdgesNP, ra ? "GUIDE_EDGE_RA_MS" : "GUIDE_EDGE_DE_MS")->value     = elapsed;
+    IUFindNumber(GuideEdgesNP, ra ? "GUIDE_EDGE_RA_CMDS" : "GUIDE_EDGE_DE_CMDS")->value = mount->GetCommandCount() - commands;
+    GuideEdgesNP->s = IPS_OK;
+    IDSetNumber(GuideEdgesNP, nullptr);
+}
+
 void EQMod::computePolarAlign(SyncData s1, SyncData s2, double lat, double *tpaalt, double *tpaaz)
 /*
 From // // http://www.whim.org/nebula/math/pdf/twostar.pdf
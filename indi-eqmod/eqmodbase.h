@@ -136,6 +136,7 @@ class EQMod : public INDI::Telescope, public INDI::GuiderInterface
         INumber *MinPulseN                   = nullptr;
         INumber *MinPulseTimerN              = nullptr;
         INumberVectorProperty *PulseLimitsNP = nullptr;
+        INumberVectorProperty *GuideEdgesNP  = nullptr;
 
         enum Hemisphere
         {
@@ -182,6 +183,7 @@ class EQMod : public INDI::Telescope, public INDI::GuiderInterface
         double GetDefaultDETrackRate();
         static void timedguideNSCallback(void *userpointer);
         static void timedguideWECallback(void *userpointer);
+        void guidePulseEdge(bool ra, double trackspeed);
         double GetRASlew();
         double GetDESlew();
         bool gotoInProgress();
@@ -272,6 +274,7 @@ class EQMod : public INDI::Telescope, public INDI::GuiderInterface
 
 #ifdef WITH_SCOPE_LIMITS
         HorizonLimits *horizon;
+        bool inGotoPathLimits(GotoParams *g, double lst, double juliandate);
 #endif
         // AutoHoming for EQ8
         static const TelescopeStatus SCOPE_AUTOHOMING = static_cast<TelescopeStatus>(SCOPE_PARKED + 1);
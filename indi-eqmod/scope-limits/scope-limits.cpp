@@ -68,6 +68,7 @@ void HorizonLimits::Reset()
 {
     if (horizon)
         horizon->erase(horizon->begin(), horizon->end());
+    BuildLookupTable();
 }
 void HorizonLimits::Init()
 {
@@ -179,6 +180,7 @@ bool HorizonLimits::ISNewNumber(const char *dev, const char *name, double values
             std::sort(horizon->begin(), horizon->end(), horizonpoint::cmp);
             low          = std::lower_bound(horizon->begin(), horizon->end(), hp, horizonpoint::cmp);
             horizonindex = std::distance(horizon->begin(), low);
+            BuildLookupTable();
             DEBUGF(INDI::Logger::DBG_SESSION,
                    "Horizon Limits: Added point Az = %lf, Alt  = %lf, Rank=%d (Total %d points)", hp.az, hp.alt,
                    horizonindex, horizon->size());
@@ -279,6 +281,7 @@ bool HorizonLimits::ISNewSwitch(const char *dev, const char *name, ISState *stat
                 std::sort(horizon->begin(), horizon->end(), horizonpoint::cmp);
                 low          = std::lower_bound(horizon->begin(), horizon->end(), hp, horizonpoint::cmp);
                 horizonindex = std::distance(horizon->begin(), low);
+                BuildLookupTable();
                 DEBUGF(INDI::Logger::DBG_SESSION,
                        "Horizon Limits: Added point Az = %f, Alt  = %f, Rank=%d (Total %d points)", hp.az, hp.alt,
                        horizonindex, horizon->size());
@@ -300,6 +303,7 @@ bool HorizonLimits::ISNewSwitch(const char *dev, const char *name, ISState *stat
                 LOGF_INFO("Horizon Limits: Deleted point Az = %f, Alt  = %f, Rank=%d",
                           horizon->at(horizonindex).az, horizon->at(horizonindex).alt, horizonindex);
                 horizon->erase(horizon->begin() + horizonindex);
+                BuildLookupTable();
                 if (horizonindex >= (int)horizon->size())
                     horizonindex = horizon->size() - 1;
                 az->value               = horizon->at(horizonindex).az;
@@ -315,6 +319,7 @@ bool HorizonLimits::ISNewSwitch(const char *dev, const char *name, ISState *stat
                 LOG_INFO("Horizon Limits: List cleared");
                 if (horizon)
                     horizon->erase(horizon->begin(), horizon->end());
+                BuildLookupTable();
                 horizonindex            = -1;
                 az->value               = 0.0;
                 alt->value              = 0.0;
@@ -514,6 +519,7 @@ char *HorizonLimits::LoadDataFile(const char *filename)
         pos = 0;
     }
 
+    BuildLookupTable();
     horizonindex            = -1;
     az->value               = 0.0;
     alt->value              = 0.0;
@@ -528,45 +534,89 @@ char *HorizonLimits::LoadDataFile(const char *filename)
     return nullptr;
 }
 
-bool HorizonLimits::inLimits(double raw_az, double raw_alt)
+void HorizonLimits::BuildLookupTable()
 {
-    horizonpoint const scope(raw_az, raw_alt);
+    std::vector<std::pair<double, double>> sorted;
+
+    if (horizon)
+        for (std::vector<horizonpoint>::iterator it = horizon->begin(); it != horizon->end(); ++it)
+            sorted.push_back(std::make_pair(it->az, it->alt));
+
+    // Points may come unordered from a data file
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](std::pair<double, double> const &h1, std::pair<double, double> const &h2)
+    {
+        return h1.first < h2.first;
+    });
+
+    lookupaz.resize(sorted.size());
+    lookupalt.resize(sorted.size());
+    for (size_t i = 0; i < sorted.size(); i++)
+    {
+        lookupaz[i]  = sorted[i].first;
+        lookupalt[i] = sorted[i].second;
+    }
+
+    // Bins use the same azimuth scaling as horizonAltitude, so a bin never starts after the point searched for
+    lookupbins.resize(HORIZON_LOOKUP_BINS + 1);
+    size_t index = 0;
+    for (size_t bin = 0; bin <= HORIZON_LOOKUP_BINS; bin++)
+    {
+        while (index < lookupaz.size() && lookupaz[index] * HORIZON_LOOKUP_BINS / 360.0 < bin)
+            index++;
+        lookupbins[bin] = index;
+    }
+}
+
+double HorizonLimits::horizonAltitude(double raw_az)
+{
+    horizonpoint const scope(raw_az, 0.0);
+    size_t const count = lookupaz.size();
 
     // Minimal altitude is zero if there is no horizon - arguable
-    if (horizon == nullptr || horizon->size() == 0)
-        return scope.alt >= 0.0;
+    if (count == 0)
+        return 0.0;
 
-    // If there is a single horizon point, test altitude directly
-    if (horizon->size() == 1)
-        return scope.alt >= horizon->begin()->alt;
+    // If there is a single horizon point, its altitude is the horizon
+    if (count == 1)
+        return lookupalt[0];
 
-    // Search for the horizon point just after which the tested point may be inserted - see std::lower_bound documentation
-    std::vector<horizonpoint>::iterator next = std::lower_bound(horizon->begin(), horizon->end(), scope, horizonpoint::cmp);
+    // Search for the first horizon point at or after the tested azimuth, starting from the bin of the azimuth
+    size_t bin = static_cast<size_t>(scope.az * HORIZON_LOOKUP_BINS / 360.0);
+    if (bin >= HORIZON_LOOKUP_BINS)
+        bin = HORIZON_LOOKUP_BINS - 1;
+    size_t next = lookupbins[bin];
+    while (next < count && lookupaz[next] < scope.az)
+        next++;
 
     // If the tested point would be inserted at the end of the horizon list, loop next point back to first
-    if (next == horizon->end())
-        next = horizon->begin();
+    if (next == count)
+        next = 0;
 
-    // If the tested azimuth is identical to the next point, test altitude directly
-    if (next->az == scope.az)
-        return (scope.alt >= next->alt);
+    // If the tested azimuth is identical to the next point, use its altitude directly
+    if (lookupaz[next] == scope.az)
+        return lookupalt[next];
 
     // Grab the previous horizon point - the one after which inserting the tested point does not alter horizon ordering
-    std::vector<horizonpoint>::iterator const prev = ((next == horizon->begin()) ? horizon->end() : next) - 1;
+    size_t const prev = ((next == 0) ? count : next) - 1;
 
-    // If the altitude is identical between the two horizon siblings, test altitude directly
-    if (prev->alt == next->alt)
-        return (scope.alt >= next->alt);
+    // If the altitude is identical between the two horizon siblings, use it directly
+    if (lookupalt[prev] == lookupalt[next])
+        return lookupalt[next];
 
     // Compute azimuth distances for horizon point and scope point from reference point
-    double const delta_horizon_az = (next->az - prev->az) + ((next->az >= prev->az) ? 0.0 : 360.0);
-    double const delta_scope_az = (scope.az - prev->az) + ((scope.az >= prev->az) ? 0.0 : 360.0);
+    double const delta_horizon_az = (lookupaz[next] - lookupaz[prev]) + ((lookupaz[next] >= lookupaz[prev]) ? 0.0 : 360.0);
+    double const delta_scope_az = (scope.az - lookupaz[prev]) + ((scope.az >= lookupaz[prev]) ? 0.0 : 360.0);
 
-    // Compute a linear interpolation coefficient between the two horizontal points and test against interpolated altitude
-    double const delta_horizon_alt = next->alt - prev->alt;
-    double const h = prev->alt + delta_horizon_alt * delta_scope_az / delta_horizon_az;
+    // Compute a linear interpolation coefficient between the two horizontal points
+    double const delta_horizon_alt = lookupalt[next] - lookupalt[prev];
+    return lookupalt[prev] + delta_horizon_alt * delta_scope_az / delta_horizon_az;
+}
 
-    return (scope.alt >= h);
+bool HorizonLimits::inLimits(double raw_az, double raw_alt)
+{
+    horizonpoint const scope(raw_az, raw_alt);
+    return (scope.alt >= horizonAltitude(scope.az));
 }
 
 bool HorizonLimits::inGotoLimits(double az, double alt)
@@ -575,6 +625,28 @@ bool HorizonLimits::inGotoLimits(double az, double alt)
     return (inLimits(az, alt) || (swlimitgotodisable->s == ISS_ON));
 }
 
+bool HorizonLimits::inGotoPathLimits(double const *az, double const *alt, int n)
+{
+    ISwitch *swlimitgotodisable = IUFindSwitch(HorizonLimitsLimitGotoSP, "HORIZONLIMITSLIMITGOTODISABLE");
+    if (swlimitgotodisable->s == ISS_ON)
+        return true;
+
+    // A scope starting outside limits, e.g. parked below the horizon, may move out of them
+    // The path is only refused when it leaves the limits after having been inside
+    bool inside = false;
+    for (int i = 0; i < n; i++)
+    {
+        if (inLimits(az[i], alt[i]))
+            inside = true;
+        else if (inside)
+        {
+            LOGF_WARN("Horizon Limits: Goto path crosses the horizon at AZ=%3.3lf ALT=%3.3lf.", az[i], alt[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
 bool HorizonLimits::checkLimits(double az, double alt, INDI::Telescope::TelescopeStatus status, bool ingoto)
 {
     static bool warningMessageDispatched = false;
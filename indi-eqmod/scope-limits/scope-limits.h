@@ -21,6 +21,9 @@
 
 #include <vector>
 
+// Number of azimuth bins of the horizon lookup table
+#define HORIZON_LOOKUP_BINS 3600
+
 // Horizon point is an immutable alt/az coordinate
 typedef struct horizonpoint
 {
@@ -49,6 +52,12 @@ class HorizonLimits
     std::vector<horizonpoint> *horizon;
     int horizonindex;
 
+    // Horizon sorted by azimuth, and for each azimuth bin the index of the first point at or after the bin start
+    std::vector<double> lookupaz;
+    std::vector<double> lookupalt;
+    std::vector<size_t> lookupbins;
+    void BuildLookupTable();
+
     char *WriteDataFile(const char *filename);
     char *LoadDataFile(const char *filename);
     char errorline[128];
@@ -72,8 +81,10 @@ class HorizonLimits
 
     virtual void Init();
     virtual void Reset();
+    virtual double horizonAltitude(double az);
     virtual bool inLimits(double az, double alt);
     virtual bool inGotoLimits(double az, double alt);
+    virtual bool inGotoPathLimits(double const *az, double const *alt, int n);
     virtual bool checkLimits(double az, double alt, INDI::Telescope::TelescopeStatus status, bool ingoto);
     virtual bool saveConfigItems(FILE *fp);
 };
@@ -0,0 +1,276 @@
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "skywatcher-udp.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+SkywatcherUDP::SkywatcherUDP()
+{
+    for (Channel &channel : channels)
+    {
+        channel.fd      = -1;
+        channel.request = -1;
+    }
+    memset(&peer, 0, sizeof(peer));
+    origin = std::chrono::steady_clock::now();
+}
+
+SkywatcherUDP::~SkywatcherUDP()
+{
+    Close();
+}
+
+bool SkywatcherUDP::Open(int fd)
+{
+    int type      = 0;
+    socklen_t len = sizeof(type);
+
+    Close();
+    if (fd < 0 || getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &len) < 0 || type != SOCK_DGRAM)
+        return false;
+    peerlen = sizeof(peer);
+    if (getpeername(fd, reinterpret_cast<struct sockaddr *>(&peer), &peerlen) < 0)
+        return false;
+
+    for (Channel &channel : channels)
+    {
+        if (!openChannel(channel))
+        {
+            Close();
+            return false;
+        }
+    }
+    resetStats();
+    opened = true;
+    return true;
+}
+
+void SkywatcherUDP::Close()
+{
+    for (Channel &channel : channels)
+        closeChannel(channel);
+    opened = false;
+}
+
+bool SkywatcherUDP::isOpen() const
+{
+    return opened;
+}
+
+const std::map<char, SkywatcherUDP::CommandStats> &SkywatcherUDP::getStats() const
+{
+    return stats;
+}
+
+void SkywatcherUDP::resetStats()
+{
+    stats.clear();
+    global = CommandStats();
+}
+
+bool SkywatcherUDP::Transact(int count, const char *const commands[], char *const replies[], int size)
+{
+    int next    = 0;
+    int active  = 0;
+    bool result = true;
+    char buf[64];
+
+    for (int i = 0; i < count; i++)
+        replies[i][0] = '\0';
+
+    while (next < count || active > 0)
+    {
+        // Fill the free channels
+        for (Channel &channel : channels)
+        {
+            if (next >= count)
+                break;
+            // a channel whose socket could not be reopened gets another try
+            if (channel.fd < 0)
+                openChannel(channel);
+            if (channel.fd < 0 || channel.request >= 0)
+                continue;
+            channel.request = next++;
+            channel.tries   = 1;
+            channel.rto     = rto(commands[channel.request][1]);
+            channel.first   = now();
+            channel.sent    = channel.first;
+            stats[commands[channel.request][1]].requests++;
+            sendCommand(channel, commands[channel.request]);
+            active++;
+        }
+        if (active == 0)
+        {
+            // every channel failed to reopen, nothing can be sent anymore
+            for (; next < count; next++)
+                stats[commands[next][1]].failures++;
+            return false;
+        }
+
+        struct pollfd fds[SKYWATCHER_UDP_CHANNELS];
+        Channel *polled[SKYWATCHER_UDP_CHANNELS];
+        int nfds        = 0;
+        double deadline = 0.0;
+        for (Channel &channel : channels)
+        {
+            if (channel.request < 0)
+                continue;
+            fds[nfds].fd      = channel.fd;
+            fds[nfds].events  = POLLIN;
+            fds[nfds].revents = 0;
+            polled[nfds++]    = &channel;
+            if (nfds == 1 || channel.sent + channel.rto < deadline)
+                deadline = channel.sent + channel.rto;
+        }
+        int timeout = static_cast<int>(std::ceil(std::max(0.0, deadline - now())));
+        if (poll(fds, nfds, timeout) < 0 && errno != EINTR)
+        {
+            for (Channel &channel : channels)
+                closeChannel(channel);
+            opened = false;
+            return false;
+        }
+
+        double t = now();
+        for (int i = 0; i < nfds; i++)
+        {
+            Channel &channel = *polled[i];
+            if (!(fds[i].revents & (POLLIN | POLLERR)))
+                continue;
+            // an ICMP error from an earlier datagram is reported here, the timer covers it
+            ssize_t n = recv(channel.fd, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+            if (n <= 0 || buf[n - 1] != '\r')
+                continue;
+            buf[n]             = '\0';
+            const char *cmd    = commands[channel.request];
+            CommandStats &cmds = stats[cmd[1]];
+            strncpy(replies[channel.request], buf, size - 1);
+            replies[channel.request][size - 1] = '\0';
+            if (channel.tries == 1)
+            {
+                // Karn: the rtt of a retransmitted command is ambiguous
+                sample(cmds, t - channel.sent);
+                sample(global, t - channel.sent);
+                channel.request = -1;
+            }
+            else
+            {
+                // replies to the other copies may still come back on this socket
+                closeChannel(channel);
+                openChannel(channel);
+            }
+            active--;
+        }
+
+        for (Channel &channel : channels)
+        {
+            if (channel.request < 0 || t < channel.sent + channel.rto)
+                continue;
+            const char *cmd = commands[channel.request];
+            if (t - channel.first >= SKYWATCHER_UDP_TIMEOUT)
+            {
+                stats[cmd[1]].failures++;
+                result = false;
+                closeChannel(channel);
+                openChannel(channel);
+                active--;
+                continue;
+            }
+            channel.tries++;
+            channel.rto  = std::min(channel.rto * 2, SKYWATCHER_UDP_MAX_RTO);
+            channel.sent = t;
+            stats[cmd[1]].retransmits++;
+            sendCommand(channel, cmd);
+        }
+    }
+    return result;
+}
+
+double SkywatcherUDP::now() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+}
+
+double SkywatcherUDP::rto(char cmd) const
+{
+    const CommandStats *s = &global;
+    auto it               = stats.find(cmd);
+    if (it != stats.end() && it->second.samples > 0)
+        s = &it->second;
+    if (s->samples == 0)
+        return SKYWATCHER_UDP_INITIAL_RTO;
+    return std::min(std::max(s->srtt + 4 * s->rttvar, SKYWATCHER_UDP_MIN_RTO), SKYWATCHER_UDP_MAX_RTO);
+}
+
+bool SkywatcherUDP::openChannel(Channel &channel)
+{
+    channel.request = -1;
+    channel.fd      = socket(peer.ss_family, SOCK_DGRAM, 0);
+    if (channel.fd < 0)
+        return false;
+    fcntl(channel.fd, F_SETFD, FD_CLOEXEC);
+    if (connect(channel.fd, reinterpret_cast<struct sockaddr *>(&peer), peerlen) < 0)
+    {
+        closeChannel(channel);
+        return false;
+    }
+    return true;
+}
+
+void SkywatcherUDP::closeChannel(Channel &channel)
+{
+    if (channel.fd >= 0)
+        close(channel.fd);
+    channel.fd      = -1;
+    channel.request = -1;
+}
+
+void SkywatcherUDP::sendCommand(Channel &channel, const char *command)
+{
+    // drop anything left from a previous command before sending this one
+    char buf[64];
+    while (recv(channel.fd, buf, sizeof(buf), MSG_DONTWAIT) > 0)
+        ;
+    // a failed send is a lost datagram, the retransmit timer handles both
+    send(channel.fd, command, strlen(command), 0);
+}
+
+void SkywatcherUDP::sample(CommandStats &s, double rtt)
+{
+    if (s.samples == 0)
+    {
+        s.srtt   = rtt;
+        s.rttvar = rtt / 2;
+        s.minrtt = rtt;
+        s.maxrtt = rtt;
+    }
+    else
+    {
+        s.rttvar = 0.75 * s.rttvar + 0.25 * std::fabs(s.srtt - rtt);
+        s.srtt   = 0.875 * s.srtt + 0.125 * rtt;
+        s.minrtt = std::min(s.minrtt, rtt);
+        s.maxrtt = std::max(s.maxrtt, rtt);
+    }
+    s.samples++;
+}
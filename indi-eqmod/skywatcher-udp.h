@@ -0,0 +1,99 @@
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/socket.h>
+
+#include <chrono>
+#include <map>
+#include <stdint.h>
+
+// Commands in flight at once, each one on its own socket
+#define SKYWATCHER_UDP_CHANNELS 4
+// Retransmit timer bounds and initial value (ms)
+#define SKYWATCHER_UDP_MIN_RTO     20.0
+#define SKYWATCHER_UDP_MAX_RTO     250.0
+#define SKYWATCHER_UDP_INITIAL_RTO 200.0
+// A command without reply after this delay (ms) is given up
+#define SKYWATCHER_UDP_TIMEOUT 5000.0
+
+/* Datagram transport of the Skywatcher protocol (AZ-GTi and Wi-Fi dongles).
+   The protocol has no request tag, so each command in flight is sent from its own
+   socket and its reply is the datagram coming back on that socket. Lost datagrams
+   are retransmitted after an adaptive timeout (RFC 6298 estimator per command).
+   A socket whose command was retransmitted is replaced once done, so that a late
+   duplicate reply can never be taken for the reply to the next command. */
+class SkywatcherUDP
+{
+    public:
+        typedef struct CommandStats
+        {
+            uint32_t requests {0};    // commands sent
+            uint32_t retransmits {0}; // datagrams sent again after a timeout
+            uint32_t failures {0};    // commands given up
+            uint32_t samples {0};     // rtt samples, only from commands answered at first send
+            double srtt {0.0};        // smoothed rtt (ms)
+            double rttvar {0.0};
+            double minrtt {0.0};
+            double maxrtt {0.0};
+        } CommandStats;
+
+        SkywatcherUDP();
+        ~SkywatcherUDP();
+
+        // Open the channels to the peer of the connected socket fd, false if fd is not a UDP socket
+        bool Open(int fd);
+        void Close();
+        bool isOpen() const;
+
+        // Send count commands (trailing CR included) with up to SKYWATCHER_UDP_CHANNELS in flight.
+        // replies[i] (size bytes) receives the reply to commands[i], CR included, or an empty string.
+        // Batched commands must not depend on each other. Returns false if one got no reply.
+        bool Transact(int count, const char *const commands[], char *const replies[], int size);
+
+        // Statistics by command letter
+        const std::map<char, CommandStats> &getStats() const;
+        void resetStats();
+
+    private:
+        typedef struct Channel
+        {
+            int fd;
+            int request; // index in the batch, -1 when free
+            int tries;
+            double first; // first send (ms)
+            double sent;  // last send (ms)
+            double rto;
+        } Channel;
+
+        double now() const;
+        double rto(char cmd) const;
+        bool openChannel(Channel &channel);
+        void closeChannel(Channel &channel);
+        void sendCommand(Channel &channel, const char *command);
+        void sample(CommandStats &stats, double rtt);
+
+        Channel channels[SKYWATCHER_UDP_CHANNELS];
+        struct sockaddr_storage peer;
+        socklen_t peerlen {0};
+        bool opened {false};
+
+        std::map<char, CommandStats> stats;
+        // estimator of all commands, used until a command has its own samples
+        CommandStats global;
+        std::chrono::steady_clock::time_point origin;
+};
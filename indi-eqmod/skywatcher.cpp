@@ -51,6 +51,9 @@ bool Skywatcher::isDebug()
 void Skywatcher::setPortFD(int value)
 {
     PortFD = value;
+    // Wi-Fi mounts (AZ-GTi, dongles) talk over UDP, use the datagram transport for them
+    if (udptransport.Open(PortFD))
+        DEBUGF(telescope->DBG_COMM, "UDP transport: %d commands in flight", SKYWATCHER_UDP_CHANNELS);
 }
 
 void Skywatcher::setSimulation(bool enable)
@@ -100,6 +103,17 @@ bool Skywatcher::Disconnect()
         return true;
     StopMotor(Axis1);
     StopMotor(Axis2);
+    if (udptransport.isOpen())
+    {
+        for (auto &it : udptransport.getStats())
+        {
+            const SkywatcherUDP::CommandStats &s = it.second;
+            DEBUGF(telescope->DBG_COMM,
+                   "UDP :%c %u sent, %u retransmitted, %u lost, rtt %.1f ms (min %.1f, max %.1f, var %.1f)",
+                   it.first, s.requests, s.retransmits, s.failures, s.srtt, s.minrtt, s.maxrtt, s.rttvar);
+        }
+        udptransport.Close();
+    }
     // Deactivate motor (for geehalel mount only)
     /*
     if (MountCode == 0xF0) {
@@ -263,6 +277,58 @@ void Skywatcher::GetDEMotorStatus(ILightVectorProperty *motorLP)
     }
 }
 
+void Skywatcher::PrefetchStatus()
+{
+    if (isSimulation() || !udptransport.isOpen())
+        return;
+
+    SkywatcherCommand cmds[2 * NUMBER_OF_SKYWATCHERAXIS];
+    SkywatcherAxis axes[2 * NUMBER_OF_SKYWATCHERAXIS];
+    char *replies[2 * NUMBER_OF_SKYWATCHERAXIS];
+    char commands[2 * NUMBER_OF_SKYWATCHERAXIS][SKYWATCHER_MAX_CMD];
+    const char *commandp[2 * NUMBER_OF_SKYWATCHERAXIS];
+    bool querystatus[NUMBER_OF_SKYWATCHERAXIS];
+    int count = 0;
+
+    for (int i = 0; i < NUMBER_OF_SKYWATCHERAXIS; i++)
+    {
+        cmds[count]      = GetAxisPosition;
+        axes[count]      = static_cast<SkywatcherAxis>(i);
+        replies[count++] = prefetchedposition[i];
+    }
+    // The status is only read ahead where CheckMotorStatus() is going to read it
+    for (int i = 0; i < NUMBER_OF_SKYWATCHERAXIS; i++)
+    {
+        querystatus[i]      = MotorStatusStale(static_cast<SkywatcherAxis>(i));
+        statusprefetched[i] = false;
+        if (!querystatus[i])
+            continue;
+        cmds[count]      = GetAxisStatus;
+        axes[count]      = static_cast<SkywatcherAxis>(i);
+        replies[count++] = prefetchedstatus[i];
+    }
+    for (int i = 0; i < count; i++)
+    {
+        snprintf(commands[i], SKYWATCHER_MAX_CMD, "%c%c%c%c", SkywatcherLeadingChar, cmds[i], AxisCmd[axes[i]],
+                 SkywatcherTrailingChar);
+        commandp[i] = commands[i];
+    }
+    commandcount += count;
+    // The queries are independent, they all go out before the first reply is back.
+    // A missing reply is simply queried again by the usual call.
+    bool replied = udptransport.Transact(count, commandp, replies, SKYWATCHER_MAX_CMD);
+    for (int i = 0; !replied && i < count; i++)
+        replied = (replies[i][0] != '\0');
+    if (!replied)
+        throw EQModError(EQModError::ErrDisconnect, "no reply over UDP, check connection");
+    gettimeofday(&lastprefetch, nullptr);
+    for (int i = 0; i < NUMBER_OF_SKYWATCHERAXIS; i++)
+    {
+        positionprefetched[i] = (prefetchedposition[i][0] == '=');
+        statusprefetched[i]   = querystatus[i] && (prefetchedstatus[i][0] == '=');
+    }
+}
+
 void Skywatcher::Init()
 {
     wasinitialized = false;
@@ -741,6 +807,7 @@ void Skywatcher::ReadMotorStatus(SkywatcherAxis axis)
             break;
     }
     gettimeofday(&lastreadmotorstatus[axis], nullptr);
+    motorstatusdirty[axis] = false;
 }
 
 void Skywatcher::SlewRA(double rate)
@@ -1106,6 +1173,59 @@ void Skywatcher::StartDETracking(double trackspeed)
         StopMotor(Axis2);
 }
 
+void Skywatcher::GuideRATracking(double trackspeed)
+{
+    GuideTracking(Axis1, trackspeed);
+}
+
+void Skywatcher::GuideDETracking(double trackspeed)
+{
+    GuideTracking(Axis2, trackspeed);
+}
+
+void Skywatcher::GuideTracking(SkywatcherAxis axis, double trackspeed)
+{
+    double rate                   = trackspeed / SKYWATCHER_STELLAR_SPEED;
+    double absrate                = fabs(rate);
+    bool running                  = (axis == Axis1) ? RARunning : DERunning;
+    SkywatcherAxisStatus *status  = (axis == Axis1) ? &RAStatus : &DEStatus;
+    SkywatcherDirection direction = ((rate >= 0.0) ? FORWARD : BACKWARD);
+
+    // The cached state is trusted here and verified by the next status poll. Anything else than
+    // a new speed for a running low speed slew goes through the full tracking start.
+    if (motorstatusdirty[axis] || !running || status->slewmode != SLEW || status->speedmode != LOWSPEED ||
+            status->direction != direction || absrate < get_min_rate() || absrate > SKYWATCHER_LOWSPEED_RATE)
+    {
+        DEBUGF(telescope->DBG_MOUNT, "%s() : Axis = %c -- motor state requires a full tracking start", __FUNCTION__,
+               AxisCmd[axis]);
+        if (axis == Axis1)
+            StartRATracking(trackspeed);
+        else
+            StartDETracking(trackspeed);
+        return;
+    }
+
+    uint32_t stepsworm = (axis == Axis1) ? RAStepsWorm : DEStepsWorm;
+    uint32_t steps360  = (axis == Axis1) ? RASteps360 : DESteps360;
+    uint32_t period    = static_cast<uint32_t>(((SKYWATCHER_STELLAR_DAY * stepsworm) / static_cast<double>
+                         (steps360)) / absrate);
+    char cmd[7];
+
+    DEBUGF(telescope->DBG_MOUNT, "%s() : Axis = %c -- period=%ld", __FUNCTION__, AxisCmd[axis], static_cast<long>(period));
+
+    long2Revu24str(period, cmd);
+    if (axis == Axis1)
+        RAPeriod = period;
+    else
+        DEPeriod = period;
+    dispatch_command(SetStepPeriod, axis, cmd);
+}
+
+uint32_t Skywatcher::GetCommandCount()
+{
+    return commandcount;
+}
+
 void Skywatcher::SetSpeed(SkywatcherAxis axis, uint32_t period)
 {
     char cmd[7];
@@ -1520,6 +1640,13 @@ void Skywatcher::StartMotor(SkywatcherAxis axis)
     }
     dispatch_command(StartMotion, axis, nullptr);
     //read_eqmod();
+    if (axis == Axis1)
+        RARunning = true;
+    else
+        DERunning = true;
+    // A goto stops on its own
+    if (NewStatus[axis].slewmode == GOTO)
+        motorstatusdirty[axis] = true;
 }
 
 void Skywatcher::StopRA()
@@ -1585,6 +1712,7 @@ void Skywatcher::SetMotion(SkywatcherAxis axis, SkywatcherAxisStatus newstatus)
         StopWaitMotor(axis);
         dispatch_command(SetMotionMode, axis, motioncmd);
         //read_eqmod();
+        *currentstatus = newstatus;
     }
     //#endif
     NewStatus[axis] = newstatus;
@@ -1612,6 +1740,7 @@ void Skywatcher::ResetMotions()
     dispatch_command(SetMotionMode, Axis1, motioncmd);
     //read_eqmod();
     NewStatus[Axis1] = newstatus;
+    RAStatus         = newstatus;
 
     CheckMotorStatus(Axis2);
     newstatus.direction = DEStatus.direction;
@@ -1622,6 +1751,7 @@ void Skywatcher::ResetMotions()
     dispatch_command(SetMotionMode, Axis2, motioncmd);
     //read_eqmod();
     NewStatus[Axis2] = newstatus;
+    DEStatus         = newstatus;
 }
 
 void Skywatcher::StopMotor(SkywatcherAxis axis)
@@ -1634,6 +1764,8 @@ void Skywatcher::StopMotor(SkywatcherAxis axis)
     DEBUGF(telescope->DBG_MOUNT, "%s() : Axis = %c", __FUNCTION__, AxisCmd[axis]);
     dispatch_command(NotInstantAxisStop, axis, nullptr);
     //read_eqmod();
+    // The motor decelerates before stopping
+    motorstatusdirty[axis] = true;
 }
 
 void Skywatcher::InstantStopMotor(SkywatcherAxis axis)
@@ -1646,6 +1778,7 @@ void Skywatcher::InstantStopMotor(SkywatcherAxis axis)
     DEBUGF(telescope->DBG_MOUNT, "%s() : Axis = %c", __FUNCTION__, AxisCmd[axis]);
     dispatch_command(InstantAxisStop, axis, nullptr);
     //read_eqmod();
+    motorstatusdirty[axis] = true;
 }
 
 void Skywatcher::StopWaitMotor(SkywatcherAxis axis)
@@ -1678,14 +1811,20 @@ void Skywatcher::StopWaitMotor(SkywatcherAxis axis)
 
 void Skywatcher::CheckMotorStatus(SkywatcherAxis axis)
 {
-    struct timeval now;
     DEBUGF(telescope->DBG_SCOPE_STATUS, "%s() : Axis = %c", __FUNCTION__, AxisCmd[axis]);
-    gettimeofday(&now, nullptr);
-    if (((now.tv_sec - lastreadmotorstatus[axis].tv_sec) + ((now.tv_usec - lastreadmotorstatus[axis].tv_usec) / 1e6)) >
-            SKYWATCHER_MAXREFRESH)
+    if (MotorStatusStale(axis))
         ReadMotorStatus(axis);
 }
 
+bool Skywatcher::MotorStatusStale(SkywatcherAxis axis)
+{
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    return motorstatusdirty[axis] ||
+           ((now.tv_sec - lastreadmotorstatus[axis].tv_sec) + ((now.tv_usec - lastreadmotorstatus[axis].tv_usec) / 1e6)) >
+           SKYWATCHER_MAXREFRESH;
+}
+
 double Skywatcher::get_min_rate()
 {
     return MIN_RATE;
@@ -1698,6 +1837,33 @@ double Skywatcher::get_max_rate()
 
 bool Skywatcher::dispatch_command(SkywatcherCommand cmd, SkywatcherAxis axis, char *command_arg)
 {
+    if (cmd == GetAxisPosition || cmd == GetAxisStatus)
+    {
+        bool *prefetched = (cmd == GetAxisPosition ? positionprefetched : statusprefetched);
+        if (prefetched[axis])
+        {
+            struct timeval now;
+            prefetched[axis] = false;
+            gettimeofday(&now, nullptr);
+            if ((now.tv_sec - lastprefetch.tv_sec) + ((now.tv_usec - lastprefetch.tv_usec) / 1e6) <=
+                    SKYWATCHER_PREFETCH_MAXAGE)
+            {
+                snprintf(command, SKYWATCHER_MAX_CMD, "%c%c%c", SkywatcherLeadingChar, cmd, AxisCmd[axis]);
+                strncpy(response, (cmd == GetAxisPosition ? prefetchedposition[axis] : prefetchedstatus[axis]),
+                        SKYWATCHER_MAX_CMD);
+                DEBUGF(telescope->DBG_COMM, "dispatch_command: \"%s\", prefetched", command);
+                debugnextread = true;
+                return check_reply(strlen(response));
+            }
+        }
+    }
+    else
+    {
+        // the motor state may change with this command
+        positionprefetched[axis] = false;
+        statusprefetched[axis]   = false;
+    }
+
     for (uint8_t i = 0; i < EQMOD_MAX_RETRY; i++)
     {
         // Clear string
@@ -1710,7 +1876,21 @@ bool Skywatcher::dispatch_command(SkywatcherCommand cmd, SkywatcherAxis axis, ch
                      SkywatcherTrailingChar);
 
         int nbytes_written = 0;
-        if (!isSimulation())
+        commandcount++;
+        if (!isSimulation() && udptransport.isOpen())
+        {
+            // Lost datagrams are sent again by the transport itself, no reply at all is final
+            const char *commands[1] = { command };
+            char *replies[1]        = { response };
+            if (!udptransport.Transact(1, commands, replies, SKYWATCHER_MAX_CMD))
+            {
+                motorstatusdirty[axis]       = true;
+                command[strlen(command) - 1] = '\0';
+                throw EQModError(EQModError::ErrDisconnect, "no reply to %s over UDP, check connection", command);
+            }
+            nbytes_written = strlen(command);
+        }
+        else if (!isSimulation())
         {
             int err_code = 0;
             tcflush(PortFD, TCIOFLUSH);
@@ -1719,6 +1899,7 @@ bool Skywatcher::dispatch_command(SkywatcherCommand cmd, SkywatcherAxis axis, ch
             {
                 if (i == EQMOD_MAX_RETRY - 1)
                 {
+                    motorstatusdirty[axis] = true;
                     char ttyerrormsg[ERROR_MSG_LENGTH];
                     tty_error_msg(err_code, ttyerrormsg, ERROR_MSG_LENGTH);
                     throw EQModError(EQModError::ErrDisconnect, "tty write failed, check connection: %s", ttyerrormsg);
@@ -1745,7 +1926,7 @@ bool Skywatcher::dispatch_command(SkywatcherCommand cmd, SkywatcherAxis axis, ch
 
         try
         {
-            if (read_eqmod())
+            if ((!isSimulation() && udptransport.isOpen()) ? check_reply(strlen(response)) : read_eqmod())
                 return true;
         }
         catch (EQModError)
@@ -1753,7 +1934,10 @@ bool Skywatcher::dispatch_command(SkywatcherCommand cmd, SkywatcherAxis axis, ch
             // By this time, we just rethrow the error
             // JM 2018-05-07 immediately rethrow if GET_FEATURES_CMD
             if (i == EQMOD_MAX_RETRY - 1 || cmd == GetFeatureCmd)
+            {
+                motorstatusdirty[axis] = true;
                 throw;
+            }
         }
 
         DEBUG(telescope->DBG_COMM, "read error, will retry again...");
@@ -1785,6 +1969,11 @@ bool Skywatcher::read_eqmod()
     {
         telescope->simulator->send_reply(response, &nbytes_read);
     }
+    return check_reply(nbytes_read);
+}
+
+bool Skywatcher::check_reply(int nbytes_read)
+{
     // Remove CR
     response[nbytes_read - 1] = '\0';
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "eqmoderror.h"
+#include "skywatcher-udp.h"
 
 #include <inditelescope.h>
 
@@ -41,6 +42,8 @@ class EQMod; // TODO
 
 #define SKYWATCHER_LOWSPEED_RATE 128
 #define SKYWATCHER_MAXREFRESH    0.5
+// Replies read ahead by PrefetchStatus() are used if not older than this (s)
+#define SKYWATCHER_PREFETCH_MAXAGE 0.25
 
 #define SKYWATCHER_BACKLASH_SPEED_RA 64
 #define SKYWATCHER_BACKLASH_SPEED_DE 64
@@ -77,6 +80,8 @@ class Skywatcher
         uint32_t GetDEPeriod();
         void GetRAMotorStatus(ILightVectorProperty *motorLP);
         void GetDEMotorStatus(ILightVectorProperty *motorLP);
+        // Over UDP, query both positions and statuses in one round trip for the calls above
+        void PrefetchStatus();
         void InquireBoardVersion(ITextVectorProperty *boardTP);
         void InquireFeatures();
         void InquireRAEncoderInfo(INumberVectorProperty *encoderNP);
@@ -92,6 +97,10 @@ class Skywatcher
         void AbsSlewTo(uint32_t raencoder, uint32_t deencoder, bool raup, bool deup);
         void StartRATracking(double trackspeed);
         void StartDETracking(double trackspeed);
+        // Guide pulse edges: a single step period command when the cached motor state allows it
+        void GuideRATracking(double trackspeed);
+        void GuideDETracking(double trackspeed);
+        uint32_t GetCommandCount();
         bool IsRARunning();
         bool IsDERunning();
         // For AstroEQ (needs an explicit :G command at the end of gotos)
@@ -248,10 +257,15 @@ class Skywatcher
 
         struct timeval lastreadmotorstatus[NUMBER_OF_SKYWATCHERAXIS];
         struct timeval lastreadmotorposition[NUMBER_OF_SKYWATCHERAXIS];
+        // Set when the motor state can no longer be known from the commands sent (stop, goto, error)
+        bool motorstatusdirty[NUMBER_OF_SKYWATCHERAXIS] {true, true};
 
         // Functions
         void CheckMotorStatus(SkywatcherAxis axis);
+        // True when CheckMotorStatus() has to read the motor status again
+        bool MotorStatusStale(SkywatcherAxis axis);
         void ReadMotorStatus(SkywatcherAxis axis);
+        void GuideTracking(SkywatcherAxis axis, double trackspeed);
         void SetMotion(SkywatcherAxis axis, SkywatcherAxisStatus newstatus);
         void SetSpeed(SkywatcherAxis axis, uint32_t period);
         void SetTarget(SkywatcherAxis axis, uint32_t increment);
@@ -276,6 +290,7 @@ class Skywatcher
         void TurnSnapPort(SkywatcherAxis axis, bool on);
 
         bool read_eqmod();
+        bool check_reply(int nbytes_read);
         bool dispatch_command(SkywatcherCommand cmd, SkywatcherAxis axis, char *arg);
 
         uint32_t Revu24str2long(char *);
@@ -321,6 +336,14 @@ class Skywatcher
         SkyWatcherFeatures AxisFeatures[NUMBER_OF_SKYWATCHERAXIS];
 
         int PortFD = -1;
+        SkywatcherUDP udptransport;
+        // Replies read ahead by PrefetchStatus(), dropped by any other command on the axis
+        bool positionprefetched[NUMBER_OF_SKYWATCHERAXIS] {false, false};
+        bool statusprefetched[NUMBER_OF_SKYWATCHERAXIS] {false, false};
+        char prefetchedposition[NUMBER_OF_SKYWATCHERAXIS][SKYWATCHER_MAX_CMD];
+        char prefetchedstatus[NUMBER_OF_SKYWATCHERAXIS][SKYWATCHER_MAX_CMD];
+        struct timeval lastprefetch;
+        uint32_t commandcount {0};
         char command[SKYWATCHER_MAX_CMD];
         char response[SKYWATCHER_MAX_CMD];
 
@@ -3,6 +3,28 @@
 
 #include "config.h"
 #include "eqmodbase.h"
+#include "skywatcher-udp.h"
+#include "simulator/skywatcher-simulator.h"
+
+#include <libnova/sidereal_time.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 
 using ::testing::_;
@@ -147,6 +169,45 @@ public:
         return true;
     }
 
+#ifdef WITH_SCOPE_LIMITS
+    // Check the path of a goto from the pole to the meridian at the given declination
+    bool TestGotoPathFromPole(double de)
+    {
+        double lst;
+
+        juliandate = getJulianDate();
+        lst        = getLst(juliandate, getLongitude());
+
+        currentRAEncoder = zeroRAEncoder;
+        currentDEEncoder = zeroDEEncoder + totalDEEncoder / 4;
+        EncodersToRADec(currentRAEncoder, currentDEEncoder, lst, &currentRA, &currentDEC, &currentHA, nullptr);
+        EXPECT_NEAR(currentDEC, 90.0, 0.001);
+
+        bzero(&gotoparams, sizeof(gotoparams));
+        gotoparams.ratarget         = lst;
+        gotoparams.detarget         = de;
+        gotoparams.racurrentencoder = currentRAEncoder;
+        gotoparams.decurrentencoder = currentDEEncoder;
+        gotoparams.checklimits      = false;
+        gotoparams.pier_side        = PIER_UNKNOWN;
+        EncoderTarget(&gotoparams);
+
+        return inGotoPathLimits(&gotoparams, lst, juliandate);
+    }
+#endif
+
+#ifdef WITH_ALIGN_GEEHALEL
+    Align *getAlign()
+    {
+        return align;
+    }
+#endif
+
+    Skywatcher *getMount()
+    {
+        return mount;
+    }
+
 };
 
 
@@ -451,8 +512,806 @@ TEST(EqmodTest, scope_limits_altaz)
 
     ASSERT_TRUE(hl->ISNewSwitch(eqmod.getDeviceName(), "HORIZONLIMITSMANAGE", iss_on, (char**) manage_clear, 1));
 }
+
+// Horizon altitude as computed by a lower bound search over the sorted horizon, on every call
+static double reference_horizon(std::vector<std::pair<double, double>> const &sorted, double az)
+{
+    az = std::fmod(std::fmod(az, 360.0) + 360.0, 360.0);
+    std::vector<std::pair<double, double>>::const_iterator next = std::lower_bound(sorted.begin(), sorted.end(),
+            std::make_pair(az, -1000.0));
+    if (next == sorted.end())
+        next = sorted.begin();
+    if (next->first == az)
+        return next->second;
+    std::vector<std::pair<double, double>>::const_iterator const prev = ((next == sorted.begin()) ? sorted.end() : next) - 1;
+    double const delta_horizon_az = (next->first - prev->first) + ((next->first >= prev->first) ? 0.0 : 360.0);
+    double const delta_scope_az = (az - prev->first) + ((az >= prev->first) ? 0.0 : 360.0);
+    return prev->second + (next->second - prev->second) * delta_scope_az / delta_horizon_az;
+}
+
+static bool load_horizon(TestEQMod &eqmod, std::vector<std::pair<double, double>> const &points)
+{
+    char filename[] = "/tmp/test_eqmod_horizonXXXXXX";
+    int const fd = mkstemp(filename);
+    if (fd < 0)
+        return false;
+    FILE * const fp = fdopen(fd, "w");
+    fprintf(fp, "# Synthetic horizon\n");
+    for (auto const &p : points)
+        fprintf(fp, "%.6f %.6f\n", p.first, p.second);
+    fclose(fp);
+
+    ISState iss_on[] = { ISS_ON };
+    char *texts[] = { filename };
+    const char *file_names[] = { "HORIZONLIMITSFILENAME" };
+    const char *load_names[] = { "HORIZONLIMITSLOADFILE" };
+    bool const result = eqmod.horizon->ISNewText(eqmod.getDeviceName(), "HORIZONLIMITSDATAFILE", texts, (char**) file_names, 1) &&
+                        eqmod.horizon->ISNewSwitch(eqmod.getDeviceName(), "HORIZONLIMITSFILEOPERATION", iss_on, (char**) load_names, 1);
+    unlink(filename);
+    return result;
+}
+
+TEST(EqmodTest, scope_limits_dense_horizon)
+{
+    TestEQMod eqmod;
+    eqmod.updateLocation(50.0, 15.0, 0);
+
+    HorizonLimits * const hl = eqmod.horizon;
+    ASSERT_NE(hl, nullptr);
+
+    // A panorama-like horizon of 20000 points, written in a shuffled order
+    std::vector<std::pair<double, double>> points;
+    for (int i = 0; i < 20000; i++)
+    {
+        double const az = i * 0.018;
+        points.push_back(std::make_pair(az, 15.0 + 10.0 * std::sin(az * M_PI / 7.0) + 5.0 * std::cos(az * M_PI / 53.0)));
+    }
+    std::vector<std::pair<double, double>> shuffled(points);
+    for (size_t i = 0; i < shuffled.size(); i++)
+        std::swap(shuffled[i], shuffled[(i * 7919) % shuffled.size()]);
+    ASSERT_TRUE(load_horizon(eqmod, shuffled));
+
+    // Re-read values as written to the file, with azimuths wrapped like horizon points
+    for (auto &p : points)
+    {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.6f %.6f", p.first, p.second);
+        sscanf(buffer, "%lf %lf", &p.first, &p.second);
+        p.first = std::fmod(std::fmod(p.first, 360.0) + 360.0, 360.0);
+    }
+
+    for (double az = -365; az < 365; az += 0.0137)
+        ASSERT_DOUBLE_EQ(hl->horizonAltitude(az), reference_horizon(points, az)) << "az=" << az;
+
+    // Benchmark the status tick check against a search over the horizon
+    int const samples = 1000000;
+    int inside = 0, reference_inside = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; i++)
+        inside += hl->inLimits(i * 0.00036, 15.0) ? 1 : 0;
+    std::chrono::duration<double> const table = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; i++)
+        reference_inside += (15.0 >= reference_horizon(points, i * 0.00036)) ? 1 : 0;
+    std::chrono::duration<double> const search = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(inside, reference_inside);
+    printf("Horizon of %zu points: lookup table %.1f ns, search %.1f ns per check\n", points.size(),
+           table.count() * 1e9 / samples, search.count() * 1e9 / samples);
+}
+
+TEST(EqmodTest, scope_limits_goto_path)
+{
+    TestEQMod eqmod;
+    eqmod.updateLocation(50.0, 15.0, 0);
+
+    HorizonLimits * const hl = eqmod.horizon;
+    ASSERT_NE(hl, nullptr);
+
+    // A 40 degree wall between azimuths 40 and 50 on a flat 10 degree horizon
+    ASSERT_TRUE(load_horizon(eqmod, { {0, 10}, {39.9, 10}, {40, 40}, {50, 40}, {50.1, 10} }));
+
+    // A path along azimuth at 30 degrees of altitude hits the wall
+    std::vector<double> az, alt;
+    for (double a = 0; a <= 90; a += 1)
+    {
+        az.push_back(a);
+        alt.push_back(30);
+    }
+    EXPECT_TRUE(hl->inGotoLimits(az.front(), alt.front()));
+    EXPECT_TRUE(hl->inGotoLimits(az.back(), alt.back()));
+    EXPECT_FALSE(hl->inGotoPathLimits(az.data(), alt.data(), static_cast<int>(az.size())));
+
+    // Above the wall it passes
+    std::fill(alt.begin(), alt.end(), 45);
+    EXPECT_TRUE(hl->inGotoPathLimits(az.data(), alt.data(), static_cast<int>(az.size())));
+
+    // A scope starting under the horizon may climb out of it
+    std::vector<double> climb_az = { 100, 100, 100, 100 };
+    std::vector<double> climb_alt = { 0, 5, 15, 30 };
+    EXPECT_TRUE(hl->inGotoPathLimits(climb_az.data(), climb_alt.data(), static_cast<int>(climb_az.size())));
+
+    // Disabling goto limits disables the path check
+    ISState iss_on[] = { ISS_ON };
+    const char * limit_disable[] = { "HORIZONLIMITSLIMITGOTODISABLE" };
+    const char * limit_enable[] = { "HORIZONLIMITSLIMITGOTOENABLE" };
+    ASSERT_TRUE(hl->ISNewSwitch(eqmod.getDeviceName(), "HORIZONLIMITSLIMITGOTO", iss_on, (char**) limit_disable, 1));
+    std::fill(alt.begin(), alt.end(), 30);
+    EXPECT_TRUE(hl->inGotoPathLimits(az.data(), alt.data(), static_cast<int>(az.size())));
+    ASSERT_TRUE(hl->ISNewSwitch(eqmod.getDeviceName(), "HORIZONLIMITSLIMITGOTO", iss_on, (char**) limit_enable, 1));
+
+    // Gotos from the pole down the meridian, towards a 20 degree high southern horizon
+    ASSERT_TRUE(load_horizon(eqmod, { {0, 0}, {150, 0}, {160, 20}, {200, 20}, {210, 0} }));
+    EXPECT_TRUE(eqmod.TestGotoPathFromPole(0));      // ends at 40 degrees of altitude
+    EXPECT_FALSE(eqmod.TestGotoPathFromPole(-30));   // ends at 10 degrees of altitude
+}
+#endif
+
+#ifdef WITH_ALIGN_GEEHALEL
+static AlignData synthetic_sync(int i)
+{
+    AlignData aligndata;
+    aligndata.lst          = std::fmod(i * 0.0371, 24.0);
+    aligndata.jd           = 2459000.5 + i * 0.0007;
+    aligndata.targetRA     = std::fmod(i * 1.1317, 24.0);
+    aligndata.targetDEC    = -60.0 + std::fmod(i * 7.731, 145.0);
+    aligndata.telescopeRA  = aligndata.targetRA + 0.01;
+    aligndata.telescopeDEC = aligndata.targetDEC - 0.02;
+    return aligndata;
+}
+
+static long file_size(std::string const &path)
+{
+    FILE * const fp = fopen(path.c_str(), "rb");
+    if (!fp)
+        return -1;
+    fseek(fp, 0, SEEK_END);
+    long const size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+TEST(EqmodTest, align_binary_data_file)
+{
+    TestEQMod eqmod;
+    char dirname[] = "/tmp/test_eqmod_alignXXXXXX";
+    ASSERT_NE(mkdtemp(dirname), nullptr);
+    std::string const xmlfile = std::string(dirname) + "/AlignData.xml";
+    std::string const binfile = std::string(dirname) + "/AlignData.bin";
+
+    // A 1000 point model, each sync journaled as it is added
+    int const points = 1000;
+    PointSet model(&eqmod);
+    model.Init();
+    double journal = 0;
+    for (int i = 0; i < points; i++)
+    {
+        model.AddPoint(synthetic_sync(i), nullptr);
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_EQ(model.JournalPoint(binfile.c_str(), synthetic_sync(i)), nullptr);
+        journal += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    ASSERT_EQ(model.getNbPoints(), points);
+
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(model.WriteDataFile(xmlfile.c_str()), nullptr);
+    std::chrono::duration<double> const xmlwrite = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    ASSERT_EQ(model.WriteDataFile(binfile.c_str()), nullptr);
+    std::chrono::duration<double> const binwrite = std::chrono::steady_clock::now() - start;
+    long const compacted = file_size(binfile);
+
+    PointSet xmlmodel(&eqmod);
+    xmlmodel.Init();
+    start = std::chrono::steady_clock::now();
+    ASSERT_EQ(xmlmodel.LoadDataFile(xmlfile.c_str()), nullptr);
+    std::chrono::duration<double> const xmlload = std::chrono::steady_clock::now() - start;
+
+    PointSet binmodel(&eqmod);
+    binmodel.Init();
+    start = std::chrono::steady_clock::now();
+    ASSERT_EQ(binmodel.LoadDataFile(binfile.c_str()), nullptr);
+    std::chrono::duration<double> const binload = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(xmlmodel.getNbPoints(), points);
+    EXPECT_EQ(binmodel.getNbPoints(), points);
+
+    // Written back, the loaded model gives the very same file
+    std::string const copyfile = std::string(dirname) + "/Copy.bin";
+    ASSERT_EQ(binmodel.WriteDataFile(copyfile.c_str()), nullptr);
+    EXPECT_EQ(file_size(copyfile), compacted);
+
+    // The copy is the journal now, a file that was not loaded or written is left alone
+    binmodel.AddPoint(synthetic_sync(points), nullptr);
+    EXPECT_NE(binmodel.JournalPoint(binfile.c_str(), synthetic_sync(points)), nullptr);
+    EXPECT_EQ(file_size(binfile), compacted);
+
+    // A sync appends one record, a torn record left by a crash is dropped on load
+    ASSERT_EQ(binmodel.LoadDataFile(binfile.c_str()), nullptr);
+    binmodel.AddPoint(synthetic_sync(points), nullptr);
+    ASSERT_EQ(binmodel.JournalPoint(binfile.c_str(), synthetic_sync(points)), nullptr);
+    long const appended = file_size(binfile);
+    EXPECT_GT(appended, compacted);
+    EXPECT_LT(appended - compacted, 64);
+    FILE * const fp = fopen(binfile.c_str(), "ab");
+    ASSERT_NE(fp, nullptr);
+    fwrite("\x01\x02\x03", 1, 3, fp);
+    fclose(fp);
+
+    PointSet reloaded(&eqmod);
+    reloaded.Init();
+    ASSERT_EQ(reloaded.LoadDataFile(binfile.c_str()), nullptr);
+    EXPECT_EQ(reloaded.getNbPoints(), points + 1);
+
+    // Clears are journaled too, and the journal is compacted once mostly dead
+    reloaded.Reset();
+    ASSERT_EQ(reloaded.JournalClear(binfile.c_str()), nullptr);
+    EXPECT_LT(file_size(binfile), 64);
+    reloaded.AddPoint(synthetic_sync(0), nullptr);
+    ASSERT_EQ(reloaded.JournalPoint(binfile.c_str(), synthetic_sync(0)), nullptr);
+    PointSet cleared(&eqmod);
+    cleared.Init();
+    ASSERT_EQ(cleared.LoadDataFile(binfile.c_str()), nullptr);
+    EXPECT_EQ(cleared.getNbPoints(), 1);
+
+    // A journal holding just a clear reloads empty, without the point tree of the previous list
+    std::string const clearfile = std::string(dirname) + "/Cleared.bin";
+    PointSet empty(&eqmod);
+    empty.Init();
+    ASSERT_EQ(empty.WriteDataFile(clearfile.c_str()), nullptr);
+    ASSERT_EQ(empty.JournalClear(clearfile.c_str()), nullptr);
+    ASSERT_NE(cleared.findNearest(10, 10, true), nullptr);
+    ASSERT_EQ(cleared.LoadDataFile(clearfile.c_str()), nullptr);
+    EXPECT_EQ(cleared.getNbPoints(), 0);
+    EXPECT_EQ(cleared.getNbTriangles(), 0);
+    EXPECT_EQ(cleared.findNearest(10, 10, true), nullptr);
+
+    printf("Align model of %d points: XML write %.2f ms load %.1f ms (%ld bytes), "
+           "binary write %.2f ms load %.1f ms (%ld bytes), journaled sync %.1f us\n",
+           points, xmlwrite.count() * 1e3, xmlload.count() * 1e3, file_size(xmlfile),
+           binwrite.count() * 1e3, binload.count() * 1e3, compacted, journal * 1e6 / points);
+
+    for (auto const &file : { xmlfile, binfile, copyfile, clearfile })
+        unlink(file.c_str());
+    rmdir(dirname);
+}
+
+// Smooth pointing error of the synthetic mount, in hours and degrees
+static void model_error(double ra, double dec, double *dra, double *ddec)
+{
+    *dra  = 0.01 + 0.005 * std::sin(ra * M_PI / 12.0);
+    *ddec = -0.02 + 0.01 * std::cos(dec * M_PI / 180.0);
+}
+
+// A sync of the synthetic mount, with the sidereal time of its date at the given longitude
+static AlignData model_sync(int i, double longitude)
+{
+    AlignData aligndata;
+    double dra, ddec;
+    aligndata.jd        = 2459000.5 + i * 0.0007;
+    aligndata.lst       = range24(ln_get_apparent_sidereal_time(aligndata.jd) + longitude / 15.0);
+    aligndata.targetRA  = std::fmod(i * 1.1317, 24.0);
+    aligndata.targetDEC = -60.0 + std::fmod(i * 7.731, 145.0);
+    model_error(aligndata.targetRA, aligndata.targetDEC, &dra, &ddec);
+    aligndata.telescopeRA  = range24(aligndata.targetRA + dra);
+    aligndata.telescopeDEC = aligndata.targetDEC + ddec;
+    return aligndata;
+}
+
+TEST(EqmodTest, align_nearest_point_tree)
+{
+    TestEQMod eqmod;
+    PointSet model(&eqmod);
+    model.Init();
+    for (int i = 0; i < 1000; i++)
+        model.AddPoint(synthetic_sync(i), nullptr);
+
+    double tree = 0, sorted = 0;
+    for (int i = 0; i < 2000; i++)
+    {
+        double const alt = -90.0 + std::fmod(i * 17.3, 180.0);
+        double const az  = std::fmod(i * 31.7, 360.0);
+        for (bool const ingoto : { false, true })
+        {
+            auto start = std::chrono::steady_clock::now();
+            PointSet::Point * const nearest = model.findNearest(alt, az, ingoto);
+            auto middle = std::chrono::steady_clock::now();
+            std::set<PointSet::Distance, bool (*)(PointSet::Distance, PointSet::Distance)> * const distances =
+                model.ComputeDistances(alt, az, PointSet::None, ingoto);
+            auto end = std::chrono::steady_clock::now();
+            tree += std::chrono::duration<double>(middle - start).count();
+            sorted += std::chrono::duration<double>(end - middle).count();
+
+            ASSERT_NE(nearest, nullptr);
+            EXPECT_EQ(nearest->htmID, distances->begin()->htmID);
+            delete distances;
+        }
+    }
+    printf("Nearest of 1000 align points: tree %.2f us, sorted distances %.2f us\n", tree * 1e6 / 4000,
+           sorted * 1e6 / 4000);
+
+    model.Reset();
+    EXPECT_EQ(model.findNearest(10, 10, true), nullptr);
+}
+
+TEST(EqmodTest, align_nstar_goto)
+{
+    TestEQMod eqmod;
+    Align * const align = eqmod.getAlign();
+    INumberVectorProperty * const geo = eqmod.getNumber("GEOGRAPHIC_COORD");
+    INDI::IGeographicCoordinates position;
+    position.longitude = IUFindNumber(geo, "LONG")->value;
+    position.latitude  = IUFindNumber(geo, "LAT")->value;
+    position.elevation = IUFindNumber(geo, "ELEV")->value;
+
+    // The driver loads a 1000 point model
+    char dirname[] = "/tmp/test_eqmod_nstarXXXXXX";
+    ASSERT_NE(mkdtemp(dirname), nullptr);
+    std::string const binfile = std::string(dirname) + "/AlignData.bin";
+    int const points = 1000;
+    PointSet model(&eqmod);
+    model.Init();
+    for (int i = 0; i < points; i++)
+        model.AddPoint(model_sync(i, position.longitude), nullptr);
+    ASSERT_EQ(model.WriteDataFile(binfile.c_str()), nullptr);
+    IUSaveText(IUFindText(eqmod.getText("ALIGNDATAFILE"), "ALIGNDATAFILENAME"), binfile.c_str());
+    align->Init();
+
+    ISState on[] = { ISS_ON };
+    const char * nstar[] = { "ALIGNNSTAR" };
+    const char * nearest[] = { "ALIGNNEAREST" };
+    ASSERT_TRUE(align->ISNewSwitch(eqmod.getDeviceName(), "ALIGNMODE", on, (char**) nstar, 1));
+
+    SyncData globalsync;
+    bzero(&globalsync, sizeof(globalsync));
+    double const jd = 2459000.6;
+    int const count = 4000;
+    std::vector<double> ra(count), dec(count);
+    for (int i = 0; i < count; i++)
+    {
+        ra[i]  = 24.0 * i / count;
+        dec[i] = -40.0 + std::fmod(i * 13.7, 120.0);
+    }
+
+    // One target at a time, as the driver does for a goto
+    std::vector<double> gotoRA = ra, gotoDEC = dec;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+        align->AlignGoto(globalsync, jd, &position, &gotoRA[i], &gotoDEC[i]);
+    std::chrono::duration<double> const single = std::chrono::steady_clock::now() - start;
+
+    // The model error is recovered
+    double maxerror = 0;
+    for (int i = 0; i < count; i++)
+    {
+        double dra, ddec;
+        model_error(ra[i], dec[i], &dra, &ddec);
+        maxerror = std::max(maxerror, std::fabs(std::remainder(gotoRA[i] - ra[i] - dra, 24.0)) * 15.0);
+        maxerror = std::max(maxerror, std::fabs(gotoDEC[i] - dec[i] - ddec));
+    }
+    EXPECT_LT(maxerror, 0.5);
+
+    // Aligned coordinates invert the goto
+    maxerror = 0;
+    for (int i = 0; i < count; i++)
+    {
+        double alignedRA, alignedDEC;
+        align->AlignNStar(jd, &position, gotoRA[i], gotoDEC[i], &alignedRA, &alignedDEC, false);
+        maxerror = std::max(maxerror, std::fabs(std::remainder(alignedRA - ra[i], 24.0)) * 15.0);
+        maxerror = std::max(maxerror, std::fabs(alignedDEC - dec[i]));
+    }
+    EXPECT_LT(maxerror, 0.5);
+
+    // Tracking a target for an hour, one position per second, mostly stays in the same face
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 3600; i++)
+    {
+        double alignedRA, alignedDEC;
+        align->AlignNStar(jd + i / 86400.0, &position, gotoRA[1000], gotoDEC[1000], &alignedRA, &alignedDEC, false);
+    }
+    std::chrono::duration<double> const tracking = std::chrono::steady_clock::now() - start;
+
+    // A new sync is a vertex of the model at once: its target goes exactly to its telescope position
+    AlignData const added = model_sync(points, position.longitude);
+    SyncData sync = globalsync;
+    sync.lst          = added.lst;
+    sync.jd           = added.jd;
+    sync.targetRA     = added.targetRA;
+    sync.targetDEC    = added.targetDEC;
+    sync.telescopeRA  = range24(added.telescopeRA + 0.05);
+    sync.telescopeDEC = added.telescopeDEC + 0.5;
+    align->AlignSync(globalsync, sync);
+    double syncRA = sync.targetRA, syncDEC = sync.targetDEC;
+    align->AlignGoto(globalsync, sync.jd, &position, &syncRA, &syncDEC);
+    EXPECT_NEAR(syncRA, sync.telescopeRA, 1e-6);
+    EXPECT_NEAR(syncDEC, sync.telescopeDEC, 1e-6);
+
+    // Nearest point mode, through the point tree
+    ASSERT_TRUE(align->ISNewSwitch(eqmod.getDeviceName(), "ALIGNMODE", on, (char**) nearest, 1));
+    std::vector<double> nearestRA = ra, nearestDEC = dec;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+        align->AlignGoto(globalsync, jd, &position, &nearestRA[i], &nearestDEC[i]);
+    std::chrono::duration<double> const nearestsingle = std::chrono::steady_clock::now() - start;
+    maxerror = 0;
+    for (int i = 0; i < count; i++)
+    {
+        double dra, ddec;
+        model_error(ra[i], dec[i], &dra, &ddec);
+        maxerror = std::max(maxerror, std::fabs(std::remainder(nearestRA[i] - ra[i] - dra, 24.0)) * 15.0);
+        maxerror = std::max(maxerror, std::fabs(nearestDEC[i] - dec[i] - ddec));
+    }
+    EXPECT_LT(maxerror, 0.5);
+
+    printf("N-star model of %d points, %d gotos %.1f ms, tracking %.2f us per position, "
+           "nearest point gotos %.1f ms\n",
+           points, count, single.count() * 1e3, tracking.count() * 1e6 / 3600, nearestsingle.count() * 1e3);
+
+    unlink(binfile.c_str());
+    rmdir(dirname);
+}
 #endif
 
+// Stand-in for a Wi-Fi mount: the skywatcher simulator behind a local UDP socket.
+// Commands and replies are lost with the given probability, replies are delayed
+// by mindelay to maxdelay ms as by the network (and may overtake each other).
+class UDPMountStandIn
+{
+public:
+    UDPMountStandIn(double loss, int mindelay, int maxdelay) : loss(loss), delay(mindelay, maxdelay), random(42)
+    {
+        simulator.setupVersion("020300");
+        simulator.setupRA(180, 47, 12, 200, 64, 2);
+        simulator.setupDE(180, 47, 12, 200, 64, 2);
+
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+        getsockname(fd, reinterpret_cast<struct sockaddr *>(&addr), &len);
+        port = addr.sin_port;
+        worker = std::thread(&UDPMountStandIn::run, this);
+    }
+
+    ~UDPMountStandIn()
+    {
+        running = false;
+        worker.join();
+        close(fd);
+    }
+
+    // A socket connected to the mount, as the INDI UDP connection opens it
+    int connectClient()
+    {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port        = port;
+        int client = socket(AF_INET, SOCK_DGRAM, 0);
+        connect(client, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+        return client;
+    }
+
+    std::atomic<int> received {0};
+    std::atomic<int> dropped {0};
+    // most replies waiting for their delay at once
+    std::atomic<int> queued {0};
+
+private:
+    typedef struct Reply
+    {
+        std::chrono::steady_clock::time_point due;
+        struct sockaddr_in to;
+        std::string data;
+    } Reply;
+
+    bool lost()
+    {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(random) < loss;
+    }
+
+    void run()
+    {
+        std::vector<Reply> replies;
+        while (running)
+        {
+            auto now    = std::chrono::steady_clock::now();
+            int timeout = 5;
+            for (auto it = replies.begin(); it != replies.end();)
+            {
+                if (it->due <= now)
+                {
+                    sendto(fd, it->data.data(), it->data.size(), 0, reinterpret_cast<struct sockaddr *>(&it->to),
+                           sizeof(it->to));
+                    it = replies.erase(it);
+                    continue;
+                }
+                timeout = std::min(timeout, static_cast<int>(
+                                       std::chrono::duration_cast<std::chrono::milliseconds>(it->due - now).count()));
+                ++it;
+            }
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            if (poll(&pfd, 1, timeout) <= 0)
+                continue;
+
+            char buf[64], reply[32];
+            struct sockaddr_in from;
+            socklen_t len = sizeof(from);
+            ssize_t n     = recvfrom(fd, buf, sizeof(buf) - 1, 0, reinterpret_cast<struct sockaddr *>(&from), &len);
+            if (n <= 0)
+                continue;
+            buf[n] = '\0';
+            received++;
+            if (lost())
+            {
+                dropped++;
+                continue;
+            }
+            int read = 0, replylen = 0;
+            simulator.process_command(buf, &read);
+            simulator.get_reply(reply, &replylen);
+            if (lost())
+            {
+                dropped++;
+                continue;
+            }
+            replies.push_back({ std::chrono::steady_clock::now() + std::chrono::milliseconds(delay(random)), from,
+                                std::string(reply, replylen) });
+            queued = std::max(queued.load(), static_cast<int>(replies.size()));
+        }
+    }
+
+    SkywatcherSimulator simulator;
+    double loss;
+    std::uniform_int_distribution<int> delay;
+    std::mt19937 random;
+    int fd;
+    in_port_t port;
+    std::atomic<bool> running {true};
+    std::thread worker;
+};
+
+TEST(EqmodTest, udp_transport_replies)
+{
+    UDPMountStandIn mount(0.0, 2, 2);
+    int client = mount.connectClient();
+    SkywatcherUDP udp;
+
+    // serial ports and pipes keep the tty path
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    EXPECT_FALSE(udp.Open(fds[0]));
+    EXPECT_FALSE(udp.isOpen());
+    close(fds[0]);
+    close(fds[1]);
+
+    ASSERT_TRUE(udp.Open(client));
+    char version[SKYWATCHER_MAX_CMD];
+    const char *inquire[] = { ":e1\r" };
+    char *versionp[]      = { version };
+    ASSERT_TRUE(udp.Transact(1, inquire, versionp, SKYWATCHER_MAX_CMD));
+    EXPECT_STREQ(version, "=020300\r");
+
+    // the poll queries, all in flight at once
+    const char *queries[] = { ":j1\r", ":j2\r", ":f1\r", ":f2\r" };
+    char replies[4][SKYWATCHER_MAX_CMD];
+    char *repliesp[] = { replies[0], replies[1], replies[2], replies[3] };
+    ASSERT_TRUE(udp.Transact(4, queries, repliesp, SKYWATCHER_MAX_CMD));
+    EXPECT_STREQ(replies[0], "=000080\r");
+    EXPECT_STREQ(replies[1], "=000080\r");
+    EXPECT_EQ(strlen(replies[2]), 5u);
+    EXPECT_EQ(strlen(replies[3]), 5u);
+
+    const SkywatcherUDP::CommandStats &stats = udp.getStats().at('j');
+    EXPECT_EQ(stats.requests, 2u);
+    EXPECT_EQ(stats.samples, 2u);
+    EXPECT_EQ(stats.retransmits, 0u);
+    EXPECT_GE(stats.minrtt, 2.0);
+
+    udp.Close();
+    close(client);
+}
+
+TEST(EqmodTest, udp_transport_loss_and_delay)
+{
+    // 15% loss each way, 5 to 20 ms of delay: replies to retransmitted commands come back late and twice
+    UDPMountStandIn mount(0.15, 5, 20);
+    int client = mount.connectClient();
+    SkywatcherUDP udp;
+    ASSERT_TRUE(udp.Open(client));
+
+    // each reply has to be the one of its own command
+    const char *queries[] = { ":e1\r", ":j1\r", ":f1\r", ":a2\r", ":j2\r" };
+    const char *expected[] = { "=020300\r", "=000080\r", nullptr, "=00B289\r", "=000080\r" };
+    char replies[5][SKYWATCHER_MAX_CMD];
+    char *repliesp[] = { replies[0], replies[1], replies[2], replies[3], replies[4] };
+    int const rounds = 50;
+    int mismatches   = 0;
+    auto start       = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++)
+    {
+        ASSERT_TRUE(udp.Transact(5, queries, repliesp, SKYWATCHER_MAX_CMD));
+        for (int k = 0; k < 5; k++)
+            if (expected[k] ? strcmp(replies[k], expected[k]) : (replies[k][0] != '=' || strlen(replies[k]) != 5))
+                mismatches++;
+    }
+    std::chrono::duration<double, std::milli> const lossy = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(mismatches, 0);
+
+    uint32_t requests = 0, retransmits = 0, failures = 0, samples = 0;
+    for (auto &it : udp.getStats())
+    {
+        requests += it.second.requests;
+        retransmits += it.second.retransmits;
+        failures += it.second.failures;
+        samples += it.second.samples;
+    }
+    // every command is answered before the transport gives up on it, the lost ones by a retransmit
+    EXPECT_EQ(requests, 5u * rounds);
+    EXPECT_EQ(failures, 0u);
+    EXPECT_GT(mount.dropped, 0);
+    EXPECT_GT(retransmits, 0u);
+    EXPECT_LT(samples, requests);
+    EXPECT_GE(samples + retransmits, requests);
+
+    udp.Close();
+    close(client);
+
+    printf("UDP 15%% loss, 5-20 ms delay: %d polls of 5 commands in %.0f ms, "
+           "%u retransmits for %d datagrams lost\n",
+           rounds, lossy.count(), retransmits, mount.dropped.load());
+}
+
+TEST(EqmodTest, udp_transport_pipelining)
+{
+    UDPMountStandIn mount(0.0, 10, 10);
+    int client = mount.connectClient();
+    SkywatcherUDP udp;
+    ASSERT_TRUE(udp.Open(client));
+
+    const char *queries[] = { ":j1\r", ":j2\r", ":f1\r", ":f2\r" };
+    char replies[4][SKYWATCHER_MAX_CMD];
+    char *repliesp[] = { replies[0], replies[1], replies[2], replies[3] };
+    int const rounds = 20;
+
+    // one command at a time, as over the serial line
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++)
+        for (int k = 0; k < 4; k++)
+            ASSERT_TRUE(udp.Transact(1, queries + k, repliesp + k, SKYWATCHER_MAX_CMD));
+    std::chrono::duration<double, std::milli> const sequential = std::chrono::steady_clock::now() - start;
+
+    // only a retransmitted command puts a second reply on its way
+    auto retransmits = [&udp]()
+    {
+        return static_cast<int>(udp.getStats().at('j').retransmits + udp.getStats().at('f').retransmits);
+    };
+    EXPECT_LE(mount.queued, 1 + retransmits());
+
+    // the whole poll is at the mount before the first reply is due
+    mount.queued = 0;
+    start        = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++)
+        ASSERT_TRUE(udp.Transact(4, queries, repliesp, SKYWATCHER_MAX_CMD));
+    std::chrono::duration<double, std::milli> const pipelined = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(mount.queued, 4);
+
+    // Karn: only first answers are timed, none of them can beat the delay
+    const SkywatcherUDP::CommandStats &stats = udp.getStats().at('f');
+    EXPECT_EQ(stats.requests, 4u * rounds);
+    EXPECT_GT(stats.samples, 0u);
+    EXPECT_GE(stats.minrtt, 10.0);
+
+    udp.Close();
+    close(client);
+
+    printf("UDP 10 ms delay, status poll: %.1f ms one command at a time, %.1f ms pipelined\n",
+           sequential.count() / rounds, pipelined.count() / rounds);
+}
+
+TEST(EqmodTest, udp_mount_prefetch)
+{
+    TestEQMod eqmod;
+    Skywatcher * const skywatcher = eqmod.getMount();
+    UDPMountStandIn mount(0.0, 2, 2);
+    int client = mount.connectClient();
+
+    skywatcher->setPortFD(client);
+    ASSERT_TRUE(skywatcher->Handshake());
+
+    // the poll reads both axes with one batch, the usual calls use its replies
+    int received = mount.received;
+    skywatcher->PrefetchStatus();
+    EXPECT_EQ(skywatcher->GetRAEncoder(), 0x800000u);
+    EXPECT_EQ(skywatcher->GetDEEncoder(), 0x800000u);
+    EXPECT_FALSE(skywatcher->IsRARunning());
+    EXPECT_FALSE(skywatcher->IsDERunning());
+    EXPECT_EQ(mount.received - received, 4);
+
+    // without a prefetch the mount is queried
+    received = mount.received;
+    EXPECT_EQ(skywatcher->GetRAEncoder(), 0x800000u);
+    EXPECT_EQ(mount.received - received, 1);
+
+    // the status read by the first poll is still fresh, the next one only reads the positions
+    received = mount.received;
+    skywatcher->PrefetchStatus();
+    EXPECT_EQ(skywatcher->GetRAEncoder(), 0x800000u);
+    EXPECT_EQ(skywatcher->GetDEEncoder(), 0x800000u);
+    EXPECT_FALSE(skywatcher->IsRARunning());
+    EXPECT_FALSE(skywatcher->IsDERunning());
+    EXPECT_EQ(mount.received - received, 2);
+
+    skywatcher->setPortFD(-1);
+    close(client);
+}
+
+TEST(EqmodTest, guide_pulse_edges)
+{
+    TestEQMod eqmod;
+    Skywatcher * const skywatcher = eqmod.getMount();
+    UDPMountStandIn mount(0.0, 0, 0);
+    int client = mount.connectClient();
+    INumber steppersN[3];
+    INumberVectorProperty steppersNP;
+
+    IUFillNumber(&steppersN[0], "RASteps360", "", "%.0f", 0, 0xFFFFFF, 0, 0);
+    IUFillNumber(&steppersN[1], "RAStepsWorm", "", "%.0f", 0, 0xFFFFFF, 0, 0);
+    IUFillNumber(&steppersN[2], "RAHighspeedRatio", "", "%.0f", 0, 0xFFFFFF, 0, 0);
+    IUFillNumberVector(&steppersNP, steppersN, 3, "EQMod Mount", "STEPPERS", "", "", IP_RO, 0, IPS_IDLE);
+
+    skywatcher->setPortFD(client);
+    ASSERT_TRUE(skywatcher->Handshake());
+    skywatcher->InquireRAEncoderInfo(&steppersNP);
+    skywatcher->InquireDEEncoderInfo(&steppersNP);
+
+    // sidereal tracking started as usual
+    skywatcher->StartRATracking(SKYWATCHER_STELLAR_SPEED);
+    ASSERT_TRUE(skywatcher->IsRARunning());
+    uint32_t const period = skywatcher->GetRAPeriod();
+
+    // pulse start and end edges in the tracking direction only change the step period
+    for (double rate : { 1.5, 1.0, 0.5, 1.0 })
+    {
+        int received      = mount.received;
+        uint32_t commands = skywatcher->GetCommandCount();
+        skywatcher->GuideRATracking(rate * SKYWATCHER_STELLAR_SPEED);
+        EXPECT_EQ(mount.received - received, 1) << "rate " << rate;
+        EXPECT_EQ(skywatcher->GetCommandCount() - commands, 1u) << "rate " << rate;
+        EXPECT_NEAR(skywatcher->GetRAPeriod(), period / rate, 1.0) << "rate " << rate;
+    }
+    EXPECT_EQ(skywatcher->GetRAPeriod(), period);
+
+    // ordinary tracking changes still read the motor status before setting the speed
+    int received = mount.received;
+    skywatcher->StartRATracking(SKYWATCHER_STELLAR_SPEED);
+    EXPECT_EQ(mount.received - received, 3);
+
+    // once the axis was stopped the edge goes through the full tracking start
+    skywatcher->StopRA();
+    received = mount.received;
+    skywatcher->GuideRATracking(SKYWATCHER_STELLAR_SPEED);
+    EXPECT_GT(mount.received - received, 1);
+    EXPECT_TRUE(skywatcher->IsRARunning());
+    EXPECT_EQ(skywatcher->GetRAPeriod(), period);
+
+    // DE is not tracking: the pulse starts the motor and its end stops it again
+    EXPECT_FALSE(skywatcher->IsDERunning());
+    received = mount.received;
+    skywatcher->GuideDETracking(0.5 * SKYWATCHER_STELLAR_SPEED);
+    EXPECT_GT(mount.received - received, 1);
+    EXPECT_TRUE(skywatcher->IsDERunning());
+    skywatcher->GuideDETracking(0.0);
+    EXPECT_FALSE(skywatcher->IsDERunning());
+
+    skywatcher->setPortFD(-1);
+    close(client);
+}
+
 int main(int argc, char **argv)
 {
     INDI::Logger::getInstance().configure("", INDI::Logger::file_off,
@@ -17,8 +17,10 @@
  */
 
 #include <sys/time.h>
+#include <algorithm>
 #include <memory>
 #include <stdint.h>
+#include <unistd.h>
 #include <arpa/inet.h>
 #include <math.h>
 #include <sys/time.h>
@@ -29,8 +31,34 @@
 #include "ffmv_ccd.h"
 #include "config.h"
 
+#include <stream/streammanager.h>
+
+#define FRAME_POLL_US 2000 /* DMA ring polling period while waiting for a frame (us) */
+
 std::unique_ptr<FFMVCCD> ffmvCCD(new FFMVCCD());
 
+/**
+ * Add a big-endian sub exposure to the stacked frame, saturating at 0xFFFF.
+ * The loop is kept branch-free so that the compiler vectorises it.
+ */
+static void stackSub(uint16_t *acc, const uint16_t *sub, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t val = acc[i] + ntohs(sub[i]);
+        acc[i] = val > 0xFFFF ? 0xFFFF : val;
+    }
+}
+
+/**
+ * Convert a big-endian frame to host order.
+ */
+static void swapFrame(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        dst[i] = ntohs(src[i]);
+}
+
 /**
  * Write to registers in the MT9V022 chip.
  * This can be done by programming the address in 0x1A00 and writing to 0x1A04.
@@ -79,10 +107,11 @@ FFMVCCD::FFMVCCD()
 {
     InExposure = false;
     capturing  = false;
+    last_exposure_length = -1;
 
     setVersion(FFMV_VERSION_MAJOR, FFMV_VERSION_MINOR);
 
-    SetCCDCapability(CCD_CAN_ABORT);
+    SetCCDCapability(CCD_CAN_ABORT | CCD_HAS_STREAMING);
 }
 
 /**************************************************************************************
@@ -259,6 +288,9 @@ bool FFMVCCD::Connect()
 ***************************************************************************************/
 bool FFMVCCD::Disconnect()
 {
+    workerAbort = true;
+    joinWorker();
+
     if (dcam)
     {
         dc1394_capture_stop(dcam);
@@ -294,6 +326,13 @@ bool FFMVCCD::initProperties()
     IUFillSwitchVector(&GainSP, GainS, 2, getDeviceName(), "GAIN", "Gain", IMAGE_SETTINGS_TAB, IP_WO, ISR_NOFMANY, 0,
                        IPS_IDLE);
 
+    /* Sub exposure statistics of the last exposure */
+    IUFillNumber(&SubStatsN[SUBS_STACKED], "SUBS_STACKED", "Stacked", "%.f", 0, 1e6, 0, 0);
+    IUFillNumber(&SubStatsN[SUBS_DROPPED], "SUBS_DROPPED", "Dropped", "%.f", 0, 1e6, 0, 0);
+    IUFillNumber(&SubStatsN[SUBS_CORRUPT], "SUBS_CORRUPT", "Corrupt", "%.f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&SubStatsNP, SubStatsN, 3, getDeviceName(), "CCD_SUB_STATS", "Subs", IMAGE_INFO_TAB, IP_RO, 60,
+                       IPS_IDLE);
+
     setDefaultPollingPeriod(250);
 
     return true;
@@ -316,10 +355,12 @@ bool FFMVCCD::updateProperties()
         // Start the timer
         SetTimer(getCurrentPollingPeriod());
         defineProperty(&GainSP);
+        defineProperty(&SubStatsNP);
     }
     else
     {
         deleteProperty(GainSP.name);
+        deleteProperty(SubStatsNP.name);
     }
 
     return true;
@@ -356,6 +397,18 @@ bool FFMVCCD::StartExposure(float duration)
 
     ms = duration * 1000;
 
+    if (Streamer->isBusy())
+    {
+        LOG_ERROR("Cannot take exposure while streaming/recording is active.");
+        return false;
+    }
+
+    if (InExposure)
+    {
+        LOG_ERROR("Camera is already exposing.");
+        return false;
+    }
+
     //LOG_ERROR("Doing %d sub exposures at %f %s each", sub_count, absShutter, prop_info.pUnits);
 
     ExposureRequest = duration;
@@ -405,6 +458,7 @@ bool FFMVCCD::StartExposure(float duration)
             LOG_ERROR("Unable to get shutter value.");
         }
         LOGF_DEBUG("Shutter value is %f.", fval);
+        last_exposure_length = duration;
     }
 
     /* Flush the DMA buffer */
@@ -434,6 +488,13 @@ bool FFMVCCD::StartExposure(float duration)
         return false;
     }
 
+    /* Stack the subs while they arrive, so the DMA ring never fills up */
+    subsStacked = subsDropped = subsCorrupt = 0;
+    subsDone    = false;
+    joinWorker();
+    workerAbort = false;
+    workerThread = std::thread(&FFMVCCD::captureSubs, this);
+
     // We're done
     return true;
 }
@@ -443,6 +504,9 @@ bool FFMVCCD::StartExposure(float duration)
 ***************************************************************************************/
 bool FFMVCCD::AbortExposure()
 {
+    workerAbort = true;
+    joinWorker();
+    dc1394_video_set_transmission(dcam, DC1394_OFF);
     InExposure = false;
     return true;
 }
@@ -577,17 +641,20 @@ void FFMVCCD::TimerHit()
         // This is an over simplified timing method, check CCDSimulator and ffmvCCD for better timing checks
         if (timeleft < 0.1)
         {
-            /* We're done exposing */
-            LOG_DEBUG("Exposure done, downloading image...");
-
             // Set exposure left to zero
             PrimaryCCD.setExposureLeft(0);
 
-            // We're no longer exposing...
-            InExposure = false;
+            /* We're done exposing once the worker has stacked the last sub */
+            if (subsDone)
+            {
+                LOG_DEBUG("Exposure done, all subs stacked.");
+
+                // We're no longer exposing...
+                InExposure = false;
 
-            /* grab and save image */
-            grabImage();
+                /* save image */
+                grabImage();
+            }
         }
         else
         {
@@ -601,72 +668,192 @@ void FFMVCCD::TimerHit()
 }
 
 /**
- * Download image from FireFly
+ * Wait for the next frame in the DMA ring.
+ * The ring is polled so that abort is never stuck in a blocking dequeue.
+ * Returns nullptr on error, abort or when no frame arrived within timeout_ms.
  */
-void FFMVCCD::grabImage()
+dc1394video_frame_t *FFMVCCD::waitFrame(int timeout_ms)
 {
-    dc1394error_t err;
-    dc1394video_frame_t *frame;
-    uint32_t uheight, uwidth;
-    int sub;
-    uint16_t val;
-    struct timeval start, end;
+    dc1394video_frame_t *frame = nullptr;
+    int waited_us = 0;
 
-    std::unique_lock<std::mutex> guard(ccdBufferLock);
-    // Let's get a pointer to the frame buffer
-    uint8_t *image = PrimaryCCD.getFrameBuffer();
+    while (!workerAbort && waited_us < timeout_ms * 1000)
+    {
+        if (dc1394_capture_dequeue(dcam, DC1394_CAPTURE_POLICY_POLL, &frame) != DC1394_SUCCESS)
+        {
+            return nullptr;
+        }
+        if (frame)
+        {
+            return frame;
+        }
+        usleep(FRAME_POLL_US);
+        waited_us += FRAME_POLL_US;
+    }
 
-    // Get width and height
+    return nullptr;
+}
+
+/**
+ * Worker stacking sub exposures as they arrive
+ */
+void FFMVCCD::captureSubs()
+{
     int width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
     int height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    int timeout_ms = ExposureRequest / sub_count * 2000 + 1000;
 
-    memset(image, 0, PrimaryCCD.getFrameBufferSize());
-
-    /*-----------------------------------------------------------------------
-    *  stop data transmission
-    *-----------------------------------------------------------------------*/
-
-    gettimeofday(&start, nullptr);
-    for (sub = 0; sub < sub_count; ++sub)
+    for (int sub = 0; sub < sub_count && !workerAbort; ++sub)
     {
         LOGF_DEBUG("Getting sub %d of %d", sub, sub_count);
-        err = dc1394_capture_dequeue(dcam, DC1394_CAPTURE_POLICY_WAIT, &frame);
-        if (err != DC1394_SUCCESS)
+        dc1394video_frame_t *frame = waitFrame(timeout_ms);
+        if (frame == nullptr)
         {
-            LOG_ERROR("Could not capture frame");
+            if (!workerAbort)
+            {
+                LOG_ERROR("Could not capture frame");
+                subsDropped++;
+            }
+            continue;
         }
-        dc1394_get_image_size_from_video_mode(dcam, DC1394_VIDEO_MODE_640x480_MONO16, &uwidth, &uheight);
 
         if (DC1394_TRUE == dc1394_capture_is_frame_corrupt(dcam, frame))
         {
             LOG_ERROR("Corrupt frame!");
+            subsCorrupt++;
+        }
+        else
+        {
+            size_t count = std::min<size_t>(width * height, frame->image_bytes / sizeof(uint16_t));
+
+            std::unique_lock<std::mutex> guard(ccdBufferLock);
+            stackSub(reinterpret_cast<uint16_t *>(PrimaryCCD.getFrameBuffer()),
+                     reinterpret_cast<const uint16_t *>(frame->image), count);
+            guard.unlock();
+
+            subsStacked++;
+        }
+
+        dc1394_capture_enqueue(dcam, frame);
+    }
+
+    subsDone = true;
+}
+
+/**
+ * Worker sending frames to the streamer
+ */
+void FFMVCCD::streamVideo()
+{
+    int width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    int height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    int timeout_ms = ExposureRequest * 2000 + 1000;
+
+    while (!workerAbort)
+    {
+        dc1394video_frame_t *frame = waitFrame(timeout_ms);
+        if (frame == nullptr)
+        {
             continue;
         }
-        // Fill buffer with random pattern
-        for (int i = 0; i < height; i++)
+
+        if (DC1394_TRUE == dc1394_capture_is_frame_corrupt(dcam, frame))
         {
-            for (int j = 0; j < width; j++)
-            {
-                /* Detect unsigned overflow */
-                val = ((uint16_t *)image)[i * width + j] + ntohs(((uint16_t *)(frame->image))[i * width + j]);
-                if (val > ((uint16_t *)image)[i * width + j])
-                {
-                    ((uint16_t *)image)[i * width + j] = val;
-                }
-                else
-                {
-                    ((uint16_t *)image)[i * width + j] = 0xFFFF;
-                }
-            }
+            LOG_DEBUG("Corrupt frame!");
+        }
+        else
+        {
+            size_t count = std::min<size_t>(width * height, frame->image_bytes / sizeof(uint16_t));
+            streamBuffer.resize(count);
+            swapFrame(streamBuffer.data(), reinterpret_cast<const uint16_t *>(frame->image), count);
+            Streamer->newFrame(reinterpret_cast<uint8_t *>(streamBuffer.data()), count * sizeof(uint16_t));
         }
 
         dc1394_capture_enqueue(dcam, frame);
     }
-    guard.unlock();
-    err = dc1394_video_set_transmission(dcam, DC1394_OFF);
-    gettimeofday(&end, nullptr);
-    LOGF_DEBUG("Download took %d uS", (int)((end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec)));
+}
+
+void FFMVCCD::joinWorker()
+{
+    if (workerThread.joinable())
+    {
+        workerThread.join();
+    }
+}
+
+/**
+ * Finish the exposure once all subs are stacked
+ */
+void FFMVCCD::grabImage()
+{
+    joinWorker();
+
+    dc1394_video_set_transmission(dcam, DC1394_OFF);
+
+    SubStatsN[SUBS_STACKED].value = subsStacked;
+    SubStatsN[SUBS_DROPPED].value = subsDropped;
+    SubStatsN[SUBS_CORRUPT].value = subsCorrupt;
+    SubStatsNP.s = (subsDropped || subsCorrupt) ? IPS_ALERT : IPS_OK;
+    IDSetNumber(&SubStatsNP, nullptr);
+
+    if (subsDropped || subsCorrupt)
+    {
+        LOGF_WARN("Stacked %d of %d subs (%d dropped, %d corrupt).", subsStacked, sub_count, subsDropped, subsCorrupt);
+    }
 
     // Let INDI::CCD know we're done filling the image buffer
     ExposureComplete(&PrimaryCCD);
 }
+
+/**************************************************************************************
+** Client is asking us to start streaming
+***************************************************************************************/
+bool FFMVCCD::StartStreaming()
+{
+    dc1394error_t err;
+
+    // Stream and exposure share the DMA ring and the worker thread
+    if (InExposure)
+    {
+        LOG_ERROR("Cannot start streaming while an exposure is in progress.");
+        return false;
+    }
+
+    // Every stream frame is a single sub, limited by the longest shutter the camera supports
+    ExposureRequest = std::min<float>(1.0 / Streamer->getTargetFPS(), max_exposure);
+
+    err = dc1394_feature_set_absolute_value(dcam, DC1394_FEATURE_SHUTTER, ExposureRequest);
+    if (err != DC1394_SUCCESS)
+    {
+        LOG_ERROR("Unable to set shutter value.");
+        return false;
+    }
+    // Next exposure must program its own sub length again
+    last_exposure_length = -1;
+
+    Streamer->setPixelFormat(INDI_MONO, 16);
+    Streamer->setSize(PrimaryCCD.getSubW() / PrimaryCCD.getBinX(), PrimaryCCD.getSubH() / PrimaryCCD.getBinY());
+
+    err = dc1394_video_set_transmission(dcam, DC1394_ON);
+    if (err != DC1394_SUCCESS)
+    {
+        LOG_ERROR("Unable to start transmission");
+        return false;
+    }
+
+    joinWorker();
+    workerAbort = false;
+    workerThread = std::thread(&FFMVCCD::streamVideo, this);
+    return true;
+}
+
+/**************************************************************************************
+** Client is asking us to stop streaming
+***************************************************************************************/
+bool FFMVCCD::StopStreaming()
+{
+    workerAbort = true;
+    joinWorker();
+    dc1394_video_set_transmission(dcam, DC1394_OFF);
+    return true;
+}
@@ -23,6 +23,10 @@
 #include <indiccd.h>
 #include <dc1394/dc1394.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 using namespace std;
 
 class FFMVCCD : public INDI::CCD
@@ -45,11 +49,19 @@ class FFMVCCD : public INDI::CCD
     bool AbortExposure();
     void TimerHit();
 
+    // Streaming
+    bool StartStreaming();
+    bool StopStreaming();
+
   private:
     // Utility functions
     float CalcTimeLeft();
     void setupParams();
     void grabImage();
+    void captureSubs();
+    void streamVideo();
+    dc1394video_frame_t *waitFrame(int timeout_ms);
+    void joinWorker();
     dc1394error_t writeMicronReg(unsigned int offset, unsigned int val);
     dc1394error_t readMicronReg(unsigned int offset, unsigned int *val);
 
@@ -67,6 +79,25 @@ class FFMVCCD : public INDI::CCD
     float last_exposure_length;
     int sub_count;
 
+    // Sub exposures are dequeued and stacked by a worker while the exposure runs
+    std::thread workerThread;
+    std::atomic_bool workerAbort { false };
+    std::atomic_bool subsDone { false };
+    int subsStacked { 0 };
+    int subsDropped { 0 };
+    int subsCorrupt { 0 };
+
+    INumber SubStatsN[3];
+    INumberVectorProperty SubStatsNP;
+    enum
+    {
+        SUBS_STACKED,
+        SUBS_DROPPED,
+        SUBS_CORRUPT
+    };
+
+    std::vector<uint16_t> streamBuffer;
+
     ISwitch GainS[2];
     ISwitchVectorProperty GainSP;
 
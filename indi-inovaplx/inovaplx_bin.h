@@ -0,0 +1,93 @@
+/*
+   INDI Driver for i-Nova PLX series
+   Copyright 2013/2014 i-Nova Technologies - Ilia Platone
+
+   Copyright (C) 2017 Jasem Mutlaq (mutlaqja@ikarustech.com)
+*/
+
+#pragma once
+
+#include <arpa/inet.h>
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+
+/* Raw frames are big-endian */
+inline uint32_t rawPixel(uint8_t v)
+{
+    return v;
+}
+
+inline uint32_t rawPixel(uint16_t v)
+{
+    return ntohs(v);
+}
+
+/**
+ * Bin and crop a raw frame. Each output pixel is the sum of a BIN x BIN block,
+ * saturated to the pixel type. BIN = 0 selects the generic binX x binY path.
+ * Sums are accumulated a whole output row at a time so that the inner loops
+ * run over contiguous memory and vectorise.
+ */
+template <typename T, int BIN>
+void binFrame(const uint8_t *raw, T *out, int rawW, int x0, int y0, int outW, int outH, int binX, int binY,
+              uint32_t *acc)
+{
+    const int bx = BIN ? BIN : binX;
+    const int by = BIN ? BIN : binY;
+    const uint32_t maxVal = std::numeric_limits<T>::max();
+    const T *src = reinterpret_cast<const T *>(raw);
+
+    for (int oy = 0; oy < outH; oy++)
+    {
+        T *dst = out + static_cast<size_t>(oy) * outW;
+
+        if (bx == 1 && by == 1)
+        {
+            const T *row = src + static_cast<size_t>(y0 + oy) * rawW + x0;
+            for (int ox = 0; ox < outW; ox++)
+                dst[ox] = rawPixel(row[ox]);
+            continue;
+        }
+
+        std::fill(acc, acc + outW, 0);
+        for (int r = 0; r < by; r++)
+        {
+            const T *row = src + static_cast<size_t>(y0 + oy * by + r) * rawW + x0;
+            for (int ox = 0; ox < outW; ox++)
+            {
+                uint32_t t = 0;
+                for (int c = 0; c < bx; c++)
+                    t += rawPixel(row[ox * bx + c]);
+                acc[ox] += t;
+            }
+        }
+
+        for (int ox = 0; ox < outW; ox++)
+            dst[ox] = acc[ox] < maxVal ? acc[ox] : maxVal;
+    }
+}
+
+template <typename T>
+void binFrame(const uint8_t *raw, T *out, int rawW, int x0, int y0, int outW, int outH, int binX, int binY,
+              uint32_t *acc)
+{
+    switch (binX == binY ? binX : 0)
+    {
+        case 1:
+            binFrame<T, 1>(raw, out, rawW, x0, y0, outW, outH, binX, binY, acc);
+            break;
+        case 2:
+            binFrame<T, 2>(raw, out, rawW, x0, y0, outW, outH, binX, binY, acc);
+            break;
+        case 3:
+            binFrame<T, 3>(raw, out, rawW, x0, y0, outW, outH, binX, binY, acc);
+            break;
+        case 4:
+            binFrame<T, 4>(raw, out, rawW, x0, y0, outW, outH, binX, binY, acc);
+            break;
+        default:
+            binFrame<T, 0>(raw, out, rawW, x0, y0, outW, outH, binX, binY, acc);
+            break;
+    }
+}
@@ -7,8 +7,17 @@
 
 #include <stdlib.h>
 #include <sys/file.h>
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include "inovaplx_ccd.h"
+#include "inovaplx_bin.h"
+
+#define GRAB_POLL_US 5000 /* Polling period of iNovaSDK_GrabFrame (us) */
+
+// The SDK is not thread safe: the capture thread, the guide timers and the INDI
+// handlers all go through this lock before calling it
+static std::mutex sdkMutex;
 
 int timerNS = -1;
 int timerWE = -1;
@@ -30,6 +39,7 @@ std::unique_ptr<INovaCCD> inova(new INovaCCD());
 static void timerWestEast(void * arg)
 {
     INDI_UNUSED(arg);
+    std::lock_guard<std::mutex> lock(sdkMutex);
     DIR |= 0x09;
     iNovaSDK_SendST4(DIR);
     IERmCallback(timerWE);
@@ -38,6 +48,7 @@ static void timerWestEast(void * arg)
 static void timerNorthSouth(void * arg)
 {
     INDI_UNUSED(arg);
+    std::lock_guard<std::mutex> lock(sdkMutex);
     DIR |= 0x06;
     iNovaSDK_SendST4(DIR);
     IERmCallback(timerNS);
@@ -52,6 +63,7 @@ INovaCCD::INovaCCD()
 bool INovaCCD::Connect()
 {
     const char *Sn;
+    std::lock_guard<std::mutex> lock(sdkMutex);
     if(iNovaSDK_MaxCamera() > 0)
     {
         Sn = iNovaSDK_OpenCamera(1);
@@ -90,6 +102,8 @@ bool INovaCCD::Connect()
 
 bool INovaCCD::Disconnect()
 {
+    stopCapture();
+    std::lock_guard<std::mutex> lock(sdkMutex);
     iNovaSDK_SensorPowerDown();
     iNovaSDK_CloseVideo();
     iNovaSDK_CloseCamera();
@@ -162,11 +176,14 @@ bool INovaCCD::updateProperties()
     if (isConnected())
     {
         // Define our properties
-        IUSaveText(&iNovaInformationT[0], iNovaSDK_GetName());
-        IUSaveText(&iNovaInformationT[1], iNovaSDK_SensorName());
-        IUSaveText(&iNovaInformationT[2], iNovaSDK_SerialNumber());
-        IUSaveText(&iNovaInformationT[3], (iNovaSDK_HasST4() ? "Yes" : "No"));
-        IUSaveText(&iNovaInformationT[4], (iNovaSDK_HasColorSensor() ? "Yes" : "No"));
+        {
+            std::lock_guard<std::mutex> lock(sdkMutex);
+            IUSaveText(&iNovaInformationT[0], iNovaSDK_GetName());
+            IUSaveText(&iNovaInformationT[1], iNovaSDK_SensorName());
+            IUSaveText(&iNovaInformationT[2], iNovaSDK_SerialNumber());
+            IUSaveText(&iNovaInformationT[3], (iNovaSDK_HasST4() ? "Yes" : "No"));
+            IUSaveText(&iNovaInformationT[4], (iNovaSDK_HasColorSensor() ? "Yes" : "No"));
+        }
         defineProperty(&iNovaInformationTP);
         defineProperty(&CameraPropertiesNP);
 
@@ -191,8 +208,15 @@ bool INovaCCD::updateProperties()
 ***************************************************************************************/
 void INovaCCD::setupParams()
 {
+    std::unique_lock<std::mutex> lock(sdkMutex);
     int bpp = iNovaSDK_GetDataWide() > 0 ? 16 : 8;
-    SetCCDParams(iNovaSDK_GetImageWidth(), iNovaSDK_GetImageHeight(), bpp, iNovaSDK_GetPixelSizeX(), iNovaSDK_GetPixelSizeY());
+    int w = iNovaSDK_GetImageWidth();
+    int h = iNovaSDK_GetImageHeight();
+    double pixelX = iNovaSDK_GetPixelSizeX();
+    double pixelY = iNovaSDK_GetPixelSizeY();
+    lock.unlock();
+
+    SetCCDParams(w, h, bpp, pixelX, pixelY);
 
     // Let's calculate how much memory we need for the primary CCD buffer
     int nbuf;
@@ -206,8 +230,13 @@ void INovaCCD::setupParams()
 ***************************************************************************************/
 bool INovaCCD::StartExposure(float duration)
 {
+    stopCapture();
+
     double expTime = 1000.0 * duration;
-    iNovaSDK_SetExpTime(expTime);
+    {
+        std::lock_guard<std::mutex> lock(sdkMutex);
+        iNovaSDK_SetExpTime(expTime);
+    }
 
     ExposureRequest = duration;
     PrimaryCCD.setExposureDuration(ExposureRequest);
@@ -215,6 +244,10 @@ bool INovaCCD::StartExposure(float duration)
 
     InExposure = true;
 
+    frameReady = false;
+    captureAbort = false;
+    captureThread = std::thread(&INovaCCD::CaptureThread, this);
+
     // We're done
     return true;
 }
@@ -224,11 +257,50 @@ bool INovaCCD::StartExposure(float duration)
 ***************************************************************************************/
 bool INovaCCD::AbortExposure()
 {
-    iNovaSDK_CancelLongExpTime();
+    stopCapture();
+    {
+        std::lock_guard<std::mutex> lock(sdkMutex);
+        iNovaSDK_CancelLongExpTime();
+    }
     InExposure = false;
     return true;
 }
 
+/**************************************************************************************
+** Stop the capture thread, if any
+***************************************************************************************/
+void INovaCCD::stopCapture()
+{
+    captureAbort = true;
+    if (captureThread.joinable())
+        captureThread.join();
+}
+
+/**************************************************************************************
+** Wait for the exposure, grab the frame and bin it, away from the INDI event loop
+***************************************************************************************/
+void INovaCCD::CaptureThread()
+{
+    // Sleep through the exposure, staying responsive to abort
+    while (!captureAbort && CalcTimeLeft() > 0)
+        usleep(std::min<long>(CalcTimeLeft() * 1000000, 100000) + 1000);
+
+    while (!captureAbort)
+    {
+        // RawData belongs to the SDK, keep the lock until it is binned
+        std::unique_lock<std::mutex> lock(sdkMutex);
+        RawData = (unsigned char*)iNovaSDK_GrabFrame();
+        if (RawData != nullptr)
+        {
+            grabImage();
+            frameReady = true;
+            return;
+        }
+        lock.unlock();
+        usleep(GRAB_POLL_US);
+    }
+}
+
 /**************************************************************************************
 ** How much longer until exposure is done?
 ***************************************************************************************/
@@ -258,8 +330,10 @@ bool INovaCCD::ISNewNumber(const char *dev, const char *name, double values[], c
     {
         IUUpdateNumber(&CameraPropertiesNP, values, names, n);
 
+        std::unique_lock<std::mutex> lock(sdkMutex);
         iNovaSDK_SetAnalogGain(static_cast<int16_t>(CameraPropertiesN[CCD_GAIN_N].value));
         iNovaSDK_SetBlackLevel(static_cast<int16_t>(CameraPropertiesN[CCD_BLACKLEVEL_N].value));
+        lock.unlock();
 
         CameraPropertiesNP.s = IPS_OK;
         IDSetNumber(&CameraPropertiesNP, nullptr);
@@ -308,18 +382,18 @@ void INovaCCD::TimerHit()
             // Just update time left in client
             PrimaryCCD.setExposureLeft(timeleft);
         }
-        else
+        else if (frameReady)
         {
-            /* We're done exposing */
-            LOG_INFO("Exposure done, downloading image...");
-            RawData = (unsigned char*)iNovaSDK_GrabFrame();
-            if(RawData != nullptr)
-            {
-                // We're no longer exposing...
-                InExposure = false;
+            /* The capture thread has the image in the frame buffer */
+            captureThread.join();
+            frameReady = false;
 
-                grabImage();
-            }
+            // We're no longer exposing...
+            InExposure = false;
+
+            // Let INDI::CCD know we're done filling the image buffer
+            LOG_INFO("Download complete.");
+            ExposureComplete(&PrimaryCCD);
         }
     }
 
@@ -329,6 +403,7 @@ void INovaCCD::TimerHit()
 
 IPState INovaCCD::GuideEast(uint32_t ms)
 {
+    std::lock_guard<std::mutex> lock(sdkMutex);
     DIR |= 0x09;
     DIR &= 0x0E;
     iNovaSDK_SendST4(DIR);
@@ -338,6 +413,7 @@ IPState INovaCCD::GuideEast(uint32_t ms)
 
 IPState INovaCCD::GuideWest(uint32_t ms)
 {
+    std::lock_guard<std::mutex> lock(sdkMutex);
     DIR |= 0x09;
     DIR &= 0x07;
     iNovaSDK_SendST4(DIR);
@@ -347,6 +423,7 @@ IPState INovaCCD::GuideWest(uint32_t ms)
 
 IPState INovaCCD::GuideNorth(uint32_t ms)
 {
+    std::lock_guard<std::mutex> lock(sdkMutex);
     DIR |= 0x06;
     DIR &= 0x0D;
     iNovaSDK_SendST4(DIR);
@@ -356,6 +433,7 @@ IPState INovaCCD::GuideNorth(uint32_t ms)
 
 IPState INovaCCD::GuideSouth(uint32_t ms)
 {
+    std::lock_guard<std::mutex> lock(sdkMutex);
     DIR |= 0x06;
     DIR &= 0x0B;
     iNovaSDK_SendST4(DIR);
@@ -370,55 +448,22 @@ void INovaCCD::grabImage()
     unsigned char * image = PrimaryCCD.getFrameBuffer();
     if(image != nullptr)
     {
-        int Bpp = iNovaSDK_GetDataWide() > 0 ? 2 : 1;
-        int p = 0;
-
         int binX = PrimaryCCD.getBinX();
         int binY = PrimaryCCD.getBinY();
         int startX = PrimaryCCD.getSubX();
         int startY = PrimaryCCD.getSubY();
-        int endX = startX + PrimaryCCD.getSubW();
-        int endY = startY + PrimaryCCD.getSubH();
-        int maxW = PrimaryCCD.getXRes();
-        int maxH = PrimaryCCD.getYRes();
-        endX = (endX > maxW ? maxW : endX);
-        endY = (endY > maxH ? maxH : endY);
-
-        for(int y = startY; y < endY; y += binY)
-        {
-            if(endY - y < binY)
-                break;
-            for(int x = startX * Bpp; x < endX * Bpp; x += Bpp * binX)
-            {
-                if(endX * Bpp - x < binX * Bpp)
-                    break;
-                int t = 0;
-                for(int yy = y; yy < y + binY; yy++)
-                {
-                    for(int xx = x; xx < x + Bpp * binX; xx += Bpp)
-                    {
-                        if(Bpp > 1)
-                        {
-                            t += RawData[1 + xx + yy * maxW * Bpp] + (RawData[xx + yy * maxW * Bpp] << 8);
-                            t = (t < 0xffff ? t : 0xffff);
-                        }
-                        else
-                        {
-                            t += RawData[xx + yy * maxW * Bpp];
-                            t = (t < 0xff ? t : 0xff);
-                        }
-                    }
-                }
-                image[p++] = (unsigned char)(t & 0xff);
-                if(Bpp > 1)
-                {
-                    image[p++] = (unsigned char)((t >> 8) & 0xff);
-                }
-            }
-        }
-        guard.unlock();
-        // Let INDI::CCD know we're done filling the image buffer
-        LOG_INFO("Download complete.");
-        ExposureComplete(&PrimaryCCD);
+        int endX = std::min(startX + PrimaryCCD.getSubW(), PrimaryCCD.getXRes());
+        int endY = std::min(startY + PrimaryCCD.getSubH(), PrimaryCCD.getYRes());
+
+        // Partial bins at the right and bottom edges are dropped
+        int outW = (endX - startX) / binX;
+        int outH = (endY - startY) / binY;
+        binAccumulator.resize(outW);
+
+        if (PrimaryCCD.getBPP() > 8)
+            binFrame(RawData, reinterpret_cast<uint16_t *>(image), PrimaryCCD.getXRes(), startX, startY, outW, outH, binX, binY,
+                     binAccumulator.data());
+        else
+            binFrame(RawData, image, PrimaryCCD.getXRes(), startX, startY, outW, outH, binX, binY, binAccumulator.data());
     }
 }
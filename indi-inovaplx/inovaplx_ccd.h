@@ -11,6 +11,9 @@
 #include <time.h>
 #include <unistd.h>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
 #include <indiccd.h>
 
 #include <inovasdk.h>
@@ -59,6 +62,13 @@ private:
 
     unsigned char *RawData;
 
+    // Frames are grabbed and binned by CaptureThread, TimerHit only completes the exposure
+    std::thread captureThread;
+    std::atomic_bool captureAbort { false };
+    std::atomic_bool frameReady { false };
+    std::vector<uint32_t> binAccumulator;
+    void stopCapture();
+
     // Struct to keep timing
     struct timeval ExpStart;
     float ExposureRequest;      
@@ -22,10 +22,13 @@
 */
 
 #include "mi_ccd.h"
+#include "mi_orient.h"
 
 #include "config.h"
 
 #include <math.h>
+#include <string.h>
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <utility>
@@ -199,6 +202,12 @@ bool MICCD::initProperties()
     IUFillNumberVector(&PreflashNP, PreflashN, 2, getDeviceName(), "NIR_PRE_FLASH", "NIR Preflash",
                        MAIN_CONTROL_TAB, IP_RW, 60, IPS_IDLE);
 
+    // Image orientation, applied during the line flip every frame needs anyway
+    IUFillSwitch(&OrientationS[ORIENTATION_MIRROR], "MIRROR_HORIZONTAL", "Mirror horizontal", ISS_OFF);
+    IUFillSwitch(&OrientationS[ORIENTATION_ROTATE_180], "ROTATE_180", "Rotate 180", ISS_OFF);
+    IUFillSwitchVector(&OrientationSP, OrientationS, 2, getDeviceName(), "CCD_ORIENTATION", "Orientation",
+                       IMAGE_SETTINGS_TAB, IP_RW, ISR_NOFMANY, 0, IPS_IDLE);
+
     addAuxControls();
 
     setDriverInterface(getDriverInterface() | FILTER_INTERFACE);
@@ -234,6 +243,8 @@ void MICCD::ISGetProperties(const char *dev)
         if (canDoPreflash)
             defineProperty(&PreflashNP);
 
+        defineProperty(&OrientationSP);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -270,6 +281,8 @@ bool MICCD::updateProperties()
         if (canDoPreflash)
             defineProperty(&PreflashNP);
 
+        defineProperty(&OrientationSP);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -305,6 +318,8 @@ bool MICCD::updateProperties()
         if (canDoPreflash)
             deleteProperty(PreflashNP.name);
 
+        deleteProperty(OrientationSP.name);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -585,26 +600,6 @@ float MICCD::calcTimeLeft()
     return ExposureRequest - timesince / 1000.0;
 }
 
-static void mirror_image(void *buf, size_t w, size_t d)
-{
-    size_t w2     = w * 2;
-    size_t half_d = d / 2;
-
-    for (size_t line = 1; line <= half_d; line++)
-    {
-        uint16_t *sa = (uint16_t *)((char *)buf + (line - 1) * w2);
-        uint16_t *da = (uint16_t *)((char *)buf + (d - line) * w2);
-        for (size_t index = 1; index <= w; index++)
-        {
-            uint16_t tmp = *sa;
-            *sa          = *da;
-            *da          = tmp;
-            ++sa;
-            ++da;
-        }
-    }
-}
-
 /* Downloads the image from the CCD. */
 int MICCD::grabImage()
 {
@@ -633,7 +628,9 @@ int MICCD::grabImage()
         }
         else
         {
-            mirror_image(image, width, height);
+            bool rotate = OrientationS[ORIENTATION_ROTATE_180].s == ISS_ON;
+            bool mirror = OrientationS[ORIENTATION_MIRROR].s == ISS_ON;
+            orient_image(reinterpret_cast<uint16_t *>(image), width, height, !rotate, mirror != rotate);
         }
     }
 
@@ -768,6 +765,13 @@ bool MICCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char
             IDSetSwitch(&ReadModeSP, nullptr);
             return true;
         }
+        else if (!strcmp(name, OrientationSP.name))
+        {
+            IUUpdateSwitch(&OrientationSP, states, names, n);
+            OrientationSP.s = IPS_OK;
+            IDSetSwitch(&OrientationSP, nullptr);
+            return true;
+        }
         else if (!strcmp(name, CoolerSP.name))
         {
 
@@ -1002,6 +1006,7 @@ bool MICCD::saveConfigItems(FILE *fp)
 
     IUSaveConfigNumber(fp, &TemperatureRampNP);
     IUSaveConfigSwitch(fp, &ReadModeSP);
+    IUSaveConfigSwitch(fp, &OrientationSP);
 
     if (numFilters > 0)
     {
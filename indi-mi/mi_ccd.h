@@ -91,6 +91,14 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
     INumber PreflashN[2];
     INumberVectorProperty PreflashNP;
 
+    ISwitch OrientationS[2];
+    ISwitchVectorProperty OrientationSP;
+    enum
+    {
+        ORIENTATION_MIRROR,
+        ORIENTATION_ROTATE_180,
+    };
+
   private:
     char name[MAXINDIDEVICE];
 
@@ -0,0 +1,96 @@
+/*
+ Moravian Instruments INDI Driver
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "mi_orient.h"
+
+#include <string.h>
+#include <algorithm>
+
+#define ORIENT_BLOCK 2048 /* Pixels per stack block of a plain line swap */
+
+/* Reverses the order of the four pixels packed in a 64 bit word */
+static inline uint64_t reverse4(uint64_t x)
+{
+    x = (x >> 32) | (x << 32);
+    return ((x >> 16) & 0x0000FFFF0000FFFFULL) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+}
+
+/* Exchanges a[i] and b[n - 1 - i] for all i, a and b must not overlap. Pixels move four at
+ * a time in 64 bit words, the word order within a 64 bit word does not depend on endianness. */
+static void swap_reversed(uint16_t *a, uint16_t *b, size_t n)
+{
+    size_t groups = n / 4;
+    for (size_t g = 0; g < groups; g++)
+    {
+        uint64_t x, y;
+        memcpy(&x, a + 4 * g, sizeof(x));
+        memcpy(&y, b + n - 4 - 4 * g, sizeof(y));
+        x = reverse4(x);
+        y = reverse4(y);
+        memcpy(a + 4 * g, &y, sizeof(y));
+        memcpy(b + n - 4 - 4 * g, &x, sizeof(x));
+    }
+    for (size_t i = 4 * groups; i < n; i++)
+    {
+        uint16_t t   = a[i];
+        a[i]         = b[n - 1 - i];
+        b[n - 1 - i] = t;
+    }
+}
+
+/* Lines come from the camera bottom-up. Flips them vertically (unless flipV is cleared) and
+ * optionally mirrors them horizontally in one in-place pass, so 180 deg rotation is just
+ * a horizontal mirror. Plain row swaps go through a stack block so memcpy can vectorize them,
+ * mirrored ones swap four pixels at a time. */
+void orient_image(uint16_t *buf, size_t w, size_t h, bool flipV, bool mirrorH)
+{
+    if (flipV && h > 1)
+    {
+        uint16_t tmp[ORIENT_BLOCK];
+        for (size_t top = 0, bottom = h - 1; top < bottom; top++, bottom--)
+        {
+            uint16_t *sa = buf + top * w;
+            uint16_t *da = buf + bottom * w;
+            if (mirrorH)
+            {
+                swap_reversed(sa, da, w);
+            }
+            else
+            {
+                for (size_t i = 0; i < w; i += ORIENT_BLOCK)
+                {
+                    size_t len = std::min<size_t>(ORIENT_BLOCK, w - i) * sizeof(uint16_t);
+                    memcpy(tmp, sa + i, len);
+                    memcpy(sa + i, da + i, len);
+                    memcpy(da + i, tmp, len);
+                }
+            }
+        }
+        // The middle line of an odd frame has no partner
+        if (mirrorH && (h % 2))
+        {
+            uint16_t *line = buf + (h / 2) * w;
+            swap_reversed(line, line + w - w / 2, w / 2);
+        }
+    }
+    else if (mirrorH)
+    {
+        for (size_t line = 0; line < h; line++)
+            swap_reversed(buf + line * w, buf + line * w + w - w / 2, w / 2);
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ Moravian Instruments image orientation benchmark
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Times orient_image on a synthetic frame for each rotate/mirror combination, against a
+ * per-pixel swap of the same transform, and checks that both give the same frame.
+ */
+
+#include "mi_orient.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <vector>
+
+static size_t width  = 4096;
+static size_t height = 4096;
+static int runs      = 10;
+
+/* One pixel at a time, as the mirror used to be done */
+static void orient_scalar(uint16_t *buf, size_t w, size_t h, bool flipV, bool mirrorH)
+{
+    if (flipV)
+    {
+        for (size_t top = 0, bottom = h - 1; top <= bottom && bottom < h; top++, bottom--)
+        {
+            uint16_t *sa = buf + top * w;
+            uint16_t *da = buf + bottom * w;
+            size_t n = (top == bottom) ? w / 2 : w;
+            for (size_t i = 0; i < n; i++)
+            {
+                size_t j   = mirrorH ? w - 1 - i : i;
+                uint16_t t = sa[i];
+                sa[i]      = da[j];
+                da[j]      = t;
+            }
+        }
+    }
+    else if (mirrorH)
+    {
+        for (size_t line = 0; line < h; line++)
+        {
+            uint16_t *l = buf + line * w;
+            for (size_t i = 0, j = w - 1; i < j; i++, j--)
+            {
+                uint16_t t = l[i];
+                l[i]       = l[j];
+                l[j]       = t;
+            }
+        }
+    }
+}
+
+static double run(void (*orient)(uint16_t *, size_t, size_t, bool, bool), std::vector<uint16_t> &buf, bool flipV,
+                  bool mirrorH)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++)
+        orient(buf.data(), width, height, flipV, mirrorH);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / runs;
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'w':
+                width = strtoul(optarg, nullptr, 10);
+                break;
+            case 'h':
+                height = strtoul(optarg, nullptr, 10);
+                break;
+            case 'n':
+                runs = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-w width] [-h height] [-n runs]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (width == 0 || height == 0 || runs <= 0)
+    {
+        fprintf(stderr, "Width, height and runs must be positive\n");
+        return 1;
+    }
+
+    std::vector<uint16_t> frame(width * height);
+    for (size_t i = 0; i < frame.size(); i++)
+        frame[i] = static_cast<uint16_t>(i * 7 + 3);
+
+    // Named after the CCD_ORIENTATION switches that select each transform
+    static const char *names[] = { "both", "rotate", "none", "mirror" };
+    printf("%zux%zu frame, %d runs\n", width, height, runs);
+    printf("%-8s %12s %12s\n", "switches", "scalar (ms)", "orient (ms)");
+    int failed = 0;
+    for (int mode = 0; mode < 4; mode++)
+    {
+        bool flipV   = mode & 2;
+        bool mirrorH = mode & 1;
+        std::vector<uint16_t> scalar = frame, oriented = frame;
+        double scalarMs = run(orient_scalar, scalar, flipV, mirrorH);
+        double orientMs = run(orient_image, oriented, flipV, mirrorH);
+        printf("%-8s %12.2f %12.2f\n", names[mode], scalarMs, orientMs);
+        if (scalar != oriented)
+        {
+            fprintf(stderr, "%s: frames differ\n", names[mode]);
+            failed++;
+        }
+    }
+    return failed ? 1 : 0;
+}
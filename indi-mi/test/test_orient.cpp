@@ -0,0 +1,84 @@
+/*
+ Moravian Instruments INDI Driver
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * In-place orientation of the downloaded frame, checked against a naive copy
+ * for each combination of the rotate and mirror switches. Sizes cover odd and
+ * even heights and lines wider than the swap block.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mi_orient.h"
+
+static std::vector<uint16_t> frame(size_t w, size_t h)
+{
+    std::vector<uint16_t> buf(w * h);
+    for (size_t i = 0; i < buf.size(); i++)
+        buf[i] = static_cast<uint16_t>(i * 7 + 3);
+    return buf;
+}
+
+static std::vector<uint16_t> reference(const std::vector<uint16_t> &src, size_t w, size_t h, bool flipV, bool mirrorH)
+{
+    std::vector<uint16_t> dst(w * h);
+    for (size_t y = 0; y < h; y++)
+        for (size_t x = 0; x < w; x++)
+            dst[y * w + x] = src[(flipV ? h - 1 - y : y) * w + (mirrorH ? w - 1 - x : x)];
+    return dst;
+}
+
+static void check(size_t w, size_t h, bool flipV, bool mirrorH)
+{
+    std::vector<uint16_t> buf = frame(w, h);
+    std::vector<uint16_t> expected = reference(buf, w, h, flipV, mirrorH);
+    orient_image(buf.data(), w, h, flipV, mirrorH);
+    EXPECT_EQ(buf, expected) << w << "x" << h << " flipV=" << flipV << " mirrorH=" << mirrorH;
+}
+
+static const size_t sizes[][2] = { { 1, 1 }, { 5, 1 }, { 1, 6 }, { 4, 3 }, { 7, 8 }, { 2048, 3 }, { 3001, 4 }, { 4099, 5 } };
+
+// default: lines come bottom-up and are only flipped
+TEST(OrientImageTest, flip)
+{
+    for (auto &s : sizes)
+        check(s[0], s[1], true, false);
+}
+
+// mirror switch alone
+TEST(OrientImageTest, flip_and_mirror)
+{
+    for (auto &s : sizes)
+        check(s[0], s[1], true, true);
+}
+
+// rotate switch alone: 180 deg of the flipped frame is a horizontal mirror
+TEST(OrientImageTest, rotate)
+{
+    for (auto &s : sizes)
+        check(s[0], s[1], false, true);
+}
+
+// mirror and rotate cancel the flip, the frame is left as read
+TEST(OrientImageTest, rotate_and_mirror)
+{
+    for (auto &s : sizes)
+        check(s[0], s[1], false, false);
+}
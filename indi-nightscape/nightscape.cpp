@@ -278,6 +278,13 @@ bool NightscapeCCD::initProperties()
 #endif
     defineProperty(&D2xxSP);
 
+    IUFillNumber(&DownloadStatsN[DOWNLOAD_TIME], "DOWNLOAD_TIME", "Download (s)", "%.2f", 0, 3600, 0, 0);
+    IUFillNumber(&DownloadStatsN[DOWNLOAD_RATE], "DOWNLOAD_RATE", "Rate (MB/s)", "%.2f", 0, 1000, 0, 0);
+    IUFillNumber(&DownloadStatsN[DOWNLOAD_STALLS], "DOWNLOAD_STALLS", "Stalls", "%.0f", 0, 1e6, 0, 0);
+    IUFillNumber(&DownloadStatsN[DOWNLOAD_STALL_TIME], "DOWNLOAD_STALL_TIME", "Stalled (s)", "%.3f", 0, 3600, 0, 0);
+    IUFillNumberVector(&DownloadStatsNP, DownloadStatsN, 4, getDeviceName(), "CCD_DOWNLOAD_STATS", "Download",
+                       IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
     // We set the CCD capabilities
     uint32_t cap = CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_COOLER | CCD_HAS_SHUTTER ;
     if (bayer)
@@ -313,6 +320,7 @@ bool NightscapeCCD::updateProperties()
         setupParams();
         defineProperty(&CoolerSP);
         defineProperty(&FanSP);
+        defineProperty(&DownloadStatsNP);
 
         // Start the timer
         SetTimer(getCurrentPollingPeriod());
@@ -321,6 +329,7 @@ bool NightscapeCCD::updateProperties()
     {
         deleteProperty(FanSP.name);
         deleteProperty(CoolerSP.name);
+        deleteProperty(DownloadStatsNP.name);
     }
 
     return true;
@@ -372,6 +381,7 @@ bool NightscapeCCD::StartExposure(float duration)
     dn->setImgSize(m->getRawImgSize(zonestart, zonelen, framediv));
     dn->setFrameYBinning(framediv);
     dn->setFrameXBinning(PrimaryCCD.getBinX());
+    dn->setLineFormat(PrimaryCCD.getSubX(), PrimaryCCD.getSubW(), PrimaryCCD.getBinX());
     m->sendzone(zonestart, zonelen, framediv);
     INDI::CCDChip::CCD_FRAME ft = PrimaryCCD.getFrameType();
     if (ft == INDI::CCDChip::DARK_FRAME || ft == INDI::CCDChip::BIAS_FRAME) dark = true;
@@ -562,6 +572,14 @@ void NightscapeCCD::TimerHit()
 ***************************************************************************************/
 void NightscapeCCD::grabImage()
 {
+    if (dn->getDownloadFailed())
+    {
+        LOG_ERROR("Image download failed.");
+        dn->freeBuf();
+        PrimaryCCD.setExposureFailed();
+        return;
+    }
+
     // Let's get a pointer to the frame buffer
     std::unique_lock<std::mutex> guard(ccdBufferLock);
     uint8_t *image = PrimaryCCD.getFrameBuffer();
@@ -583,6 +601,14 @@ void NightscapeCCD::grabImage()
     dn->freeBuf();
     LOGF_DEBUG( "Download %d lines complete.", dn->getActWriteLines());
 
+    double dltime = dn->getDownloadTime();
+    DownloadStatsN[DOWNLOAD_TIME].value = dltime;
+    DownloadStatsN[DOWNLOAD_RATE].value = dltime > 0 ? dn->getDownloadBytes() / dltime / (1024.0 * 1024.0) : 0;
+    DownloadStatsN[DOWNLOAD_STALLS].value = dn->getStalls();
+    DownloadStatsN[DOWNLOAD_STALL_TIME].value = dn->getStallTime();
+    DownloadStatsNP.s = IPS_OK;
+    IDSetNumber(&DownloadStatsNP, nullptr);
+
     // Let INDI::CCD know we're done filling the image buffer
     ExposureComplete(&PrimaryCCD);
 }
@@ -81,6 +81,16 @@ class NightscapeCCD : public INDI::CCD
 #endif
 #endif
 	  ISwitchVectorProperty D2xxSP;
+
+    INumber DownloadStatsN[4];
+    INumberVectorProperty DownloadStatsNP;
+    enum
+    {
+        DOWNLOAD_TIME,
+        DOWNLOAD_RATE,
+        DOWNLOAD_STALLS,
+        DOWNLOAD_STALL_TIME
+    };
 	   
   private:
     // Utility functions
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "nschannel-replay.h"
+#include  "nsdebug.h"
+
+static long long micros()
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return (long long)now.tv_usec + (long long)now.tv_sec * 1000000LL;
+}
+
+int NsChannelReplay::scan(void) {
+		f = fopen(fname, "rb");
+		if (f == NULL) {
+			DO_ERR( "cannot open replay file %s, error %s\n", fname, strerror(errno));
+			return -1;
+		}
+		fseek(f, 0, SEEK_END);
+		size = ftell(f);
+		ndevs = 1;
+		restart();
+		DO_INFO("replaying %s, %ld bytes\n", fname, size);
+		return ndevs;
+}
+
+int NsChannelReplay::opencontrol(void) {
+		return 0;
+}
+
+int NsChannelReplay::opendownload(void) {
+		// same payload per read as a real FT2232H chunk
+		maxxfer = DEFAULT_CHUNK_SIZE - ((DEFAULT_CHUNK_SIZE / 512)*2);
+		return maxxfer;
+}
+
+int NsChannelReplay::close() {
+		if (f) fclose(f);
+		f = NULL;
+		opened = 0;
+		return 0;
+}
+
+int NsChannelReplay::resetcontrol(void) {
+		return 0;
+}
+
+void NsChannelReplay::restart(void) {
+		if (f) fseek(f, 0, SEEK_SET);
+		sent = 0;
+		startus = micros();
+}
+
+long NsChannelReplay::getSize(void) {
+		return size;
+}
+
+int NsChannelReplay::readCommand(unsigned char *, size_t) {
+		return 0;
+}
+
+int NsChannelReplay::writeCommand(const unsigned char *, size_t size) {
+		return size;
+}
+
+int NsChannelReplay::readData(unsigned char *buf, size_t size) {
+		if (f == NULL) return -1;
+		if (rate > 0) {
+			// hold the data back until the link would have delivered it
+			long long due = startus + (long long)((sent + size) * 1000000.0 / rate);
+			long long now = micros();
+			if (due > now) usleep(due - now);
+		}
+		size_t rc = fread(buf, 1, size, f);
+		if (rc == 0 && ferror(f)) {
+			DO_ERR( "replay read failed: %s\n", strerror(errno));
+			return -1;
+		}
+		sent += rc;
+		return rc;
+}
+
+int NsChannelReplay::purgeData(void) {
+		return 0;
+}
+
+int NsChannelReplay::setDataRts(void) {
+		return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef __NS_CHANNEL_REPLAY_H__
+#define __NS_CHANNEL_REPLAY_H__
+#include "nschannel.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Feeds a recorded raw download (as written by nstest) back through the
+// data channel, optionally paced at a fixed rate, for download timing runs.
+class NsChannelReplay : public NsChannel {
+	public:
+		NsChannelReplay(const char * file, double mbps) {
+			fname = file;
+			rate = mbps * 1024.0 * 1024.0;
+			f = NULL;
+			size = 0;
+			maxxfer = 0;
+			opened = 0;
+			camnum = 1;
+		}
+		~NsChannelReplay() { close(); }
+		int close();
+		int readCommand(unsigned char * buf, size_t n);
+		int writeCommand(const unsigned char * buf, size_t n);
+		int readData(unsigned char * buf, size_t n);
+		int purgeData(void);
+		int setDataRts(void);
+		int resetcontrol (void);
+		void restart(void);
+		long getSize(void);
+
+  protected:
+  	int opencontrol (void);
+		int opendownload(void);
+		int scan(void);
+	private:
+		const char * fname;
+		FILE * f;
+		long size;
+		double rate;
+		long long sent;
+		long long startus;
+};
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "nschannel-u.h"
 #include  "nsdebug.h"
+#include <string.h>
 
 struct ftdi_context * NsChannelU::getDataChannel(void) {
 		return &data_channel;	
@@ -12,6 +13,7 @@ struct ftdi_context * NsChannelU::getCommandChannel(void) {
 
 int NsChannelU::close()
 {
+		stopStream();
 		ftdi_usb_close(&data_channel);
 		ftdi_usb_close(&command_channel);
 		ftdi_usb_close(&scan_channel);
@@ -111,6 +113,7 @@ int  NsChannelU::opendownload(void)
        return -1;
     }	
      //maxxfer = chunksize - ((chunksize / 64)*2);
+    streamsize = chunksize;
     maxxfer = chunksize - ((chunksize / 512)*2);
     //maxxfer = imgsz;
     DO_INFO("actual read chunksize %d, max xfer %d\n", chunksize, maxxfer); 
@@ -285,4 +288,116 @@ int NsChannelU::setDataRts(void) {
 	}	
 	return 0;
 }   			
- 
\ No newline at end of file
+ 
+static void LIBUSB_CALL stream_done(struct libusb_transfer * xfer)
+{
+	struct ns_stream_xfer * sx = (struct ns_stream_xfer *)xfer->user_data;
+	sx->done = 1;
+}
+
+int NsChannelU::startStream(void) {
+	struct ftdi_context * ftdid = &data_channel;
+	int rc2;
+
+	if (streaming) stopStream();
+	for (int i = 0; i < NS_STREAM_XFERS; i++) {
+		stream[i].xfer = NULL;
+		stream[i].buf = NULL;
+		stream[i].done = 1;
+	}
+	for (int i = 0; i < NS_STREAM_XFERS; i++) {
+		stream[i].xfer = libusb_alloc_transfer(0);
+		stream[i].buf = (unsigned char *)malloc(streamsize);
+		if (stream[i].xfer == NULL || stream[i].buf == NULL) {
+			DO_ERR("unable to allocate stream transfer %d\n", i);
+			streaming = true;
+			stopStream();
+			return -1;
+		}
+		libusb_fill_bulk_transfer(stream[i].xfer, ftdid->usb_dev, ftdid->out_ep,
+			stream[i].buf, streamsize, stream_done, &stream[i], ftdid->usb_read_timeout);
+	}
+	streaming = true;
+	streamhead = 0;
+	// queue every transfer up front so the host always has a request
+	// pending on the data endpoint while the previous one is consumed
+	for (int i = 0; i < NS_STREAM_XFERS; i++) {
+		stream[i].done = 0;
+		rc2 = libusb_submit_transfer(stream[i].xfer);
+		if (rc2 < 0) {
+			stream[i].done = 1;
+			DO_ERR("unable to submit stream transfer: %d (%s)\n", rc2, libusb_error_name(rc2));
+			stopStream();
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int NsChannelU::streamData(unsigned char *buf, size_t size) {
+	struct ftdi_context * ftdid = &data_channel;
+	int rc2;
+
+	if (!streaming) return readData(buf, size);
+
+	struct ns_stream_xfer * sx = &stream[streamhead];
+	while (!sx->done) {
+		struct timeval tv = { 0, 100000 };
+		rc2 = libusb_handle_events_timeout_completed(ftdid->usb_ctx, &tv, (int *)&sx->done);
+		if (rc2 < 0) {
+			DO_ERR("unable to handle stream events: %d (%s)\n", rc2, libusb_error_name(rc2));
+			return -1;
+		}
+	}
+	struct libusb_transfer * xfer = sx->xfer;
+	if (xfer->status != LIBUSB_TRANSFER_COMPLETED && xfer->status != LIBUSB_TRANSFER_TIMED_OUT) {
+		DO_ERR("stream transfer failed: %d\n", xfer->status);
+		return -1;
+	}
+
+	// every packet starts with two modem status bytes, strip them
+	int nread = 0;
+	int packet = ftdid->max_packet_size;
+	for (int off = 0; off < xfer->actual_length; off += packet) {
+		int len = xfer->actual_length - off;
+		if (len > packet) len = packet;
+		if (len <= 2) continue;
+		len -= 2;
+		if ((size_t)(nread + len) > size) {
+			DO_ERR("stream read overflow %d\n", nread + len);
+			len = size - nread;
+		}
+		memcpy(buf + nread, xfer->buffer + off + 2, len);
+		nread += len;
+	}
+
+	sx->done = 0;
+	rc2 = libusb_submit_transfer(xfer);
+	if (rc2 < 0) {
+		sx->done = 1;
+		DO_ERR("unable to resubmit stream transfer: %d (%s)\n", rc2, libusb_error_name(rc2));
+		return -1;
+	}
+	streamhead = (streamhead + 1) % NS_STREAM_XFERS;
+	return nread;
+}
+
+void NsChannelU::stopStream(void) {
+	struct ftdi_context * ftdid = &data_channel;
+
+	if (!streaming) return;
+	for (int i = 0; i < NS_STREAM_XFERS; i++) {
+		if (stream[i].xfer && !stream[i].done) libusb_cancel_transfer(stream[i].xfer);
+	}
+	for (int i = 0; i < NS_STREAM_XFERS; i++) {
+		while (stream[i].xfer && !stream[i].done) {
+			struct timeval tv = { 0, 100000 };
+			if (libusb_handle_events_timeout_completed(ftdid->usb_ctx, &tv, (int *)&stream[i].done) < 0) break;
+		}
+		if (stream[i].xfer) libusb_free_transfer(stream[i].xfer);
+		if (stream[i].buf) free(stream[i].buf);
+		stream[i].xfer = NULL;
+		stream[i].buf = NULL;
+	}
+	streaming = false;
+}
@@ -4,6 +4,15 @@
 #include <stdlib.h>
 #include <libftdi1/ftdi.h>
 
+// bulk transfers kept queued on the data endpoint while streaming
+#define NS_STREAM_XFERS 4
+
+struct ns_stream_xfer {
+	struct libusb_transfer * xfer;
+	unsigned char * buf;
+	volatile int done;
+};
+
 class NsChannelU : public NsChannel {
 	public:
 		NsChannelU() {
@@ -26,6 +35,9 @@ class NsChannelU : public NsChannel {
 		int readCommand(unsigned char * buf, size_t n);
 		int writeCommand(const unsigned char * buf, size_t n);
 		int readData(unsigned char * buf, size_t n);
+		int startStream(void);
+		int streamData(unsigned char * buf, size_t n);
+		void stopStream(void);
 		int purgeData(void);
 		int setDataRts(void);
 		int resetcontrol (void);
@@ -42,6 +54,10 @@ class NsChannelU : public NsChannel {
 		struct ftdi_context data_channel;
 		struct ftdi_device_list * devs;
 		struct libusb_device * camdev;
+		struct ns_stream_xfer stream[NS_STREAM_XFERS];
+		int streamhead { 0 };
+		bool streaming { false };
+		unsigned streamsize { 0 };
 		
 
 };
@@ -25,6 +25,11 @@ class NsChannel {
 		virtual int readCommand(unsigned char * buf, size_t n) = 0;
 		virtual int writeCommand(const unsigned char * buf, size_t n) = 0;
 		virtual int readData(unsigned char * buf, size_t n)= 0;
+		// streamed download: channels that can keep several reads in flight
+		// override these, the default is a plain blocking readData
+		virtual int startStream(void) { return 0; }
+		virtual int streamData(unsigned char * buf, size_t n) { return readData(buf, n); }
+		virtual void stopStream(void) { }
 		virtual int purgeData(void)= 0;
 		virtual int setDataRts(void)= 0;
 		virtual int resetcontrol (void)= 0;
@@ -7,6 +7,20 @@
 #include <string.h>
 #include "nsdebug.h"
 #include <math.h>
+#include <sys/time.h>
+
+// give up if the camera sends nothing at all for this long
+#define NS_FIRST_DATA_US 30000000LL
+// once data flowed, the image is over only after this long without data,
+// whatever the read timeout of the channel is
+#define NS_LAST_DATA_US 3000000LL
+
+static long long micros()
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return (long long)now.tv_usec + (long long)now.tv_sec * 1000000LL;
+}
 
 void NsDownload::setFrameYBinning(int binning) {
 			ctx->imgp->ybinning = binning;	
@@ -112,52 +126,71 @@ void NsDownload::setZeroReads(int zeroes){
 
 int NsDownload::downloader() 
 {
-			//struct ftdi_context * ftdid = cn->->getDataChannel();
-			//struct ftdi_transfer_control * ctl;
-
       int rc2;
-      int hardloop = 20; 
-      int sleepage = 1000;
-    
 			int download =1;
-			if (rd->nread > rd->bufsiz) {
+			int maxxfer = cn->getMaxXfer();
+
+			if (rd->nread + maxxfer > rd->bufsiz) {
             DO_ERR("image too large %d\n", rd->nread);
 		     		return (-1);
 			}
-    	while((rc2 = cn->readData(rd->buffer+rd->nread, cn->getMaxXfer())) == 0 && hardloop > 0) {
-				if (hardloop % 5  == 0) DO_INFO("W%d\n",hardloop);
-    		usleep(sleepage);
-				sleepage *= 2;
-				if (sleepage > 100000) sleepage = 100000;
-				hardloop--;
+			if (!streaming) {
+				// keep the channel's reads queued for the whole image, there
+				// is no sleeping between reads any more, an empty read just
+				// means the camera has not caught up yet
+				if (cn->startStream() < 0) {
+					DO_ERR("%s\n", "unable to start stream, falling back to plain reads");
+				}
+				streaming = true;
+				zeroes = 0;
+				stalls = 0;
+				stallus = 0;
+				firstus = 0;
+				startus = micros();
+				lastus = startus;
 			}
-      /* ctl = ftdi_read_data_submit(ftdid, rd->buffer+rd->nread,  maxxfer);
-      if (ctl == NULL) {
-      	DO_ERR( "unable to submit read: %d (%s)\n", rc2, ftdi_get_error_string(ftdid));
-				return (-1);
-      }
-      DO_INFO( ".");
-      rc2 = ftdi_transfer_data_done(ctl);
-      */
+			long long t0 = micros();
+			rc2 = cn->streamData(rd->buffer+rd->nread, maxxfer);
+			long long t1 = micros();
    		if (rc2 < 0 ) {
         DO_ERR("unable to read download data: %d\n", rc2);
+        cn->stopStream();
+        streaming = false;
 				return (-1);
 			}
-			rd->nread += rc2;
-			if (rc2 != cn->getMaxXfer()) {
-				DO_INFO("short! %d %d\n", rd->nblks, rc2);
-			}		
-			
-			if (rc2 == 0) {
+			if (rc2 > 0) {
+				if (firstus == 0) firstus = t0;
+				lastus = t1;
+				rd->nread += rc2;
+				rd->nblks ++;
+				zeroes = 0;
+				cooklines();
+			} else if (rd->nread > 0) {
+				stalls++;
+				stallus += t1 - t0;
+				zeroes++;
+			} else if (t1 - startus > NS_FIRST_DATA_US) {
+				DO_ERR("no download data after %lld ms\n", (t1 - startus) / 1000);
+				cn->stopStream();
+				streaming = false;
+				return (-1);
+			}
+
+			if (rd->nread >= rd->imgsz || (rd->nread > 0 && zeroes >= zero_reads && t1 - lastus >= NS_LAST_DATA_US)) {
 				readdone = 1;
-			} else { rd->nblks ++; }
-			if (rd->nread >= rd->imgsz) {
-				readdone = 1;	
 			}
 			if (readdone) {
 			  download=0;
 				lastread = rc2;
-			
+				cn->stopStream();
+				streaming = false;
+
+				dlbytes = rd->nread;
+				dltime = firstus ? (lastus - firstus) / 1000000.0 : 0;
+				stalltime = stallus / 1000000.0;
+				laststalls = stalls;
+				DO_INFO("download %d bytes in %.3f s, %d stalls %.3f s\n", rd->nread, dltime, stalls, stalltime);
+
 				rb = rdd;
 				retrBuf = &rb;
 				rd->buffer = NULL;
@@ -165,6 +198,26 @@ int NsDownload::downloader()
 			return download;		
 }
 
+double NsDownload::getDownloadTime() {
+	return dltime;
+}
+
+size_t NsDownload::getDownloadBytes() {
+	return dlbytes;
+}
+
+int NsDownload::getStalls() {
+	return laststalls;
+}
+
+double NsDownload::getStallTime() {
+	return stalltime;
+}
+
+bool NsDownload::getDownloadFailed() {
+	return dlfailed;
+}
+
 
 /*
 
@@ -302,14 +355,65 @@ void NsDownload::writedownload(int pad, int cooked)
 
 
 
+static void cookline(const uint8_t * src, uint8_t * dst, int xstart, int xlen, int xbin)
+{
+	const uint16_t * in = (const uint16_t *)(src + (KAF8300_POSTAMBLE*2) + xstart*2);
+	uint16_t * out = (uint16_t *)dst;
+	int nout;
+
+	if (xbin <= 1) {
+		memcpy (out, in, xlen * 2);
+		return;
+	}
+	nout = xlen / xbin;
+	if (xbin == 2) {
+		for (int i = 0; i < nout; i++)
+			out[i] = (in[2*i] + in[2*i+1]) >> 1;
+	} else {
+		for (int i = 0; i < nout; i++) {
+			unsigned pxav = 0;
+			for (int a = 0; a < xbin; a++)
+				pxav += in[i*xbin + a];
+			out[i] = pxav / xbin;
+		}
+	}
+}
+
+void NsDownload::setLineFormat(int xstart, int xlen, int xbin)
+{
+	std::unique_lock<std::mutex> ulock(mutx);
+	size_t need;
+
+	if (xbin < 1) xbin = 1;
+	need = (size_t)(xlen / xbin) * 2 * IMG_MAX_Y;
+	if (need > cookbufsiz) {
+		free(cookbuf);
+		cookbuf = (unsigned char *)malloc(need);
+		cookbufsiz = cookbuf ? need : 0;
+	}
+	cook_xstart = xstart;
+	cook_xlen = xlen;
+	cook_xbin = xbin;
+	cookedlines = 0;
+}
+
+// convert the lines that have completely arrived since the last read
+void NsDownload::cooklines()
+{
+	int linelen, lines;
+
+	if (cookbuf == NULL) return;
+	linelen = (cook_xlen / cook_xbin) * 2;
+	lines = rd->nread / (KAF8300_MAX_X*2);
+	if (lines > IMG_MAX_Y) lines = IMG_MAX_Y;
+	for (; cookedlines < lines; cookedlines++) {
+		cookline(rd->buffer + (size_t)cookedlines * KAF8300_MAX_X*2,
+			cookbuf + (size_t)cookedlines * linelen, cook_xstart, cook_xlen, cook_xbin);
+	}
+}
+
 void NsDownload::copydownload(unsigned char *buf, int xstart, int xlen, int xbin, int pad, int cooked)
 {
-	unsigned char linebuf[KAF8300_MAX_X*2];
-	bool forwards = true;
-	bool rms = false;
-	int binning = xbin;
-	uint8_t * dbufp = buf;
-	uint8_t * bufp;
 	int nwrite = 0;
 	
 	if (retrBuf == NULL) {
@@ -324,66 +428,23 @@ void NsDownload::copydownload(unsigned char *buf, int xstart, int xlen, int xbin
 		} else {
 			nwrite = retrBuf->nread;
 		}
-		memcpy (dbufp, retrBuf->buffer, nwrite);
+		memcpy (buf, retrBuf->buffer, nwrite);
 	} else {
-		//int actlines = nwrite / (KAF8300_MAX_X*2);
-	  //int rem = nwrite % (KAF8300_MAX_X*2);
-	  nwrite = retrBuf->nread;
-		int nwriteleft = nwrite;
-		if (forwards) {
-			bufp = retrBuf->buffer;
-			//dbufp =  (dbufp +(KAF8300_ACTIVE_X*2*IMG_Y)) - (KAF8300_ACTIVE_X*2);
-		} else {
-			bufp = (retrBuf->buffer + nwrite) - (KAF8300_MAX_X*2);
-			dbufp =  (dbufp +(KAF8300_ACTIVE_X*2*IMG_MAX_Y)) - (KAF8300_ACTIVE_X*2);
+		if (xbin < 1) xbin = 1;
+		int linelen = (xlen / xbin) * 2;
+		int lines = retrBuf->nread / (KAF8300_MAX_X*2);
+		int done = 0;
+
+		// most of the frame was already converted while it was downloading
+		if (cookbuf && cook_xstart == xstart && cook_xlen == xlen && cook_xbin == xbin) {
+			done = cookedlines < lines ? cookedlines : lines;
+			memcpy (buf, cookbuf, (size_t)done * linelen);
 		}
-		writelines = 0;
-	  while (nwriteleft >= (KAF8300_MAX_X*2)) {
-	  //swab (bufp + (KAF8300_POSTAMBLE*2),  linebuf, KAF8300_ACTIVE_X*2 );
-	   //memcpy (dbufp, linebuf, KAF8300_ACTIVE_X*2);
-	    if (binning > 1) {
-	    	uint8_t * lbufp = bufp + (KAF8300_POSTAMBLE*2) + xstart*2;
-	    	int len = xlen * 2;
-	    	int linelen = 0;
-	    	while (len > 0) {
-	    		short px[4];
-	    		long long pxsq =0;
-	    		long pxav =0;
-	    		short pxa;
-	    		memcpy(px, lbufp,binning * 2);
-	    		for (int a = 0; a < binning; a++) {
-	    			pxav += px[a];
-	    			pxsq	+= px[a]*px[a];
-	    		}
-	    		pxav /= binning;
-	    		pxsq /= binning;
-	    		if(rms) {
-	    			pxa = round(sqrt((double)	pxsq));
-	    			
-	    		} else {
-	    			pxa = pxav;	
-	    		}
-	    		memcpy (linebuf + linelen, &pxa, 2);
-	    		linelen += 2;
-	    		lbufp += 2*binning;
-	    		len -= 2* binning;
-				}
-				memcpy (dbufp, linebuf, (xlen*2)/binning);
-
-	    } else {
-	  		memcpy (dbufp, bufp + (KAF8300_POSTAMBLE*2) + xstart*2, xlen * 2 ); //KAF8300_ACTIVE_X*2 );
-	  	}
-			if (forwards) { 
-				bufp +=  KAF8300_MAX_X*2;
-				dbufp +=(xlen*2)/binning;
-			} else {
-				bufp -=  KAF8300_MAX_X*2;
-				dbufp-=(xlen*2)/binning;
-			}
-			nwriteleft -= KAF8300_MAX_X*2;
-			writelines++;
-	  }
-	 DO_INFO( "wrote %d lines\n", writelines);
+		for (int y = done; y < lines; y++) {
+			cookline(retrBuf->buffer + (size_t)y * KAF8300_MAX_X*2, buf + (size_t)y * linelen, xstart, xlen, xbin);
+		}
+		writelines = lines;
+	 DO_INFO( "wrote %d lines (%d converted during download)\n", writelines, done);
 	}	 
 }
 
@@ -407,26 +468,6 @@ int NsDownload::purgedownload()
 }
 
 
-int NsDownload::fulldownload() 
-{
-		int rc2;
-		
-		rc2 = cn->readData(rd->buffer+rd->nread, rd->bufsiz - rd->nread);
-		if (rc2 < 0 ) {
-			DO_ERR( "unable to read: %d\n", rc2);
-			return (-1);
-		}
-		if (rc2 > 0) {
-			DO_INFO("read %d\n", rc2);
-		  rd->nread += rc2;
-		  rd->nblks += rc2/65536;
-		  DO_INFO("read %d tot %d\n", rc2, rd->nread);
-
-		}	
-		return rc2;
-}
-
-
 void NsDownload::initdownload()
 {
 	  long imgszmax = KAF8300_MAX_X*0x9ca*2 + DEFAULT_CHUNK_SIZE;
@@ -439,6 +480,7 @@ void NsDownload::initdownload()
 
 		rd->bufsiz = imgszmax;
 		rd->nblks = 0;	
+		cookedlines = 0;
 }
 
 
@@ -450,11 +492,6 @@ void NsDownload::initdownload()
 void NsDownload::trun()
 {
 
-	int maxxfer;
-  int zeroes = 0;
-	//struct ftdi_context * ftdid = cn->getDataChannel();
-	maxxfer = cn->getMaxXfer();
-
 	do  {
 		DO_INFO("%s\n", "initdownload");
 		std::unique_lock<std::mutex> ulock(mutx);
@@ -465,57 +502,41 @@ void NsDownload::trun()
 
 	
 		if (do_download && !in_download) {
-			//ftdi_usb_close(ftdid);
-			//maxxfer = opendownload(ftdid, ctx->dev);
 			in_download = 1;
+			dlfailed = 0;
 			ctx->imgseq++;
-			zeroes = 0;
 		}
 	  while (in_download && !interrupted) {
-	  	//int rc2= cn->setDataRts();;
-    	//if (rc2  < 0) {
-      //  		DO_ERR( "unable to set rts: %d\n", rc2);
-    	//}	
-    	int down = 0;
-	    if (zero_reads > 1) 
-	  		down = fulldownload();
-	  	else
-	  		down = downloader();
+    	int down = downloader();
 	  	if (down < 0) {
 	  		DO_ERR( "unable to read download: %d\n", down);
+	  		dlfailed = 1;
 	  		do_download = 0;
 	  		in_download = 0;
 	  		continue;
 	  	}
-	  	if (rd->nread < rd->imgsz) {
-	  		if (down == 0 && rd->nread > 0) {
-    			zeroes++;
-	  		}
-	  		if (zeroes < zero_reads) continue;
-	  	}
+	  	if (down > 0) continue;
 	  	int pad = 0;
-	  	if (rd->nread != rd->imgsz) {
-	  		int actlines = rd->nread / (KAF8300_MAX_X*2);
-	  		int rem = rd->nread % (KAF8300_MAX_X*2);
-	  		DO_INFO( "siz %d read %d act lines %d rem %d\n",  rd->imgsz,rd->nread, actlines, rem);
-	  		if (rd->imgsz - rd->nread < KAF8300_MAX_X * 5) {
+	  	if (retrBuf->nread != retrBuf->imgsz) {
+	  		int actlines = retrBuf->nread / (KAF8300_MAX_X*2);
+	  		int rem = retrBuf->nread % (KAF8300_MAX_X*2);
+	  		DO_INFO( "siz %d read %d act lines %d rem %d\n",  retrBuf->imgsz,retrBuf->nread, actlines, rem);
+	  		if (retrBuf->imgsz - retrBuf->nread < KAF8300_MAX_X * 5) {
 	  			pad = 1;
+	  		} else if (retrBuf->nread < retrBuf->imgsz) {
+	  			DO_ERR( "download truncated: %d of %d bytes\n", retrBuf->nread, retrBuf->imgsz);
+	  			dlfailed = 1;
 	  		}
 	    }	
-	    lastread = down;
-	    	   // IDLog("foop\n");
-
-	    if (zero_reads > 1) {
-	    	rb = rdd;
-	    	retrBuf = &rb;
-	    	rd->buffer = NULL;
-	    }
-	    //IDLog("retr %p buf %p \n", retrBuf, rb.buffer);
-	    if(write_it) writedownload(pad, 0);
+	    if(write_it && !dlfailed) writedownload(pad, 0);
 			
 	  	do_download = 0;
 	  	in_download = 0;
 	  }
+	  if (streaming) {
+	  	cn->stopStream();
+	  	streaming = false;
+	  }
 	  if (!in_download && !do_download) {
 			initdownload();  	
 	  	purgedownload ();
@@ -77,6 +77,9 @@ class NsDownload {
 		 		readdone = 0;
 		 		retrBuf = NULL;
 		 }
+		 ~NsDownload() {
+		 	free(cookbuf);
+		 }
 		 void setFrameYBinning(int  binning);
 		 void setFrameXBinning(int  binning);
 
@@ -106,10 +109,16 @@ class NsDownload {
 		void copydownload(unsigned char *buf, int xstart, int xlen, int xbin, int pad, int cooked);
 		void writedownload(int pad, int cooked);
 		void setZeroReads(int zeroes);
+		void setLineFormat(int xstart, int xlen, int xbin);
+		double getDownloadTime();
+		size_t getDownloadBytes();
+		int getStalls();
+		double getStallTime();
+		bool getDownloadFailed();
 	private:
 
 	  void fitsheader(int x, int y, char * fbase, struct img_params * ip);
-		int fulldownload(); 
+		void cooklines();
 		bool getDoDownload();
 		struct download_params dp;
 		struct img_params ip;
@@ -122,6 +131,7 @@ class NsDownload {
 		volatile int do_download;
 		volatile int in_download;
 		volatile int interrupted;
+		volatile int dlfailed { 0 };
 
 		NsChannel * cn;
 		int write_it;
@@ -136,5 +146,26 @@ class NsDownload {
 		ns_readdata_t * retrBuf;
 		int zero_reads { 1 };
 		int writelines{0};
+
+		// lines reconstructed while the download is still running
+		unsigned char * cookbuf { NULL };
+		size_t cookbufsiz { 0 };
+		int cook_xstart { 0 };
+		int cook_xlen { 0 };
+		int cook_xbin { 0 };
+		int cookedlines { 0 };
+
+		// download statistics, times in microseconds
+		bool streaming { false };
+		int zeroes { 0 };
+		long long startus { 0 };
+		long long firstus { 0 };
+		long long lastus { 0 };
+		long long stallus { 0 };
+		int stalls { 0 };
+		size_t dlbytes { 0 };
+		double dltime { 0 };
+		double stalltime { 0 };
+		int laststalls { 0 };
 };
 #endif
\ No newline at end of file
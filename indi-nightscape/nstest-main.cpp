@@ -23,6 +23,7 @@
 #include "nsdownload.h"
 #include "nsdebug.h"
 #include "nschannel-u.h"
+#include "nschannel-replay.h"
 #ifdef HAVE_D2XX
 #include "nschannel-ftd.h"
 #endif
@@ -55,9 +56,46 @@ long long millis()
 
 
 
+/* download a recorded raw stream nexp times through NsDownload and report timing */
+int replay(const char * file, double rate, int nexp, int binning)
+{
+		NsChannelReplay * cn = new NsChannelReplay(file, rate);
+		if (cn->open() < 0) return -1;
+
+		NsDownload * d = new NsDownload(cn);
+		d->setImgSize(cn->getSize());
+		d->setZeroReads(1);
+		d->setLineFormat(0, KAF8300_ACTIVE_X, binning);
+		unsigned char * frame = (unsigned char *)malloc(KAF8300_ACTIVE_X * 2 * IMG_MAX_Y);
+
+		if (nexp < 1) nexp = 1;
+		for (int n = 0; n < nexp && !interrupted; n++) {
+			int rc;
+			cn->restart();
+			d->initdownload();
+			long long start = millis();
+			while ((rc = d->downloader()) > 0 && !interrupted) ;
+			if (rc < 0) return -1;
+			long long read = millis();
+			d->copydownload(frame, 0, KAF8300_ACTIVE_X, binning, 0, 1);
+			long long copied = millis();
+			double dltime = d->getDownloadTime();
+			fprintf(stderr, "replay %d: %zu bytes in %.3f s (%.2f MB/s), %d stalls %.3f s, read %lld ms, copy %lld ms\n",
+				n + 1, d->getDownloadBytes(), dltime,
+				dltime > 0 ? d->getDownloadBytes() / dltime / (1024.0 * 1024.0) : 0,
+				d->getStalls(), d->getStallTime(), read - start, copied - read);
+			d->freeBuf();
+		}
+		free(frame);
+		delete d;
+		delete cn;
+		return 0;
+}
+
+
 void usage(char * prog)
 {
-		fprintf(stderr, "usage: %s [-c camera] [-f fanspeed=1-3] [-n num exp] [-t temp(c)] [ -d tdiff(c)] [-e exposure(s)] [-b binning=1|2] [-z start,lines] increment [-i] dark [-k]\n", prog);
+		fprintf(stderr, "usage: %s [-c camera] [-f fanspeed=1-3] [-n num exp] [-t temp(c)] [ -d tdiff(c)] [-e exposure(s)] [-b binning=1|2] [-z start,lines] increment [-i] dark [-k] [-r replay.bin] [-R replay MB/s]\n", prog);
 		exit(-1);	
 }
 
@@ -95,11 +133,13 @@ int main(int argc, char **argv)
 		char fbase [64];
 		int laststat = 0;
 		bool dark = false;
+		const char * replayfile = NULL;
+		double replayrate = 0;
     //char fbase[64] = "";
 
     //bigbuf = malloc(3358*2536*2);
     signal(SIGINT, siginthandler);
-    while ((i = getopt(argc, argv, "t:f:c:n:e:b:z:d:o:ik")) != -1)
+    while ((i = getopt(argc, argv, "t:f:c:n:e:b:z:d:o:ikr:R:")) != -1)
     {
         switch (i)
         {
@@ -138,12 +178,21 @@ int main(int argc, char **argv)
 				  case 'k':
 				  	dark = true;
 				  	break;
+				  case 'r':
+				  	replayfile = optarg;
+				  	break;
+				  case 'R':
+				  	replayrate = strtod(optarg, NULL);
+				  	break;
 					default:
 						usage(argv[0]);
 						break;
         }
     }
-    
+    if (replayfile) {
+    	exit(replay(replayfile, replayrate, nexp, binning) < 0 ? -1 : 0);
+    }
+
    	NsChannel * cn;
 #ifdef HAVE_D2XX
    	if (ftd) {
@@ -313,20 +313,10 @@ int dcraw_parse_header_info(const char *filename, struct dcraw_header *header)
     return 0;
 }
 
-int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
-                char *bayer_pattern)
+static int libraw_unpack(LibRaw &RawProcessor, const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis,
+                         int *w, int *h, int *bitsperpixel, char *bayer_pattern)
 {
     int ret = 0;
-    // Creation of image processing object
-    LibRaw RawProcessor;
-
-    // Let us open the file
-    if ((ret = RawProcessor.open_file(filename)) != LIBRAW_SUCCESS)
-    {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open %s: %s", filename, libraw_strerror(ret));
-        RawProcessor.recycle();
-        return -1;
-    }
 
     // Let us unpack the image
     if ((ret = RawProcessor.unpack()) != LIBRAW_SUCCESS)
@@ -384,6 +374,41 @@ int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_
     return 0;
 }
 
+int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
+                char *bayer_pattern)
+{
+    int ret = 0;
+    // Creation of image processing object
+    LibRaw RawProcessor;
+
+    // Let us open the file
+    if ((ret = RawProcessor.open_file(filename)) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open %s: %s", filename, libraw_strerror(ret));
+        RawProcessor.recycle();
+        return -1;
+    }
+
+    return libraw_unpack(RawProcessor, filename, memptr, memsize, n_axis, w, h, bitsperpixel, bayer_pattern);
+}
+
+int read_libraw_mem(unsigned char *inBuffer, unsigned long inSize, uint8_t **memptr, size_t *memsize, int *n_axis, int *w,
+                    int *h, int *bitsperpixel, char *bayer_pattern)
+{
+    int ret = 0;
+    LibRaw RawProcessor;
+
+    // LibRaw decodes straight from the camera download, the buffer must outlive the processor
+    if ((ret = RawProcessor.open_buffer(inBuffer, inSize)) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open raw buffer: %s", libraw_strerror(ret));
+        RawProcessor.recycle();
+        return -1;
+    }
+
+    return libraw_unpack(RawProcessor, "raw buffer", memptr, memsize, n_axis, w, h, bitsperpixel, bayer_pattern);
+}
+
 int read_dcraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel)
 {
     struct dcraw_header header;
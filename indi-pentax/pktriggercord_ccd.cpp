@@ -24,8 +24,9 @@
 
 #define MINISO 100
 #define MAXISO 102400
-
-#define TMPFILEBASE (char *)"/tmp/indipentax.tmp"
+// the image buffer is only ready once the camera has processed the frame
+#define BUFFER_RETRIES 120
+#define BUFFER_RETRY_DELAY 0.25
 
 PkTriggerCordCCD::PkTriggerCordCCD(const char * name)
 {
@@ -43,6 +44,7 @@ PkTriggerCordCCD::PkTriggerCordCCD(const char * name)
 
 PkTriggerCordCCD::~PkTriggerCordCCD()
 {
+    free(imageData);
 }
 
 const char *PkTriggerCordCCD::getDefaultName()
@@ -77,6 +79,10 @@ bool PkTriggerCordCCD::initProperties()
     IUFillSwitch(&preserveOriginalS[0], "PRESERVE_OFF", "Keep FITS Only", ISS_ON);
     IUFillSwitchVector(&preserveOriginalSP, preserveOriginalS, 2, getDeviceName(), "PRESERVE_ORIGINAL", "Copy Option", OPTIONS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
+    IUFillNumber(&DownloadStatsN[DOWNLOAD_TIME], "DOWNLOAD_TIME", "Download (s)", "%.2f", 0, 3600, 0, 0);
+    IUFillNumber(&DownloadStatsN[DOWNLOAD_RATE], "DOWNLOAD_RATE", "Rate (MB/s)", "%.2f", 0, 1000, 0, 0);
+    IUFillNumberVector(&DownloadStatsNP, DownloadStatsN, 2, getDeviceName(), "CCD_DOWNLOAD_STATS", "Download", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
     PrimaryCCD.setMinMaxStep("CCD_EXPOSURE", "CCD_EXPOSURE_VALUE", 0.0001, 7200, 1, false);
 
     IUSaveText(&BayerT[2], "RGGB");
@@ -108,6 +114,7 @@ bool PkTriggerCordCCD::updateProperties()
 
         defineProperty(&transferFormatSP);
         defineProperty(&autoFocusSP);
+        defineProperty(&DownloadStatsNP);
         if (transferFormatS[0].s == ISS_ON) {
             defineProperty(&preserveOriginalSP);
         }
@@ -119,6 +126,7 @@ bool PkTriggerCordCCD::updateProperties()
         deleteCaptureSwitches();
 
         deleteProperty(autoFocusSP.name);
+        deleteProperty(DownloadStatsNP.name);
         deleteProperty(transferFormatSP.name);
         deleteProperty(preserveOriginalSP.name);
 
@@ -273,24 +281,40 @@ bool PkTriggerCordCCD::shutterPress(pslr_rational_t shutter_speed)
 	LOG_DEBUG("Shutter pressed.");
 	pslr_get_status(device, &status);
 
-	user_file_format_t ufft = *get_file_format_t(uff);
-	char * output_file = TMPFILEBASE;
-	int fd = open_file(output_file, 1, ufft);
-	
-	int cnt = 0;
-	while ( save_buffer(device, 0, fd, &status, uff, quality ) ) {
-		LOGF_DEBUG("Saved buffer (%d)",cnt++);
+	free(imageData);
+	imageData = nullptr;
+	imageDataSize = 0;
+
+	// the download is timed from the attempt that finds the buffer ready, so
+	// the rate does not include the time spent waiting for the camera
+	struct timeval waitStart, dlStart, dlEnd;
+	gettimeofday(&waitStart, nullptr);
+
+	bool downloaded = false;
+	for (int cnt = 0; cnt < BUFFER_RETRIES; cnt++) {
+		gettimeofday(&dlStart, nullptr);
+		if (!save_buffer_mem(device, 0, &imageData, &imageDataSize, &status, uff, quality)) {
+			downloaded = true;
+			break;
+		}
+		LOGF_DEBUG("Waiting for buffer (%d)",cnt);
+		sleep_sec(BUFFER_RETRY_DELAY);
 	}
-	
+
+	gettimeofday(&dlEnd, nullptr);
+	downloadTime = downloaded ? (dlEnd.tv_sec - dlStart.tv_sec) + (dlEnd.tv_usec - dlStart.tv_usec) / 1e6 : 0;
+
 	pslr_delete_buffer(device, 0);
-	if (fd != 1) {
-		close(fd);
-	}
 	if (need_bulb_new_cleanup) {
 		bulb_new_cleanup(device);
 	}
-		
-    return 1;
+
+	if (!downloaded) {
+		LOGF_ERROR("Image buffer not ready after %.0f seconds, giving up.",
+		           (dlEnd.tv_sec - waitStart.tv_sec) + (dlEnd.tv_usec - waitStart.tv_usec) / 1e6);
+		return false;
+	}
+	return true;
 }
 
 
@@ -497,12 +521,13 @@ void PkTriggerCordCCD::TimerHit()
         std::chrono::milliseconds span (100);
         if ( shutter_result.wait_for(span)!=std::future_status::timeout) {
             bool result = shutter_result.get();
-            INDI_UNUSED(result);
             InDownload = false;
             InExposure = false;
 
-            grabImage();
-            ExposureComplete(&PrimaryCCD);
+            if (result && grabImage())
+                ExposureComplete(&PrimaryCCD);
+            else
+                PrimaryCCD.setExposureFailed();
         } else if (InDownload && isDebug()) {
             IDLog("Still waiting for download...\n");
         }
@@ -515,17 +540,18 @@ void PkTriggerCordCCD::TimerHit()
 
 bool PkTriggerCordCCD::grabImage()
 {
-    //set correct tmpfile location
-    char tmpfile[256];
-    if (uff==USER_FILE_FORMAT_JPEG) {
-        snprintf(tmpfile, 256, "%s-0001.jpg", TMPFILEBASE);
-    } else if (uff==USER_FILE_FORMAT_DNG) {
-        snprintf(tmpfile, 256, "%s-0001.dng", TMPFILEBASE);
-    } else {
-        snprintf(tmpfile, 256, "%s-0001.pef", TMPFILEBASE);
+    if (imageData == nullptr || imageDataSize == 0)
+    {
+        LOG_ERROR("No image was downloaded from the camera.");
+        return false;
     }
-	LOGF_DEBUG("Reading temp file from: %s",tmpfile);
 
+    DownloadStatsN[DOWNLOAD_TIME].value = downloadTime;
+    DownloadStatsN[DOWNLOAD_RATE].value = downloadTime > 0 ? imageDataSize / downloadTime / (1024.0 * 1024.0) : 0;
+    DownloadStatsNP.s = IPS_OK;
+    IDSetNumber(&DownloadStatsNP, nullptr);
+    LOGF_DEBUG("Downloaded %u bytes in %.2f seconds (%.2f MB/s).", imageDataSize,
+               DownloadStatsN[DOWNLOAD_TIME].value, DownloadStatsN[DOWNLOAD_RATE].value);
 
     // fits handling code
     if (transferFormatS[0].s == ISS_ON)
@@ -537,10 +563,9 @@ bool PkTriggerCordCCD::grabImage()
 
         if (uff==USER_FILE_FORMAT_JPEG)
         {            
-            if (read_jpeg(tmpfile, &memptr, &memsize, &naxis, &w, &h))
+            if (read_jpeg_mem(imageData, imageDataSize, &memptr, &memsize, &naxis, &w, &h))
             {
                 LOG_ERROR("Exposure failed to parse jpeg.");
-                unlink(tmpfile);
                 return false;
             }
             
@@ -554,10 +579,9 @@ bool PkTriggerCordCCD::grabImage()
         {
             char bayer_pattern[8] = {};
 
-            if (read_libraw(tmpfile, &memptr, &memsize, &naxis, &w, &h, &bpp, bayer_pattern))
+            if (read_libraw_mem(imageData, imageDataSize, &memptr, &memsize, &naxis, &w, &h, &bpp, bayer_pattern))
             {
                 LOG_ERROR("Exposure failed to parse raw image.");
-                unlink(tmpfile);
                 return false;
             }
 
@@ -590,16 +614,13 @@ bool PkTriggerCordCCD::grabImage()
             prefix = std::regex_replace(prefix, std::regex("XXX"), string(ts));
             char newname[255];
             snprintf(newname, 255, "%s.%s",prefix.c_str(),getFormatFileExtension(uff));
-            if (std::rename(tmpfile, newname)) {
-                LOGF_ERROR("File system error prevented saving original image to %s.  Saved to %s instead.", newname,tmpfile);
+            if (!saveOriginal(newname)) {
+                LOGF_ERROR("File system error prevented saving original image to %s.", newname);
             }
             else {
                 LOGF_INFO("Saved original image to %s.", newname);
             }
         }
-        else {
-            std::remove(tmpfile);
-        }
 
     }
     // native handling code
@@ -607,29 +628,29 @@ bool PkTriggerCordCCD::grabImage()
     {
         PrimaryCCD.setImageExtension(getFormatFileExtension(uff));
 
-        FILE* f = fopen(tmpfile, "r");
-        fseek(f, 0, SEEK_END);
-        size_t size = ftell(f);
-        rewind(f);
-
-        PrimaryCCD.setFrameBufferSize(size);
-        char * memptr = (char *)PrimaryCCD.getFrameBuffer();
-        size_t readSize = fread(memptr, sizeof(char), size, f);
-        if (readSize != size)
-        {
-            LOGF_ERROR("Error, %u bytes of data read instead of %u.", readSize, size);
-        }
-        PrimaryCCD.setFrameBuffer((unsigned char *)memptr);
-        fclose(f);
-		LOG_DEBUG("Copied to frame buffer.  Leaving temp file for debug purposes.");
-		if (!isDebug()) {
-			std::remove(tmpfile);
-		}
+        PrimaryCCD.setFrameBufferSize(imageDataSize);
+        memcpy(PrimaryCCD.getFrameBuffer(), imageData, imageDataSize);
+		LOG_DEBUG("Copied to frame buffer.");
     }
 
+    free(imageData);
+    imageData = nullptr;
+    imageDataSize = 0;
+
     return true;
 }
 
+bool PkTriggerCordCCD::saveOriginal(const char *filename)
+{
+    FILE *f = fopen(filename, "w");
+    if (f == nullptr)
+        return false;
+
+    size_t written = fwrite(imageData, sizeof(uint8_t), imageDataSize, f);
+    fclose(f);
+    return written == imageDataSize;
+}
+
 
 ISwitch * PkTriggerCordCCD::create_switch(const char * basestr, string options[], size_t numOptions, int setidx)
 {
@@ -102,6 +102,14 @@ protected:
     IText DeviceInfoT[6] {};
     ITextVectorProperty DeviceInfoTP;
 
+    INumber DownloadStatsN[2];
+    INumberVectorProperty DownloadStatsNP;
+    enum
+    {
+        DOWNLOAD_TIME,
+        DOWNLOAD_RATE
+    };
+
     bool saveConfigItems(FILE * fp);
 
     bool ISNewSwitch(const char * dev, const char * name, ISState * states, char * names[], int n);
@@ -125,6 +133,12 @@ protected:
 
     bool shutterPress(pslr_rational_t shutter_speed);
     std::future<bool> shutter_result;
+
+    // Image as downloaded from the camera, decoded in place by grabImage()
+    uint8_t *imageData { nullptr };
+    uint32_t imageDataSize { 0 };
+    double downloadTime { 0 };
+    bool saveOriginal(const char *filename);
 };
 
 #endif // PKTRIGGERCORD_CCD_H
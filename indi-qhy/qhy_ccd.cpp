@@ -202,6 +202,13 @@ bool QHYCCD::initProperties()
     IUFillNumberVector(&USBBufferNP, USBBufferN, 1, getDeviceName(), "USB_BUFFER", "USB Buffer", MAIN_CONTROL_TAB,
                        IP_RW, 60, IPS_IDLE);
 
+    // Time requests wait for the SDK, by type
+    IUFillNumber(&SDKLatencyN[QHYSDKScheduler::REQUEST_FRAME], "LATENCY_FRAME", "Frame reads (ms)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumber(&SDKLatencyN[QHYSDKScheduler::REQUEST_CONTROL], "LATENCY_CONTROL", "Controls (ms)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumber(&SDKLatencyN[QHYSDKScheduler::REQUEST_STATUS], "LATENCY_STATUS", "Status polls (ms)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&SDKLatencyNP, SDKLatencyN, QHYSDKScheduler::REQUEST_TYPES, getDeviceName(), "SDK_QUEUE_LATENCY",
+                       "SDK Latency", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
     // Cooler Mode
     IUFillSwitch(&CoolerModeS[COOLER_AUTOMATIC], "COOLER_AUTOMATIC", "Auto", ISS_ON);
     IUFillSwitch(&CoolerModeS[COOLER_MANUAL], "COOLER_MANUAL", "Manual", ISS_OFF);
@@ -364,6 +371,7 @@ void QHYCCD::ISGetProperties(const char *dev)
         defineProperty(&USBBufferNP);
 
         defineProperty(&SDKVersionTP);
+        defineProperty(&SDKLatencyNP);
 
         if (HasAmpGlow)
             defineProperty(&AMPGlowSP);
@@ -410,8 +418,6 @@ bool QHYCCD::updateProperties()
 
             CoolerNP.p = HasCoolerManualMode ? IP_RW : IP_RO;
             defineProperty(&CoolerNP);
-
-            m_TemperatureTimerID = IEAddTimer(getCurrentPollingPeriod(), QHYCCD::updateTemperatureHelper, this);
         }
 
         double min = 0, max = 0, step = 0;
@@ -552,6 +558,7 @@ bool QHYCCD::updateProperties()
         defineProperty(&USBBufferNP);
 
         defineProperty(&SDKVersionTP);
+        defineProperty(&SDKLatencyNP);
 
         if (HasAmpGlow)
         {
@@ -595,8 +602,6 @@ bool QHYCCD::updateProperties()
                 deleteProperty(CoolerModeSP.name);
 
             deleteProperty(CoolerNP.name);
-
-            RemoveTimer(m_TemperatureTimerID);
         }
 
         if (HasUSBSpeed)
@@ -630,6 +635,7 @@ bool QHYCCD::updateProperties()
         deleteProperty(USBBufferNP.name);
 
         deleteProperty(SDKVersionTP.name);
+        deleteProperty(SDKLatencyNP.name);
 
         if (HasAmpGlow)
             deleteProperty(AMPGlowSP.name);
@@ -1029,6 +1035,13 @@ bool QHYCCD::Connect()
         }
         pthread_mutex_unlock(&condMutex);
 
+        {
+            std::lock_guard<std::mutex> guard(m_StatusLock);
+            m_HasCachedTemperature = false;
+            m_CachedFilter = -1;
+        }
+        m_SDK.start();
+
         SetTimer(getCurrentPollingPeriod());
 
         return true;
@@ -1050,6 +1063,8 @@ bool QHYCCD::Disconnect()
     pthread_cond_signal(&cv);
     pthread_mutex_unlock(&condMutex);
     pthread_join(m_ImagingThread, nullptr);
+    // Let queued status polls finish before the handle goes away
+    m_SDK.stop();
     //tState = StateNone;
     if (isSimulation() == false)
     {
@@ -1166,7 +1181,10 @@ int QHYCCD::SetTemperature(double temperature)
     m_TemperatureRequest = temperature;
     m_PWMRequest = -1;
 
-    SetQHYCCDParam(m_CameraHandle, CONTROL_COOLER, m_TemperatureRequest);
+    m_SDK.post(QHYSDKScheduler::REQUEST_CONTROL, [this, temperature]()
+    {
+        SetQHYCCDParam(m_CameraHandle, CONTROL_COOLER, temperature);
+    });
 
     setCoolerEnabled(m_TemperatureRequest <= TemperatureN[0].value);
     setCoolerMode(COOLER_AUTOMATIC);
@@ -1281,7 +1299,12 @@ bool QHYCCD::StartExposure(float duration)
     if (isSimulation())
         ret = QHYCCD_SUCCESS;
     else
-        ret = ExpQHYCCDSingleFrame(m_CameraHandle);
+    {
+        ret = m_SDK.call(QHYSDKScheduler::REQUEST_CONTROL, [this]()
+        {
+            return ExpQHYCCDSingleFrame(m_CameraHandle);
+        });
+    }
     if (ret == QHYCCD_ERROR)
     {
         LOGF_INFO("Begin QHYCCD expose failed (%d)", ret);
@@ -1321,7 +1344,10 @@ bool QHYCCD::AbortExposure()
 
     if (std::string(m_CamID) != "QHY5-M-")
     {
-        int rc = CancelQHYCCDExposingAndReadout(m_CameraHandle);
+        int rc = m_SDK.call(QHYSDKScheduler::REQUEST_CONTROL, [this]()
+        {
+            return CancelQHYCCDExposingAndReadout(m_CameraHandle);
+        });
         if (rc == QHYCCD_SUCCESS)
         {
             InExposure = false;
@@ -1445,7 +1471,10 @@ int QHYCCD::grabImage()
         uint32_t ret, w, h, bpp, channels;
 
         LOG_DEBUG("GetQHYCCDSingleFrame Blocking read call.");
-        ret = GetQHYCCDSingleFrame(m_CameraHandle, &w, &h, &bpp, &channels, PrimaryCCD.getFrameBuffer());
+        ret = m_SDK.call(QHYSDKScheduler::REQUEST_FRAME, [&]()
+        {
+            return GetQHYCCDSingleFrame(m_CameraHandle, &w, &h, &bpp, &channels, PrimaryCCD.getFrameBuffer());
+        });
         LOG_DEBUG("GetQHYCCDSingleFrame Blocking read call complete.");
 
         if (ret != QHYCCD_SUCCESS)
@@ -1496,16 +1525,20 @@ void QHYCCD::TimerHit()
     //        }
     //    }
 
+    if (HasCooler())
+        updateTemperature();
+
     if (FilterSlotNP.s == IPS_BUSY)
     {
-        char currentPos[MAXINDINAME] = {0};
-        int rc = GetQHYCCDCFWStatus(m_CameraHandle, currentPos);
-        if (rc == QHYCCD_SUCCESS)
+        int position;
+        {
+            std::lock_guard<std::mutex> guard(m_StatusLock);
+            position = m_CachedFilter;
+            m_CachedFilter = -1;
+        }
+        if (position > 0)
         {
-            // QHY filter wheel positions are from '0' to 'F'
-            // 0 to 15
-            // INDI Filter Wheel 1 to 16
-            CurrentFilter = strtol(currentPos, nullptr, 16) + 1;
+            CurrentFilter = position;
             LOGF_DEBUG("Filter current position: %d", CurrentFilter);
 
             if (TargetFilter == CurrentFilter)
@@ -1523,9 +1556,92 @@ void QHYCCD::TimerHit()
         }
     }
 
+    queueStatusBatch();
+    updateSDKLatency();
+
     SetTimer(getCurrentPollingPeriod());
 }
 
+void QHYCCD::queueStatusBatch()
+{
+    if (isSimulation())
+        return;
+
+    // Coalesce: if the last batch is still waiting behind frame reads, skip this round.
+    // Each SDK call is its own job so a frame read never waits for more than one of them.
+    if (m_SDK.pending(QHYSDKScheduler::REQUEST_STATUS))
+        return;
+
+    if (HasCooler())
+    {
+        bool regulate = TemperatureNP.s == IPS_BUSY;
+        double temperature = m_TemperatureRequest;
+        double pwm = m_PWMRequest;
+        // JM 2020-05-18: QHY reported that setting the PWM breaks automatic coolers, so it is only done for manual coolers.
+        // Temperature Readout does not work, if we do not set "something", so lets set the current value...
+        if (!regulate && pwm < 0 && CoolerModeS[COOLER_MANUAL].s == ISS_ON && TemperatureNP.s == IPS_OK)
+            pwm = CoolerN[0].value * 255.0 / 100;
+
+        if (regulate || pwm >= 0)
+        {
+            m_SDK.post(QHYSDKScheduler::REQUEST_STATUS, [this, regulate, temperature, pwm]()
+            {
+                if (regulate)
+                    SetQHYCCDParam(m_CameraHandle, CONTROL_COOLER, temperature);
+                else
+                    SetQHYCCDParam(m_CameraHandle, CONTROL_MANULPWM, pwm);
+            });
+        }
+        m_SDK.post(QHYSDKScheduler::REQUEST_STATUS, [this]()
+        {
+            double value = GetQHYCCDParam(m_CameraHandle, CONTROL_CURTEMP);
+            std::lock_guard<std::mutex> guard(m_StatusLock);
+            m_CachedTemperature = value;
+        });
+        m_SDK.post(QHYSDKScheduler::REQUEST_STATUS, [this]()
+        {
+            double value = GetQHYCCDParam(m_CameraHandle, CONTROL_CURPWM);
+            std::lock_guard<std::mutex> guard(m_StatusLock);
+            m_CachedCoolerPower = value;
+            m_HasCachedTemperature = true;
+        });
+    }
+
+    if (FilterSlotNP.s == IPS_BUSY)
+    {
+        m_SDK.post(QHYSDKScheduler::REQUEST_STATUS, [this]()
+        {
+            char currentPos[MAXINDINAME] = {0};
+            if (GetQHYCCDCFWStatus(m_CameraHandle, currentPos) == QHYCCD_SUCCESS)
+            {
+                // QHY filter wheel positions are from '0' to 'F'
+                // 0 to 15
+                // INDI Filter Wheel 1 to 16
+                std::lock_guard<std::mutex> guard(m_StatusLock);
+                m_CachedFilter = strtol(currentPos, nullptr, 16) + 1;
+            }
+        });
+    }
+}
+
+void QHYCCD::updateSDKLatency()
+{
+    bool changed = false;
+    for (int i = 0; i < QHYSDKScheduler::REQUEST_TYPES; i++)
+    {
+        QHYSDKScheduler::Latency latency = m_SDK.takeLatency(static_cast<QHYSDKScheduler::RequestType>(i));
+        if (latency.count == 0)
+            continue;
+        SDKLatencyN[i].value = latency.average;
+        changed = true;
+    }
+    if (changed)
+    {
+        SDKLatencyNP.s = IPS_OK;
+        IDSetNumber(&SDKLatencyNP, nullptr);
+    }
+}
+
 IPState QHYCCD::GuideNorth(uint32_t ms)
 {
     ControlQHYCCDGuide(m_CameraHandle, 1, ms);
@@ -1560,7 +1676,10 @@ bool QHYCCD::SelectFilter(int position)
     // INDI Filters 1 to 16
     char targetPos[8] = {0};
     snprintf(targetPos, 8, "%X", position - 1);
-    return (SendOrder2QHYCCDCFW(m_CameraHandle, targetPos, 1) == QHYCCD_SUCCESS);
+    return m_SDK.call(QHYSDKScheduler::REQUEST_CONTROL, [this, &targetPos]()
+    {
+        return SendOrder2QHYCCDCFW(m_CameraHandle, targetPos, 1);
+    }) == QHYCCD_SUCCESS;
 }
 
 int QHYCCD::QueryFilter()
@@ -1617,7 +1736,10 @@ bool QHYCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
                 {
                     m_PWMRequest = 0;
                     m_TemperatureRequest = 30;
-                    SetQHYCCDParam(m_CameraHandle, CONTROL_MANULPWM, 0);
+                    m_SDK.post(QHYSDKScheduler::REQUEST_CONTROL, [this]()
+                    {
+                        SetQHYCCDParam(m_CameraHandle, CONTROL_MANULPWM, 0);
+                    });
 
                     CoolerSP.s = IPS_IDLE;
                     IDSetSwitch(&CoolerSP, nullptr);
@@ -2131,11 +2253,6 @@ bool QHYCCD::isQHY5PIIC()
     return std::string(m_CamID, 9) == "QHY5PII-C";
 }
 
-void QHYCCD::updateTemperatureHelper(void *p)
-{
-    static_cast<QHYCCD *>(p)->updateTemperature();
-}
-
 void QHYCCD::updateTemperature()
 {
     double ccdtemp = 0, coolpower = 0;
@@ -2152,27 +2269,12 @@ void QHYCCD::updateTemperature()
     }
     else
     {
-        // Sleep for 1 second before setting temperature/pwm again.
-        //usleep(1000000);
-
-        // Call this function as long as we are busy
-        if (TemperatureNP.s == IPS_BUSY)
-        {
-            SetQHYCCDParam(m_CameraHandle, CONTROL_COOLER, m_TemperatureRequest);
-        }
-        else if (m_PWMRequest >= 0)
-        {
-            SetQHYCCDParam(m_CameraHandle, CONTROL_MANULPWM, m_PWMRequest);
-        }
-        // JM 2020-05-18: QHY reported the code below break automatic coolers, so it is only avaiable for manual coolers.
-        // Temperature Readout does not work, if we do not set "something", so lets set the current value...
-        else if (CoolerModeS[COOLER_MANUAL].s == ISS_ON && TemperatureNP.s == IPS_OK)
-        {
-            SetQHYCCDParam(m_CameraHandle, CONTROL_MANULPWM, CoolerN[0].value * 255.0 / 100 );
-        }
-
-        ccdtemp   = GetQHYCCDParam(m_CameraHandle, CONTROL_CURTEMP);
-        coolpower = GetQHYCCDParam(m_CameraHandle, CONTROL_CURPWM);
+        // Served from the last status batch, see queueStatusBatch()
+        std::lock_guard<std::mutex> guard(m_StatusLock);
+        if (!m_HasCachedTemperature)
+            return;
+        ccdtemp   = m_CachedTemperature;
+        coolpower = m_CachedCoolerPower;
     }
 
     // No need to spam to log
@@ -2209,8 +2311,6 @@ void QHYCCD::updateTemperature()
 
     IDSetNumber(&TemperatureNP, nullptr);
     IDSetNumber(&CoolerNP, nullptr);
-
-    m_TemperatureTimerID = IEAddTimer(getCurrentPollingPeriod(), QHYCCD::updateTemperatureHelper, this);
 }
 
 bool QHYCCD::saveConfigItems(FILE *fp)
@@ -2365,7 +2465,10 @@ bool QHYCCD::StartStreaming()
 
     LOGF_INFO("Starting video streaming with exposure %.f seconds (%.f FPS), w=%d h=%d", m_ExposureRequest,
               Streamer->getTargetFPS(), subW, subH);
-    BeginQHYCCDLive(m_CameraHandle);
+    m_SDK.call(QHYSDKScheduler::REQUEST_CONTROL, [this]()
+    {
+        return BeginQHYCCDLive(m_CameraHandle);
+    });
     pthread_mutex_lock(&condMutex);
     m_ThreadRequest = StateStream;
     pthread_cond_signal(&cv);
@@ -2384,7 +2487,10 @@ bool QHYCCD::StopStreaming()
         pthread_cond_wait(&cv, &condMutex);
     }
     pthread_mutex_unlock(&condMutex);
-    StopQHYCCDLive(m_CameraHandle);
+    m_SDK.call(QHYSDKScheduler::REQUEST_CONTROL, [this]()
+    {
+        return StopQHYCCDLive(m_CameraHandle);
+    });
 
     //LOG_INFO("stopped live mode"); //DEBUG
 
@@ -2474,7 +2580,10 @@ void QHYCCD::streamVideo()
         while (retries++ < 10)
         {
 
-            ret = GetQHYCCDLiveFrame(m_CameraHandle, &w, &h, &bpp, &channels, buffer);
+            ret = m_SDK.call(QHYSDKScheduler::REQUEST_FRAME, [&]()
+            {
+                return GetQHYCCDLiveFrame(m_CameraHandle, &w, &h, &bpp, &channels, buffer);
+            });
             if (ret == QHYCCD_ERROR)
                 usleep(1000);
             else
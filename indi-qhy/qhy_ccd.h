@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include "qhy_sdk_scheduler.h"
+
 #include <qhyccd.h>
 #include <indiccd.h>
 #include <indifilterinterface.h>
@@ -101,6 +103,10 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         ITextVectorProperty SDKVersionTP;
         IText SDKVersionT[1] {};
 
+        // SDK queue latency
+        INumberVectorProperty SDKLatencyNP;
+        INumber SDKLatencyN[QHYSDKScheduler::REQUEST_TYPES];
+
         // Cooler Switch
         ISwitchVectorProperty CoolerSP;
         ISwitch CoolerS[2];
@@ -386,7 +392,9 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         void setCoolerEnabled(bool enable);
         // Temperature update
         void updateTemperature();
-        static void updateTemperatureHelper(void *);
+        // Queue the periodic cooler and filter wheel queries
+        void queueStatusBatch();
+        void updateSDKLatency();
 
         /////////////////////////////////////////////////////////////////////////////
         /// Misc
@@ -438,8 +446,12 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         double m_PWMRequest { -1 };
         // Max filter count.
         int m_MaxFilterCount { -1 };
-        // Temperature Timer
-        int m_TemperatureTimerID;
+        // Values from the last status batch, guarded by m_StatusLock
+        std::mutex m_StatusLock;
+        bool m_HasCachedTemperature { false };
+        double m_CachedTemperature { 0 };
+        double m_CachedCoolerPower { 0 };
+        int m_CachedFilter { -1 };
         // Camera Handle
         qhyccd_handle *m_CameraHandle {nullptr};
         // Camera Image Frame Type
@@ -472,6 +484,9 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         pthread_t m_ImagingThread;
         pthread_cond_t cv         = PTHREAD_COND_INITIALIZER;
         pthread_mutex_t condMutex = PTHREAD_MUTEX_INITIALIZER;
+        // Frame reads, status polls and the calls starting or stopping a frame go through here,
+        // frame reads first. Frame setup before an exposure or a stream calls the SDK directly.
+        QHYSDKScheduler m_SDK;
 
         void logQHYMessages(const std::string &message);
         std::function<void(const std::string &)> m_QHYLogCallback;
@@ -0,0 +1,181 @@
+/*
+ QHY SDK scheduler benchmark
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Compares frame read delays when status polls call the SDK directly from their own
+ * timers against routing every call through QHYSDKScheduler. The SDK is mocked: each
+ * call holds one lock for a configurable time, like the real SDK does per handle.
+ */
+
+#include "qhy_sdk_scheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+
+static std::mutex sdkLock;
+static int frameMs    = 200;
+static int paramMs    = 20;
+static int wheelMs    = 30;
+static int exposureMs = 100;
+static int pollMs     = 250;
+static int frames     = 20;
+
+static uint32_t mockCall(int ms)
+{
+    std::lock_guard<std::mutex> guard(sdkLock);
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    return 0;
+}
+
+struct FrameDelay
+{
+    double total { 0 };
+    double maximum { 0 };
+
+    void add(std::chrono::steady_clock::time_point ready)
+    {
+        // Time spent before the read itself could start
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - ready;
+        double delay = std::max(0.0, elapsed.count() - frameMs);
+        total += delay;
+        maximum = std::max(maximum, delay);
+    }
+};
+
+/* Cooler and filter wheel timers calling the SDK on their own, as the driver used to */
+static FrameDelay runDirect()
+{
+    std::atomic_bool done { false };
+    std::thread status([&done]()
+    {
+        while (!done)
+        {
+            mockCall(paramMs);
+            mockCall(paramMs);
+            mockCall(paramMs);
+            mockCall(wheelMs);
+            std::this_thread::sleep_for(std::chrono::milliseconds(pollMs));
+        }
+    });
+
+    FrameDelay delay;
+    for (int i = 0; i < frames; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(exposureMs));
+        auto ready = std::chrono::steady_clock::now();
+        mockCall(frameMs);
+        delay.add(ready);
+    }
+    done = true;
+    status.join();
+    return delay;
+}
+
+/* Same load with every call going through the scheduler */
+static FrameDelay runScheduled(QHYSDKScheduler &sdk)
+{
+    std::atomic_bool done { false };
+    sdk.start();
+    std::thread status([&done, &sdk]()
+    {
+        while (!done)
+        {
+            if (!sdk.pending(QHYSDKScheduler::REQUEST_STATUS))
+            {
+                sdk.post(QHYSDKScheduler::REQUEST_STATUS, []() { mockCall(paramMs); });
+                sdk.post(QHYSDKScheduler::REQUEST_STATUS, []() { mockCall(paramMs); });
+                sdk.post(QHYSDKScheduler::REQUEST_STATUS, []() { mockCall(paramMs); });
+                sdk.post(QHYSDKScheduler::REQUEST_STATUS, []() { mockCall(wheelMs); });
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(pollMs));
+        }
+    });
+
+    FrameDelay delay;
+    for (int i = 0; i < frames; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(exposureMs));
+        auto ready = std::chrono::steady_clock::now();
+        sdk.call(QHYSDKScheduler::REQUEST_FRAME, []()
+        {
+            return mockCall(frameMs);
+        });
+        delay.add(ready);
+    }
+    done = true;
+    status.join();
+    sdk.stop();
+    return delay;
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "n:e:f:p:w:i:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                frames = atoi(optarg);
+                break;
+            case 'e':
+                exposureMs = atoi(optarg);
+                break;
+            case 'f':
+                frameMs = atoi(optarg);
+                break;
+            case 'p':
+                paramMs = atoi(optarg);
+                break;
+            case 'w':
+                wheelMs = atoi(optarg);
+                break;
+            case 'i':
+                pollMs = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n frames] [-e exposure ms] [-f frame read ms] [-p param call ms] "
+                        "[-w wheel call ms] [-i poll interval ms]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    printf("Mock SDK: frame read %d ms, param call %d ms, wheel call %d ms, poll every %d ms\n",
+           frameMs, paramMs, wheelMs, pollMs);
+
+    FrameDelay direct = runDirect();
+    printf("Direct calls:    frame delay avg %.1f ms, max %.1f ms\n", direct.total / frames, direct.maximum);
+
+    QHYSDKScheduler sdk;
+    FrameDelay scheduled = runScheduled(sdk);
+    printf("Scheduled calls: frame delay avg %.1f ms, max %.1f ms\n", scheduled.total / frames, scheduled.maximum);
+
+    const char *names[QHYSDKScheduler::REQUEST_TYPES] = { "frame", "control", "status" };
+    for (int i = 0; i < QHYSDKScheduler::REQUEST_TYPES; i++)
+    {
+        QHYSDKScheduler::Latency latency = sdk.takeLatency(static_cast<QHYSDKScheduler::RequestType>(i));
+        printf("Queue latency %-8s avg %.1f ms, max %.1f ms (%u requests)\n", names[i], latency.average, latency.maximum,
+               latency.count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ QHY INDI Driver
+
+ Copyright (C) 2014 Jasem Mutlaq (mutlaqja@ikarustech.com)
+ Copyright (C) 2014 Zhirong Li (lzr@qhyccd.com)
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qhy_sdk_scheduler.h"
+
+#include <algorithm>
+
+QHYSDKScheduler::~QHYSDKScheduler()
+{
+    stop();
+}
+
+void QHYSDKScheduler::start()
+{
+    std::lock_guard<std::mutex> guard(m_Lock);
+    if (m_Running)
+        return;
+    m_Running = true;
+    m_Thread  = std::thread(&QHYSDKScheduler::run, this);
+}
+
+void QHYSDKScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_Lock);
+        if (!m_Running)
+            return;
+        m_Running = false;
+    }
+    m_QueueCV.notify_all();
+    m_Thread.join();
+}
+
+uint32_t QHYSDKScheduler::call(RequestType type, const std::function<uint32_t()> &job)
+{
+    std::unique_lock<std::mutex> guard(m_Lock);
+    if (!m_Running)
+    {
+        guard.unlock();
+        return job();
+    }
+
+    uint32_t result = 0;
+    bool done       = false;
+    m_Queues[type].push_back({type, [&result, &job]()
+    {
+        result = job();
+    }, std::chrono::steady_clock::now(), &done});
+    m_Outstanding[type]++;
+    m_QueueCV.notify_one();
+    m_DoneCV.wait(guard, [&done]()
+    {
+        return done;
+    });
+    return result;
+}
+
+void QHYSDKScheduler::post(RequestType type, std::function<void()> job)
+{
+    std::unique_lock<std::mutex> guard(m_Lock);
+    if (!m_Running)
+    {
+        guard.unlock();
+        job();
+        return;
+    }
+    m_Queues[type].push_back({type, std::move(job), std::chrono::steady_clock::now(), nullptr});
+    m_Outstanding[type]++;
+    m_QueueCV.notify_one();
+}
+
+bool QHYSDKScheduler::pending(RequestType type)
+{
+    std::lock_guard<std::mutex> guard(m_Lock);
+    return m_Outstanding[type] > 0;
+}
+
+QHYSDKScheduler::Latency QHYSDKScheduler::takeLatency(RequestType type)
+{
+    std::lock_guard<std::mutex> guard(m_Lock);
+    Latency latency = m_Latency[type];
+    if (latency.count > 0)
+        latency.average = m_LatencySum[type] / latency.count;
+    m_Latency[type]    = Latency();
+    m_LatencySum[type] = 0;
+    return latency;
+}
+
+void QHYSDKScheduler::run()
+{
+    std::unique_lock<std::mutex> guard(m_Lock);
+    while (true)
+    {
+        int type = 0;
+        while (type < REQUEST_TYPES && m_Queues[type].empty())
+            type++;
+
+        if (type == REQUEST_TYPES)
+        {
+            // Drain everything before stopping so no caller is left waiting
+            if (!m_Running)
+                break;
+            m_QueueCV.wait(guard);
+            continue;
+        }
+
+        Job job = std::move(m_Queues[type].front());
+        m_Queues[type].pop_front();
+
+        std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - job.queued;
+        m_LatencySum[type] += waited.count();
+        m_Latency[type].maximum = std::max(m_Latency[type].maximum, waited.count());
+        m_Latency[type].count++;
+
+        guard.unlock();
+        job.run();
+        guard.lock();
+
+        m_Outstanding[type]--;
+        if (job.done)
+        {
+            *job.done = true;
+            m_DoneCV.notify_all();
+        }
+    }
+}
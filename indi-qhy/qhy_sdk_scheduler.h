@@ -0,0 +1,101 @@
+/*
+ QHY INDI Driver
+
+ Copyright (C) 2014 Jasem Mutlaq (mutlaqja@ikarustech.com)
+ Copyright (C) 2014 Zhirong Li (lzr@qhyccd.com)
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief The QHYSDKScheduler class funnels the SDK calls made while imaging through one thread.
+ *
+ * The QHY SDK serialises calls on a handle internally, so a status query issued while a frame
+ * is wanted delays the frame. Frame reads, status polls, user controls and the calls starting,
+ * cancelling or stopping a frame are queued here. The setup calls made before an exposure or a
+ * stream starts (binning, ROI, bit depth, gain...) still call the SDK directly and only wait on
+ * the SDK's own lock. Requests are queued by type and always served in type order:
+ * frame reads first, then user controls, then periodic status polls. Status polls should be
+ * queued as one small job per SDK call so a frame read can slip in between them.
+ */
+class QHYSDKScheduler
+{
+    public:
+        enum RequestType
+        {
+            REQUEST_FRAME,
+            REQUEST_CONTROL,
+            REQUEST_STATUS,
+            REQUEST_TYPES
+        };
+
+        struct Latency
+        {
+            double average { 0 };   // ms
+            double maximum { 0 };   // ms
+            uint32_t count { 0 };
+        };
+
+        QHYSDKScheduler() = default;
+        ~QHYSDKScheduler();
+
+        void start();
+        /** Serve what is still queued, then stop the thread. */
+        void stop();
+
+        /** Run job on the scheduler thread and wait for its result. Runs inline when stopped. */
+        uint32_t call(RequestType type, const std::function<uint32_t()> &job);
+
+        /** Queue job without waiting for it. */
+        void post(RequestType type, std::function<void()> job);
+
+        /** True while a job of this type is queued or running. */
+        bool pending(RequestType type);
+
+        /** Queue latency of each type since the previous call. */
+        Latency takeLatency(RequestType type);
+
+    private:
+        struct Job
+        {
+            RequestType type;
+            std::function<void()> run;
+            std::chrono::steady_clock::time_point queued;
+            bool *done;
+        };
+
+        void run();
+
+        std::deque<Job> m_Queues[REQUEST_TYPES];
+        uint32_t m_Outstanding[REQUEST_TYPES] {};
+        double m_LatencySum[REQUEST_TYPES] {};
+        Latency m_Latency[REQUEST_TYPES];
+
+        std::mutex m_Lock;
+        std::condition_variable m_QueueCV;
+        std::condition_variable m_DoneCV;
+        std::thread m_Thread;
+        bool m_Running { false };
+};
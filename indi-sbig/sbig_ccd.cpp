@@ -32,6 +32,7 @@
 #include "sbig_ccd.h"
 
 #include <eventloop.h>
+#include <stream/streammanager.h>
 
 #include <math.h>
 #include <unistd.h>
@@ -51,6 +52,10 @@
 #define MAX_DEVICES         20   /* Max device cameraCount */
 #define MAX_THREAD_RETRIES  3
 #define MAX_THREAD_WAIT     300000
+#define READOUT_LINES_BLOCK 16      /* Lines read per sbigLock hold, so guide head and cooler requests can interleave */
+#define SIM_PIXEL_RATE      1000000 /* Simulated digitizer rate (pixels/s) */
+#define MIN_VIDEO_EXPOSURE  0.01    /* Shortest exposure the driver accepts (s) */
+#define VIDEO_POLL_US       2000    /* Exposure status polling while streaming */
 
 static class Loader
 {
@@ -305,6 +310,9 @@ SBIGCCD::SBIGCCD() : FilterInterface(this)
 
 SBIGCCD::~SBIGCCD()
 {
+    StopStreaming();
+    m_AbortPrimaryReadout = true;
+    joinPrimaryReadout();
     CloseDevice();
     CloseDriver();
 }
@@ -451,6 +459,19 @@ bool SBIGCCD::initProperties()
     IUFillSwitchVector(&FilterConnectionSP, FilterConnectionS, 2, getDeviceName(), "CFW_CONNECTION", "Connect",
                        FILTER_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
+    // Readout throughput of the last downloaded frame
+    IUFillNumber(&ReadoutRateN[READOUT_PRIMARY], "READOUT_PRIMARY", "Primary (kpx/s)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumber(&ReadoutRateN[READOUT_GUIDE], "READOUT_GUIDE", "Guide (kpx/s)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&ReadoutRateNP, ReadoutRateN, 2, getDeviceName(), "CCD_READOUT_RATE", "Readout", IMAGE_INFO_TAB,
+                       IP_RO, 0, IPS_IDLE);
+
+    // Video mode: delivered frame rate and how each frame splits between exposure and readout
+    IUFillNumber(&VideoTimingN[VIDEO_FPS], "VIDEO_FPS", "Frame rate (fps)", "%.2f", 0, 1000, 0, 0);
+    IUFillNumber(&VideoTimingN[VIDEO_EXPOSURE], "VIDEO_EXPOSURE", "Exposure (ms)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumber(&VideoTimingN[VIDEO_READOUT], "VIDEO_READOUT", "Readout (ms)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&VideoTimingNP, VideoTimingN, 3, getDeviceName(), "CCD_VIDEO_TIMING", "Video", IMAGE_INFO_TAB,
+                       IP_RO, 0, IPS_IDLE);
+
     /////////////////////////////////////////////////////////////////////////////
     /// Adaptive Optics
     /////////////////////////////////////////////////////////////////////////////
@@ -512,6 +533,8 @@ bool SBIGCCD::updateProperties()
             defineProperty(&CoolerNP);
         }
         defineProperty(&IgnoreErrorsSP);
+        defineProperty(&ReadoutRateNP);
+        defineProperty(&VideoTimingNP);
         if (m_hasFilterWheel)
         {
             defineProperty(&FilterConnectionSP);
@@ -554,6 +577,8 @@ bool SBIGCCD::updateProperties()
             deleteProperty(CoolerNP.name);
         }
         deleteProperty(IgnoreErrorsSP.name);
+        deleteProperty(ReadoutRateNP.name);
+        deleteProperty(VideoTimingNP.name);
 
         if (m_hasAO)
         {
@@ -819,7 +844,8 @@ bool SBIGCCD::Connect()
         {
             LOGF_INFO("CCD is connected at port %s", port);
             GetExtendedCCDInfo();
-            uint32_t cap = CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_SHUTTER | CCD_HAS_ST4_PORT;
+            uint32_t cap = CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_SHUTTER | CCD_HAS_ST4_PORT |
+                           CCD_HAS_STREAMING;
             if (m_hasGuideHead)
                 cap |= CCD_HAS_GUIDE_HEAD;
             if (m_isColor)
@@ -860,6 +886,9 @@ bool SBIGCCD::Disconnect()
         return true;
     m_useExternalTrackingCCD = false;
     m_hasGuideHead           = false;
+    StopStreaming();
+    m_AbortPrimaryReadout    = true;
+    joinPrimaryReadout();
 #ifdef ASYNC_READOUT
     pthread_mutex_lock(&condMutex);
     grabPredicate   = GRAB_PRIMARY_CCD;
@@ -1093,6 +1122,15 @@ int SBIGCCD::StartExposure(INDI::CCDChip *targetChip, double duration)
 
 bool SBIGCCD::StartExposure(float duration)
 {
+    if (Streamer->isBusy())
+    {
+        LOG_ERROR("Cannot take exposure while streaming/recording is active.");
+        return false;
+    }
+
+    // A download still in progress completes or fails its frame before its thread ends
+    joinPrimaryReadout();
+
     ExposureRequest = duration;
 
     if (duration >= 3)
@@ -1112,6 +1150,13 @@ bool SBIGCCD::StartExposure(float duration)
 
 bool SBIGCCD::StartGuideExposure(float duration)
 {
+    // The video loop keeps the camera busy, TimerHit does not poll the guide head meanwhile
+    if (m_Streaming)
+    {
+        LOG_ERROR("Cannot take guide exposure while streaming is active.");
+        return false;
+    }
+
     GuideExposureRequest = duration;
 
     if (duration >= 3)
@@ -1152,6 +1197,9 @@ bool SBIGCCD::AbortExposure()
 {
     int res = CE_NO_ERROR;
     LOG_DEBUG("Aborting primary camera exposure...");
+    // Stop a running readout before ending the exposure
+    m_AbortPrimaryReadout = true;
+    joinPrimaryReadout();
     for (int i = 0; i < MAX_THREAD_RETRIES; i++)
     {
         res = AbortExposure(&PrimaryCCD);
@@ -1244,6 +1292,11 @@ bool SBIGCCD::updateFrameProperties(INDI::CCDChip *targetChip)
 
 bool SBIGCCD::UpdateCCDFrame(int x, int y, int w, int h)
 {
+    if (m_Streaming)
+    {
+        LOG_ERROR("Cannot change the frame while streaming is active.");
+        return false;
+    }
     LOGF_DEBUG("The final main camera image area is (%ld, %ld), (%ld, %ld)", x, y, w, h);
     PrimaryCCD.setFrame(x, y, w, h);
     int nbuf = (w * h * PrimaryCCD.getBPP() / 8) + 512;
@@ -1264,6 +1317,11 @@ bool SBIGCCD::UpdateGuiderFrame(int x, int y, int w, int h)
 
 bool SBIGCCD::UpdateCCDBin(int binx, int biny)
 {
+    if (m_Streaming)
+    {
+        LOG_ERROR("Cannot change the binning while streaming is active.");
+        return false;
+    }
     if (binx != biny)
     {
         biny = binx;
@@ -1410,39 +1468,178 @@ bool SBIGCCD::grabImage(INDI::CCDChip *targetChip)
 
     LOGF_DEBUG("%s readout in progress...", targetChip == &PrimaryCCD ? "Primary camera" : "Guide head");
 
+    // In simulation, readoutCCD is served line by line by simulateReadoutLine.
+    uint16_t *buffer = reinterpret_cast<uint16_t *>(targetChip->getFrameBuffer());
+    int res                = 0;
+    for (int i = 0; i < MAX_THREAD_RETRIES; i++)
+    {
+        res = readoutCCD(left, top, width, height, buffer, targetChip);
+        if (res == CE_NO_ERROR || (targetChip == &PrimaryCCD && m_AbortPrimaryReadout))
+            break;
+        LOGF_DEBUG("Readout error, retrying...", res);
+        usleep(MAX_THREAD_WAIT);
+    }
+    if (res != CE_NO_ERROR)
+    {
+        LOGF_ERROR("%s readout error",
+                   targetChip == &PrimaryCCD ? "Primary camera" : "Guide head");
+        return false;
+    }
+    LOGF_DEBUG("%s readout complete", targetChip == &PrimaryCCD ? "Primary camera" : "Guide head");
+    ExposureComplete(targetChip);
+    return true;
+}
+
+void SBIGCCD::grabPrimaryImageAsync()
+{
+    joinPrimaryReadout();
+    m_AbortPrimaryReadout  = false;
+    m_PrimaryReadoutThread = std::thread([this]()
+    {
+        if (grabImage(&PrimaryCCD) == false && !m_AbortPrimaryReadout)
+            PrimaryCCD.setExposureFailed();
+    });
+}
+
+void SBIGCCD::joinPrimaryReadout()
+{
+    // ExposureComplete may start the next fast exposure from the readout thread itself,
+    // the thread is then reaped by the next download
+    if (m_PrimaryReadoutThread.joinable() && m_PrimaryReadoutThread.get_id() != std::this_thread::get_id())
+        m_PrimaryReadoutThread.join();
+}
+
+bool SBIGCCD::StartStreaming()
+{
+    if (InExposure)
+    {
+        LOG_ERROR("Cannot start video while an exposure is in progress.");
+        return false;
+    }
+    if (InGuideExposure)
+    {
+        LOG_ERROR("Cannot start video while a guide exposure is in progress.");
+        return false;
+    }
+    joinPrimaryReadout();
+    // A stream stopped on an error leaves its finished thread behind
+    if (m_StreamThread.joinable())
+        m_StreamThread.join();
+
+    Streamer->setPixelFormat(INDI_MONO, 16);
+    Streamer->setSize(PrimaryCCD.getSubW() / PrimaryCCD.getBinX(), PrimaryCCD.getSubH() / PrimaryCCD.getBinY());
+
+    m_AbortPrimaryReadout = false;
+    m_Streaming           = true;
+    m_StreamThread        = std::thread(&SBIGCCD::streamVideo, this);
+    return true;
+}
+
+bool SBIGCCD::StopStreaming()
+{
+    if (!m_StreamThread.joinable())
+        return true;
+    // Called back through the streamer when the stream thread stops on an error
+    if (m_StreamThread.get_id() == std::this_thread::get_id())
+        return true;
+    m_Streaming           = false;
+    m_AbortPrimaryReadout = true;
+    m_StreamThread.join();
+    m_AbortPrimaryReadout = false;
+    // The loop may have left an exposure running
+    AbortExposure(&PrimaryCCD);
+    return true;
+}
+
+bool SBIGCCD::waitExposureDone(INDI::CCDChip *targetChip, double duration,
+                               std::chrono::steady_clock::time_point start)
+{
+    // Sleep through the bulk of the exposure, then poll closely so the readout starts right away
+    std::chrono::duration<double> remaining(duration);
+    remaining -= std::chrono::steady_clock::now() - start;
     if (isSimulation())
     {
-        uint8_t *image = targetChip->getFrameBuffer();
-        for (int i = 0; i < height * 2; i++)
-        {
-            for (int j = 0; j < width; j++)
-            {
-                image[i * width + j] = rand() % 255;
-            }
-        }
+        if (remaining.count() > 0)
+            std::this_thread::sleep_for(remaining);
+        return m_Streaming;
     }
-    else
+    if (remaining.count() > 0.01)
+        std::this_thread::sleep_for(remaining - std::chrono::milliseconds(10));
+    while (m_Streaming)
+    {
+        if (isExposureDone(targetChip))
+            return true;
+        usleep(VIDEO_POLL_US);
+    }
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Video mode: binned, subframed exposures read back to back, the next
+/// exposure starting as soon as the previous readout ends.
+/////////////////////////////////////////////////////////////////////////////
+void SBIGCCD::streamVideo()
+{
+    INDI::CCDChip *targetChip = &PrimaryCCD;
+    uint16_t left   = targetChip->getSubX() / targetChip->getBinX();
+    uint16_t top    = targetChip->getSubY() / targetChip->getBinY();
+    uint16_t width  = targetChip->getSubW() / targetChip->getBinX();
+    uint16_t height = targetChip->getSubH() / targetChip->getBinY();
+    m_StreamBuffer.resize(width * height);
+
+    auto windowStart = std::chrono::steady_clock::now();
+    std::chrono::duration<double> exposureTime(0), readoutTime(0);
+    int frames = 0;
+
+    while (m_Streaming)
     {
-        uint16_t *buffer = reinterpret_cast<uint16_t *>(targetChip->getFrameBuffer());
-        int res                = 0;
-        for (int i = 0; i < MAX_THREAD_RETRIES; i++)
+        double duration = std::max(MIN_VIDEO_EXPOSURE, 1.0 / Streamer->getTargetFPS());
+        auto frameStart = std::chrono::steady_clock::now();
+        if (StartExposure(targetChip, duration) != CE_NO_ERROR)
         {
-            res = readoutCCD(left, top, width, height, buffer, targetChip);
-            if (res == CE_NO_ERROR)
-                break;
-            LOGF_DEBUG("Readout error, retrying...", res);
-            usleep(MAX_THREAD_WAIT);
+            LOG_ERROR("Failed to start video exposure");
+            break;
         }
+        // ExposureRequest and ExpStart belong to the main loop, the video exposure is timed here
+        if (!waitExposureDone(targetChip, duration, std::chrono::steady_clock::now()))
+            break;
+
+        auto readoutStart = std::chrono::steady_clock::now();
+        int res = readoutCCD(left, top, width, height, m_StreamBuffer.data(), targetChip);
         if (res != CE_NO_ERROR)
         {
-            LOGF_ERROR("%s readout error",
-                       targetChip == &PrimaryCCD ? "Primary camera" : "Guide head");
-            return false;
+            if (m_Streaming)
+                LOG_ERROR("Video readout failed");
+            break;
+        }
+        auto readoutEnd = std::chrono::steady_clock::now();
+        Streamer->newFrame(reinterpret_cast<uint8_t *>(m_StreamBuffer.data()), m_StreamBuffer.size() * sizeof(uint16_t));
+
+        frames++;
+        exposureTime += readoutStart - frameStart;
+        readoutTime += readoutEnd - readoutStart;
+        std::chrono::duration<double> window = readoutEnd - windowStart;
+        if (window.count() >= 1)
+        {
+            VideoTimingN[VIDEO_FPS].value      = frames / window.count();
+            VideoTimingN[VIDEO_EXPOSURE].value = exposureTime.count() * 1000 / frames;
+            VideoTimingN[VIDEO_READOUT].value  = readoutTime.count() * 1000 / frames;
+            VideoTimingNP.s = IPS_OK;
+            IDSetNumber(&VideoTimingNP, nullptr);
+            windowStart  = readoutEnd;
+            exposureTime = readoutTime = std::chrono::duration<double>(0);
+            frames       = 0;
         }
     }
-    LOGF_DEBUG("%s readout complete", targetChip == &PrimaryCCD ? "Primary camera" : "Guide head");
-    ExposureComplete(targetChip);
-    return true;
+
+    // Still set when the loop broke on an error: leave video mode so that exposures are
+    // accepted again and the client sees the stream stop.
+    if (m_Streaming)
+    {
+        m_Streaming = false;
+        AbortExposure(targetChip);
+        Streamer->setStream(false);
+    }
 }
 
 bool SBIGCCD::saveConfigItems(FILE *fp)
@@ -1479,8 +1676,7 @@ void SBIGCCD::TimerHit()
             LOG_DEBUG("Primay camera exposure done, downloading image...");
             targetChip->setExposureLeft(0);
             InExposure = false;
-            if (grabImage(targetChip) == false)
-                targetChip->setExposureFailed();
+            grabPrimaryImageAsync();
         }
         else
         {
@@ -2148,6 +2344,8 @@ int SBIGCCD::SBIGUnivDrvCommand(PAR_COMMAND command, void *params, void *results
     SetDriverHandleParams sdhp;
     if (isSimulation())
     {
+        if (command == CC_READOUT_LINE || command == CC_READ_SUBTRACT_LINE)
+            return simulateReadoutLine(static_cast<ReadoutLineParams *>(params), static_cast<uint16_t *>(results));
         return CE_NO_ERROR;
     }
     // Make sure we have a valid handle to the driver.
@@ -2370,7 +2568,18 @@ void SBIGCCD::updateTemperature()
     bool enabled;
     double ccdTemp, setpointTemp, percentTE, power;
 
-    std::unique_lock<std::mutex> guard(sbigLock);
+    std::unique_lock<std::mutex> guard(sbigLock, std::defer_lock);
+    // Do not hold up the main loop behind a video frame, try again on the next poll
+    if (m_Streaming)
+    {
+        if (!guard.try_lock())
+        {
+            IEAddTimer(TEMPERATURE_POLL_MS, SBIGCCD::updateTemperatureHelper, this);
+            return;
+        }
+    }
+    else
+        guard.lock();
     int res = QueryTemperatureStatus(enabled, ccdTemp, setpointTemp, percentTE);
     guard.unlock();
 
@@ -2494,8 +2703,9 @@ bool SBIGCCD::isExposureDone(INDI::CCDChip *targetChip)
 int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t height,
                         uint16_t *buffer, INDI::CCDChip *targetChip)
 {
-    int h, ccd, binning, res;
-    if (targetChip == &PrimaryCCD)
+    int ccd, binning, res;
+    bool isPrimary = (targetChip == &PrimaryCCD);
+    if (isPrimary)
     {
         ccd = CCD_IMAGING;
     }
@@ -2507,6 +2717,9 @@ int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t he
     {
         return res;
     }
+
+    auto readoutStart = std::chrono::steady_clock::now();
+
     StartReadoutParams srp;
     srp.ccd         = ccd;
     srp.readoutMode = binning;
@@ -2519,8 +2732,7 @@ int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t he
     if (res != CE_NO_ERROR)
     {
         LOGF_ERROR("%s readoutCCD - StartReadout error! (%s)",
-                   (targetChip == &PrimaryCCD) ? "Primary" : "Guide", GetErrorString(res));
-        guard.unlock();
+                   isPrimary ? "Primary" : "Guide", GetErrorString(res));
         return res;
     }
     ReadoutLineParams rlp;
@@ -2528,23 +2740,67 @@ int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t he
     rlp.readoutMode = binning;
     rlp.pixelStart  = left;
     rlp.pixelLength = width;
-    for (h = 0; h < height; h++)
+
+    // The universal driver digitizes one line per call. Read them in blocks and drop the lock
+    // in between, so that the guide head and cooler do not stall during long primary downloads.
+    // A guide head readout holds the lock for its whole (short) frame.
+    for (int h = 0; h < height && res == CE_NO_ERROR; )
     {
-        ReadoutLine(&rlp, buffer + (h * width), false);
+        int blockEnd = isPrimary ? std::min<int>(h + READOUT_LINES_BLOCK, height) : height;
+        for (; h < blockEnd; h++)
+        {
+            if ((res = ReadoutLine(&rlp, buffer + (h * width), false)) != CE_NO_ERROR)
+                break;
+        }
+        if (isPrimary && h < height && res == CE_NO_ERROR)
+        {
+            guard.unlock();
+            if (m_AbortPrimaryReadout)
+                res = CE_KBD_ESC;
+            guard.lock();
+        }
     }
+
     EndReadoutParams erp;
     erp.ccd = ccd;
-    if ((res = EndReadout(&erp)) != CE_NO_ERROR)
+    int endRes = EndReadout(&erp);
+    guard.unlock();
+    if (res != CE_NO_ERROR)
     {
-        LOGF_ERROR("%s readoutCCD - EndReadout error! (%s)",
-                   (targetChip == &PrimaryCCD) ? "Primary" : "Guide", GetErrorString(res));
-        guard.unlock();
+        LOGF_ERROR("%s readoutCCD - ReadoutLine %s", isPrimary ? "Primary" : "Guide",
+                   (isPrimary && m_AbortPrimaryReadout) ? "aborted" : "error!");
         return res;
     }
-    guard.unlock();
+    if (endRes != CE_NO_ERROR)
+    {
+        LOGF_ERROR("%s readoutCCD - EndReadout error! (%s)",
+                   isPrimary ? "Primary" : "Guide", GetErrorString(endRes));
+        return endRes;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - readoutStart;
+    // Video frames report through CCD_VIDEO_TIMING instead
+    if (isPrimary && m_Streaming)
+        return res;
+    int index = isPrimary ? READOUT_PRIMARY : READOUT_GUIDE;
+    ReadoutRateN[index].value = (elapsed.count() > 0) ? (width * height) / elapsed.count() / 1000.0 : 0;
+    ReadoutRateNP.s = IPS_OK;
+    IDSetNumber(&ReadoutRateNP, nullptr);
+    LOGF_DEBUG("%s readout of %dx%d took %.3f seconds (%.1f kpx/s)", isPrimary ? "Primary" : "Guide",
+               width, height, elapsed.count(), ReadoutRateN[index].value);
     return res;
 }
 
+int SBIGCCD::simulateReadoutLine(ReadoutLineParams *rlp, uint16_t *results)
+{
+    // Stand-in for the universal driver: noise data at a fixed digitizer rate, enough to
+    // benchmark the readout path without hardware.
+    for (int i = 0; i < rlp->pixelLength; i++)
+        results[i] = 1000 + rand() % 200;
+    usleep(rlp->pixelLength * 1000000 / SIM_PIXEL_RATE);
+    return CE_NO_ERROR;
+}
+
 //==========================================================================
 
 int SBIGCCD::CFWConnect()
@@ -37,7 +37,10 @@
 #include <sbigudrv.h>
 #endif
 
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 #define DEVICE struct usb_device *
 
@@ -149,6 +152,9 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         virtual bool StartGuideExposure(float duration) override;
         virtual bool AbortGuideExposure() override;
 
+        virtual bool StartStreaming() override;
+        virtual bool StopStreaming() override;
+
 #ifdef __APPLE__
         libusb_device *dev;
         libusb_device_handle *handle;
@@ -259,6 +265,26 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         ISwitch FilterConnectionS[2];
         ISwitchVectorProperty FilterConnectionSP;
 
+        /////////////////////////////////////////////////////////////////////////////
+        /// Readout Properties
+        /////////////////////////////////////////////////////////////////////////////
+        INumber ReadoutRateN[2];
+        INumberVectorProperty ReadoutRateNP;
+        enum
+        {
+            READOUT_PRIMARY,
+            READOUT_GUIDE,
+        };
+
+        INumber VideoTimingN[3];
+        INumberVectorProperty VideoTimingNP;
+        enum
+        {
+            VIDEO_FPS,
+            VIDEO_EXPOSURE,
+            VIDEO_READOUT,
+        };
+
         /////////////////////////////////////////////////////////////////////////////
         /// Camera capabilities
         /////////////////////////////////////////////////////////////////////////////
@@ -272,6 +298,13 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         /// Threading Variables
         /////////////////////////////////////////////////////////////////////////////
         std::mutex sbigLock;
+        // Primary chip downloads run here so guide head frames keep flowing from TimerHit
+        std::thread m_PrimaryReadoutThread;
+        std::atomic_bool m_AbortPrimaryReadout { false };
+        // Video mode exposes and reads the primary chip back to back here
+        std::thread m_StreamThread;
+        std::atomic_bool m_Streaming { false };
+        std::vector<uint16_t> m_StreamBuffer;
 
         /////////////////////////////////////////////////////////////////////////////
         /// Exposure Variables
@@ -429,6 +462,11 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         /// Utility Functions
         /////////////////////////////////////////////////////////////////////////////
         bool grabImage(INDI::CCDChip *targetChip);
+        void grabPrimaryImageAsync();
+        void joinPrimaryReadout();
+        void streamVideo();
+        bool waitExposureDone(INDI::CCDChip *targetChip, double duration, std::chrono::steady_clock::time_point start);
+        int simulateReadoutLine(ReadoutLineParams *rlp, unsigned short *results);
         bool setupParams();
         // SBIG's software interface to the Universal Driver Library function:
         int SBIGUnivDrvCommand(PAR_COMMAND, void *, void *);
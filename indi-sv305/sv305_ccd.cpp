@@ -24,6 +24,7 @@
 
 #include <memory>
 #include <deque>
+#include <limits>
 #include <time.h>
 #include <math.h>
 #include <unistd.h>
@@ -66,6 +67,50 @@ public:
     }
 } loader;
 
+
+// stretching 12bits depth to 16bits depth, written as a flat loop so it vectorizes
+static void stretchFrame(uint16_t *frame, size_t count, int shift)
+{
+    for (size_t i = 0; i < count; i++)
+        frame[i] <<= shift;
+}
+
+
+// software binning with the stretch folded in, saturating like CCDChip::binFrame
+template <typename T>
+static void binStretchFrame(const T *src, T *dst, int width, int height, int bin, int shift,
+                            std::vector<uint32_t> &acc)
+{
+    const uint32_t maxValue = std::numeric_limits<T>::max();
+    int binWidth  = width / bin;
+    int binHeight = height / bin;
+
+    acc.resize(binWidth);
+    for (int y = 0; y < binHeight; y++)
+    {
+        std::fill(acc.begin(), acc.end(), 0);
+        for (int row = 0; row < bin; row++)
+        {
+            const T *line = src + (y * bin + row) * width;
+            if (bin == 2)
+            {
+                for (int x = 0; x < binWidth; x++)
+                    acc[x] += line[2 * x] + line[2 * x + 1];
+            }
+            else
+            {
+                for (int x = 0; x < binWidth; x++)
+                    for (int k = 0; k < bin; k++)
+                        acc[x] += line[x * bin + k];
+            }
+        }
+
+        T *out = dst + y * binWidth;
+        for (int x = 0; x < binWidth; x++)
+            out[x] = std::min(acc[x] << shift, maxValue);
+    }
+}
+
 //////////////////////////////////////////////////
 // SV305 CLASS
 //
@@ -131,6 +176,11 @@ bool Sv305CCD::initProperties()
 
     SetCCDCapability(cap);
 
+    // streaming statistics
+    IUFillNumber(&StreamStatsN[STREAM_FPS], "STREAM_FPS", "Measured FPS", "%.1f", 0, 1000, 0, 0);
+    IUFillNumber(&StreamStatsN[STREAM_DROPPED], "STREAM_DROPPED", "Dropped frames", "%.f", 0, 1e9, 0, 0);
+    IUFillNumberVector(&StreamStatsNP, StreamStatsN, 2, getDeviceName(), "STREAM_STATS", "Stream stats", STREAM_TAB, IP_RO, 60, IPS_IDLE);
+
     addConfigurationControl();
     addDebugControl();
     return true;
@@ -170,6 +220,9 @@ bool Sv305CCD::updateProperties()
         // stretch factor
         defineProperty(&StretchSP);
 
+        // streaming statistics
+        defineProperty(&StreamStatsNP);
+
         timerID = SetTimer(getCurrentPollingPeriod());
     }
     else
@@ -193,6 +246,9 @@ bool Sv305CCD::updateProperties()
 
         // stretch factor
         deleteProperty(StretchSP.name);
+
+        // streaming statistics
+        deleteProperty(StreamStatsNP.name);
     }
 
     return true;
@@ -453,9 +509,13 @@ bool Sv305CCD::Connect()
     // set CCD up
     updateCCDParams();
 
-    // create streaming thread
+    // reset video ring
+    videoRing.reset();
+
+    // create capture and publishing threads
     terminateThread = false;
     pthread_create(&primary_thread, nullptr, &streamVideoHelper, this);
+    pthread_create(&publish_thread, nullptr, &publishVideoHelper, this);
 
     /* Success! */
     LOG_INFO("CCD is online. Retrieving basic data.\n");
@@ -473,23 +533,27 @@ bool Sv305CCD::Disconnect()
     pthread_cond_signal(&cv);
     pthread_mutex_unlock(&condMutex);
 
+    videoRing.stop();
+
     //pthread_mutex_lock(&cameraID_mutex);
 
     // stop camera
     status = SVBStopVideoCapture(cameraID);
+
+    // capture wait is bounded, so both threads exit shortly, whether or not the camera stopped
+    pthread_join(primary_thread, nullptr);
+    pthread_join(publish_thread, nullptr);
+
+    // the threads are gone either way, so close the camera rather than leave it half connected
     if(status != SVB_SUCCESS)
     {
         LOG_ERROR("Error, stop camera failed\n");
-        pthread_mutex_unlock(&cameraID_mutex);
-        return false;
     }
 
     // destroy camera
     status = SVBCloseCamera(cameraID);
     LOG_INFO("CCD is offline.\n");
 
-    pthread_mutex_unlock(&cameraID_mutex);
-
     return true;
 }
 
@@ -607,7 +671,11 @@ bool Sv305CCD::StartStreaming()
 
     // stream init
     Streamer->setPixelFormat(INDI_BAYER_GRBG, bitDepth);
-    Streamer->setSize(PrimaryCCD.getXRes(), PrimaryCCD.getYRes());
+    Streamer->setSize(PrimaryCCD.getSubW() / PrimaryCCD.getBinX(), PrimaryCCD.getSubH() / PrimaryCCD.getBinY());
+
+    // reset statistics
+    videoRing.resetStats();
+    gettimeofday(&videoStatsStart, nullptr);
 
     // streaming exposure time
     ExposureRequest = 1.0 / Streamer->getTargetFPS();
@@ -685,12 +753,10 @@ void* Sv305CCD::streamVideoHelper(void * context)
 }
 
 
-//
+// capture thread : SVBGetVideoData blocks until the camera delivers the next frame,
+// so the sensor paces the loop
 void* Sv305CCD::streamVideo()
 {
-    auto start = std::chrono::high_resolution_clock::now();
-    auto finish = std::chrono::high_resolution_clock::now();
-
     while (true)
     {
         pthread_mutex_lock(&condMutex);
@@ -698,55 +764,116 @@ void* Sv305CCD::streamVideo()
         while (!streaming)
         {
             pthread_cond_wait(&cv, &condMutex);
-            // ???
-            ExposureRequest = 1.0 / Streamer->getTargetFPS();
         }
 
         if (terminateThread)
+        {
+            pthread_mutex_unlock(&condMutex);
             break;
+        }
 
         pthread_mutex_unlock(&condMutex);
 
-        unsigned char* imageBuffer = PrimaryCCD.getFrameBuffer();
+        int width  = PrimaryCCD.getSubW();
+        int height = PrimaryCCD.getSubH();
+        long frameSize = (long)width * height * (bitDepth / 8);
+        // wait long enough for one exposure plus readout
+        int waitMs = ExposureRequest * 2000 + 500;
 
-        pthread_mutex_lock(&cameraID_mutex);
+        // binning the frame is published with, read before it is captured
+        int bin = binning ? PrimaryCCD.getBinX() : 1;
 
-        // get the frame
-        status = SVBGetVideoData(cameraID, imageBuffer, PrimaryCCD.getFrameBufferSize(), 100000 );
+        // take a free slot, or recycle the oldest unpublished frame
+        int slot = videoRing.acquire();
 
+        // no allocation unless the frame size changed
+        std::vector<unsigned char> &frame = videoRing.buffer(slot);
+        frame.resize(frameSize);
+
+        pthread_mutex_lock(&cameraID_mutex);
+        SVB_ERROR_CODE ret = SVBGetVideoData(cameraID, frame.data(), frameSize, waitMs);
         pthread_mutex_unlock(&cameraID_mutex);
 
-        finish = std::chrono::high_resolution_clock::now();
+        if (ret == SVB_SUCCESS)
+            videoRing.commit(slot, width, height, bin);
+        else
+            videoRing.discard(slot);
+    }
+
+    return nullptr;
+}
+
+
+//
+void* Sv305CCD::publishVideoHelper(void * context)
+{
+    return static_cast<Sv305CCD *>(context)->publishVideo();
+}
+
+
+// publishing thread : stretch, bin and send frames without blocking the capture
+void* Sv305CCD::publishVideo()
+{
+    while (true)
+    {
+        int slot = videoRing.waitReady();
+        if (slot < 0)
+            break;
 
-        // stretching 12bits depth to 16bits depth
-        if(bitDepth==16 && (bitStretch != 0))
+        int width  = videoRing.width(slot);
+        int height = videoRing.height(slot);
+        int bin    = videoRing.bin(slot);
+        int shift  = (bitDepth == 16) ? bitStretch : 0;
+        unsigned char *frame = videoRing.buffer(slot).data();
+        uint32_t size = videoRing.buffer(slot).size();
+
+        if (bin > 1)
         {
-            u_int16_t* tmp=(u_int16_t*)imageBuffer;
-            for(int i=0; i<PrimaryCCD.getFrameBufferSize()/2; i++)
-            {
-                tmp[i]<<=bitStretch;
-            }
+            size = (width / bin) * (height / bin) * (bitDepth / 8);
+            videoBinBuffer.resize(size);
+            if (bitDepth == 16)
+                binStretchFrame(reinterpret_cast<uint16_t *>(frame), reinterpret_cast<uint16_t *>(videoBinBuffer.data()),
+                                width, height, bin, shift, binAccumulator);
+            else
+                binStretchFrame(frame, videoBinBuffer.data(), width, height, bin, 0, binAccumulator);
+            frame = videoBinBuffer.data();
         }
-
-        if(binning)
+        else if (shift != 0)
         {
-            PrimaryCCD.binFrame();
+            stretchFrame(reinterpret_cast<uint16_t *>(frame), size / 2, shift);
         }
 
-        uint32_t size = PrimaryCCD.getFrameBufferSize() / (PrimaryCCD.getBinX() * PrimaryCCD.getBinY());
-        Streamer->newFrame(PrimaryCCD.getFrameBuffer(), size);
+        Streamer->newFrame(frame, size);
 
-        std::chrono::duration<double> elapsed = finish - start;
-        if (elapsed.count() < ExposureRequest)
-            usleep(fabs(ExposureRequest - elapsed.count()) * 1e6);
-
-        start = std::chrono::high_resolution_clock::now();
+        videoRing.release(slot);
     }
 
     return nullptr;
 }
 
 
+// publish measured frame rate and dropped frames
+void Sv305CCD::updateStreamStats()
+{
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+
+    double elapsed = (now.tv_sec - videoStatsStart.tv_sec) + (now.tv_usec - videoStatsStart.tv_usec) / 1e6;
+    if (elapsed < 1.0)
+        return;
+
+    int frames, dropped;
+    videoRing.takeStats(frames, dropped);
+
+    videoStatsStart = now;
+
+    StreamStatsN[STREAM_FPS].value = frames / elapsed;
+    StreamStatsN[STREAM_DROPPED].value = dropped;
+    StreamStatsNP.s = IPS_OK;
+    IDSetNumber(&StreamStatsNP, nullptr);
+}
+
+
 // subframing
 bool Sv305CCD::UpdateCCDFrame(int x, int y, int w, int h)
 {
@@ -889,11 +1016,7 @@ void Sv305CCD::TimerHit()
                     // stretching 12bits depth to 16bits depth
                     if(bitDepth==16 && (bitStretch != 0))
                     {
-                        u_int16_t* tmp=(u_int16_t*)imageBuffer;
-                        for(int i=0; i<PrimaryCCD.getFrameBufferSize()/2; i++)
-                        {
-                                tmp[i]<<=bitStretch;
-                        }
+                        stretchFrame((uint16_t*)imageBuffer, PrimaryCCD.getFrameBufferSize()/2, bitStretch);
                     }
 
                     // binning if needed
@@ -917,6 +1040,9 @@ void Sv305CCD::TimerHit()
         }
     }
 
+    if (streaming)
+        updateStreamStats();
+
     if (timerID == -1)
         SetTimer(getCurrentPollingPeriod());
     return;
@@ -27,8 +27,10 @@
 
 #include <indiccd.h>
 #include <iostream>
+#include <vector>
 
 #include "libsv305/SVBCameraSDK.h"
+#include "sv305_video_ring.h"
 
 
 using namespace std;
@@ -63,6 +65,8 @@ class Sv305CCD : public INDI::CCD
         virtual bool StopStreaming() override;
         static void* streamVideoHelper(void *context);
         void* streamVideo();
+        static void* publishVideoHelper(void *context);
+        void* publishVideo();
 
         // subframe
         virtual bool UpdateCCDFrame(int x, int y, int w, int h) override;
@@ -125,6 +129,20 @@ class Sv305CCD : public INDI::CCD
         pthread_t primary_thread;
         bool terminateThread;
 
+        // video frame ring between streamVideo and publishVideo
+        Sv305VideoRing videoRing;
+        pthread_t publish_thread;
+        // software binning output and accumulator
+        std::vector<unsigned char> videoBinBuffer;
+        std::vector<uint32_t> binAccumulator;
+
+        // streaming statistics
+        struct timeval videoStatsStart;
+        INumber StreamStatsN[2];
+        INumberVectorProperty StreamStatsNP;
+        enum { STREAM_FPS, STREAM_DROPPED };
+        void updateStreamStats();
+
         // controls settings
         enum
         {
@@ -0,0 +1,166 @@
+/*
+ SV305 CCD
+ SVBONY SV305 Camera driver
+ Copyright (C) 2020 Blaise-Florentin Collin (thx8411@yahoo.fr)
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "sv305_video_ring.h"
+
+
+const int Sv305VideoRing::SIZE;
+
+
+//
+Sv305VideoRing::Sv305VideoRing()
+{
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cv, NULL);
+    reset();
+}
+
+
+//
+Sv305VideoRing::~Sv305VideoRing()
+{
+    pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&cv);
+}
+
+
+//
+void Sv305VideoRing::reset()
+{
+    pthread_mutex_lock(&mutex);
+    freeSlots.clear();
+    readySlots.clear();
+    for (int i = 0; i < SIZE; i++)
+    {
+        freeSlots.push_back(i);
+        widths[i]  = 0;
+        heights[i] = 0;
+        bins[i]    = 1;
+    }
+    stopped   = false;
+    published = 0;
+    dropped   = 0;
+    pthread_mutex_unlock(&mutex);
+}
+
+
+//
+int Sv305VideoRing::acquire()
+{
+    pthread_mutex_lock(&mutex);
+    int slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.front();
+        freeSlots.pop_front();
+    }
+    else
+    {
+        // the publisher holds at most one slot, so there is always a ready one left
+        slot = readySlots.front();
+        readySlots.pop_front();
+        dropped++;
+    }
+    pthread_mutex_unlock(&mutex);
+    return slot;
+}
+
+
+//
+void Sv305VideoRing::commit(int slot, int width, int height, int bin)
+{
+    pthread_mutex_lock(&mutex);
+    widths[slot]  = width;
+    heights[slot] = height;
+    bins[slot]    = bin;
+    readySlots.push_back(slot);
+    pthread_cond_signal(&cv);
+    pthread_mutex_unlock(&mutex);
+}
+
+
+//
+void Sv305VideoRing::discard(int slot)
+{
+    pthread_mutex_lock(&mutex);
+    freeSlots.push_back(slot);
+    pthread_mutex_unlock(&mutex);
+}
+
+
+//
+int Sv305VideoRing::waitReady()
+{
+    pthread_mutex_lock(&mutex);
+    while (readySlots.empty() && !stopped)
+    {
+        pthread_cond_wait(&cv, &mutex);
+    }
+
+    int slot = -1;
+    if (!stopped)
+    {
+        slot = readySlots.front();
+        readySlots.pop_front();
+    }
+    pthread_mutex_unlock(&mutex);
+    return slot;
+}
+
+
+//
+void Sv305VideoRing::release(int slot)
+{
+    pthread_mutex_lock(&mutex);
+    freeSlots.push_back(slot);
+    published++;
+    pthread_mutex_unlock(&mutex);
+}
+
+
+//
+void Sv305VideoRing::stop()
+{
+    pthread_mutex_lock(&mutex);
+    stopped = true;
+    pthread_cond_broadcast(&cv);
+    pthread_mutex_unlock(&mutex);
+}
+
+
+//
+void Sv305VideoRing::takeStats(int &frameCount, int &droppedCount)
+{
+    pthread_mutex_lock(&mutex);
+    frameCount   = published;
+    droppedCount = dropped;
+    published    = 0;
+    pthread_mutex_unlock(&mutex);
+}
+
+
+//
+void Sv305VideoRing::resetStats()
+{
+    pthread_mutex_lock(&mutex);
+    published = 0;
+    dropped   = 0;
+    pthread_mutex_unlock(&mutex);
+}
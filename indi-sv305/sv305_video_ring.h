@@ -0,0 +1,99 @@
+/*
+ SV305 CCD
+ SVBONY SV305 Camera driver
+ Copyright (C) 2020 Blaise-Florentin Collin (thx8411@yahoo.fr)
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef SV305_VIDEO_RING_H
+#define SV305_VIDEO_RING_H
+
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+
+/////////////////////////////////////////////////
+// SV305VIDEORING CLASS
+//
+// Video frame ring : the capture thread fills free slots, the publishing
+// thread stretches, bins and sends ready slots. When the publisher falls
+// behind, the oldest ready frame is recycled and counted as dropped.
+// Each slot keeps the geometry and binning it was captured with.
+//
+
+class Sv305VideoRing
+{
+    public:
+        static const int SIZE = 4;
+
+        Sv305VideoRing();
+        ~Sv305VideoRing();
+
+        // all slots free, statistics cleared, waitReady() blocks again
+        void reset();
+
+        // capture side : take a free slot, or recycle the oldest ready one
+        int acquire();
+        // frame captured, hand it over to the publisher
+        void commit(int slot, int width, int height, int bin);
+        // capture failed, slot back to the free list
+        void discard(int slot);
+
+        // publishing side : next ready slot, -1 once stop() was called
+        int waitReady();
+        // frame published, slot back to the free list
+        void release(int slot);
+
+        // wake up and end waitReady()
+        void stop();
+
+        // published frames since the last call, dropped frames since resetStats()
+        void takeStats(int &frameCount, int &droppedCount);
+        void resetStats();
+
+        std::vector<unsigned char> &buffer(int slot)
+        {
+            return frames[slot];
+        }
+        int width(int slot) const
+        {
+            return widths[slot];
+        }
+        int height(int slot) const
+        {
+            return heights[slot];
+        }
+        int bin(int slot) const
+        {
+            return bins[slot];
+        }
+
+    private:
+        std::vector<unsigned char> frames[SIZE];
+        int widths[SIZE];
+        int heights[SIZE];
+        int bins[SIZE];
+        std::deque<int> freeSlots;
+        std::deque<int> readySlots;
+        bool stopped;
+        int published;
+        int dropped;
+        pthread_mutex_t mutex;
+        pthread_cond_t cv;
+};
+
+#endif // SV305_VIDEO_RING_H
@@ -0,0 +1,184 @@
+/*
+ SV305 CCD
+ SVBONY SV305 Camera driver
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Hand-over between the capture and publishing threads: frames keep the geometry and
+ * binning they were captured with, a slow publisher drops the oldest frames, and stop()
+ * releases a waiting publisher.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <thread>
+
+#include "sv305_video_ring.h"
+
+static void capture(Sv305VideoRing &ring, int sequence, int width, int height, int bin)
+{
+    int slot = ring.acquire();
+    ring.buffer(slot).resize(sizeof(sequence));
+    memcpy(ring.buffer(slot).data(), &sequence, sizeof(sequence));
+    ring.commit(slot, width, height, bin);
+}
+
+static int sequenceOf(Sv305VideoRing &ring, int slot)
+{
+    int sequence;
+    memcpy(&sequence, ring.buffer(slot).data(), sizeof(sequence));
+    return sequence;
+}
+
+TEST(Sv305VideoRingTest, frames_keep_their_binning)
+{
+    Sv305VideoRing ring;
+
+    // binning changed between the two captures, before either was published
+    capture(ring, 0, 1920, 1080, 2);
+    capture(ring, 1, 1280, 720, 1);
+
+    int slot = ring.waitReady();
+    ASSERT_GE(slot, 0);
+    EXPECT_EQ(sequenceOf(ring, slot), 0);
+    EXPECT_EQ(ring.width(slot), 1920);
+    EXPECT_EQ(ring.height(slot), 1080);
+    EXPECT_EQ(ring.bin(slot), 2);
+    ring.release(slot);
+
+    slot = ring.waitReady();
+    ASSERT_GE(slot, 0);
+    EXPECT_EQ(sequenceOf(ring, slot), 1);
+    EXPECT_EQ(ring.width(slot), 1280);
+    EXPECT_EQ(ring.height(slot), 720);
+    EXPECT_EQ(ring.bin(slot), 1);
+    ring.release(slot);
+
+    int frames, dropped;
+    ring.takeStats(frames, dropped);
+    EXPECT_EQ(frames, 2);
+    EXPECT_EQ(dropped, 0);
+}
+
+TEST(Sv305VideoRingTest, slow_publisher_drops_the_oldest_frames)
+{
+    Sv305VideoRing ring;
+
+    // one frame held by the publisher, the capture runs SIZE + 2 frames ahead
+    capture(ring, 0, 8, 8, 1);
+    int held = ring.waitReady();
+    ASSERT_GE(held, 0);
+    for (int i = 1; i <= Sv305VideoRing::SIZE + 2; i++)
+        capture(ring, i, 8, 8, 1);
+    ring.release(held);
+
+    // the ring keeps the newest SIZE - 1 frames, in capture order
+    for (int i = Sv305VideoRing::SIZE + 2 - (Sv305VideoRing::SIZE - 2); i <= Sv305VideoRing::SIZE + 2; i++)
+    {
+        int slot = ring.waitReady();
+        ASSERT_GE(slot, 0);
+        EXPECT_NE(slot, held);
+        EXPECT_EQ(sequenceOf(ring, slot), i);
+        ring.release(slot);
+    }
+
+    int frames, dropped;
+    ring.takeStats(frames, dropped);
+    EXPECT_EQ(frames, Sv305VideoRing::SIZE);
+    EXPECT_EQ(dropped, 3);
+
+    ring.resetStats();
+    ring.takeStats(frames, dropped);
+    EXPECT_EQ(frames, 0);
+    EXPECT_EQ(dropped, 0);
+}
+
+TEST(Sv305VideoRingTest, failed_capture_is_not_published)
+{
+    Sv305VideoRing ring;
+
+    ring.discard(ring.acquire());
+    capture(ring, 7, 8, 8, 1);
+
+    int slot = ring.waitReady();
+    ASSERT_GE(slot, 0);
+    EXPECT_EQ(sequenceOf(ring, slot), 7);
+    ring.release(slot);
+
+    // every slot is free again
+    for (int i = 0; i < Sv305VideoRing::SIZE; i++)
+        ring.acquire();
+    int frames, dropped;
+    ring.takeStats(frames, dropped);
+    EXPECT_EQ(dropped, 0);
+}
+
+TEST(Sv305VideoRingTest, stop_releases_the_publisher)
+{
+    Sv305VideoRing ring;
+
+    int slot = 0;
+    std::thread publisher([&ring, &slot]()
+    {
+        slot = ring.waitReady();
+    });
+    ring.stop();
+    publisher.join();
+    EXPECT_EQ(slot, -1);
+
+    // a stopped ring does not hand out frames until it is reset
+    capture(ring, 0, 8, 8, 1);
+    EXPECT_EQ(ring.waitReady(), -1);
+    ring.reset();
+    capture(ring, 1, 8, 8, 1);
+    slot = ring.waitReady();
+    ASSERT_GE(slot, 0);
+    EXPECT_EQ(sequenceOf(ring, slot), 1);
+}
+
+TEST(Sv305VideoRingTest, threads_publish_frames_in_order)
+{
+    Sv305VideoRing ring;
+    const int count = 2000;
+
+    std::thread publisher([&ring]()
+    {
+        int last = -1;
+        while (true)
+        {
+            int slot = ring.waitReady();
+            if (slot < 0)
+                break;
+            int sequence = sequenceOf(ring, slot);
+            EXPECT_GT(sequence, last);
+            last = sequence;
+            ring.release(slot);
+            if (sequence == count - 1)
+                break;
+        }
+    });
+
+    for (int i = 0; i < count; i++)
+        capture(ring, i, 8, 8, 1);
+    publisher.join();
+
+    // every frame was either published or dropped
+    int frames, dropped;
+    ring.takeStats(frames, dropped);
+    EXPECT_EQ(frames + dropped, count);
+}
@@ -0,0 +1,111 @@
+/*
+  Starlight Xpress CCD INDI Driver
+
+  Copyright (c) 2012-2013 Cloudmakers, s. r. o.
+  All Rights Reserved.
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the Free
+  Software Foundation; either version 2 of the License, or (at your option)
+  any later version.
+
+  This program is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+  more details.
+
+  You should have received a copy of the GNU General Public License along with
+  this program; if not, write to the Free Software Foundation, Inc., 59
+  Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  The full GNU General Public License is included in this distribution in the
+  file called LICENSE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Reorder rows read from an ICX453 sensor into the Bayer layout. Each source row
+ * holds 2 * width pixels covering two sensor rows, interleaved in groups of four.
+ * offset1 and offset2 locate the second pixel of the top and bottom sensor row
+ * within each group (2 and 3, swapped on the SXVF-M25C). dst receives 2 * rows
+ * rows of width pixels.
+ */
+static inline void sxReorderICX453Rows(const uint16_t *src, uint16_t *dst, int width, int rows, int offset1, int offset2)
+{
+    for (int row = 0; row < rows; row++)
+    {
+        const uint16_t *in = src + row * 2 * width;
+        uint16_t *out0     = dst + 2 * row * width;
+        uint16_t *out1     = out0 + width;
+        for (int col = 0; col < width; col += 2)
+        {
+            const uint16_t *cell = in + col * 2;
+            out0[col]     = cell[0];
+            out0[col + 1] = cell[offset1];
+            out1[col]     = cell[1];
+            out1[col + 1] = cell[offset2];
+        }
+    }
+}
+
+/*
+ * Luminance helpers for the fast guide readout of one-shot colour sensors.
+ *
+ * Each 2x2 Bayer cell is collapsed to a single luminance value which is written
+ * back to all four pixels, so the frame keeps the geometry the client asked for
+ * and the Bayer pattern stays valid: a client that debayers it gets a grey image.
+ * Both helpers work on a block of rows so they can be run on each USB chunk as
+ * soon as it has been read.
+ */
+
+/*
+ * Expand rows latched with 2x2 hardware binning. src holds rows of width / 2
+ * binned pixels, dst receives 2 * rows rows of width pixels. The camera sums
+ * the four photosites of a cell, the sum is averaged like sxLumaICX453Rows does
+ * so that both readouts keep the scale of a single pixel.
+ */
+static inline void sxExpandBinnedRows(const uint16_t *src, uint16_t *dst, int width, int rows)
+{
+    int half = width / 2;
+    for (int row = 0; row < rows; row++)
+    {
+        const uint16_t *in = src + row * half;
+        uint16_t *out0     = dst + 2 * row * width;
+        uint16_t *out1     = out0 + width;
+        for (int col = 0; col < half; col++)
+        {
+            uint16_t value    = (uint16_t)(((uint32_t)in[col] + 2) >> 2);
+            out0[2 * col]     = value;
+            out0[2 * col + 1] = value;
+            out1[2 * col]     = value;
+            out1[2 * col + 1] = value;
+        }
+    }
+}
+
+/*
+ * Bin rows read from an ICX453 sensor. Each source row holds 2 * width pixels
+ * covering two sensor rows, with the four pixels of every Bayer cell stored
+ * next to each other. dst receives 2 * rows rows of width pixels.
+ */
+static inline void sxLumaICX453Rows(const uint16_t *src, uint16_t *dst, int width, int rows)
+{
+    for (int row = 0; row < rows; row++)
+    {
+        const uint16_t *in = src + row * 2 * width;
+        uint16_t *out0     = dst + 2 * row * width;
+        uint16_t *out1     = out0 + width;
+        for (int col = 0; col < width; col += 2)
+        {
+            const uint16_t *cell = in + col * 2;
+            uint16_t value = (uint16_t)(((uint32_t)cell[0] + cell[1] + cell[2] + cell[3] + 2) >> 2);
+            out0[col]      = value;
+            out0[col + 1]  = value;
+            out1[col]      = value;
+            out1[col + 1]  = value;
+        }
+    }
+}
@@ -31,8 +31,10 @@
 
 #include "sxccd.h"
 
+#include "sxbayer.h"
 #include "sxconfig.h"
 
+#include <algorithm>
 #include <cmath>
 #include <deque>
 #include <memory>
@@ -47,6 +49,18 @@
 
 #define TIMER 1000
 
+// bytes read per step of the fast guide readout
+#define LUMA_CHUNK_SIZE (256 * 1024)
+// longest light frame still taken as a guide frame by the fast guide readout (s)
+#define FAST_GUIDE_MAX_EXPOSURE 10.0
+
+static long sxMicros()
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 static class Loader
 {
         std::deque<std::unique_ptr<SXCCD>> cameras;
@@ -148,6 +162,14 @@ bool SXCCD::initProperties()
     IUFillSwitch(&ShutterS[1], "SHUTTER_OFF", "Manual close", ISS_ON);
     IUFillSwitchVector(&ShutterSP, ShutterS, 2, getDeviceName(), "CCD_SHUTTER", "Shutter", OPTIONS_TAB, IP_RW,
                        ISR_1OFMANY, 60, IPS_IDLE);
+    IUFillSwitch(&GuideReadoutS[0], "GUIDE_READOUT_COLOR", "Full colour", ISS_ON);
+    IUFillSwitch(&GuideReadoutS[1], "GUIDE_READOUT_FAST", "Fast luminance", ISS_OFF);
+    IUFillSwitchVector(&GuideReadoutSP, GuideReadoutS, 2, getDeviceName(), "CCD_GUIDE_READOUT", "Guide readout",
+                       OPTIONS_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+    IUFillNumber(&TurnaroundN[0], "TURNAROUND_PRIMARY", "Primary (ms)", "%.1f", 0, 600000, 0, 0);
+    IUFillNumber(&TurnaroundN[1], "TURNAROUND_GUIDER", "Guider (ms)", "%.1f", 0, 600000, 0, 0);
+    IUFillNumberVector(&TurnaroundNP, TurnaroundN, 2, getDeviceName(), "CCD_READOUT_TURNAROUND", "Turnaround",
+                       IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
 
     //Adding switch to let user indicate whether the CCD has a Bayer filter, since I do not know which models beyond UltraStar C actually do
     //    IUFillSwitch(&BayerS[0], "BAYER_TRUE", "True", ISS_OFF);
@@ -173,6 +195,12 @@ bool SXCCD::updateProperties()
             defineProperty(&CoolerSP);
         if (HasShutter)
             defineProperty(&ShutterSP);
+        if (HasColor)
+        {
+            defineProperty(&GuideReadoutSP);
+            loadConfig(true, GuideReadoutSP.name);
+        }
+        defineProperty(&TurnaroundNP);
         //        if (HasColor) {
         //            defineProperty(&BayerSP);
         //        }
@@ -183,6 +211,9 @@ bool SXCCD::updateProperties()
             deleteProperty(CoolerSP.name);
         if (HasShutter)
             deleteProperty(ShutterSP.name);
+        if (HasColor)
+            deleteProperty(GuideReadoutSP.name);
+        deleteProperty(TurnaroundNP.name);
         //        if (HasColor) {
         //            deleteProperty(BayerSP.name);
         //        }
@@ -403,7 +434,7 @@ bool SXCCD::StartExposure(float n)
 {
     InExposure = true;
     PrimaryCCD.setExposureDuration(n);
-    if (sxIsInterlaced(model) && PrimaryCCD.getBinY() == 1)
+    if (sxIsInterlaced(model) && PrimaryCCD.getBinY() == 1 && !IsFastGuideFrame())
     {
         sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
         usleep(wipeDelay);
@@ -477,8 +508,13 @@ void SXCCD::ExposureTimerHit()
                 size = subW * subH / binX / binY;
             if (HasShutter)
                 sxSetShutter(handle, 1);
-            DidLatch = true;
-            if (isInterlaced)
+            DidLatch       = true;
+            long startTime = sxMicros();
+            if (IsFastGuideFrame())
+            {
+                rc = ReadLuminance(subX, subY, subW, subH);
+            }
+            else if (isInterlaced)
             {
                 if (binY > 1)
                 {
@@ -491,13 +527,10 @@ void SXCCD::ExposureTimerHit()
                 {
                     rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2, subW,
                                        subH / 2, binX, 1);
-                    struct timeval tv;
-                    gettimeofday(&tv, nullptr);
-                    long startTime = tv.tv_sec * 1000000 + tv.tv_usec;
+                    long fieldStart = sxMicros();
                     if (rc)
                         rc = sxReadPixels(handle, evenBuf, size);
-                    gettimeofday(&tv, nullptr);
-                    wipeDelay = tv.tv_sec * 1000000 + tv.tv_usec - startTime;
+                    wipeDelay = sxMicros() - fieldStart;
                     if (rc)
                         rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_ODD | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2,
                                            subW, subH / 2, binX, 1);
@@ -524,9 +557,6 @@ void SXCCD::ExposureTimerHit()
                         rc = sxReadPixels(handle, evenBuf, size * 2);
                         if (rc)
                         {
-                            uint16_t *buf16 = reinterpret_cast<uint16_t *>(buf);
-                            uint16_t *evenBuf16 = reinterpret_cast<uint16_t *>(evenBuf);
-
                             int offset_1 = 2, offset_2 = 3;
                             if (strstr(getDeviceName(), "SXVF-M25C"))
                             {
@@ -536,21 +566,8 @@ void SXCCD::ExposureTimerHit()
                                 offset_2 = 2;
                             }
 
-                            for (int i = 0; i < subH; i += 2)
-                            {
-                                for (int j = 0; j < subW; j += 2)
-                                {
-                                    int isubW = i * subW;
-                                    int i1subW = (i + 1) * subW;
-                                    int j2 = j * 2;
-
-                                    buf16[isubW + j]  = evenBuf16[isubW + j2];
-                                    buf16[isubW + j + 1]  = evenBuf16[isubW + j2 + offset_1];
-                                    buf16[i1subW + j]  = evenBuf16[isubW + j2 + 1];
-                                    buf16[i1subW + j + 1]  = evenBuf16[isubW + j2 + offset_2];
-
-                                }
-                            }
+                            sxReorderICX453Rows(reinterpret_cast<uint16_t *>(evenBuf), reinterpret_cast<uint16_t *>(buf),
+                                                subW, subH / 2, offset_1, offset_2);
                         }
                     }
                     else
@@ -569,7 +586,10 @@ void SXCCD::ExposureTimerHit()
             InExposure = false;
             PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
             if (rc)
+            {
+                SetTurnaround(0, startTime);
                 ExposureComplete(&PrimaryCCD);
+            }
         }
     }
 }
@@ -616,6 +636,7 @@ void SXCCD::GuideExposureTimerHit()
         int size             = subW * subH / binX / binY;
         uint8_t *buf         = GuideCCD.getFrameBuffer();
         DidGuideLatch        = true;
+        long startTime       = sxMicros();
         rc                   = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 1, subX, subY, subW, subH, binX, binY);
         if (rc)
             rc = sxReadPixels(handle, buf, size);
@@ -623,10 +644,65 @@ void SXCCD::GuideExposureTimerHit()
         InGuideExposure = false;
         GuideCCD.setExposureLeft(GuideExposureTimeLeft = 0);
         if (rc)
+        {
+            SetTurnaround(1, startTime);
             ExposureComplete(&GuideCCD);
+        }
     }
 }
 
+bool SXCCD::IsFastGuideFrame()
+{
+    // Short 1x1 colour light frames only, aligned to the Bayer cell. Calibration frames and
+    // imaging exposures always get the full colour readout.
+    if (!HasColor || GuideReadoutS[1].s != ISS_ON)
+        return false;
+    if (PrimaryCCD.getFrameType() != INDI::CCDChip::LIGHT_FRAME ||
+            PrimaryCCD.getExposureDuration() > FAST_GUIDE_MAX_EXPOSURE)
+        return false;
+    if (PrimaryCCD.getBinX() != 1 || PrimaryCCD.getBinY() != 1)
+        return false;
+    return (PrimaryCCD.getSubX() | PrimaryCCD.getSubY() | PrimaryCCD.getSubW() | PrimaryCCD.getSubH()) % 2 == 0;
+}
+
+bool SXCCD::ReadLuminance(int subX, int subY, int subW, int subH)
+{
+    // Bin each Bayer cell in the camera where it can be done, otherwise fold the
+    // cells chunk by chunk while the rest of the frame is still on the wire.
+    bool isICX453   = sxIsICX453(model);
+    uint16_t *buf16 = reinterpret_cast<uint16_t *>(PrimaryCCD.getFrameBuffer());
+    int rowPixels   = isICX453 ? subW * 2 : subW / 2;
+    int rows        = subH / 2;
+    int chunkRows   = std::max(1, LUMA_CHUNK_SIZE / (rowPixels * 2));
+    int rc;
+    lumaBuf.resize(chunkRows * rowPixels);
+    if (isICX453)
+        rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX * 2, subY / 2, subW * 2, subH / 2, 1, 1);
+    else if (sxIsInterlaced(model))
+        rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX, subY / 2, subW, subH / 2, 2, 1);
+    else
+        rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX, subY, subW, subH, 2, 2);
+    for (int row = 0; rc && row < rows; row += chunkRows)
+    {
+        int count = std::min(chunkRows, rows - row);
+        rc        = sxReadPixels(handle, lumaBuf.data(), count * rowPixels * 2);
+        if (!rc)
+            break;
+        if (isICX453)
+            sxLumaICX453Rows(lumaBuf.data(), buf16 + 2 * row * subW, subW, count);
+        else
+            sxExpandBinnedRows(lumaBuf.data(), buf16 + 2 * row * subW, subW, count);
+    }
+    return rc;
+}
+
+void SXCCD::SetTurnaround(int index, long startTime)
+{
+    TurnaroundN[index].value = (sxMicros() - startTime) / 1000.0;
+    TurnaroundNP.s           = IPS_OK;
+    IDSetNumber(&TurnaroundNP, nullptr);
+}
+
 IPState SXCCD::GuideWest(uint32_t ms)
 {
     if (!HasST4Port || ms < 1)
@@ -775,6 +851,13 @@ bool SXCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char
         IDSetNumber(&TemperatureNP, nullptr);
         result = true;
     }
+    else if (strcmp(name, GuideReadoutSP.name) == 0)
+    {
+        IUUpdateSwitch(&GuideReadoutSP, states, names, n);
+        GuideReadoutSP.s = IPS_OK;
+        IDSetSwitch(&GuideReadoutSP, nullptr);
+        result = true;
+    }
     //    else if (strcmp(name, BayerSP.name) == 0)
     //    {
     //        IUUpdateSwitch(&BayerSP, states, names, n);
@@ -795,9 +878,11 @@ bool SXCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char
     return result;
 }
 
-//bool SXCCD::saveConfigItems(FILE *fp)
-//{
-//    INDI::CCD::saveConfigItems(fp);
-//    IUSaveConfigSwitch(fp, &BayerSP);
-//    return true;
-//}
+bool SXCCD::saveConfigItems(FILE *fp)
+{
+    INDI::CCD::saveConfigItems(fp);
+    if (HasColor)
+        IUSaveConfigSwitch(fp, &GuideReadoutSP);
+    //    IUSaveConfigSwitch(fp, &BayerSP);
+    return true;
+}
@@ -35,6 +35,8 @@
 
 #include <indiccd.h>
 
+#include <vector>
+
 void ExposureTimerCallback(void *p);
 void GuideExposureTimerCallback(void *p);
 void WEGuiderTimerCallback(void *p);
@@ -53,6 +55,11 @@ class SXCCD : public INDI::CCD
         ISwitchVectorProperty CoolerSP;
         ISwitch ShutterS[2];
         ISwitchVectorProperty ShutterSP;
+        ISwitch GuideReadoutS[2];
+        ISwitchVectorProperty GuideReadoutSP;
+        INumber TurnaroundN[2];
+        INumberVectorProperty TurnaroundNP;
+        std::vector<uint16_t> lumaBuf;
         //    ISwitch BayerS[2];
         //    ISwitchVectorProperty BayerSP;
         float TemperatureRequest;
@@ -68,6 +75,9 @@ class SXCCD : public INDI::CCD
         bool DidGuideLatch;
         bool InGuideExposure;
         char GuideStatus;
+        bool IsFastGuideFrame();
+        bool ReadLuminance(int subX, int subY, int subW, int subH);
+        void SetTurnaround(int index, long startTime);
 
     protected:
         const char *getDefaultName();
@@ -88,7 +98,7 @@ class SXCCD : public INDI::CCD
         void GuideExposureTimerHit();
         void WEGuiderTimerHit();
         void NSGuiderTimerHit();
-        //bool saveConfigItems(FILE *fp);
+        bool saveConfigItems(FILE *fp);
         IPState GuideWest(uint32_t ms);
         IPState GuideEast(uint32_t ms);
         IPState GuideNorth(uint32_t ms);
@@ -29,11 +29,17 @@
 
 #include "sxccdusb.h"
 
+#include "sxbayer.h"
 #include "sxconfig.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <memory.h>
+#include <sys/time.h>
 #include <unistd.h>
+#include <vector>
 
 int n;
 DEVICE devices[20];
@@ -43,10 +49,154 @@ HANDLE handles[20];
 struct t_sxccd_params params;
 unsigned short pixels[10 * 10];
 
-int main()
+static long micros()
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/*
+ * Replay a recorded raw 1x1 frame (width x height 16-bit pixels in camera readout
+ * order) through the full colour readout and through the fast luminance guide
+ * readout of the driver, check that both agree on the luminance of every Bayer
+ * cell and print the turnaround of both. The transfer time is derived from the
+ * USB rate, the processing time is measured on the driver's own helpers.
+ */
+static int replay(const char *file, int width, int height, bool icx453, bool m25c, double rate)
+{
+    long size = (long)width * height;
+    std::vector<uint16_t> raw(size), frame(size), luma(size);
+    FILE *fp = fopen(file, "rb");
+    if (fp == nullptr || fread(raw.data(), 2, size, fp) != (size_t)size)
+    {
+        std::cout << "can't read " << size << " pixels from " << file << std::endl;
+        if (fp)
+            fclose(fp);
+        return 1;
+    }
+    fclose(fp);
+
+    // offsets used by SXCCD::ExposureTimerHit, swapped on the SXVF-M25C
+    int offset1 = m25c ? 3 : 2, offset2 = m25c ? 2 : 3;
+
+    // what the camera sends back when it bins the Bayer cells itself
+    std::vector<uint16_t> binned(size / 4);
+    if (!icx453)
+        for (int y = 0; y < height / 2; y++)
+            for (int x = 0; x < width / 2; x++)
+            {
+                const uint16_t *cell = raw.data() + 2 * y * width + 2 * x;
+                binned[y * (width / 2) + x] = std::min(65535, cell[0] + cell[1] + cell[width] + cell[width + 1]);
+            }
+
+    // same chunking as SXCCD::ReadLuminance
+    int rowPixels = icx453 ? width * 2 : width / 2;
+    int rows      = height / 2;
+    int chunkRows = std::max(1, 256 * 1024 / (rowPixels * 2));
+    const uint16_t *source = icx453 ? raw.data() : binned.data();
+
+    const int runs = 10;
+    long full = 0, fast = 0;
+    for (int run = 0; run < runs; run++)
+    {
+        long start = micros();
+        if (icx453)
+            sxReorderICX453Rows(raw.data(), frame.data(), width, height / 2, offset1, offset2);
+        else
+            memcpy(frame.data(), raw.data(), size * 2);
+        full += micros() - start;
+
+        start = micros();
+        for (int row = 0; row < rows; row += chunkRows)
+        {
+            int count = std::min(chunkRows, rows - row);
+            if (icx453)
+                sxLumaICX453Rows(source + (long)row * rowPixels, luma.data() + 2L * row * width, width, count);
+            else
+                sxExpandBinnedRows(source + (long)row * rowPixels, luma.data() + 2L * row * width, width, count);
+        }
+        fast += micros() - start;
+    }
+
+    // every pixel of a cell must carry the luminance of that cell of the colour frame
+    long mismatches = 0;
+    for (int y = 0; y < height; y += 2)
+        for (int x = 0; x < width; x += 2)
+        {
+            const uint16_t *cell = frame.data() + (long)y * width + x;
+            uint32_t sum = (uint32_t)cell[0] + cell[1] + cell[width] + cell[width + 1];
+            // a camera binned sum is clipped to 16 bit before it is averaged
+            if (!icx453)
+                sum = std::min<uint32_t>(sum, 65535);
+            uint16_t expected = (uint16_t)((sum + 2) >> 2);
+            const uint16_t *out = luma.data() + (long)y * width + x;
+            if (out[0] != expected || out[1] != expected || out[width] != expected || out[width + 1] != expected)
+                mismatches++;
+        }
+
+    double fullBytes = size * 2.0, fastBytes = (double)rows * rowPixels * 2;
+    double fullTransfer = rate > 0 ? fullBytes / rate / 1000.0 : 0;
+    double fastTransfer = rate > 0 ? fastBytes / rate / 1000.0 : 0;
+    std::cout << "full colour readout: " << fullTransfer << " ms transfer + " << full / runs / 1000.0
+              << " ms processing" << std::endl;
+    std::cout << "fast luminance readout: " << fastTransfer << " ms transfer + " << fast / runs / 1000.0
+              << " ms processing" << std::endl;
+    if (mismatches)
+    {
+        std::cout << mismatches << " Bayer cells differ between the two readouts" << std::endl;
+        return 1;
+    }
+    std::cout << "luminance of all " << size / 4 << " Bayer cells matches" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
 {
     int i = 0;
     unsigned short us = 0;
+    const char *replayFile = nullptr;
+    int width = 0, height = 0;
+    bool icx453 = false;
+    bool m25c = false;
+    double rate = 0;
+
+    while ((i = getopt(argc, argv, "r:w:h:imR:")) != -1)
+    {
+        switch (i)
+        {
+            case 'r':
+                replayFile = optarg;
+                break;
+            case 'w':
+                width = atoi(optarg);
+                break;
+            case 'h':
+                height = atoi(optarg);
+                break;
+            case 'i':
+                icx453 = true;
+                break;
+            case 'm':
+                m25c = true;
+                break;
+            case 'R':
+                rate = atof(optarg);
+                break;
+            default:
+                std::cout << "usage: sx_ccd_test [-r raw_frame -w width -h height [-i [-m]] [-R MB/s]]" << std::endl;
+                return 1;
+        }
+    }
+    if (replayFile != nullptr)
+    {
+        if (width <= 0 || height <= 0 || width % 2 || height % 2)
+        {
+            std::cout << "replay needs even -w and -h" << std::endl;
+            return 1;
+        }
+        return replay(replayFile, width, height, icx453, m25c, rate);
+    }
 
     sxDebug(true);
 
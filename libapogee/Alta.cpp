@@ -478,6 +478,32 @@ Apg::Status Alta::GetImagingStatus()
 //////////////////////////// 
 // GET  IMAGE 
 void Alta::GetImage( std::vector<uint16_t> & out )
+{
+    uint16_t r=0, c=0;
+    ExposureAndGetImgRC( r, c );
+    const size_t count = static_cast<size_t>(r) * GetImageZ() * GetRoiNumCols();
+
+    if( count != out.size() )
+    {
+        out.clear();
+        out.resize( count );
+    }
+
+    DownloadImage( out.data(), out.size(), r, c );
+}
+
+//////////////////////////// 
+// GET  IMAGE 
+void Alta::GetImage( uint16_t * out, const size_t count )
+{
+    uint16_t r=0, c=0;
+    ExposureAndGetImgRC( r, c );
+    DownloadImage( out, count, r, c );
+}
+
+//////////////////////////// 
+// DOWNLOAD  IMAGE 
+void Alta::DownloadImage( uint16_t * out, const size_t count, const uint16_t r, const uint16_t c )
 {
 #ifdef DEBUGGING_CAMERA
     apgHelper::DebugMsg( "Alta::GetImage -> BEGINNING" );
@@ -517,24 +543,26 @@ void Alta::GetImage( std::vector<uint16_t> & out )
     // even if the GetImage function throws
     // we can try to copy whatever data we managed
     // to fetch from the camera into the user supplied
-    // vector
-    uint16_t r=0, c = 0;
-    ExposureAndGetImgRC( r, c );
+    // buffer
     const uint16_t z = GetImageZ();
-    std::vector<uint16_t> datafromCam( r*c*z, 0 ); 
+    // the transfer overwrites the buffer, no need to clear it
+    m_ImgXferBuf.resize( static_cast<size_t>(r)*c*z );
 
     const int32_t dataLen = r*z;
     const int32_t numCols = GetRoiNumCols();  
 
-    if( dataLen*numCols != apgHelper::SizeT2Int32( out.size() ) )
+    if( static_cast<size_t>(dataLen)*numCols > count )
     {
-        out.clear();
-        out.resize( dataLen*numCols );
+        std::stringstream msg;
+        msg << "Image buffer too small, " << count;
+        msg << " pixels for " << dataLen*numCols << " pixels of image data.";
+        apgHelper::throwRuntimeException( m_fileName, msg.str(), 
+            __LINE__, Apg::ErrorType_InvalidUsage );
     }
 
     try
     {
-        m_CamIo->GetImageData( datafromCam );
+        m_CamIo->GetImageData( m_ImgXferBuf );
     }
     catch(std::exception & err )
     {
@@ -545,7 +573,7 @@ void Alta::GetImage( std::vector<uint16_t> & out )
         ApgLogger::Instance().Write(ApgLogger::LEVEL_RELEASE,"error",
         apgHelper::mkMsg( m_fileName, msg, __LINE__) );
 
-        FixImgFromCamera( datafromCam, out, dataLen, numCols );
+        FixImgFromCamera( m_ImgXferBuf, out, dataLen, numCols );
         throw;
     }
     
@@ -580,7 +608,7 @@ void Alta::GetImage( std::vector<uint16_t> & out )
 #endif
 
     // removing the AD garbage pixels at the beginning of every row
-    FixImgFromCamera( datafromCam, out, dataLen, numCols );
+    FixImgFromCamera( m_ImgXferBuf, out, dataLen, numCols );
   
     ApgLogger::Instance().Write(ApgLogger::LEVEL_DEBUG,"info","Get Image Completed.");
 
@@ -955,11 +983,11 @@ Apg::FanMode Alta::GetFanMode()
 //////////////////////////// 
 //      FIX      IMG        FROM          CAMERA
 void Alta::FixImgFromCamera( const std::vector<uint16_t> & data,
-                              std::vector<uint16_t> & out,  const int32_t rows, 
+                              uint16_t * out,  const int32_t rows, 
                               const int32_t cols )
 {
     const int32_t offset = m_CcdAcqSettings->GetPixelShift();
-    ImgFix::SingleOuputCopy( data, out, rows, cols, offset );
+    ImgFix::SingleOuputCopy( data.data(), out, rows, cols, offset );
 }
 
 //////////////////////////// 
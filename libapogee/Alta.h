@@ -40,6 +40,7 @@ class DLL_EXPORT Alta : public ApogeeCam
         Apg::Status GetImagingStatus();
       
         void GetImage( std::vector<uint16_t> & out );
+        void GetImage( uint16_t * out, size_t count );
 
         void StopExposure( bool Digitize );
 
@@ -198,6 +199,7 @@ class DLL_EXPORT Alta : public ApogeeCam
         Alta(const std::string & ioType,
              const std::string & DeviceAddr);
 
+        void DownloadImage( uint16_t * out, size_t count, uint16_t r, uint16_t c );
         void ExposureAndGetImgRC(uint16_t & r, uint16_t & c);
         uint16_t ExposureZ();
         uint16_t GetImageZ();
@@ -206,7 +208,7 @@ class DLL_EXPORT Alta : public ApogeeCam
             const std::string & DeviceAddr);
 
         void FixImgFromCamera( const std::vector<uint16_t> & data,
-            std::vector<uint16_t> & out,  int32_t rows, int32_t cols);
+            uint16_t * out,  int32_t rows, int32_t cols);
 
     private:
         
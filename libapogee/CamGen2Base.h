@@ -25,6 +25,7 @@ class DLL_EXPORT CamGen2Base  : public ApogeeCam
         Apg::Status GetImagingStatus();
 
         void GetImage( std::vector<uint16_t> & out );
+        void GetImage( uint16_t * out, size_t count );
 
         void StopExposure( bool Digitize );
 
@@ -45,6 +46,8 @@ class DLL_EXPORT CamGen2Base  : public ApogeeCam
 
         uint16_t ExposureZ();
 
+        void DownloadImage( uint16_t * out, size_t count, uint16_t r, uint16_t c );
+
         uint16_t GetImageZ();
 
         uint16_t GetIlluminationMask();
@@ -32,25 +32,58 @@ void ImgFix::SingleOuputCopy( const std::vector<uint16_t> & data,
       std::vector<uint16_t> & out, const int32_t rows,  const int32_t numImgCols,  
       const int32_t numLatencyPixels )
 {
+    SingleOuputCopy( data.data(), out.data(), rows, numImgCols, numLatencyPixels );
+}
+
+//////////////////////////// 
+//      QUAD      OUPUT       COPY
+void ImgFix::QuadOuputCopy( const std::vector<uint16_t> & data, 
+      std::vector<uint16_t> & out, const int32_t rows,  const int32_t cols,  
+      const int32_t numLatencyPixels, const int32_t outputBuffOffset )
+{
+    QuadOuputCopy( data.data(), out.data(), rows, cols, numLatencyPixels, outputBuffOffset );
+}
+
+//////////////////////////// 
+//      QUAD       OUPUT       FIX
+void ImgFix::QuadOuputFix( const std::vector<uint16_t> & data, 
+                                             std::vector<uint16_t> & out,
+                                             const int32_t rows,  const int32_t cols,
+                                             const int32_t numLatencyPixels)
+{
+    QuadOuputFix( data.data(), out.data(), rows, cols, numLatencyPixels );
+}
+
+//////////////////////////// 
+//      DUAL       OUPUT       FIX
+void ImgFix::DualOuputFix( const std::vector<uint16_t> & data, 
+                                             std::vector<uint16_t> & out,
+                                             const int32_t rows,  const int32_t cols,
+                                             const int32_t numLatencyPixels)
+{
+    DualOuputFix( data.data(), out.data(), rows, cols, numLatencyPixels );
+}
 
+//////////////////////////// 
+//      SINGLE       OUPUT       COPY
+void ImgFix::SingleOuputCopy( const uint16_t * data, uint16_t * out,
+      const int32_t rows,  const int32_t numImgCols,  
+      const int32_t numLatencyPixels )
+{
     // in testing found that this function is much faster than the erase function
     const int32_t actNumCols = numImgCols + numLatencyPixels;
 
-    for(int32_t r = 0, actColsOffset=numLatencyPixels, outColsOffset=0; r < rows;
-		    actColsOffset += actNumCols, outColsOffset += numImgCols, ++r)
+    const uint16_t * src = data + numLatencyPixels;
+    for(int32_t r = 0; r < rows; ++r, src += actNumCols, out += numImgCols)
     {
-        std::vector<uint16_t>::const_iterator start = data.begin()+actColsOffset;
-        std::vector<uint16_t>::const_iterator end = start + numImgCols;
-        std::vector<uint16_t>::iterator outStart = out.begin() + outColsOffset;
-        std::copy( start, end, outStart );
+        std::copy( src, src + numImgCols, out );
     }
 }
 
-
 //////////////////////////// 
 //      QUAD      OUPUT       COPY
-void ImgFix::QuadOuputCopy( const std::vector<uint16_t> & data, 
-      std::vector<uint16_t> & out, const int32_t rows,  const int32_t cols,  
+void ImgFix::QuadOuputCopy( const uint16_t * data, uint16_t * out,
+      const int32_t rows,  const int32_t cols,  
       const int32_t numLatencyPixels, const int32_t outputBuffOffset )
 {
     int32_t numGood =  ( cols / 2 ) * 4;
@@ -58,100 +91,78 @@ void ImgFix::QuadOuputCopy( const std::vector<uint16_t> & data,
 
     int32_t down = rows*cols;
     
-    int32_t goodStart = 0;
-    int32_t badStart = numLatencyPixels*2;
+    const uint16_t * src = data + numLatencyPixels*2;
+    uint16_t * dst = out + outputBuffOffset;
 
     while( down > 0 )
     {
-         int32_t len = std::min<int32_t>( down, numGood );
+        int32_t len = std::min<int32_t>( down, numGood );
 
-        std::vector<uint16_t>::const_iterator start = data.begin()+badStart;
-        std::vector<uint16_t>::const_iterator end = start + len;
-        std::vector<uint16_t>::iterator outStart = out.begin() + outputBuffOffset + goodStart;
-        std::copy( start, end, outStart );
+        std::copy( src, src + len, dst );
 
-         goodStart += len;
-         badStart += (len + numBad);
-         down -= len;
+        dst += len;
+        src += len + numBad;
+        down -= len;
     }
 }
 
 //////////////////////////// 
 //      QUAD       OUPUT       FIX
-void ImgFix::QuadOuputFix( const std::vector<uint16_t> & data, 
-                                             std::vector<uint16_t> & out,
+void ImgFix::QuadOuputFix( const uint16_t * data, uint16_t * out,
                                              const int32_t rows,  const int32_t cols,
                                              const int32_t numLatencyPixels)
 {
     const int32_t HALF_COLS = cols / 2;
     const int32_t HALF_ROWS = rows / 2;
     
-    int32_t index = numLatencyPixels*2;
+    const uint16_t * src = data + numLatencyPixels*2;
   
+    // the four outputs are interleaved pixel by pixel, one from each 
+    // corner, each reading walks towards the centre of the sensor
     for( int32_t r=0; r < HALF_ROWS; ++r )
     {
-        int32_t topOffset = cols*r;
-        int32_t bottomOffset = (cols*(rows-(r+1)));
+        uint16_t * top = out + cols*r;
+        uint16_t * bottom = out + cols*(rows-(r+1));
 
-        for( int32_t c=0; c < HALF_COLS; ++c)
+        for( int32_t c=0; c < HALF_COLS; ++c, src += 4 )
         {
-            int32_t ul = topOffset + c;
-            out[ul] = data[index];
-
-            int32_t ur =  topOffset + (cols-(c+1) );
-            ++index;
-            out[ur] = data[index];
-            
-            int32_t lr = bottomOffset + (cols-(c+1) );
-            ++index;
-            out[lr] = data[index];
-
-            int32_t ll = bottomOffset+c;
-            ++index;
-            out[ll] = data[index];
-
-            ++index;
+            top[c] = src[0];
+            top[cols-(c+1)] = src[1];
+            bottom[cols-(c+1)] = src[2];
+            bottom[c] = src[3];
         }
 
         //skip the latency pixels
-        index += numLatencyPixels*2;
+        src += numLatencyPixels*2;
     }
 }
 
 //////////////////////////// 
 //      DUAL       OUPUT       FIX
-void ImgFix::DualOuputFix( const std::vector<uint16_t> & data, 
-                                             std::vector<uint16_t> & out,
+void ImgFix::DualOuputFix( const uint16_t * data, uint16_t * out,
                                              const int32_t rows,  const int32_t cols,
                                              const int32_t numLatencyPixels)
 {
-   
     const int32_t HALF_COLS = cols / 2;
 
      //account for the odd no op col
     const int32_t oddAdjust = ( cols % 2 ) ? 1 : 0;
-    const int32_t START_UR_COL = cols;
 
-    int32_t index = numLatencyPixels;
+    const uint16_t * src = data + numLatencyPixels;
   
     for( int32_t r=0; r < rows; ++r )
     {
-        int32_t topOffset = cols*r;
+        uint16_t * left = out + cols*r;
+        // skip odd col if need with oddAdjust
+        uint16_t * right = left + cols - 1 - oddAdjust;
 
-        for( int32_t c=0; c < HALF_COLS; ++c)
+        for( int32_t c=0; c < HALF_COLS; ++c, src += 2 )
         {
-            // skip odd col if need with oddAdjust
-            int32_t ur =  topOffset + (START_UR_COL-(c+1) ) - oddAdjust;
-            out[ur] = data[index];
-
-           int32_t ul = topOffset + c;
-            ++index;
-            out[ul] = data[index];
-            
-            ++index;
+            right[-c] = src[0];
+            left[c] = src[1];
         }
 
         //skip the latency pixels
-        index += numLatencyPixels;
+        src += numLatencyPixels;
     }
 }
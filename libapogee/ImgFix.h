@@ -38,6 +38,21 @@ namespace ImgFix
                                      std::vector<uint16_t> & out,
                                      const int32_t rows,  const int32_t cols,
                                      const int32_t numLatencyPixels );
+
+    // raw pointer versions, these write the fixed image straight into a 
+    // caller supplied buffer of at least rows*cols pixels
+    void SingleOuputCopy( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t numImgCols, int32_t numLatencyPixels );
+
+    void QuadOuputCopy( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t cols, int32_t numLatencyPixels,
+        int32_t outputBuffOffset=0 );
+
+    void QuadOuputFix( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t cols, int32_t numLatencyPixels );
+
+    void DualOuputFix( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t cols, int32_t numLatencyPixels );
 }; 
 
 #endif
@@ -81,9 +81,12 @@ UInt16 gRoi_top[kNumCamsSupported];
 UInt16 gRoi_right[kNumCamsSupported];
 UInt16 gRoi_bottom[kNumCamsSupported];
 
+// width of the IBIS1300 sensor, and so of its black row vector
+#define IBIS_SENSOR_COLS 1280
+
 // for IBIS 1300 image sensor we look at the average of the first row of black pixels to perform the column normalization
 // this is where we store the average.  It is computed every time the gain setting on the image sensor is made.
-SInt32 gBlackOffsets[1280];
+SInt32 gBlackOffsets[IBIS_SENSOR_COLS];
 
 // for the Starfish PRO camera, we will calculate the column and row offsets from information in the overscan pixels
 // we will use the vertical overscan to calculate the column offsets and the horizontal overscan to calculate the
@@ -1128,79 +1131,88 @@ float fcImage_calcFullFrameRowAvgForRow(UInt16 *frameBufferPtr, int imageWidth,
     return retValue;
 }
 
-// routine to perform line level normalization on the RAW camera image
-// Used to get rid of the camera's read noise associated with ROWs
-// enter with pointer to 16 bit image
-//
-void fcImage_doFullFrameRowLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight)
+// clamp a corrected pixel back into the 16 bit range
+static inline UInt16 fcImage_clampFloatPixel(float floatPixel)
 {
-    //float reference;
-    int row, col;
-    UInt16 *inputPtr;
-    UInt16 aPixel;
-    float rowAvg = 0;
-    float thisRowAvg;
-    //float minRowAvg;
-    //float colAvg;
-    float frameAvg;
-    float rowOffset;
-    //float colOffset;
-    float floatPixel;
+    if (floatPixel > 65535.0f)
+        floatPixel = 65535.0f;
 
-    if (gDoSimulation)
-    {
-        srand(time(NULL));
-        int i = 0, j = 0;
+    if (floatPixel < 0.0f)
+        floatPixel = 0.0f;
 
-        for (i = 0; i < imageHeight; i++)
-            for (j = 0; j < imageWidth; j++)
-                frameBufferPtr[i * imageWidth + j] = rand() % 65535;
+    return (UInt16)floatPixel;
+}
 
-        return;
-    }
+static inline UInt16 fcImage_clampPixel(SInt32 bigPixel)
+{
+    if (bigPixel > 65535)
+        bigPixel = 65535;
 
-    // make sure we are dealing with 16 bit pixels
-    //	printf("fcImage_doFullFrameRowLevelNormalization\n");
+    if (bigPixel < 0)
+        bigPixel = 0;
+
+    return (UInt16)bigPixel;
+}
+
+// single pass line level normalization.  Each row is offset so that the average of its
+// 14 black cols matches the corrected black level of the previous row (the first row is
+// matched to the black average of the whole frame).  The first 'skipCols' cols are dropped
+// on output so the result can go straight into the caller's buffer.  outputPtr may be
+// frameBufferPtr when skipCols is 0.
+//
+static void fcImage_normalizeRows(UInt16 *frameBufferPtr, int imageWidth, int imageHeight, int skipCols,
+                                  UInt16 *outputPtr)
+{
+    int outWidth      = imageWidth - skipCols;
+    int row, col;
+    float prevAvg;
 
     // calculate the average of all the black pixels
-    frameAvg = fcImage_calcFullFrameAllColAvg(frameBufferPtr, imageWidth, imageHeight);
+    prevAvg = fcImage_calcFullFrameAllColAvg(frameBufferPtr, imageWidth, imageHeight);
 
     for (row = 0; row < imageHeight; row++)
     {
-        if (row > 0)
-            rowAvg = fcImage_calcFullFrameRowAvgForRow(frameBufferPtr, imageWidth, imageHeight, (row - 1));
-        //		rowAvg  = [self calcFullFrameRowMedianForRow: (row - 1)];
+        UInt16 *inputPtr = frameBufferPtr + (row * imageWidth);
+        UInt16 *rowOutPtr = outputPtr + (row * outWidth);
+        float thisRowAvg = 0.0f;
+        float correctedAvg = 0.0f;
+        float rowOffset;
 
-        thisRowAvg = fcImage_calcFullFrameRowAvgForRow(frameBufferPtr, imageWidth, imageHeight, row);
-        //		thisRowAvg = [self calcFullFrameRowMedianForRow: row];
-
-        if (row == 0)
-            rowOffset = frameAvg - thisRowAvg;
-        else
-            rowOffset = rowAvg - thisRowAvg; // 11-23-07
+        for (col = 0; col < 14; col++)
+            thisRowAvg += (float)inputPtr[col];
+        thisRowAvg = thisRowAvg / 14.0;
 
-        inputPtr = frameBufferPtr;
-        inputPtr = inputPtr + (row * imageWidth);
-        for (col = 0; col < imageWidth; col++)
-        //		for (col = 0; col < (imageWidth / 2); col++)
-        {
-            // get the next pixel
-            aPixel = *inputPtr;
+        rowOffset = prevAvg - thisRowAvg;
 
-            floatPixel = (float)aPixel;
+        // black level of this row once corrected, reference for the next row
+        for (col = 0; col < 14; col++)
+            correctedAvg += (float)fcImage_clampFloatPixel((float)inputPtr[col] + rowOffset);
+        prevAvg = correctedAvg / 14.0;
 
-            floatPixel += rowOffset;
+        for (col = skipCols; col < imageWidth; col++)
+            rowOutPtr[col - skipCols] = fcImage_clampFloatPixel((float)inputPtr[col] + rowOffset);
+    }
+}
 
-            if (floatPixel > 65535.0)
-                floatPixel = 65535.0;
+// routine to perform line level normalization on the RAW camera image
+// Used to get rid of the camera's read noise associated with ROWs
+// enter with pointer to 16 bit image
+//
+void fcImage_doFullFrameRowLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight)
+{
+    if (gDoSimulation)
+    {
+        srand(time(NULL));
+        int i = 0, j = 0;
 
-            if (floatPixel < 0.0)
-                floatPixel = 0.0;
+        for (i = 0; i < imageHeight; i++)
+            for (j = 0; j < imageWidth; j++)
+                frameBufferPtr[i * imageWidth + j] = rand() % 65535;
 
-            // put corrected value back
-            *inputPtr++ = (UInt16)floatPixel;
-        }
+        return;
     }
+
+    fcImage_normalizeRows(frameBufferPtr, imageWidth, imageHeight, 0, frameBufferPtr);
 }
 
 // routine to strip the black columns form the image read from the camera.  the camera's image is
@@ -1302,6 +1314,10 @@ float fcImage_IBIS_calcFirstBlackRowAverage(UInt16 *frameBufferPtr, int imageWid
 
     retValue = 0.0;
 
+    // the black row vector only covers the sensor width
+    if (imageWidth > IBIS_SENSOR_COLS)
+        imageWidth = IBIS_SENSOR_COLS;
+
     // we will average all of the pixels in the first row
 
     for (col = 0; col < imageWidth; col++)
@@ -1428,66 +1444,57 @@ void fcImage_IBIS_computeAvgColOffsets(int camNum)
     fcUsb_cmd_setIntegrationTime(camNum, savedIntegrationTime);
 }
 
-// routine to perform column level normalization on the RAW camera image
-// Used to get rid of the camera's fixed pattern noise associated with COLs
-// enter with pointer to 16 bit image
+// column level normalization, optionally followed by the pedestal subtraction of
+// fcImage_IBIS_subtractPedestal, in one row order pass over the image.  The per col
+// offsets are computed once up front.  The first (black) row is left untouched.
+// Cols past the sensor width have no black row entry, they only lose the pedestal.
 //
-void fcImage_IBIS_doFullFrameColLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight)
+static void fcImage_IBIS_normalizeCols(UInt16 *frameBufferPtr, int imageWidth, int imageHeight, bool subtractPedestal)
 {
-    //float reference;
-    int row, col;
-    UInt16 *inputPtr;
-    UInt16 aPixel;
-    //float rowAvg;
-    SInt32 thisColBlack;
-    //float minRowAvg;
-    //float colAvg;
-    float frameAvg;
-    //float rowOffset;
-    SInt32 colOffset;
-    //float floatPixel;
+    SInt32 colOffsets[IBIS_SENSOR_COLS];
     SInt32 blackAvg;
-    SInt32 bigPixel;
-    //SInt32 theOffset;
-
-    // make sure we are dealing with 16 bit pixels
+    SInt32 thePedestal;
+    int row, col, normCols;
 
-    //	printf("fcImage_IBIS_doFullFrameColLevelNormalization\n");
+    normCols = imageWidth;
+    if (normCols > IBIS_SENSOR_COLS)
+    {
+        Starfish_LogFmt("IBIS frame is %d cols wide, normalizing the first %d\n", imageWidth, IBIS_SENSOR_COLS);
+        normCols = IBIS_SENSOR_COLS;
+    }
 
     // calculate the average of all the black pixels
-    frameAvg = fcImage_IBIS_calcFirstBlackRowAverage(frameBufferPtr, imageWidth, imageHeight);
-    blackAvg = (SInt32)frameAvg;
+    blackAvg    = (SInt32)fcImage_IBIS_calcFirstBlackRowAverage(frameBufferPtr, normCols, imageHeight);
+    thePedestal = subtractPedestal ? blackAvg : 0;
 
-    for (col = 0; col < imageWidth; col++)
-    {
-        // first get this cols black pixel from the first row of the image
-        thisColBlack = gBlackOffsets[col];
+    for (col = 0; col < normCols; col++)
+        colOffsets[col] = blackAvg - gBlackOffsets[col];
 
-        colOffset = blackAvg - thisColBlack;
+    for (row = 1; row < imageHeight; row++)
+    {
+        UInt16 *inputPtr = frameBufferPtr + (row * imageWidth);
 
-        for (row = 1; row < imageHeight; row++)
+        for (col = 0; col < normCols; col++)
         {
-            // get the pixel for this row/col
-            inputPtr = frameBufferPtr;
-            inputPtr = inputPtr + (row * imageWidth) + col;
-            aPixel   = *inputPtr;
-            bigPixel = (SInt32)aPixel;
-
-            // normalize
-            bigPixel = bigPixel + colOffset;
-
-            if (bigPixel > 65535)
-                bigPixel = 65535;
-
-            if (bigPixel < 0)
-                bigPixel = 0;
-
-            // put corrected value back
-            *inputPtr = (UInt16)bigPixel;
+            // normalize, then remove the pedestal.  Clamp after each step like the two
+            // separate passes used to.
+            SInt32 bigPixel = fcImage_clampPixel((SInt32)inputPtr[col] + colOffsets[col]);
+            inputPtr[col]   = fcImage_clampPixel(bigPixel - thePedestal);
         }
+        for (; col < imageWidth; col++)
+            inputPtr[col] = fcImage_clampPixel((SInt32)inputPtr[col] - thePedestal);
     }
 }
 
+// routine to perform column level normalization on the RAW camera image
+// Used to get rid of the camera's fixed pattern noise associated with COLs
+// enter with pointer to 16 bit image
+//
+void fcImage_IBIS_doFullFrameColLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight)
+{
+    fcImage_IBIS_normalizeCols(frameBufferPtr, imageWidth, imageHeight, false);
+}
+
 // routine to compute the column level offsets in the image.
 // We do this by examining the vertical overscan region in the image
 // Computing the average in the particular column.
@@ -1561,18 +1568,7 @@ void fcImage_PRO_calcColOffsets(UInt16 *frameBufferPtr, int imageWidth, int imag
 //
 void fcImage_PRO_doFullFrameColLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight)
 {
-    //float reference;
     int row, col;
-    UInt16 *inputPtr;
-    UInt16 aPixel;
-    //float rowAvg;
-    //float thisRowAvg;
-    //float minRowAvg;
-    //float colAvg;
-    //float frameAvg;
-    //float rowOffset;
-    float colOffset;
-    float floatPixel;
 
     //	printf("fcImage_PRO_doFullFrameColLevelNormalization\n");
     Starfish_Log("fcImage_PRO_doFullFrameColLevelNormalization\n");
@@ -1580,31 +1576,14 @@ void fcImage_PRO_doFullFrameColLevelNormalization(UInt16 *frameBufferPtr, int im
     // calculate the average of all the black pixels in the vertical overscan area
     //	fcImage_PRO_calcColOffsets(frameBufferPtr, imageWidth, imageHeight);
 
+    // the offsets are whole numbers, so integer math gives the same result as the
+    // float conversion per pixel did, and lets the row loop vectorize
     for (row = 0; row < imageHeight; row++)
     {
-        inputPtr = frameBufferPtr;
-        inputPtr = inputPtr + (row * imageWidth);
-        for (col = 0; col < imageWidth; col++)
-        {
-            // get the next pixel
-            aPixel = *inputPtr;
-
-            // get the offset for this column
-            colOffset = (float)gProBlackColOffsets[col];
-
-            floatPixel = (float)aPixel;
+        UInt16 *inputPtr = frameBufferPtr + (row * imageWidth);
 
-            floatPixel -= colOffset;
-
-            if (floatPixel > 65535.0)
-                floatPixel = 65535.0;
-
-            if (floatPixel < 0.0)
-                floatPixel = 0.0;
-
-            // put corrected value back
-            *inputPtr++ = (UInt16)floatPixel;
-        }
+        for (col = 0; col < imageWidth; col++)
+            inputPtr[col] = fcImage_clampPixel((SInt32)inputPtr[col] - gProBlackColOffsets[col]);
     }
 }
 
@@ -3778,7 +3757,7 @@ int fcUsb_cmd_getRawFrame(int camNum, UInt16 numRows, UInt16 numCols, UInt16 *fr
     if (gCamerasFound[camNum - 1].camFinalProduct == starfish_pro4m_final_deviceID)
     {
         maxBytes     = numRows * numCols * 2; // 2 bytes / pixel
-        numBytesRead = RcvUSB(camNum, (unsigned char *)&frameBuffer, maxBytes);
+        numBytesRead = RcvUSB(camNum, (unsigned char *)frameBuffer, maxBytes);
 
         Starfish_LogFmt("   read - %ld bytes\n", numBytesRead);
         
@@ -3791,10 +3770,9 @@ int fcUsb_cmd_getRawFrame(int camNum, UInt16 numRows, UInt16 numCols, UInt16 *fr
         if (gCamerasFound[camNum - 1].camFinalProduct == starfish_ibis13_final_deviceID)
         {
             maxBytes     = numRows * numCols * 2; // 2 bytes / pixel
-            numBytesRead = RcvUSB(camNum, (unsigned char *)&frameBuffer, maxBytes);
+            numBytesRead = RcvUSB(camNum, (unsigned char *)frameBuffer, maxBytes);
 
-            fcImage_IBIS_doFullFrameColLevelNormalization(frameBuffer, numCols, numRows);
-            fcImage_IBIS_subtractPedestal(frameBuffer, numCols, numRows);
+            fcImage_IBIS_normalizeCols(frameBuffer, numCols, numRows, true);
         }
         else
         {
@@ -3812,11 +3790,9 @@ int fcUsb_cmd_getRawFrame(int camNum, UInt16 numRows, UInt16 numCols, UInt16 *fr
             }
             Starfish_LogFmt("   fcUsb_cmd_getRawFrame - numBytesRead - %i\n", (unsigned int)numBytesRead);
             
+            // normalize and strip the black cols straight into the caller's buffer
             if (gReadBlack[camNum - 1] && numBytesRead != 0)
-            {
-                fcImage_doFullFrameRowLevelNormalization(gFrameBuffer, (numCols + 16), numRows);
-                fcImage_StripBlackCols(camNum, frameBuffer);
-            }
+                fcImage_normalizeRows(gFrameBuffer, (numCols + 16), numRows, 16, frameBuffer);
         } // if Starfish
     }
 
@@ -0,0 +1,218 @@
+/*
+ * Times the fishcamp image normalization against the per pixel routines it
+ * replaced, on synthetic frames, and checks that both give the same image.
+ * The library sources are built in so that the static routines are reachable.
+ *
+ * usage: fishcamp_normalize_bench [-w width] [-h height] [-n runs]
+ */
+
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "fishcamp.c"
+
+// row level normalization as it was: two black col averages per row, then an
+// in place pass, and a separate pass to strip the black cols
+static void old_rowNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight)
+{
+    int row, col;
+    float frameAvg = fcImage_calcFullFrameAllColAvg(frameBufferPtr, imageWidth, imageHeight);
+
+    for (row = 0; row < imageHeight; row++)
+    {
+        float rowAvg     = row > 0 ? fcImage_calcFullFrameRowAvgForRow(frameBufferPtr, imageWidth, imageHeight, row - 1) : 0;
+        float thisRowAvg = fcImage_calcFullFrameRowAvgForRow(frameBufferPtr, imageWidth, imageHeight, row);
+        float rowOffset  = (row == 0) ? frameAvg - thisRowAvg : rowAvg - thisRowAvg;
+        UInt16 *inputPtr = frameBufferPtr + (row * imageWidth);
+
+        for (col = 0; col < imageWidth; col++)
+        {
+            float floatPixel = (float)inputPtr[col] + rowOffset;
+            if (floatPixel > 65535.0)
+                floatPixel = 65535.0;
+            if (floatPixel < 0.0)
+                floatPixel = 0.0;
+            inputPtr[col] = (UInt16)floatPixel;
+        }
+    }
+}
+
+static void old_stripBlackCols(UInt16 *src, int imageWidth, int imageHeight, UInt16 *dst)
+{
+    int row, col;
+    for (row = 0; row < imageHeight; row++)
+        for (col = 0; col < imageWidth; col++)
+            dst[row * imageWidth + col] = src[row * (imageWidth + 16) + 16 + col];
+}
+
+// IBIS col normalization as it was: col by col down the frame, then the pedestal
+static void old_ibisCols(UInt16 *frameBufferPtr, int imageWidth, int imageHeight)
+{
+    int row, col;
+    SInt32 blackAvg = (SInt32)fcImage_IBIS_calcFirstBlackRowAverage(frameBufferPtr, imageWidth, imageHeight);
+
+    for (col = 0; col < imageWidth; col++)
+    {
+        SInt32 colOffset = blackAvg - gBlackOffsets[col];
+        for (row = 1; row < imageHeight; row++)
+        {
+            UInt16 *inputPtr = frameBufferPtr + (row * imageWidth) + col;
+            *inputPtr        = fcImage_clampPixel((SInt32)*inputPtr + colOffset);
+        }
+    }
+    fcImage_IBIS_subtractPedestal(frameBufferPtr, imageWidth, imageHeight);
+}
+
+// PRO col normalization as it was, in float
+static void old_proCols(UInt16 *frameBufferPtr, int imageWidth, int imageHeight)
+{
+    int row, col;
+    for (row = 0; row < imageHeight; row++)
+    {
+        UInt16 *inputPtr = frameBufferPtr + (row * imageWidth);
+        for (col = 0; col < imageWidth; col++)
+        {
+            float floatPixel = (float)inputPtr[col] - (float)gProBlackColOffsets[col];
+            if (floatPixel > 65535.0)
+                floatPixel = 65535.0;
+            if (floatPixel < 0.0)
+                floatPixel = 0.0;
+            inputPtr[col] = (UInt16)floatPixel;
+        }
+    }
+}
+
+static void fillFrame(UInt16 *buf, int w, int h)
+{
+    int row, col;
+    srand(1);
+    for (row = 0; row < h; row++)
+        for (col = 0; col < w; col++)
+            buf[row * w + col] = 300 + 5 * (row % 17) + 3 * (col % 11) + rand() % 64;
+}
+
+static double elapsedMs(struct timeval *start)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_usec - start->tv_usec) / 1000.0;
+}
+
+static void report(const char *name, double oldMs, double newMs, int runs, bool same)
+{
+    printf("%-6s %10.2f %10.2f %7.1fx  %s\n", name, oldMs / runs, newMs / runs, oldMs / newMs,
+           same ? "identical" : "DIFFERENT");
+}
+
+int main(int argc, char *argv[])
+{
+    int width = 1280, height = 1024, runs = 20;
+    int opt, i, failed = 0;
+
+    while ((opt = getopt(argc, argv, "w:h:n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'w':
+                width = atoi(optarg);
+                break;
+            case 'h':
+                height = atoi(optarg);
+                break;
+            case 'n':
+                runs = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-w width] [-h height] [-n runs]\n", argv[0]);
+                return 1;
+        }
+    }
+    // the IBIS black row vector, and so the IBIS comparison, only covers the sensor width
+    if (width <= 0 || width > IBIS_SENSOR_COLS || height <= 0 || runs <= 0)
+    {
+        fprintf(stderr, "width must be 1-%d, height and runs positive\n", IBIS_SENSOR_COLS);
+        return 1;
+    }
+
+    size_t pixels   = (size_t)width * height;
+    size_t rawBytes = (size_t)(width + 16) * height * sizeof(UInt16);
+    UInt16 *raw     = malloc(rawBytes);
+    UInt16 *oldBuf  = malloc(rawBytes);
+    UInt16 *newBuf  = malloc(rawBytes);
+    UInt16 *oldOut  = malloc(pixels * sizeof(UInt16));
+    UInt16 *newOut  = malloc(pixels * sizeof(UInt16));
+    struct timeval start;
+    double oldMs, newMs;
+
+    for (i = 0; i < IBIS_SENSOR_COLS; i++)
+        gBlackOffsets[i] = 400 + rand() % 120 - 60;
+    for (i = 0; i < 4096; i++)
+        gProBlackColOffsets[i] = rand() % 100 - 50;
+
+    printf("%dx%d frames, %d runs, ms per frame\n", width, height, runs);
+    printf("%-6s %10s %10s %8s\n", "pass", "old", "new", "speedup");
+
+    // rows, reading the black cols and stripping them
+    fillFrame(raw, width + 16, height);
+    oldMs = newMs = 0;
+    for (i = 0; i < runs; i++)
+    {
+        memcpy(oldBuf, raw, rawBytes);
+        gettimeofday(&start, NULL);
+        old_rowNormalization(oldBuf, width + 16, height);
+        old_stripBlackCols(oldBuf, width, height, oldOut);
+        oldMs += elapsedMs(&start);
+
+        memcpy(newBuf, raw, rawBytes);
+        gettimeofday(&start, NULL);
+        fcImage_normalizeRows(newBuf, width + 16, height, 16, newOut);
+        newMs += elapsedMs(&start);
+    }
+    bool same = memcmp(oldOut, newOut, pixels * sizeof(UInt16)) == 0;
+    failed += !same;
+    report("rows", oldMs, newMs, runs, same);
+
+    // IBIS cols and pedestal
+    fillFrame(raw, width, height);
+    oldMs = newMs = 0;
+    for (i = 0; i < runs; i++)
+    {
+        memcpy(oldBuf, raw, pixels * sizeof(UInt16));
+        gettimeofday(&start, NULL);
+        old_ibisCols(oldBuf, width, height);
+        oldMs += elapsedMs(&start);
+
+        memcpy(newBuf, raw, pixels * sizeof(UInt16));
+        gettimeofday(&start, NULL);
+        fcImage_IBIS_normalizeCols(newBuf, width, height, true);
+        newMs += elapsedMs(&start);
+    }
+    same = memcmp(oldBuf, newBuf, pixels * sizeof(UInt16)) == 0;
+    failed += !same;
+    report("ibis", oldMs, newMs, runs, same);
+
+    // PRO cols
+    oldMs = newMs = 0;
+    for (i = 0; i < runs; i++)
+    {
+        memcpy(oldBuf, raw, pixels * sizeof(UInt16));
+        gettimeofday(&start, NULL);
+        old_proCols(oldBuf, width, height);
+        oldMs += elapsedMs(&start);
+
+        memcpy(newBuf, raw, pixels * sizeof(UInt16));
+        gettimeofday(&start, NULL);
+        fcImage_PRO_doFullFrameColLevelNormalization(newBuf, width, height);
+        newMs += elapsedMs(&start);
+    }
+    same = memcmp(oldBuf, newBuf, pixels * sizeof(UInt16)) == 0;
+    failed += !same;
+    report("pro", oldMs, newMs, runs, same);
+
+    free(raw);
+    free(oldBuf);
+    free(newBuf);
+    free(oldOut);
+    free(newOut);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,16 @@
+/*
+ * Builds the library sources into the test so that the static image
+ * normalization routines can be called from test_normalize.cpp.
+ */
+
+#include "../fishcamp.c"
+
+void test_normalizeRows(UInt16 *frameBufferPtr, int imageWidth, int imageHeight, int skipCols, UInt16 *outputPtr)
+{
+    fcImage_normalizeRows(frameBufferPtr, imageWidth, imageHeight, skipCols, outputPtr);
+}
+
+void test_IBIS_normalizeCols(UInt16 *frameBufferPtr, int imageWidth, int imageHeight, bool subtractPedestal)
+{
+    fcImage_IBIS_normalizeCols(frameBufferPtr, imageWidth, imageHeight, subtractPedestal);
+}
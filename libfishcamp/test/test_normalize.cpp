@@ -0,0 +1,183 @@
+/*
+ * Row and column normalization of the fishcamp frames, checked against a
+ * straightforward version of the original per pixel routines. The frames are
+ * synthetic: a black level that drifts per row and per column, plus some
+ * pixels close to both ends of the 16 bit range so that clamping is exercised.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "fishcamp.h"
+
+extern "C"
+{
+    extern SInt32 gBlackOffsets[1280];
+    extern SInt32 gProBlackColOffsets[4096];
+
+    void test_normalizeRows(UInt16 *frameBufferPtr, int imageWidth, int imageHeight, int skipCols, UInt16 *outputPtr);
+    void test_IBIS_normalizeCols(UInt16 *frameBufferPtr, int imageWidth, int imageHeight, bool subtractPedestal);
+    void fcImage_doFullFrameRowLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight);
+    void fcImage_IBIS_doFullFrameColLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight);
+    void fcImage_PRO_doFullFrameColLevelNormalization(UInt16 *frameBufferPtr, int imageWidth, int imageHeight);
+}
+
+static std::vector<UInt16> frame(int w, int h, unsigned seed)
+{
+    std::vector<UInt16> buf(w * h);
+    srand(seed);
+    for (int row = 0; row < h; row++)
+        for (int col = 0; col < w; col++)
+        {
+            int v = 300 + 5 * (row % 17) + 3 * (col % 11) + rand() % 64;
+            if (rand() % 97 == 0)
+                v = 65500 + rand() % 36;
+            if (rand() % 89 == 0)
+                v = rand() % 8;
+            buf[row * w + col] = v;
+        }
+    return buf;
+}
+
+static UInt16 clampFloat(float v)
+{
+    return v > 65535.0f ? 65535 : v < 0.0f ? 0 : (UInt16)v;
+}
+
+static UInt16 clampInt(SInt32 v)
+{
+    return v > 65535 ? 65535 : v < 0 ? 0 : (UInt16)v;
+}
+
+static float blackAvg(const UInt16 *row)
+{
+    float sum = 0.0f;
+    for (int col = 0; col < 14; col++)
+        sum += row[col];
+    return sum / 14.0;
+}
+
+// each row is corrected in place against the already corrected row above it
+static void referenceRows(std::vector<UInt16> &buf, int w, int h)
+{
+    float frameAvg = 0.0f;
+    for (int row = 0; row < h; row++)
+        for (int col = 0; col < 14; col++)
+            frameAvg += buf[row * w + col];
+    frameAvg = frameAvg / (14.0 * (float)h);
+
+    for (int row = 0; row < h; row++)
+    {
+        float reference = row == 0 ? frameAvg : blackAvg(&buf[(row - 1) * w]);
+        float rowOffset = reference - blackAvg(&buf[row * w]);
+        for (int col = 0; col < w; col++)
+            buf[row * w + col] = clampFloat((float)buf[row * w + col] + rowOffset);
+    }
+}
+
+static SInt32 blackRowAvg(int w)
+{
+    float sum = 0.0f;
+    for (int col = 0; col < w; col++)
+        sum += (float)gBlackOffsets[col];
+    return (SInt32)(sum / (float)w);
+}
+
+// column by column normalization, then an optional pedestal pass, row 0 untouched
+static void referenceIBIS(std::vector<UInt16> &buf, int w, int h, bool subtractPedestal)
+{
+    SInt32 avg = blackRowAvg(w);
+    for (int col = 0; col < w; col++)
+        for (int row = 1; row < h; row++)
+            buf[row * w + col] = clampInt((SInt32)buf[row * w + col] + avg - gBlackOffsets[col]);
+    if (subtractPedestal)
+        for (int i = w; i < w * h; i++)
+            buf[i] = clampInt((SInt32)buf[i] - avg);
+}
+
+static void setBlackOffsets(SInt32 *offsets, int count, int base, int spread)
+{
+    srand(7);
+    for (int col = 0; col < count; col++)
+        offsets[col] = base + rand() % spread - spread / 2;
+}
+
+TEST(NormalizeTest, row_level_in_place)
+{
+    const int w = 333, h = 57;
+    std::vector<UInt16> buf = frame(w, h, 1), expected = buf;
+
+    referenceRows(expected, w, h);
+    fcImage_doFullFrameRowLevelNormalization(buf.data(), w, h);
+    EXPECT_EQ(buf, expected);
+}
+
+TEST(NormalizeTest, row_level_strips_black_cols)
+{
+    const int w = 256, h = 40;
+    std::vector<UInt16> raw = frame(w + 16, h, 2), expected = raw, out(w * h, 0);
+
+    referenceRows(expected, w + 16, h);
+    test_normalizeRows(raw.data(), w + 16, h, 16, out.data());
+    for (int row = 0; row < h; row++)
+        for (int col = 0; col < w; col++)
+            ASSERT_EQ(out[row * w + col], expected[row * (w + 16) + 16 + col]) << row << "," << col;
+}
+
+TEST(NormalizeTest, ibis_cols)
+{
+    const int w = 1280, h = 32;
+    std::vector<UInt16> buf = frame(w, h, 3), expected = buf;
+
+    setBlackOffsets(gBlackOffsets, 1280, 400, 120);
+    referenceIBIS(expected, w, h, false);
+    fcImage_IBIS_doFullFrameColLevelNormalization(buf.data(), w, h);
+    EXPECT_EQ(buf, expected);
+}
+
+TEST(NormalizeTest, ibis_cols_and_pedestal)
+{
+    const int w = 640, h = 48;
+    std::vector<UInt16> buf = frame(w, h, 4), expected = buf;
+
+    setBlackOffsets(gBlackOffsets, 1280, 350, 200);
+    referenceIBIS(expected, w, h, true);
+    test_IBIS_normalizeCols(buf.data(), w, h, true);
+    EXPECT_EQ(buf, expected);
+}
+
+// cols past the 1280 wide black row vector only lose the pedestal
+TEST(NormalizeTest, ibis_wide_frames)
+{
+    const int w = 1300, h = 6;
+    std::vector<UInt16> buf = frame(w, h, 5), expected = buf;
+
+    setBlackOffsets(gBlackOffsets, 1280, 380, 150);
+    SInt32 avg = blackRowAvg(1280);
+    for (int row = 1; row < h; row++)
+        for (int col = 0; col < w; col++)
+        {
+            SInt32 pixel = expected[row * w + col];
+            if (col < 1280)
+                pixel = clampInt(pixel + avg - gBlackOffsets[col]);
+            expected[row * w + col] = clampInt(pixel - avg);
+        }
+    test_IBIS_normalizeCols(buf.data(), w, h, true);
+    EXPECT_EQ(buf, expected);
+}
+
+TEST(NormalizeTest, pro_cols)
+{
+    const int w = 2304, h = 20;
+    std::vector<UInt16> buf = frame(w, h, 6), expected = buf;
+
+    setBlackOffsets(gProBlackColOffsets, 4096, 0, 100);
+    for (int row = 0; row < h; row++)
+        for (int col = 0; col < w; col++)
+            expected[row * w + col] = clampFloat((float)expected[row * w + col] - (float)gProBlackColOffsets[col]);
+    fcImage_PRO_doFullFrameColLevelNormalization(buf.data(), w, h);
+    EXPECT_EQ(buf, expected);
+}
@@ -39,6 +39,7 @@
 // Header file for functions in pktriggercord-cli.c
 
 int save_buffer(pslr_handle_t camhandle, int bufno, int fd, pslr_status *status, user_file_format filefmt, int jpeg_stars);
+int save_buffer_mem(pslr_handle_t camhandle, int bufno, uint8_t **pdata, uint32_t *plength, pslr_status *status, user_file_format filefmt, int jpeg_stars);
 void save_memory(pslr_handle_t camhandle, int fd, uint32_t length);
 
 void print_status_info( pslr_handle_t h, pslr_status status );
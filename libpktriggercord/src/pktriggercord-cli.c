@@ -156,6 +156,22 @@ int save_buffer(pslr_handle_t camhandle, int bufno, int fd, pslr_status *status,
     return 0;
 }
 
+int save_buffer_mem(pslr_handle_t camhandle, int bufno, uint8_t **pdata, uint32_t *plength, pslr_status *status, user_file_format filefmt, int jpeg_stars) {
+    pslr_buffer_type imagetype;
+
+    if (filefmt == USER_FILE_FORMAT_PEF) {
+        imagetype = PSLR_BUF_PEF;
+    } else if (filefmt == USER_FILE_FORMAT_DNG) {
+        imagetype = PSLR_BUF_DNG;
+    } else {
+        imagetype = pslr_get_jpeg_buffer_type( camhandle, jpeg_stars );
+    }
+
+    DPRINT("get buffer %d type %d res %d to memory\n", bufno, imagetype, status->jpeg_resolution);
+
+    return pslr_get_buffer(camhandle, bufno, imagetype, status->jpeg_resolution, pdata, plength) != PSLR_OK;
+}
+
 void save_memory(pslr_handle_t camhandle, int fd, uint32_t length) {
     uint8_t buf[65536];
     uint32_t current;
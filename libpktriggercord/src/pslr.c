@@ -54,8 +54,10 @@
 
 
 #define POLL_INTERVAL 50000 /* Number of us to wait when polling */
-#define BLKSZ 65536 /* Block size for downloads; if too big, we get
+#define BLKSZ 65536 /* Smallest block size for downloads; if too big, we get
                      * memory allocation error from sg driver */
+#define MAX_BLKSZ 1048576 /* Block size tried first; halved down to BLKSZ
+                           * while the sg driver or the camera refuses it */
 #define BLOCK_RETRY 3 /* Number of retries, since we can occasionally
                        * get SCSI errors when downloading data */
 
@@ -386,6 +388,7 @@ pslr_handle_t pslr_init( char *model, char *device ) {
             if ( result == PSLR_OK ) {
                 DPRINT("\tFound camera %s %s\n", vendorId, productId);
                 pslr.fd = fd;
+                pslr.download_blksz = MAX_BLKSZ;
                 if ( model != NULL ) {
                     // user specified the camera model
                     camera_name = pslr_camera_name( &pslr );
@@ -660,22 +663,21 @@ int pslr_get_buffer(pslr_handle_t h, int bufno, pslr_buffer_type type, int resol
     uint32_t size = pslr_buffer_get_size(h);
     buf = malloc(size);
     if (!buf) {
+        pslr_buffer_close(h);
         return PSLR_NO_MEMORY;
     }
 
     uint32_t bufpos = 0;
-    while (true) {
-        uint32_t nextread = size - bufpos > 65536 ? 65536 : size - bufpos;
-        if (nextread == 0) {
-            break;
-        }
-        uint32_t bytes = pslr_buffer_read(h, buf+bufpos, nextread);
+    while (bufpos < size) {
+        uint32_t bytes = pslr_buffer_read(h, buf+bufpos, size - bufpos);
         if (bytes == 0) {
             break;
         }
         bufpos += bytes;
     }
     if ( bufpos != size ) {
+        free(buf);
+        pslr_buffer_close(h);
         return PSLR_READ_ERROR;
     }
     pslr_buffer_close(h);
@@ -1084,14 +1086,13 @@ uint32_t pslr_buffer_read(pslr_handle_t h, uint8_t *buf, uint32_t size) {
     seg_offs = p->offset - pos;
     addr = p->segments[i].addr + seg_offs;
 
-    /* Compute block size */
+    /* Compute block size; ipslr_download splits it into transfers of up to
+     * MAX_BLKSZ, so a caller with a large buffer gets the rest of the segment
+     * at once */
     blksz = size;
     if (blksz > p->segments[i].length - seg_offs) {
         blksz = p->segments[i].length - seg_offs;
     }
-    if (blksz > BLKSZ) {
-        blksz = BLKSZ;
-    }
 
 //    DPRINT("File offset %d segment: %d offset %d address 0x%x read size %d\n", p->offset,
 //           i, seg_offs, addr, blksz);
@@ -1424,31 +1425,51 @@ static int ipslr_buffer_segment_info(ipslr_handle_t *p, pslr_buffer_segment_info
     return PSLR_OK;
 }
 
+static int ipslr_download_block(ipslr_handle_t *p, uint32_t addr, uint32_t block, uint8_t *buf, int *n) {
+    uint8_t downloadCmd[8] = {0xf0, 0x24, 0x06, 0x02, 0x00, 0x00, 0x00, 0x00};
+
+    //DPRINT("Get 0x%x bytes from 0x%x\n", block, addr);
+    CHECK(ipslr_write_args(p, 2, addr, block));
+    CHECK(command(p->fd, 0x06, 0x00, 0x08));
+    get_status(p->fd);
+
+    *n = scsi_read(p->fd, downloadCmd, sizeof (downloadCmd), buf, block);
+    get_status(p->fd);
+    return PSLR_OK;
+}
+
 static int ipslr_download(ipslr_handle_t *p, uint32_t addr, uint32_t length, uint8_t *buf) {
     DPRINT("[C]\t\tipslr_download(address = 0x%X, length = %d)\n", addr, length);
-    uint8_t downloadCmd[8] = {0xf0, 0x24, 0x06, 0x02, 0x00, 0x00, 0x00, 0x00};
     uint32_t block;
     int n;
+    int ret;
     int retry;
     uint32_t length_start = length;
 
+    if (p->download_blksz < BLKSZ || p->download_blksz > MAX_BLKSZ) {
+        p->download_blksz = MAX_BLKSZ;
+    }
+
     retry = 0;
     while (length > 0) {
-        if (length > BLKSZ) {
-            block = BLKSZ;
+        if (length > p->download_blksz) {
+            block = p->download_blksz;
         } else {
             block = length;
         }
 
-        //DPRINT("Get 0x%x bytes from 0x%x\n", block, addr);
-        CHECK(ipslr_write_args(p, 2, addr, block));
-        CHECK(command(p->fd, 0x06, 0x00, 0x08));
-        get_status(p->fd);
-
-        n = scsi_read(p->fd, downloadCmd, sizeof (downloadCmd), buf, block);
-        get_status(p->fd);
-
-        if (n < 0) {
+        ret = ipslr_download_block(p, addr, block, buf, &n);
+        if (ret != PSLR_OK || n < 0) {
+            if (block > BLKSZ) {
+                /* The transfer is too big for the sg driver or the camera,
+                 * keep a smaller one for the rest of the session */
+                DPRINT("\tDownload of %d bytes failed, trying %d\n", block, block / 2);
+                p->download_blksz = block / 2 > BLKSZ ? block / 2 : BLKSZ;
+                continue;
+            }
+            if (ret != PSLR_OK) {
+                return ret;
+            }
             if (retry < BLOCK_RETRY) {
                 retry++;
                 continue;
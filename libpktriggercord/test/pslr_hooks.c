@@ -0,0 +1,137 @@
+/*
+ * Builds pslr.c into the test over a simulated camera instead of the SCSI
+ * layer, so that buffer downloads can be replayed command by command. The
+ * camera answers the argument, download and status commands of a buffer
+ * read from a memory image; reads bigger than its transfer limit fail the
+ * way the sg driver refuses a too big request.
+ */
+
+#include "../src/pslr.c"
+
+bool debug = false;
+
+static uint8_t *sim_memory = NULL;
+static uint32_t sim_size = 0;
+static uint32_t sim_args[4];
+static uint32_t sim_max_transfer = 0;
+static int sim_fail_reads = 0;
+static int sim_downloads = 0;
+static int sim_failed_reads = 0;
+
+char **get_drives(int *drive_num) {
+    *drive_num = 0;
+    return NULL;
+}
+
+pslr_result get_drive_info(char *drive_name, int *device,
+                           char *vendor_id, int vendor_id_size_max,
+                           char *product_id, int product_id_size_max) {
+    INDI_UNUSED(drive_name);
+    INDI_UNUSED(device);
+    INDI_UNUSED(vendor_id);
+    INDI_UNUSED(vendor_id_size_max);
+    INDI_UNUSED(product_id);
+    INDI_UNUSED(product_id_size_max);
+    return PSLR_DEVICE_ERROR;
+}
+
+void close_drive(int *device) {
+    INDI_UNUSED(device);
+}
+
+int scsi_write(int sg_fd, uint8_t *cmd, uint32_t cmdLen,
+               uint8_t *buf, uint32_t bufLen) {
+    INDI_UNUSED(sg_fd);
+    INDI_UNUSED(cmdLen);
+    if (cmd[1] == 0x4f) {
+        /* no model yet, so the arguments come one by one, big endian */
+        if (bufLen != 4 || cmd[2] / 4 >= 4) {
+            return PSLR_COMMAND_ERROR;
+        }
+        sim_args[cmd[2] / 4] = get_uint32_be(buf);
+        return PSLR_OK;
+    }
+    if (cmd[1] == 0x24 && cmd[2] == 0x06) {
+        sim_downloads++;
+        return PSLR_OK;
+    }
+    return PSLR_COMMAND_ERROR;
+}
+
+int scsi_read(int sg_fd, uint8_t *cmd, uint32_t cmdLen,
+              uint8_t *buf, uint32_t bufLen) {
+    INDI_UNUSED(sg_fd);
+    INDI_UNUSED(cmdLen);
+    if (cmd[1] == 0x26) {
+        /* status: idle, no error */
+        memset(buf, 0, bufLen);
+        return bufLen;
+    }
+    if (cmd[1] == 0x24 && cmd[2] == 0x06 && cmd[3] == 0x02) {
+        uint32_t addr = sim_args[0];
+        uint32_t length = sim_args[1];
+        if (bufLen > sim_max_transfer) {
+            sim_failed_reads++;
+            return -PSLR_DEVICE_ERROR;
+        }
+        if (sim_fail_reads > 0) {
+            sim_fail_reads--;
+            sim_failed_reads++;
+            return -PSLR_SCSI_ERROR;
+        }
+        if (length != bufLen || addr + length > sim_size) {
+            return -PSLR_READ_ERROR;
+        }
+        memcpy(buf, sim_memory + addr, length);
+        return length;
+    }
+    return -PSLR_COMMAND_ERROR;
+}
+
+pslr_handle_t test_camera_open(const uint32_t *lengths, int count, uint32_t max_transfer) {
+    uint32_t addr = 0x1000;
+    int i;
+
+    free(sim_memory);
+    memset(&pslr, 0, sizeof (pslr));
+    for (i = 0; i < count; i++) {
+        pslr.segments[i].offset = 0;
+        pslr.segments[i].addr = addr;
+        pslr.segments[i].length = lengths[i];
+        /* a gap between the segments, which must never be read */
+        addr += lengths[i] + 0x100;
+    }
+    pslr.segment_count = count;
+
+    sim_size = addr;
+    sim_memory = malloc(sim_size);
+    for (i = 0; i < (int)sim_size; i++) {
+        sim_memory[i] = (uint8_t)(i * 7 + (i >> 9));
+    }
+    memset(sim_args, 0, sizeof (sim_args));
+    sim_max_transfer = max_transfer;
+    sim_fail_reads = 0;
+    sim_downloads = 0;
+    sim_failed_reads = 0;
+    return &pslr;
+}
+
+uint8_t test_camera_byte(int segment, uint32_t offset) {
+    return sim_memory[pslr.segments[segment].addr + offset];
+}
+
+void test_camera_fail_reads(int count) {
+    sim_fail_reads = count;
+}
+
+int test_camera_downloads() {
+    return sim_downloads;
+}
+
+int test_camera_failed_reads() {
+    return sim_failed_reads;
+}
+
+uint32_t test_camera_block_size() {
+    return pslr.download_blksz;
+}
@@ -0,0 +1,115 @@
+/*
+ * Buffer downloads replayed against a simulated camera (pslr_hooks.c): large
+ * caller buffers are read in few big transfers, transfers the sg driver
+ * refuses fall back to smaller blocks, and SCSI errors are retried.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <vector>
+
+extern "C"
+{
+    typedef void *pslr_handle_t;
+
+    uint32_t pslr_buffer_read(pslr_handle_t h, uint8_t *buf, uint32_t size);
+
+    pslr_handle_t test_camera_open(const uint32_t *lengths, int count, uint32_t max_transfer);
+    uint8_t test_camera_byte(int segment, uint32_t offset);
+    void test_camera_fail_reads(int count);
+    int test_camera_downloads();
+    int test_camera_failed_reads();
+    uint32_t test_camera_block_size();
+}
+
+static const uint32_t KB = 1024;
+static const uint32_t MB = 1024 * 1024;
+
+// reads the whole buffer the way pslr_get_buffer does
+static std::vector<uint8_t> readBuffer(pslr_handle_t h, uint32_t size, int *calls = nullptr)
+{
+    std::vector<uint8_t> buf(size);
+    uint32_t pos = 0;
+    int n = 0;
+    while (pos < size)
+    {
+        uint32_t bytes = pslr_buffer_read(h, buf.data() + pos, size - pos);
+        if (bytes == 0)
+            break;
+        pos += bytes;
+        n++;
+    }
+    buf.resize(pos);
+    if (calls)
+        *calls = n;
+    return buf;
+}
+
+static void expectSegments(const std::vector<uint8_t> &buf, const uint32_t *lengths, int count)
+{
+    uint32_t pos = 0;
+    for (int s = 0; s < count; s++)
+        for (uint32_t i = 0; i < lengths[s]; i++, pos++)
+            if (buf[pos] != test_camera_byte(s, i))
+            {
+                ADD_FAILURE() << "segment " << s << " byte " << i << " differs";
+                return;
+            }
+}
+
+TEST(PslrDownloadTest, large_reads_use_few_transfers)
+{
+    const uint32_t lengths[] = { 3 * MB + 123, 200000 };
+    pslr_handle_t h = test_camera_open(lengths, 2, MB);
+
+    int calls;
+    std::vector<uint8_t> buf = readBuffer(h, lengths[0] + lengths[1], &calls);
+    ASSERT_EQ(buf.size(), lengths[0] + lengths[1]);
+    expectSegments(buf, lengths, 2);
+
+    // one call per segment, 4 + 1 transfers instead of 52 with 64 KiB blocks
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(test_camera_downloads(), 5);
+    EXPECT_EQ(test_camera_failed_reads(), 0);
+}
+
+TEST(PslrDownloadTest, refused_transfers_fall_back)
+{
+    const uint32_t lengths[] = { MB };
+    pslr_handle_t h = test_camera_open(lengths, 1, 128 * KB);
+
+    std::vector<uint8_t> buf = readBuffer(h, lengths[0]);
+    ASSERT_EQ(buf.size(), lengths[0]);
+    expectSegments(buf, lengths, 1);
+
+    // 1 MiB, 512 KiB and 256 KiB refused, then 8 blocks of 128 KiB
+    EXPECT_EQ(test_camera_failed_reads(), 3);
+    EXPECT_EQ(test_camera_downloads(), 3 + 8);
+    EXPECT_EQ(test_camera_block_size(), 128 * KB);
+}
+
+TEST(PslrDownloadTest, smallest_blocks_are_retried)
+{
+    const uint32_t lengths[] = { 256 * KB };
+    pslr_handle_t h = test_camera_open(lengths, 1, 64 * KB);
+
+    std::vector<uint8_t> buf = readBuffer(h, lengths[0]);
+    ASSERT_EQ(buf.size(), lengths[0]);
+    EXPECT_EQ(test_camera_block_size(), 64 * KB);
+
+    // a couple of SCSI errors on 64 KiB blocks are retried
+    h = test_camera_open(lengths, 1, 64 * KB);
+    readBuffer(h, 64 * KB);
+    test_camera_fail_reads(2);
+    buf = readBuffer(h, lengths[0] - 64 * KB);
+    ASSERT_EQ(buf.size(), lengths[0] - 64 * KB);
+    EXPECT_EQ(buf[0], test_camera_byte(0, 64 * KB));
+
+    // more errors than retries fail the read
+    h = test_camera_open(lengths, 1, 64 * KB);
+    readBuffer(h, 64 * KB);
+    test_camera_fail_reads(4);
+    EXPECT_EQ(pslr_buffer_read(h, buf.data(), 64 * KB), 0U);
+}